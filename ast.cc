@@ -9,6 +9,7 @@
 #include <stdio.h>  // printf
 #include "errors.h"
 #include "scope.h"
+#include "astcache.h"
 
 Node::Node(yyltype loc) {
   
@@ -39,6 +40,12 @@ Identifier::Identifier(yyltype loc, const char *n) : Node(loc) {
     cached = NULL;
 }
 
+int Identifier::Serialize(AstWriter *w) {
+    int off = w->BeginNode(kIdentifier, this);
+    w->PutString(name);
+    return off;
+}
+
 
 /*Проверяем, что находиться в скопе классов*/
 bool Node::IsClassScope(lookup l) {
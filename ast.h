@@ -32,6 +32,8 @@ class 		Scope;
 class 		Decl;
 class 		Identifier;
 class 		Type;
+class 		AstWriter;
+class 		IRGen;
 
 class Node 
 {
@@ -58,6 +60,10 @@ class Node
 
     bool IsClassScope(lookup l=kDeep);
 
+    // Writes this node's record for the AST cache (see astcache.h) and
+    // returns its offset. Nodes the parser never builds write nothing.
+    virtual int Serialize(AstWriter *w) { return 0; }
+
 };
    
 
@@ -74,6 +80,7 @@ class Identifier : public Node
     friend std::ostream& operator<<(std::ostream& out, Identifier *id) { return out << id->name; }
 
     const char *GetName() { return name; }
+    int Serialize(AstWriter *w);
 };
 
 
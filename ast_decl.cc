@@ -4,10 +4,13 @@
  */
 
 #include "ast_decl.h"
+#include <string.h>
 #include "ast_type.h"
 #include "ast_stmt.h"
 #include "scope.h"
 #include "errors.h"
+#include "astcache.h"
+#include "irgen.h"
 
 
 // получаем местоположение узла
@@ -31,6 +34,14 @@ VarDecl::VarDecl(Identifier *n, Type *t) : Decl(n) {
 //
 void VarDecl::Check() { type->Check(); }
 
+int VarDecl::Serialize(AstWriter *w) {
+    int i = w->Write(id), t = w->Write(type);
+    int off = w->BeginNode(kVarDecl, this);
+    w->PutRef(i);
+    w->PutRef(t);
+    return off;
+}
+
 //
 ClassDecl::ClassDecl(Identifier *n, NamedType *ex, List<NamedType*> *imp, List<Decl*> *m) : Decl(n) {
     // extends can be NULL, impl & mem may be empty lists but cannot be NULL
@@ -42,26 +53,38 @@ ClassDecl::ClassDecl(Identifier *n, NamedType *ex, List<NamedType*> *imp, List<D
     cType = new NamedType(n);
     cType->SetParent(this);
     convImp = NULL;
+    vtable = NULL;
 }
 
 //класс для проверки элементов дерева
+// extends and implements were already resolved by the hierarchy pass
+// (see hierarchy.h), which reported and dropped the undeclared ones.
 void ClassDecl::Check() {
-
-    if (extends && !extends->IsClass()) {
-        ReportError::IdentifierNotDeclared(extends->GetId(), LookingForClass);
-        extends = NULL;
-    }
-    for (int i = 0; i < implements->NumElements(); i++) {
-        NamedType *in = implements->Nth(i);
-        if (!in->IsInterface()) {
-            ReportError::IdentifierNotDeclared(in->GetId(), LookingForInterface);
-            implements->RemoveAt(i--);
-        }
-    }
     PrepareScope();
     members->CheckAll();
 }
 
+int ClassDecl::Serialize(AstWriter *w) {
+    int i = w->Write(id), e = w->Write(extends);
+    int im = w->WriteList(implements), m = w->WriteList(members);
+    int off = w->BeginNode(kClassDecl, this);
+    w->PutRef(i);
+    w->PutRef(e);
+    w->PutRef(im);
+    w->PutRef(m);
+    return off;
+}
+
+void ClassDecl::Emit(IRGen *gen) {
+    for (int i = 0; i < members->NumElements(); i++)
+        members->Nth(i)->Emit(gen);
+}
+
+void ClassDecl::Fold() {
+    for (int i = 0; i < members->NumElements(); i++)
+        members->Nth(i)->Fold();
+}
+
 // This is not done very cleanly. I should sit down and sort this out. Right now
 // I was using the copy-in strategy from the old compiler, but I think the link to
 // parent may be the better way now.
@@ -70,8 +93,9 @@ Scope *ClassDecl::PrepareScope()
 {
     if (nodeScope) return nodeScope;
     nodeScope = new Scope();  
+    ClassDecl *ext = NULL;
     if (extends) {
-        ClassDecl *ext = dynamic_cast<ClassDecl*>(parent->FindDecl(extends->GetId())); 
+        ext = dynamic_cast<ClassDecl*>(parent->FindDecl(extends->GetId())); 
         if (ext) nodeScope->CopyFromScope(ext->PrepareScope(), this);
     }
     convImp = new List<InterfaceDecl*>;
@@ -84,9 +108,38 @@ Scope *ClassDecl::PrepareScope()
 	  }
     }
     members->DeclareAll(nodeScope);
+    LayOutVTable(ext);
     return nodeScope;
 }
 
+/* Method: LayOutVTable
+ * --------------------
+ * Gives each method of the class a fixed slot in its vtable. The vtable
+ * starts as a copy of the superclass's, so inherited methods keep their
+ * slots; a method overriding one of them takes over its slot and a new
+ * method is added at the end. A call through a reference of this class's
+ * type can then find the method in any subclass at the same slot.
+ */
+void ClassDecl::LayOutVTable(ClassDecl *ext)
+{
+    vtable = new List<FnDecl*>;
+    if (ext) {
+        List<FnDecl*> *inherited = ext->GetVTable();
+        for (int i = 0; i < inherited->NumElements(); i++)
+            vtable->Append(inherited->Nth(i));
+    }
+    for (int i = 0; i < members->NumElements(); i++) {
+        FnDecl *fn = dynamic_cast<FnDecl*>(members->Nth(i));
+        if (!fn) continue;
+        int slot = 0;
+        while (slot < vtable->NumElements() && strcmp(vtable->Nth(slot)->GetName(), fn->GetName()))
+            slot++;
+        if (slot < vtable->NumElements()) vtable->RemoveAt(slot);
+        vtable->InsertAt(fn, slot);
+        fn->SetVTableSlot(slot);
+    }
+}
+
 
 //по умолчанию задаем, что все узлы
 InterfaceDecl::InterfaceDecl(Identifier *n, List<Decl*> *m) : Decl(n) {
@@ -98,11 +151,24 @@ void InterfaceDecl::Check() {
     PrepareScope();
     members->CheckAll();
 }
+
+int InterfaceDecl::Serialize(AstWriter *w) {
+    int i = w->Write(id), m = w->WriteList(members);
+    int off = w->BeginNode(kInterfaceDecl, this);
+    w->PutRef(i);
+    w->PutRef(m);
+    return off;
+}
   
+// Each method's slot is its index in the itables for this interface.
 Scope *InterfaceDecl::PrepareScope() {
     if (nodeScope) return nodeScope;
     nodeScope = new Scope();  
     members->DeclareAll(nodeScope);
+    for (int i = 0, slot = 0; i < members->NumElements(); i++) {
+        FnDecl *fn = dynamic_cast<FnDecl*>(members->Nth(i));
+        if (fn) fn->SetVTableSlot(slot++);
+    }
     return nodeScope;
 }
 	
@@ -111,6 +177,7 @@ FnDecl::FnDecl(Identifier *n, Type *r, List<VarDecl*> *d) : Decl(n) {
     (returnType=r)->SetParent(this);
     (formals=d)->SetParentAll(this);
     body = NULL;
+    vtableSlot = -1;
 }
 
 void FnDecl::SetFunctionBody(Stmt *b) { 
@@ -127,6 +194,27 @@ void FnDecl::Check() {
     }
 }
 
+int FnDecl::Serialize(AstWriter *w) {
+    int i = w->Write(id), r = w->Write(returnType);
+    int f = w->WriteList(formals), b = w->Write(body);
+    int off = w->BeginNode(kFnDecl, this);
+    w->PutRef(i);
+    w->PutRef(r);
+    w->PutRef(f);
+    w->PutRef(b);
+    return off;
+}
+
+void FnDecl::Emit(IRGen *gen) {
+    gen->BeginFunction(this);
+    if (body) gen->EmitStmt(body);
+    gen->EndFunction();
+}
+
+void FnDecl::Fold() {
+    if (body) body = body->Fold();
+}
+
 bool FnDecl::ConflictsWithPrevious(Decl *prev) {
  // special case error for method override
     if (IsMethodDecl() && prev->IsMethodDecl() && parent != prev->GetParent()) { 
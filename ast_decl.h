@@ -36,6 +36,12 @@ class Decl : public Node
     virtual bool IsInterfaceDecl() { return false; }
     virtual bool IsFnDecl() { return false; } 
     virtual bool IsMethodDecl() { return false; }
+
+    // Folds the constant expressions in the bodies (see Program::Fold)
+    virtual void Fold() {}
+
+    // Lowers the declaration to the IR (see irgen.h)
+    virtual void Emit(IRGen *gen) {}
 };
 
 class VarDecl : public Decl 
@@ -46,7 +52,9 @@ class VarDecl : public Decl
   public:
     VarDecl(Identifier *name, Type *type);
     void Check();
+    int Serialize(AstWriter *w);
     Type *GetDeclaredType() { return type; }
+    bool IsVarDecl() { return true; }
 };
 
 class ClassDecl : public Decl 
@@ -57,11 +65,23 @@ class ClassDecl : public Decl
     List<NamedType*> *implements;
     Type *cType;
     List<InterfaceDecl*> *convImp;
+    List<FnDecl*> *vtable;
+
+    void LayOutVTable(ClassDecl *ext);
 
   public:
     ClassDecl(Identifier *name, NamedType *extends, 
               List<NamedType*> *implements, List<Decl*> *members);
     void Check();
+    NamedType *GetExtends() { return extends; }
+    void ClearExtends() { extends = NULL; }
+    List<NamedType*> *GetImplements() { return implements; }
+    List<Decl*> *GetMembers() { return members; }
+    Type *GetClassType() { return cType; }
+    List<FnDecl*> *GetVTable() { PrepareScope(); return vtable; }
+    int Serialize(AstWriter *w);
+    void Fold();
+    void Emit(IRGen *gen);
     bool IsClassDecl() { return true; }
     Scope *PrepareScope();
 };
@@ -74,6 +94,8 @@ class InterfaceDecl : public Decl
   public:
     InterfaceDecl(Identifier *name, List<Decl*> *members);
     void Check();
+    List<Decl*> *GetMembers() { return members; }
+    int Serialize(AstWriter *w);
     bool IsInterfaceDecl() { return true; }
     Scope *PrepareScope();
 };
@@ -84,11 +106,19 @@ class FnDecl : public Decl
     List<VarDecl*> *formals;
     Type *returnType;
     Stmt *body;
+    int vtableSlot;
     
   public:
     FnDecl(Identifier *name, Type *returnType, List<VarDecl*> *formals);
     void SetFunctionBody(Stmt *b);
     void Check();
+    Type *GetReturnType() { return returnType; }
+    List<VarDecl*> *GetFormals() { return formals; }
+    int GetVTableSlot() { return vtableSlot; } // vtable or itable slot, -1 for a function
+    void SetVTableSlot(int slot) { vtableSlot = slot; }
+    int Serialize(AstWriter *w);
+    void Fold();
+    void Emit(IRGen *gen);
     bool IsFnDecl() { return true; }
     bool IsMethodDecl();
     bool ConflictsWithPrevious(Decl *prev);
@@ -6,8 +6,12 @@
 #include "ast_type.h"
 #include "ast_decl.h"
 #include <string.h>
+#include <limits.h>
+#include <math.h>
 
 #include "errors.h"
+#include "astcache.h"
+#include "irgen.h"
 
 
 IntConstant::IntConstant(yyltype loc, int val) : Expr(loc) {
@@ -31,6 +35,66 @@ Operator::Operator(yyltype loc, const char *tok) : Node(loc) {
     Assert(tok != NULL);
     strncpy(tokenString, tok, sizeof(tokenString));
 }
+
+int EmptyExpr::Serialize(AstWriter *w) {
+    return w->BeginNode(kEmptyExpr, this);
+}
+
+int IntConstant::Serialize(AstWriter *w) {
+    int off = w->BeginNode(kIntConstant, this);
+    w->PutInt(value);
+    return off;
+}
+
+int DoubleConstant::Serialize(AstWriter *w) {
+    int off = w->BeginNode(kDoubleConstant, this);
+    w->PutDouble(value);
+    return off;
+}
+
+int BoolConstant::Serialize(AstWriter *w) {
+    int off = w->BeginNode(kBoolConstant, this);
+    w->PutInt(value);
+    return off;
+}
+
+int StringConstant::Serialize(AstWriter *w) {
+    int off = w->BeginNode(kStringConstant, this);
+    w->PutString(value);
+    return off;
+}
+
+int NullConstant::Serialize(AstWriter *w) {
+    return w->BeginNode(kNullConstant, this);
+}
+
+int EmptyExpr::Emit(IRGen *gen) { return -1; }
+
+int IntConstant::Emit(IRGen *gen) {
+    return gen->EmitValue(opLoadInt, Type::intType, value);
+}
+
+int DoubleConstant::Emit(IRGen *gen) {
+    return gen->EmitValue(opLoadDouble, Type::doubleType, gen->DoubleConstant(value));
+}
+
+int BoolConstant::Emit(IRGen *gen) {
+    return gen->EmitValue(opLoadInt, Type::boolType, value);
+}
+
+int StringConstant::Emit(IRGen *gen) {
+    return gen->EmitValue(opLoadString, Type::stringType, gen->StringConstant(value));
+}
+
+int NullConstant::Emit(IRGen *gen) {
+    return gen->EmitValue(opLoadNull, Type::nullType);
+}
+
+int Operator::Serialize(AstWriter *w) {
+    int off = w->BeginNode(kOperator, this);
+    w->PutString(tokenString);
+    return off;
+}
 CompoundExpr::CompoundExpr(Expr *l, Operator *o, Expr *r) 
   : Expr(Join(l->GetLocation(), r->GetLocation())) {
     Assert(l != NULL && o != NULL && r != NULL);
@@ -57,6 +121,224 @@ CompoundExpr::CompoundExpr(Expr *l, Operator *o)
     right=NULL;
 } 
 
+// left or right is written as a NULL reference for the unary forms
+int CompoundExpr::SerializeAs(AstWriter *w, int tag) {
+    int l = w->Write(left), o = w->Write(op), r = w->Write(right);
+    int off = w->BeginNode((nodeTagT)tag, this);
+    w->PutRef(l);
+    w->PutRef(o);
+    w->PutRef(r);
+    return off;
+}
+
+int PostfixExpr::Serialize(AstWriter *w) { return SerializeAs(w, kPostfixExpr); }
+int ArithmeticExpr::Serialize(AstWriter *w) { return SerializeAs(w, kArithmeticExpr); }
+int RelationalExpr::Serialize(AstWriter *w) { return SerializeAs(w, kRelationalExpr); }
+int EqualityExpr::Serialize(AstWriter *w) { return SerializeAs(w, kEqualityExpr); }
+int LogicalExpr::Serialize(AstWriter *w) { return SerializeAs(w, kLogicalExpr); }
+int AssignExpr::Serialize(AstWriter *w) { return SerializeAs(w, kAssignExpr); }
+
+/* The operators of each kind of expression and the int and double forms
+ * of the instruction for each. The checker has made sure the operands
+ * have the same type, so the type of the right operand picks the form.
+ */
+typedef struct {
+    const char *token;
+    opCodeT intOp, doubleOp;
+} opTableT;
+
+static const opTableT arithmeticOps[] = {
+    { "+", opAddI, opAddD }, { "-", opSubI, opSubD }, { "*", opMulI, opMulD },
+    { "/", opDivI, opDivD }, { "%", opModI, opModD }, { NULL }
+};
+static const opTableT relationalOps[] = {
+    { "<", opLtI, opLtD }, { "<=", opLeI, opLeD }, { ">", opGtI, opGtD },
+    { ">=", opGeI, opGeD }, { NULL }
+};
+
+static opCodeT LookupOp(const opTableT *table, Operator *op, bool isDouble) {
+    for (; table->token; table++)
+        if (!strcmp(table->token, op->str()))
+            return isDouble ? table->doubleOp : table->intOp;
+    Assert(0);
+    return opNop;
+}
+
+int ArithmeticExpr::Emit(IRGen *gen) {
+    int l = left ? left->Emit(gen) : -1;
+    int r = right->Emit(gen);
+    bool isDouble = (gen->GetValueType(r) == vDouble);
+    if (!left) return gen->EmitValue(isDouble ? opNegD : opNegI, gen->GetRegType(r), r);
+    return gen->EmitValue(LookupOp(arithmeticOps, op, isDouble), gen->GetRegType(r), l, r);
+}
+
+int RelationalExpr::Emit(IRGen *gen) {
+    int l = left->Emit(gen), r = right->Emit(gen);
+    bool isDouble = (gen->GetValueType(r) == vDouble);
+    return gen->EmitValue(LookupOp(relationalOps, op, isDouble), Type::boolType, l, r);
+}
+
+/* Strings compare by contents, other references by identity.
+ */
+int EqualityExpr::Emit(IRGen *gen) {
+    int l = left->Emit(gen), r = right->Emit(gen);
+    bool equal = !strcmp(op->str(), "==");
+    valueTypeT lt = gen->GetValueType(l), rt = gen->GetValueType(r);
+    opCodeT code = equal ? opEqI : opNeI;
+    if (lt == vDouble)
+        code = equal ? opEqD : opNeD;
+    else if (lt == vString && rt == vString)
+        code = equal ? opEqStr : opNeStr;
+    else if (IsReference(lt) || IsReference(rt))
+        code = equal ? opEqRef : opNeRef;
+    return gen->EmitValue(code, Type::boolType, l, r);
+}
+
+int LogicalExpr::Emit(IRGen *gen) {
+    int l = left ? left->Emit(gen) : -1;
+    int r = right->Emit(gen);
+    if (!left) return gen->EmitValue(opNot, Type::boolType, r);
+    return gen->EmitValue(!strcmp(op->str(), "&&") ? opAnd : opOr, Type::boolType, l, r);
+}
+
+/* Folding. Expressions whose operands are constants become constants,
+ * with int arithmetic wrapping around and doubles computed as the VM
+ * does; an int division by zero or of INT_MIN by -1 is left to fail at
+ * run time. Identities drop a constant operand that cannot change the
+ * value (x + 0, x * 1, !!b, b && true). Both operands of && and || are
+ * always evaluated, so a constant one may only be dropped when it does
+ * not decide the result.
+ */
+Expr *CompoundExpr::Fold() {
+    if (left) left = left->Fold();
+    if (right) right = right->Fold();
+    return this;
+}
+
+Expr *CompoundExpr::Replace(Expr *e) {
+    e->SetParent(parent);
+    return e;
+}
+
+static bool IsIntConstant(Expr *e, int value) {
+    IntConstant *c = dynamic_cast<IntConstant*>(e);
+    return c && c->GetValue() == value;
+}
+
+static bool IsDoubleConstant(Expr *e, double value) {
+    DoubleConstant *c = dynamic_cast<DoubleConstant*>(e);
+    return c && c->GetValue() == value;
+}
+
+static bool IsBoolConstant(Expr *e, bool value) {
+    BoolConstant *c = dynamic_cast<BoolConstant*>(e);
+    return c && c->GetValue() == value;
+}
+
+Expr *ArithmeticExpr::Fold() {
+    CompoundExpr::Fold();
+    IntConstant *li = dynamic_cast<IntConstant*>(left), *ri = dynamic_cast<IntConstant*>(right);
+    DoubleConstant *ld = dynamic_cast<DoubleConstant*>(left), *rd = dynamic_cast<DoubleConstant*>(right);
+    char o = op->str()[0];
+    if (!left) {
+        if (ri) return Replace(new IntConstant(*location, (int)(0u - (unsigned)ri->GetValue())));
+        if (rd) return Replace(new DoubleConstant(*location, -rd->GetValue()));
+        return this;
+    }
+    if (li && ri) {
+        int a = li->GetValue(), b = ri->GetValue();
+        if ((o == '/' || o == '%') && (b == 0 || (a == INT_MIN && b == -1))) return this;
+        unsigned ua = a, ub = b;
+        int value = o == '+' ? (int)(ua + ub) : o == '-' ? (int)(ua - ub) : o == '*' ? (int)(ua * ub) :
+                    o == '/' ? a / b : a % b;
+        return Replace(new IntConstant(*location, value));
+    }
+    if (ld && rd) {
+        double a = ld->GetValue(), b = rd->GetValue();
+        double value = o == '+' ? a + b : o == '-' ? a - b : o == '*' ? a * b : o == '/' ? a / b : fmod(a, b);
+        return Replace(new DoubleConstant(*location, value));
+    }
+    if ((o == '+' || o == '-') && IsIntConstant(right, 0)) return Replace(left);
+    if ((o == '*' || o == '/') && (IsIntConstant(right, 1) || IsDoubleConstant(right, 1))) return Replace(left);
+    if (o == '-' && IsDoubleConstant(right, 0) && !signbit(rd->GetValue())) return Replace(left);
+    if (o == '+' && IsIntConstant(left, 0)) return Replace(right);
+    if (o == '*' && (IsIntConstant(left, 1) || IsDoubleConstant(left, 1))) return Replace(right);
+    return this;
+}
+
+Expr *RelationalExpr::Fold() {
+    CompoundExpr::Fold();
+    double a, b;
+    IntConstant *li = dynamic_cast<IntConstant*>(left), *ri = dynamic_cast<IntConstant*>(right);
+    DoubleConstant *ld = dynamic_cast<DoubleConstant*>(left), *rd = dynamic_cast<DoubleConstant*>(right);
+    if (li && ri) {
+        a = li->GetValue();
+        b = ri->GetValue();
+    } else if (ld && rd) {
+        a = ld->GetValue();
+        b = rd->GetValue();
+    } else {
+        return this;
+    }
+    const char *o = op->str();
+    bool value = !strcmp(o, "<") ? a < b : !strcmp(o, "<=") ? a <= b : !strcmp(o, ">") ? a > b : a >= b;
+    return Replace(new BoolConstant(*location, value));
+}
+
+Expr *EqualityExpr::Fold() {
+    CompoundExpr::Fold();
+    bool equal;
+    IntConstant *li = dynamic_cast<IntConstant*>(left), *ri = dynamic_cast<IntConstant*>(right);
+    DoubleConstant *ld = dynamic_cast<DoubleConstant*>(left), *rd = dynamic_cast<DoubleConstant*>(right);
+    BoolConstant *lb = dynamic_cast<BoolConstant*>(left), *rb = dynamic_cast<BoolConstant*>(right);
+    StringConstant *ls = dynamic_cast<StringConstant*>(left), *rs = dynamic_cast<StringConstant*>(right);
+    if (li && ri) equal = li->GetValue() == ri->GetValue();
+    else if (ld && rd) equal = ld->GetValue() == rd->GetValue();
+    else if (lb && rb) equal = lb->GetValue() == rb->GetValue();
+    else if (ls && rs) equal = !strcmp(ls->GetValue(), rs->GetValue());
+    else if (dynamic_cast<NullConstant*>(left) && dynamic_cast<NullConstant*>(right)) equal = true;
+    else return this;
+    return Replace(new BoolConstant(*location, equal == !strcmp(op->str(), "==")));
+}
+
+Expr *LogicalExpr::Fold() {
+    CompoundExpr::Fold();
+    BoolConstant *lb = dynamic_cast<BoolConstant*>(left), *rb = dynamic_cast<BoolConstant*>(right);
+    if (!left) {
+        if (rb) return Replace(new BoolConstant(*location, !rb->GetValue()));
+        LogicalExpr *inner = dynamic_cast<LogicalExpr*>(right);
+        if (inner && !inner->left) return Replace(inner->right);
+        return this;
+    }
+    bool isAnd = !strcmp(op->str(), "&&");
+    if (lb && rb)
+        return Replace(new BoolConstant(*location, isAnd ? lb->GetValue() && rb->GetValue()
+                                                         : lb->GetValue() || rb->GetValue()));
+    if (IsBoolConstant(right, isAnd)) return Replace(left);
+    if (IsBoolConstant(left, isAnd)) return Replace(right);
+    return this;
+}
+
+int AssignExpr::Emit(IRGen *gen) {
+    int r = right->Emit(gen);
+    LValue *lvalue = dynamic_cast<LValue*>(left);
+    Assert(lvalue != NULL);
+    lvalue->EmitStore(gen, r);
+    return r;
+}
+
+/* x++ and x-- yield the old value of x.
+ */
+int PostfixExpr::Emit(IRGen *gen) {
+    int v = left->Emit(gen);
+    Type *t = gen->GetRegType(v);
+    int old = gen->EmitValue(opMove, t, v);
+    int one = gen->EmitValue(opLoadInt, Type::intType, 1);
+    int updated = gen->EmitValue(!strcmp(op->str(), "++") ? opAddI : opSubI, t, old, one);
+    dynamic_cast<LValue*>(left)->EmitStore(gen, updated);
+    return old;
+}
+
 void CompoundExpr::Check() {
   Type* aux;
   aux = CompoundExpr::GetType();
@@ -145,7 +427,7 @@ Type* AssignExpr::GetType(){
         return Type::errorType;
     }
     if ((typeLeft != Type::nullType) &&(typeRight!= Type::nullType)){
-        if(typeLeft->IsEquivalentTo(typeRight)==false){
+        if(typeLeft->IsCompatibleWith(typeRight)==false){
             ReportError::IncompatibleOperands(op, typeLeft, typeRight);
             return Type::errorType;
         }
@@ -178,6 +460,31 @@ ArrayAccess::ArrayAccess(yyltype loc, Expr *b, Expr *s) : LValue(loc) {
     (subscript=s)->SetParent(this);
 }
 
+int ArrayAccess::Serialize(AstWriter *w) {
+    int b = w->Write(base), s = w->Write(subscript);
+    int off = w->BeginNode(kArrayAccess, this);
+    w->PutRef(b);
+    w->PutRef(s);
+    return off;
+}
+
+int ArrayAccess::Emit(IRGen *gen) {
+    int b = base->Emit(gen), s = subscript->Emit(gen);
+    ArrayType *t = dynamic_cast<ArrayType*>(gen->GetRegType(b));
+    return gen->EmitValue(opArrayLoad, t->GetElemType(), b, s);
+}
+
+void ArrayAccess::EmitStore(IRGen *gen, int reg) {
+    int b = base->Emit(gen), s = subscript->Emit(gen);
+    gen->Emit(opArrayStore, -1, b, s, reg);
+}
+
+Expr *ArrayAccess::Fold() {
+    base = base->Fold();
+    subscript = subscript->Fold();
+    return this;
+}
+
 void ArrayAccess::Check(){
     //Проверить что основание типа массив
     Type* basetype;
@@ -216,6 +523,39 @@ FieldAccess::FieldAccess(Expr *b, Identifier *f)
     (field=f)->SetParent(this);
 }
 
+int FieldAccess::Serialize(AstWriter *w) {
+    int b = w->Write(base), f = w->Write(field);
+    int off = w->BeginNode(kFieldAccess, this);
+    w->PutRef(b);
+    w->PutRef(f);
+    return off;
+}
+
+/* Without a base the name is a variable in scope: a local, a global or
+ * a field of this. With one, it is a field of the base's static class.
+ */
+int FieldAccess::Emit(IRGen *gen) {
+    if (!base) return gen->LoadVariable(dynamic_cast<VarDecl*>(parent->FindDecl(field)));
+    int b = base->Emit(gen);
+    Decl *cls = gen->GetClassDecl(b);
+    VarDecl *var = dynamic_cast<VarDecl*>(gen->LookupMember(cls, field));
+    return gen->EmitValue(opGetField, var->GetDeclaredType(), b, gen->GetMember(cls, field->GetName()));
+}
+
+void FieldAccess::EmitStore(IRGen *gen, int reg) {
+    if (!base) {
+        gen->StoreVariable(dynamic_cast<VarDecl*>(parent->FindDecl(field)), reg);
+        return;
+    }
+    int b = base->Emit(gen);
+    gen->Emit(opSetField, -1, b, gen->GetMember(gen->GetClassDecl(b), field->GetName()), reg);
+}
+
+
+Expr *FieldAccess::Fold() {
+    if (base) base = base->Fold();
+    return this;
+}
 
 
 Type* FieldAccess::GetType(){
@@ -257,7 +597,10 @@ Type* FieldAccess::GetType(){
         ReportError::InaccessibleField(field, base->GetType());
         return Type::errorType;
     }
-    return Type::errorType;
+    Identifier *id = dynamic_cast<NamedType*>(base->GetType())->GetId();
+    Scope *classScope = parent->FindDecl(id)->PrepareScope();
+    VarDecl *vardecl = dynamic_cast<VarDecl*>(classScope->Lookup(field));
+    return vardecl ? vardecl->GetDeclaredType() : Type::errorType;
 }
 
 void FieldAccess::Check(){
@@ -274,6 +617,56 @@ Call::Call(yyltype loc, Expr *b, Identifier *f, List<Expr*> *a) : Expr(loc)  {
     (actuals=a)->SetParentAll(this);
 }
 
+int Call::Serialize(AstWriter *w) {
+    int b = w->Write(base), f = w->Write(field), a = w->WriteList(actuals);
+    int off = w->BeginNode(kCall, this);
+    w->PutRef(b);
+    w->PutRef(f);
+    w->PutRef(a);
+    return off;
+}
+
+/* A call without a base is to a global function, or to a method of this
+ * if the name is found in the class. A method's receiver is passed as
+ * its first argument. length() on an array is not a call at all.
+ */
+int Call::Emit(IRGen *gen) {
+    std::vector<int> args;
+    Decl *cls = NULL;
+    FnDecl *fn;
+    if (base) {
+        int receiver = base->Emit(gen);
+        if (gen->GetValueType(receiver) == vArray)
+            return gen->EmitValue(opArrayLength, Type::intType, receiver);
+        cls = gen->GetClassDecl(receiver);
+        fn = dynamic_cast<FnDecl*>(gen->LookupMember(cls, field));
+        args.push_back(receiver);
+    } else {
+        fn = dynamic_cast<FnDecl*>(parent->FindDecl(field));
+        if (fn->IsMethodDecl()) {
+            cls = gen->GetClassDecl(gen->GetThis());
+            args.push_back(gen->GetThis());
+        }
+    }
+    Assert(fn != NULL);
+    for (int i = 0; i < actuals->NumElements(); i++)
+        args.push_back(actuals->Nth(i)->Emit(gen));
+    if (!cls)
+        return gen->EmitCall(opCall, fn->GetReturnType(), gen->GetFunction(fn), args);
+    opCodeT op = cls->IsClassDecl() && dynamic_cast<ClassDecl*>(fn->GetParent()) ? opCallVirtual : opCallInterface;
+    return gen->EmitCall(op, fn->GetReturnType(), gen->GetMember(cls, field->GetName()), args);
+}
+
+Expr *Call::Fold() {
+    if (base) base = base->Fold();
+    for (int i = 0; i < actuals->NumElements(); i++) {
+        Expr *actual = actuals->Nth(i)->Fold();
+        actuals->RemoveAt(i);
+        actuals->InsertAt(actual, i);
+    }
+    return this;
+}
+
 void Call::Check(){
     actuals->CheckAll();
     if (base==NULL){
@@ -285,13 +678,17 @@ void Call::Check(){
                 return;
         }
         //Проверка что формально и на самом деле одинковые размеры
-        List<VarDecl*> formals = fndecl->GetFormals();
-        if(actuals->NumElements()!=formals.NumElements()){
-            ReportError::NumArgsMismatch(field, formals.NumElements(), actuals->NumElements());
+        List<VarDecl*> *formals = fndecl->GetFormals();
+        if(actuals->NumElements()!=formals->NumElements()){
+            ReportError::NumArgsMismatch(field, formals->NumElements(), actuals->NumElements());
             return;
         }
         return;
     }
+    //length() массива
+    if(dynamic_cast<ArrayType*>(base->GetType())!=NULL && strcmp(field->GetName(), "length")==0){
+        return;
+    }
     //Проверка что база имеет перечисленный тип не примитивный и не массив
     if(dynamic_cast<NamedType*>(base->GetType())==NULL){
         ReportError::FieldNotFoundInBase(field, base->GetType());
@@ -316,11 +713,44 @@ void Call::Check(){
 
 };
 
+/* Method: GetFnDecl
+ * -----------------
+ * Returns the function or method called, or NULL if the name does not
+ * resolve to one. Reports nothing, Check does that.
+ */
+FnDecl *Call::GetFnDecl(){
+    if (base==NULL)
+        return dynamic_cast<FnDecl*>(parent->FindDecl(field));
+    NamedType *baseType = dynamic_cast<NamedType*>(base->GetType());
+    if (baseType==NULL || baseType->GetDeclForType()==NULL)
+        return NULL;
+    Scope *classScope = baseType->GetDeclForType()->PrepareScope();
+    return dynamic_cast<FnDecl*>(classScope->Lookup(field));
+}
+
+Type* Call::GetType(){
+    if (base && dynamic_cast<ArrayType*>(base->GetType()) && strcmp(field->GetName(), "length")==0)
+        return Type::intType;
+    FnDecl *fndecl = GetFnDecl();
+    return fndecl ? fndecl->GetReturnType() : Type::errorType;
+}
+
 NewExpr::NewExpr(yyltype loc, NamedType *c) : Expr(loc) { 
   Assert(c != NULL);
   (cType=c)->SetParent(this);
 }
 
+int NewExpr::Serialize(AstWriter *w) {
+    int c = w->Write(cType);
+    int off = w->BeginNode(kNewExpr, this);
+    w->PutRef(c);
+    return off;
+}
+
+int NewExpr::Emit(IRGen *gen) {
+    return gen->EmitValue(opNew, cType, gen->GetClass(cType->GetDeclForType()));
+}
+
 
 NewArrayExpr::NewArrayExpr(yyltype loc, Expr *sz, Type *et) : Expr(loc) {
     Assert(sz != NULL && et != NULL);
@@ -329,6 +759,42 @@ NewArrayExpr::NewArrayExpr(yyltype loc, Expr *sz, Type *et) : Expr(loc) {
     currloc=loc; // Добавим местоположение для новой переменнй в массиве
 }
 
+int NewArrayExpr::Serialize(AstWriter *w) {
+    int s = w->Write(size), e = w->Write(elemType);
+    int off = w->BeginNode(kNewArrayExpr, this);
+    w->PutRef(s);
+    w->PutRef(e);
+    return off;
+}
+
+int NewArrayExpr::Emit(IRGen *gen) {
+    int s = size->Emit(gen);
+    Type *t = new ArrayType(currloc, elemType);
+    elemType->SetParent(this); // the ArrayType took it over
+    return gen->EmitValue(opNewArray, t, s, ValueTypeOf(elemType));
+}
+
+Expr *NewArrayExpr::Fold() {
+    size = size->Fold();
+    return this;
+}
+
+int ReadIntegerExpr::Serialize(AstWriter *w) {
+    return w->BeginNode(kReadIntegerExpr, this);
+}
+
+int ReadLineExpr::Serialize(AstWriter *w) {
+    return w->BeginNode(kReadLineExpr, this);
+}
+
+int ReadIntegerExpr::Emit(IRGen *gen) {
+    return gen->EmitValue(opReadInteger, Type::intType);
+}
+
+int ReadLineExpr::Emit(IRGen *gen) {
+    return gen->EmitValue(opReadLine, Type::stringType);
+}
+
        
 void NewArrayExpr::Check(){
     //Проверить, что размер массива целое число
@@ -352,5 +818,17 @@ void This::Check(){
 }
 Type* This::GetType(){
     This::Check();
+    for (Node *n = parent; n; n = n->GetParent()) {
+        ClassDecl *classdecl = dynamic_cast<ClassDecl*>(n);
+        if (classdecl) return classdecl->GetClassType();
+    }
     return Type::errorType;
 }
+
+int This::Serialize(AstWriter *w) {
+    return w->BeginNode(kThis, this);
+}
+
+int This::Emit(IRGen *gen) {
+    return gen->GetThis();
+}
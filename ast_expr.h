@@ -15,6 +15,7 @@
 
 class NamedType; // for new
 class Type; // for NewArray
+class FnDecl;
 
 
 class Expr : public Stmt 
@@ -24,6 +25,7 @@ class Expr : public Stmt
     Expr() : Stmt() {}
     virtual void Check(){return;}
     virtual Type* GetType(){return(Type::errorType);}
+    virtual Expr *Fold() { return this; }
 };
 
 /* This node type is used for those places where an expression is optional.
@@ -32,6 +34,8 @@ class Expr : public Stmt
 class EmptyExpr : public Expr
 {
   public: Type* GetType(){return(Type::errorType);}
+    int Serialize(AstWriter *w);
+    int Emit(IRGen *gen);
 };
 
 class IntConstant : public Expr 
@@ -42,6 +46,9 @@ class IntConstant : public Expr
   public:
     IntConstant(yyltype loc, int val);
     Type* GetType(){return(Type::intType);}
+    int GetValue() { return value; }
+    int Serialize(AstWriter *w);
+    int Emit(IRGen *gen);
 };
 
 class DoubleConstant : public Expr 
@@ -52,6 +59,9 @@ class DoubleConstant : public Expr
   public:
     DoubleConstant(yyltype loc, double val);
     Type* GetType(){return(Type::doubleType);}
+    double GetValue() { return value; }
+    int Serialize(AstWriter *w);
+    int Emit(IRGen *gen);
 };
 
 class BoolConstant : public Expr 
@@ -62,6 +72,9 @@ class BoolConstant : public Expr
   public:
     BoolConstant(yyltype loc, bool val);
     Type* GetType(){return(Type::boolType);}
+    bool GetValue() { return value; }
+    int Serialize(AstWriter *w);
+    int Emit(IRGen *gen);
 };
 
 class StringConstant : public Expr 
@@ -72,6 +85,9 @@ class StringConstant : public Expr
   public:
     StringConstant(yyltype loc, const char *val);
     Type* GetType(){return(Type::stringType);}
+    const char *GetValue() { return value; }
+    int Serialize(AstWriter *w);
+    int Emit(IRGen *gen);
 };
 
 class NullConstant: public Expr 
@@ -79,6 +95,8 @@ class NullConstant: public Expr
   public: 
     NullConstant(yyltype loc) : Expr(loc) {}
     Type* GetType(){return(Type::nullType);}
+    int Serialize(AstWriter *w);
+    int Emit(IRGen *gen);
 };
 
 class Operator : public Node 
@@ -90,6 +108,7 @@ class Operator : public Node
     Operator(yyltype loc, const char *tok);
     friend std::ostream& operator<<(std::ostream& out, Operator *o) { return out << o->tokenString; }
     const char *str() { return tokenString; }
+    int Serialize(AstWriter *w);
  };
  
 class CompoundExpr : public Expr
@@ -106,6 +125,11 @@ class CompoundExpr : public Expr
     Type* GetRight();
     Type* GetType();
     void Check();
+    Expr *Fold();
+
+  protected:
+    int SerializeAs(AstWriter *w, int tag);
+    Expr *Replace(Expr *e);
 };
 
 class PostfixExpr : public CompoundExpr 
@@ -113,6 +137,8 @@ class PostfixExpr : public CompoundExpr
   public:
     PostfixExpr(Expr *lhs, Operator *op) : CompoundExpr(lhs,op) {}
     Type* GetType(){return(Type::errorType);}
+    int Serialize(AstWriter *w);
+    int Emit(IRGen *gen);
 };
 
 class ArithmeticExpr : public CompoundExpr 
@@ -122,6 +148,9 @@ class ArithmeticExpr : public CompoundExpr
     ArithmeticExpr(Operator *op, Expr *rhs) : CompoundExpr(op,rhs) {}
     Type* GetType();
     void Check();
+    int Serialize(AstWriter *w);
+    Expr *Fold();
+    int Emit(IRGen *gen);
 };
 
 class RelationalExpr : public CompoundExpr 
@@ -129,6 +158,9 @@ class RelationalExpr : public CompoundExpr
   public:
     RelationalExpr(Expr *lhs, Operator *op, Expr *rhs) : CompoundExpr(lhs,op,rhs) {}
     Type* GetType(){return(Type::errorType);}
+    int Serialize(AstWriter *w);
+    Expr *Fold();
+    int Emit(IRGen *gen);
 };
 
 class EqualityExpr : public CompoundExpr 
@@ -137,6 +169,9 @@ class EqualityExpr : public CompoundExpr
     EqualityExpr(Expr *lhs, Operator *op, Expr *rhs) : CompoundExpr(lhs,op,rhs) {}
     const char *GetPrintNameForNode() { return "EqualityExpr"; }
     Type* GetType(){return(Type::errorType);}
+    int Serialize(AstWriter *w);
+    Expr *Fold();
+    int Emit(IRGen *gen);
 };
 
 class LogicalExpr : public CompoundExpr 
@@ -146,6 +181,9 @@ class LogicalExpr : public CompoundExpr
     LogicalExpr(Operator *op, Expr *rhs) : CompoundExpr(op,rhs) {}
     const char *GetPrintNameForNode() { return "LogicalExpr"; }
     Type* GetType(){return(Type::errorType);}
+    int Serialize(AstWriter *w);
+    Expr *Fold();
+    int Emit(IRGen *gen);
 };
 
 class AssignExpr : public CompoundExpr 
@@ -157,12 +195,15 @@ class AssignExpr : public CompoundExpr
     Type* GetRight();
     Type* GetType();
     void Check();
+    int Serialize(AstWriter *w);
+    int Emit(IRGen *gen);
 };
 
 class LValue : public Expr 
 {
   public:
     LValue(yyltype loc) : Expr(loc) {}
+    virtual void EmitStore(IRGen *gen, int reg) {} // assigns the value in reg
     Type* GetType(){return(Type::errorType);}
 };
 
@@ -172,6 +213,8 @@ class This : public Expr
     This(yyltype loc) : Expr(loc) {}
     Type* GetType();
     void Check();
+    int Serialize(AstWriter *w);
+    int Emit(IRGen *gen);
 };
 
 class ArrayAccess : public LValue 
@@ -183,6 +226,10 @@ class ArrayAccess : public LValue
     ArrayAccess(yyltype loc, Expr *base, Expr *subscript);
     Type* GetType();
     void Check();
+    int Serialize(AstWriter *w);
+    Expr *Fold();
+    int Emit(IRGen *gen);
+    void EmitStore(IRGen *gen, int reg);
 };
 
 /* Note that field access is used both for qualified names
@@ -200,6 +247,10 @@ class FieldAccess : public LValue
     FieldAccess(Expr *base, Identifier *field); //ok to pass NULL base
     Type* GetType();
     void Check();
+    int Serialize(AstWriter *w);
+    Expr *Fold();
+    int Emit(IRGen *gen);
+    void EmitStore(IRGen *gen, int reg);
 };
 
 /* Like field access, call is used both for qualified base.field()
@@ -215,8 +266,12 @@ class Call : public Expr
     
   public:
     Call(yyltype loc, Expr *base, Identifier *field, List<Expr*> *args);
-    Type* GetType(){return(Type::errorType);}
+    FnDecl *GetFnDecl();
+    Type* GetType();
     void Check();
+    int Serialize(AstWriter *w);
+    Expr *Fold();
+    int Emit(IRGen *gen);
 };
 
 class NewExpr : public Expr
@@ -227,6 +282,8 @@ class NewExpr : public Expr
   public:
     NewExpr(yyltype loc, NamedType *clsType);
     Type* GetType(){return(Type::errorType);}
+    int Serialize(AstWriter *w);
+    int Emit(IRGen *gen);
 };
 
 class NewArrayExpr : public Expr
@@ -240,6 +297,9 @@ class NewArrayExpr : public Expr
     NewArrayExpr(yyltype loc, Expr *sizeExpr, Type *elemType);
     Type* GetType();
     void Check();
+    int Serialize(AstWriter *w);
+    Expr *Fold();
+    int Emit(IRGen *gen);
 };
 
 class ReadIntegerExpr : public Expr
@@ -247,6 +307,8 @@ class ReadIntegerExpr : public Expr
   public:
     ReadIntegerExpr(yyltype loc) : Expr(loc) {}
     Type* GetType(){return(Type::errorType);}
+    int Serialize(AstWriter *w);
+    int Emit(IRGen *gen);
 };
 
 class ReadLineExpr : public Expr
@@ -254,6 +316,8 @@ class ReadLineExpr : public Expr
   public:
     ReadLineExpr(yyltype loc) : Expr (loc) {}
     Type* GetType(){return(Type::errorType);}
+    int Serialize(AstWriter *w);
+    int Emit(IRGen *gen);
 };
 
     
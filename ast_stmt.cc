@@ -8,17 +8,120 @@
 #include "ast_expr.h"
 #include "scope.h"
 #include "errors.h"
+#include "astcache.h"
+#include "parallel.h"
+#include "hierarchy.h"
+#include "irgen.h"
+#include <string>
 
 
 Program::Program(List<Decl*> *d) {
     Assert(d != NULL);
     (decls=d)->SetParentAll(this);
+    imported = new List<Decl*>;
+    included = new List<Decl*>;
+    imports = new List<const char*>;
+}
+
+/* Imported declarations (see summary.h) are declared in the global scope
+ * ahead of our own, but they have no bodies and were already checked in
+ * their own unit, so they are not checked again.
+ */
+void Program::Import(List<Decl*> *d) {
+    d->SetParentAll(this);
+    for (int i = 0; i < d->NumElements(); i++)
+        imported->Append(d->Nth(i));
+}
+
+/* Units named by #import (see module.h) are included in dependency order,
+ * each after the units it imports. Their declarations share our global
+ * scope and are checked along with our own.
+ */
+void Program::Include(Program *unit) {
+    List<Decl*> *d = unit->decls;
+    d->SetParentAll(this);
+    for (int i = 0; i < d->NumElements(); i++)
+        included->Append(d->Nth(i));
+}
+
+/* Function: CheckAll
+ * ----------------
+ * Checks decls->Nth(i) for each i from first on, on several threads when
+ * --jobs asks for them (see parallel.h). Once the global scope and all
+ * class scopes are built and the types they declare are resolved (see
+ * hierarchy.h), checking one declaration only writes to nodes inside it
+ * and reads the others, so they can be checked independently. Each declaration's
+ * messages are appended to messages[i] and everything is printed
+ * afterwards in source order, giving the same output as a serial check.
+ */
+static void CheckAll(List<Decl*> *decls, int first, string *messages) {
+    int n = decls->NumElements();
+    ParallelFor(n - first, [&](int k) {
+        ReportError::CaptureTo(&messages[first + k]);
+        decls->Nth(first + k)->Check();
+        ReportError::CaptureTo(NULL);
+    });
+    fflush(stdout);
+    for (int i = 0; i < n; i++)
+        std::cerr << messages[i];
 }
 
 void Program::Check() {
     nodeScope = new Scope();
+    imported->DeclareAll(nodeScope);
+    included->DeclareAll(nodeScope);
     decls->DeclareAll(nodeScope);
-    decls->CheckAll();
+    List<Decl*> *all = new List<Decl*>;
+    List<Decl*> *parts[] = { imported, included, decls };
+    for (int p = 0; p < 3; p++)
+        for (int i = 0; i < parts[p]->NumElements(); i++)
+            all->Append(parts[p]->Nth(i));
+    string *messages = new string[all->NumElements()];
+    PrepareClassScopes(all, messages);
+    CheckAll(all, imported->NumElements(), messages);
+    delete[] messages;
+}
+
+/* Method: Emit
+ * ------------
+ * Lowers the program: declares the global declarations of all the files
+ * in the module first, so any of them can be referred to, then emits the
+ * function bodies.
+ */
+void Program::Emit(IRGen *gen) {
+    List<Decl*> *all = new List<Decl*>;
+    for (int i = 0; i < included->NumElements(); i++)
+        all->Append(included->Nth(i));
+    for (int i = 0; i < decls->NumElements(); i++)
+        all->Append(decls->Nth(i));
+    gen->DeclareAll(all);
+    for (int i = 0; i < all->NumElements(); i++)
+        all->Nth(i)->Emit(gen);
+}
+
+/* Method: Fold
+ * ------------
+ * Folds the constant expressions in the bodies of a checked program
+ * (see the Fold methods in ast_expr.cc) and drops the statements a
+ * constant test rules out, so lowering emits less code. The tree is
+ * only changed in place of expressions and statements; declarations
+ * and scopes stay as the checker left them.
+ */
+void Program::Fold() {
+    for (int i = 0; i < included->NumElements(); i++)
+        included->Nth(i)->Fold();
+    for (int i = 0; i < decls->NumElements(); i++)
+        decls->Nth(i)->Fold();
+}
+
+int Program::Serialize(AstWriter *w) {
+    int d = w->WriteList(decls);
+    int off = w->BeginNode(kProgram, this);
+    w->PutRef(d);
+    w->PutInt(imports->NumElements());
+    for (int i = 0; i < imports->NumElements(); i++)
+        w->PutString(imports->Nth(i));
+    return off;
 }
 
 StmtBlock::StmtBlock(List<VarDecl*> *d, List<Stmt*> *s) {
@@ -33,6 +136,35 @@ void StmtBlock::Check() {
     stmts->CheckAll();
 }
 
+int StmtBlock::Serialize(AstWriter *w) {
+    int d = w->WriteList(decls), s = w->WriteList(stmts);
+    int off = w->BeginNode(kStmtBlock, this);
+    w->PutRef(d);
+    w->PutRef(s);
+    return off;
+}
+
+int StmtBlock::Emit(IRGen *gen) {
+    for (int i = 0; i < decls->NumElements(); i++)
+        gen->DeclareLocal(decls->Nth(i));
+    for (int i = 0; i < stmts->NumElements(); i++)
+        gen->EmitStmt(stmts->Nth(i));
+    return -1;
+}
+
+/* A folded statement that does nothing, such as an if whose test is
+ * false and which has no else, is an EmptyExpr and is left out.
+ */
+Stmt *StmtBlock::Fold() {
+    for (int i = 0; i < stmts->NumElements(); ) {
+        Stmt *stmt = stmts->Nth(i)->Fold();
+        stmts->RemoveAt(i);
+        if (dynamic_cast<EmptyExpr*>(stmt)) continue;
+        stmts->InsertAt(stmt, i++);
+    }
+    return this;
+}
+
 ConditionalStmt::ConditionalStmt(Expr *t, Stmt *b) { 
     Assert(t != NULL && b != NULL);
     (test=t)->SetParent(this); 
@@ -43,12 +175,102 @@ void ConditionalStmt::Check() {
     body->Check();
 }
 
+Stmt *ConditionalStmt::Fold() {
+    test = test->Fold();
+    body = body->Fold();
+    return this;
+}
+
+/* Returns a statement that does nothing, to stand in for one folded away.
+ */
+static Stmt *Nothing(Node *parent) {
+    Stmt *empty = new EmptyExpr();
+    empty->SetParent(parent);
+    return empty;
+}
+
 ForStmt::ForStmt(Expr *i, Expr *t, Expr *s, Stmt *b): LoopStmt(t, b) { 
     Assert(i != NULL && t != NULL && s != NULL && b != NULL);
     (init=i)->SetParent(this);
     (step=s)->SetParent(this);
 }
 
+int ForStmt::Serialize(AstWriter *w) {
+    int i = w->Write(init), t = w->Write(test);
+    int s = w->Write(step), b = w->Write(body);
+    int off = w->BeginNode(kForStmt, this);
+    w->PutRef(i);
+    w->PutRef(t);
+    w->PutRef(s);
+    w->PutRef(b);
+    return off;
+}
+
+/* Loops are lowered with the test both before the loop and at its
+ * bottom, so the body is the loop's header: it runs once each time the
+ * loop is entered, which lets the optimizer (opt.h) hoist out of it
+ * even loads that may fail.
+ */
+int ForStmt::Emit(IRGen *gen) {
+    int loop = gen->NewBlock(), exit = gen->NewBlock();
+    gen->SetLine(init);
+    init->Emit(gen);
+    gen->SetLine(test);
+    gen->EmitBranch(test->Emit(gen), loop, exit);
+    gen->StartBlock(loop);
+    gen->PushBreakTarget(exit);
+    gen->EmitStmt(body);
+    gen->PopBreakTarget();
+    gen->SetLine(step);
+    step->Emit(gen);
+    gen->SetLine(test);
+    gen->EmitBranch(test->Emit(gen), loop, exit);
+    gen->StartBlock(exit);
+    return -1;
+}
+
+/* A loop whose test is false never runs its body; a for loop still
+ * runs its initialization.
+ */
+Stmt *ForStmt::Fold() {
+    ConditionalStmt::Fold();
+    init = init->Fold();
+    step = step->Fold();
+    BoolConstant *constant = dynamic_cast<BoolConstant*>(test);
+    if (!constant || constant->GetValue()) return this;
+    init->SetParent(parent);
+    return init;
+}
+
+int WhileStmt::Serialize(AstWriter *w) {
+    int t = w->Write(test), b = w->Write(body);
+    int off = w->BeginNode(kWhileStmt, this);
+    w->PutRef(t);
+    w->PutRef(b);
+    return off;
+}
+
+int WhileStmt::Emit(IRGen *gen) {
+    int loop = gen->NewBlock(), exit = gen->NewBlock();
+    gen->SetLine(test);
+    gen->EmitBranch(test->Emit(gen), loop, exit);
+    gen->StartBlock(loop);
+    gen->PushBreakTarget(exit);
+    gen->EmitStmt(body);
+    gen->PopBreakTarget();
+    gen->SetLine(test);
+    gen->EmitBranch(test->Emit(gen), loop, exit);
+    gen->StartBlock(exit);
+    return -1;
+}
+
+Stmt *WhileStmt::Fold() {
+    ConditionalStmt::Fold();
+    BoolConstant *constant = dynamic_cast<BoolConstant*>(test);
+    if (!constant || constant->GetValue()) return this;
+    return Nothing(parent);
+}
+
 IfStmt::IfStmt(Expr *t, Stmt *tb, Stmt *eb): ConditionalStmt(t, tb) { 
     Assert(t != NULL && tb != NULL); // else can be NULL
     elseBody = eb;
@@ -59,17 +281,156 @@ void IfStmt::Check() {
     if (elseBody) elseBody->Check();
 }
 
+int IfStmt::Serialize(AstWriter *w) {
+    int t = w->Write(test), b = w->Write(body), e = w->Write(elseBody);
+    int off = w->BeginNode(kIfStmt, this);
+    w->PutRef(t);
+    w->PutRef(b);
+    w->PutRef(e);
+    return off;
+}
+
+int IfStmt::Emit(IRGen *gen) {
+    int then = gen->NewBlock(), other = elseBody ? gen->NewBlock() : -1;
+    int join = gen->NewBlock();
+    gen->SetLine(test);
+    gen->EmitBranch(test->Emit(gen), then, elseBody ? other : join);
+    gen->StartBlock(then);
+    gen->EmitStmt(body);
+    gen->EmitJump(join);
+    if (elseBody) {
+        gen->StartBlock(other);
+        gen->EmitStmt(elseBody);
+        gen->EmitJump(join);
+    }
+    gen->StartBlock(join);
+    return -1;
+}
+
+/* An if whose test is constant is replaced by the branch it takes.
+ */
+Stmt *IfStmt::Fold() {
+    ConditionalStmt::Fold();
+    if (elseBody) elseBody = elseBody->Fold();
+    BoolConstant *constant = dynamic_cast<BoolConstant*>(test);
+    if (!constant) return this;
+    Stmt *taken = constant->GetValue() ? body : elseBody;
+    if (!taken) return Nothing(parent);
+    taken->SetParent(parent);
+    return taken;
+}
+
+void BreakStmt::Check() {
+    for (Node *n = parent; n; n = n->GetParent()) {
+        if (dynamic_cast<LoopStmt*>(n)) return;
+        if (dynamic_cast<Decl*>(n)) break;
+    }
+    ReportError::BreakOutsideLoop(this);
+}
+
+int BreakStmt::Serialize(AstWriter *w) {
+    return w->BeginNode(kBreakStmt, this);
+}
+
+int BreakStmt::Emit(IRGen *gen) {
+    gen->EmitJump(gen->GetBreakTarget());
+    return -1;
+}
+
 
 ReturnStmt::ReturnStmt(yyltype loc, Expr *e) : Stmt(loc) { 
     Assert(e != NULL);
     (expr=e)->SetParent(this);
 }
+
+int ReturnStmt::Serialize(AstWriter *w) {
+    int e = w->Write(expr);
+    int off = w->BeginNode(kReturnStmt, this);
+    w->PutRef(e);
+    return off;
+}
+
+int ReturnStmt::Emit(IRGen *gen) {
+    gen->EmitReturn(expr->Emit(gen));
+    return -1;
+}
+
+Stmt *ReturnStmt::Fold() {
+    expr = expr->Fold();
+    return this;
+}
   
 PrintStmt::PrintStmt(List<Expr*> *a) {    
     Assert(a != NULL);
     (args=a)->SetParentAll(this);
 }
 
+int PrintStmt::Serialize(AstWriter *w) {
+    int a = w->WriteList(args);
+    int off = w->BeginNode(kPrintStmt, this);
+    w->PutRef(a);
+    return off;
+}
+
+int PrintStmt::Emit(IRGen *gen) {
+    static const opCodeT print[] = { opPrintInt, opPrintBool, opPrintDouble, opPrintString };
+    for (int i = 0; i < args->NumElements(); i++) {
+        gen->SetLine(args->Nth(i));
+        int reg = args->Nth(i)->Emit(gen);
+        Assert(reg >= 0 && gen->GetValueType(reg) <= vString);
+        gen->Emit(print[gen->GetValueType(reg)], -1, reg);
+    }
+    return -1;
+}
+
+// What a constant argument of Print prints, as the inside of a string
+// literal; false if the argument is not a string, int or bool constant.
+static bool PrintedText(Expr *arg, std::string &text) {
+    if (StringConstant *s = dynamic_cast<StringConstant*>(arg)) {
+        text = s->GetValue();
+        text = text.substr(1, text.size() - 2);
+    } else if (IntConstant *i = dynamic_cast<IntConstant*>(arg)) {
+        text = std::to_string(i->GetValue());
+    } else if (BoolConstant *b = dynamic_cast<BoolConstant*>(arg)) {
+        text = b->GetValue() ? "true" : "false";
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Whether text ends in a lone backslash, which prints as itself at the
+// end of a literal but would escape the first character joined after it.
+static bool EndsInBackslash(const std::string &text) {
+    int n = 0;
+    while (n < (int)text.size() && text[text.size() - 1 - n] == '\\') n++;
+    return n % 2 == 1;
+}
+
+/* Method: Fold
+ * ------------
+ * Folds the arguments and joins runs of constant ones into one string,
+ * so that they are printed with a single write. The texts are joined as
+ * written, before escapes are replaced (see IRGen::StringConstant), so
+ * a text ending in a lone backslash is not joined to the next.
+ */
+Stmt *PrintStmt::Fold() {
+    for (int i = 0; i < args->NumElements(); i++) {
+        Expr *arg = args->Nth(i)->Fold();
+        args->RemoveAt(i);
+        std::string before, text;
+        if (i > 0 && PrintedText(args->Nth(i - 1), before) && PrintedText(arg, text)
+            && !EndsInBackslash(before)) {
+            Expr *prev = args->Nth(--i);
+            args->RemoveAt(i);
+            arg = new StringConstant(*prev->GetLocation(), ("\"" + before + text + "\"").c_str());
+            arg->SetParent(this);
+        }
+        args->InsertAt(arg, i);
+    }
+    return this;
+}
+
 
 CaseStmt::CaseStmt(Expr *i, List<Stmt*> *s){ 
     Assert(i != NULL);
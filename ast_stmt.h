@@ -19,10 +19,21 @@ class Program : public Node
 {
   protected:
      List<Decl*> *decls;
+     List<Decl*> *imported;
+     List<Decl*> *included;
+     List<const char*> *imports;
      
   public:
      Program(List<Decl*> *declList);
      void Check();
+     List<Decl*> *GetDecls() { return decls; }
+     void Import(List<Decl*> *importedDecls);
+     void Include(Program *unit);
+     void SetImports(List<const char*> *files) { imports = files; }
+     List<const char*> *GetImports() { return imports; }
+     int Serialize(AstWriter *w);
+     void Fold();
+     void Emit(IRGen *gen);
 };
 
 class Stmt : public Node
@@ -30,6 +41,14 @@ class Stmt : public Node
   public:
      Stmt() : Node() {}
      Stmt(yyltype loc) : Node(loc) {}
+
+     // Folds the constant expressions in the checked statement and
+     // returns the statement to use in its place (see Program::Fold).
+     virtual Stmt *Fold() { return this; }
+
+     // Appends the statement's code to the current block (see irgen.h).
+     // An expression returns the register holding its value, or -1.
+     virtual int Emit(IRGen *gen) { return -1; }
 };
 
 class StmtBlock : public Stmt 
@@ -41,6 +60,9 @@ class StmtBlock : public Stmt
   public:
     StmtBlock(List<VarDecl*> *variableDeclarations, List<Stmt*> *statements);
     void Check();
+    int Serialize(AstWriter *w);
+    Stmt *Fold();
+    int Emit(IRGen *gen);
 };
 
   
@@ -53,6 +75,7 @@ class ConditionalStmt : public Stmt
   public:
     ConditionalStmt(Expr *testExpr, Stmt *body);
     void Check();
+    Stmt *Fold();
 };
 
 class LoopStmt : public ConditionalStmt 
@@ -69,12 +92,18 @@ class ForStmt : public LoopStmt
   
   public:
     ForStmt(Expr *init, Expr *test, Expr *step, Stmt *body);
+    int Serialize(AstWriter *w);
+    Stmt *Fold();
+    int Emit(IRGen *gen);
 };
 
 class WhileStmt : public LoopStmt 
 {
   public:
     WhileStmt(Expr *test, Stmt *body) : LoopStmt(test, body) {}
+    int Serialize(AstWriter *w);
+    Stmt *Fold();
+    int Emit(IRGen *gen);
 };
 
 class IfStmt : public ConditionalStmt 
@@ -85,12 +114,18 @@ class IfStmt : public ConditionalStmt
   public:
     IfStmt(Expr *test, Stmt *thenBody, Stmt *elseBody);
     void Check();
+    int Serialize(AstWriter *w);
+    Stmt *Fold();
+    int Emit(IRGen *gen);
 };
 
 class BreakStmt : public Stmt 
 {
   public:
     BreakStmt(yyltype loc) : Stmt(loc) {}
+    void Check();
+    int Serialize(AstWriter *w);
+    int Emit(IRGen *gen);
 };
 
 class ReturnStmt : public Stmt  
@@ -100,6 +135,9 @@ class ReturnStmt : public Stmt
   
   public:
     ReturnStmt(yyltype loc, Expr *expr);
+    int Serialize(AstWriter *w);
+    Stmt *Fold();
+    int Emit(IRGen *gen);
 };
 
 class PrintStmt : public Stmt
@@ -109,6 +147,9 @@ class PrintStmt : public Stmt
     
   public:
     PrintStmt(List<Expr*> *arguments);
+    int Serialize(AstWriter *w);
+    Stmt *Fold();
+    int Emit(IRGen *gen);
 };
 
 
@@ -7,6 +7,7 @@
 #include <string.h>
 
 #include "errors.h"
+#include "astcache.h"
  
 /* Class constants
  * ---------------
@@ -29,22 +30,35 @@ Type::Type(const char *n) {
     typeName = strdup(n);
 }
 
+/* The built-in types are shared, so they are written as an index into
+ * this table and mapped back to the same shared object when read.
+ */
+int Type::Serialize(AstWriter *w) {
+    Type *builtins[] = {intType, doubleType, boolType, voidType,
+                        nullType, stringType, errorType};
+    int off = w->BeginNode(kBuiltinType, NULL);
+    for (int i = 0; i < sizeof(builtins)/sizeof(builtins[0]); i++)
+        if (this == builtins[i]) { w->PutInt(i); return off; }
+    Assert(0); // only the shared built-in types are plain Type nodes
+    return 0;
+}
+
 
 
 	
 NamedType::NamedType(Identifier *i) : Type(*i->GetLocation()) {
     Assert(i != NULL);
     (id=i)->SetParent(this);
+    cachedDecl = NULL;
 } 
 
 void NamedType::Check() {
     if (!GetDeclForType()) {
-        isError = true;
         ReportError::IdentifierNotDeclared(id, LookingForType);
     }
 }
 Decl *NamedType::GetDeclForType() {
-    if (!cachedDecl && !isError) {
+    if (!cachedDecl) {
         Decl *declForName = FindDecl(id);
         if (declForName && (declForName->IsClassDecl() || declForName->IsInterfaceDecl())) 
             cachedDecl = declForName;
@@ -67,6 +81,29 @@ bool NamedType::IsEquivalentTo(Type *other) {
     return ot && strcmp(id->GetName(), ot->id->GetName()) == 0;
 }
 
+/* Method: IsCompatibleWith
+ * ------------------------
+ * A class can be assigned to any class it extends and any interface it
+ * or one of its superclasses implements.
+ */
+bool NamedType::IsCompatibleWith(Type *other) {
+    if (IsEquivalentTo(other)) return true;
+    NamedType *ot = dynamic_cast<NamedType*>(other);
+    ClassDecl *cd = ot ? dynamic_cast<ClassDecl*>(ot->GetDeclForType()) : NULL;
+    if (!cd) return false;
+    List<NamedType*> *implements = cd->GetImplements();
+    for (int i = 0; i < implements->NumElements(); i++)
+        if (IsEquivalentTo(implements->Nth(i))) return true;
+    return cd->GetExtends() && IsCompatibleWith(cd->GetExtends());
+}
+
+int NamedType::Serialize(AstWriter *w) {
+    int i = w->Write(id);
+    int off = w->BeginNode(kNamedType, this);
+    w->PutRef(i);
+    return off;
+}
+
 ArrayType::ArrayType(yyltype loc, Type *et) : Type(loc) {
     Assert(et != NULL);
     (elemType=et)->SetParent(this);
@@ -81,3 +118,10 @@ bool ArrayType::IsEquivalentTo(Type *other) {
     return (o && elemType->IsEquivalentTo(o->elemType));
 }
 
+int ArrayType::Serialize(AstWriter *w) {
+    int e = w->Write(elemType);
+    int off = w->BeginNode(kArrayType, this);
+    w->PutRef(e);
+    return off;
+}
+
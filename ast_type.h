@@ -28,6 +28,9 @@ class Type : public Node
     virtual void PrintToStream(std::ostream& out) { out << typeName; }
     friend std::ostream& operator<<(std::ostream& out, Type *t) { t->PrintToStream(out); return out; }
     virtual bool IsEquivalentTo(Type *other) { return this == other; }
+    // true if a value of type other can be assigned to this type
+    virtual bool IsCompatibleWith(Type *other) { return IsEquivalentTo(other); }
+    int Serialize(AstWriter *w);
 };
 
 class NamedType : public Type 
@@ -35,7 +38,6 @@ class NamedType : public Type
   protected:
     Identifier *id;
     Decl *cachedDecl; // either class or inteface
-    bool isError;
     
   public:
     NamedType(Identifier *i);
@@ -47,6 +49,8 @@ class NamedType : public Type
     bool IsClass();
     Identifier *GetId() { return id; }
     bool IsEquivalentTo(Type *other);
+    bool IsCompatibleWith(Type *other);
+    int Serialize(AstWriter *w);
 };
 
 class ArrayType : public Type 
@@ -58,8 +62,10 @@ class ArrayType : public Type
     ArrayType(yyltype loc, Type *elemType);
     
     void PrintToStream(std::ostream& out) { out << elemType << "[]"; }
+    Type *GetElemType() { return elemType; }
     void Check();
     bool IsEquivalentTo(Type *other);
+    int Serialize(AstWriter *w);
 };
 
  
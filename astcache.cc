@@ -0,0 +1,432 @@
+/* File: astcache.cc
+ * -----------------
+ * Implementation of the AST cache writer and the mmap-based reader.
+ */
+
+#include "astcache.h"
+#include "ast.h"
+#include "ast_type.h"
+#include "ast_decl.h"
+#include "ast_expr.h"
+#include "ast_stmt.h"
+#include "utility.h"
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+
+static const uint32_t CacheMagic = 0x41434344;  // "DCCA"
+static const uint32_t CacheVersion = 2;
+
+struct CacheHeader {
+    uint32_t magic, version;
+    uint64_t hash;
+    uint32_t root, size;
+};
+
+/* Every record starts with the tag, a flag telling whether the node has
+ * a location, and the four location fields, followed by the payload.
+ */
+static const int RecordHeaderWords = 6;
+
+
+AstWriter::AstWriter() : buf(sizeof(CacheHeader), '\0') {}
+
+int AstWriter::Write(Node *n) {
+    return n ? n->Serialize(this) : 0;
+}
+
+int AstWriter::BeginNode(nodeTagT tag, Node *n) {
+    int off = buf.size();
+    yyltype *loc = n ? n->GetLocation() : NULL;
+    PutInt(tag);
+    PutInt(loc != NULL);
+    PutInt(loc ? loc->first_line : 0);
+    PutInt(loc ? loc->first_column : 0);
+    PutInt(loc ? loc->last_line : 0);
+    PutInt(loc ? loc->last_column : 0);
+    return off;
+}
+
+void AstWriter::PutInt(int value) {
+    buf.append((const char *)&value, sizeof(value));
+}
+
+void AstWriter::PutDouble(double value) {
+    buf.append((const char *)&value, sizeof(value));
+}
+
+// Strings are stored with their length and terminating NUL, padded
+// so the next word stays aligned.
+void AstWriter::PutString(const char *str) {
+    int len = strlen(str);
+    PutInt(len);
+    buf.append(str, len + 1);
+    while (buf.size() % sizeof(int)) buf.push_back('\0');
+}
+
+bool AstWriter::SaveToFile(const char *path, uint64_t hash, int root) {
+    CacheHeader h = {CacheMagic, CacheVersion, hash, (uint32_t)root, (uint32_t)buf.size()};
+    memcpy(&buf[0], &h, sizeof(h));
+
+    // write to a private name first so a concurrent reader never sees
+    // a half-written file
+    std::string tmp = std::string(path) + ".tmp" + std::to_string(getpid());
+    FILE *fp = fopen(tmp.c_str(), "wb");
+    if (!fp) return false;
+    bool ok = fwrite(buf.data(), 1, buf.size(), fp) == buf.size();
+    ok = (fclose(fp) == 0) && ok;
+    if (ok) ok = rename(tmp.c_str(), path) == 0;
+    if (!ok) unlink(tmp.c_str());
+    return ok;
+}
+
+
+/* Class: AstReader
+ * ----------------
+ * Rebuilds nodes from a mapped cache file. All offsets are validated
+ * before use: a child record must lie before its parent (that is the
+ * order the writer produces them in), which also rules out cycles.
+ * Any inconsistency just marks the read as failed.
+ */
+class AstReader
+{
+  protected:
+    const char *base;
+    int size;
+    int file;                    // that the locations are in
+    bool ok;
+
+    const int *Record(int off, int limit, int payloadWords);
+    yyltype Location(const int *rec);
+    const char *String(const int *rec, int word);
+
+  public:
+    AstReader(const char *b, int sz, int f) : base(b), size(sz), file(f), ok(true) {}
+    bool Succeeded() { return ok; }
+
+    Node *Read(int off, int limit);
+
+    template <class T> T *ReadAs(int off, int limit) {
+        Node *n = Read(off, limit);
+        T *t = dynamic_cast<T*>(n);
+        if (n && !t) ok = false;
+        return t;
+    }
+
+    template <class Element> List<Element> *ReadList(int off, int limit) {
+        const int *rec = Record(off, limit, 1);
+        if (!rec || rec[0] != kList) { ok = false; return new List<Element>; }
+        int count = rec[RecordHeaderWords];
+        List<Element> *list = new List<Element>;
+        if (count < 0 || count > size / (int)sizeof(int) || !Record(off, limit, 1 + count)) { ok = false; return list; }
+        for (int i = 0; i < count && ok; i++) {
+            Element e = dynamic_cast<Element>(Read(rec[RecordHeaderWords + 1 + i], off));
+            if (e) list->Append(e);
+            else ok = false;
+        }
+        return list;
+    }
+};
+
+
+const int *AstReader::Record(int off, int limit, int payloadWords) {
+    // (size - off) / sizeof(int) is how many words are left, so a payload
+    // length read from a corrupt file cannot overflow the sum.
+    if (off < (int)sizeof(CacheHeader) || off % sizeof(int) || off >= limit || off >= size
+        || payloadWords < 0 || payloadWords > (size - off) / (int)sizeof(int) - RecordHeaderWords) {
+        ok = false;
+        return NULL;
+    }
+    return (const int *)(base + off);
+}
+
+yyltype AstReader::Location(const int *rec) {
+    yyltype loc;
+    memset(&loc, 0, sizeof(loc));
+    loc.first_line = rec[2];
+    loc.first_column = rec[3];
+    loc.last_line = rec[4];
+    loc.last_column = rec[5];
+    loc.file = file;
+    return loc;
+}
+
+const char *AstReader::String(const int *rec, int word) {
+    const int *p = rec + RecordHeaderWords + word;
+    int len = p[0];
+    const char *str = (const char *)(p + 1);
+    if (len < 0 || len >= base + size - str || str[len] != '\0') {
+        ok = false;
+        return "";
+    }
+    return str;
+}
+
+/* Each record is read back with the constructor the parser would have
+ * used. Nodes whose location is computed from their children by the
+ * constructor (compound expressions, field access, declarations) get
+ * the same location again that way.
+ */
+Node *AstReader::Read(int off, int limit) {
+    if (off == 0 || !ok) return NULL;
+    const int *rec = Record(off, limit, 0);
+    if (!rec) return NULL;
+    const int *p = rec + RecordHeaderWords;
+    yyltype loc = Location(rec);
+
+    switch (rec[0]) {
+      case kProgram: {
+        if (!Record(off, limit, 2)) return NULL;
+        Program *program = new Program(ReadList<Decl*>(p[0], off));
+        List<const char*> *imports = new List<const char*>;
+        for (int i = 0, word = 2; i < p[1] && ok; i++) {
+            if (!Record(off, limit, word + 1)) return NULL;
+            const char *file = String(rec, word);
+            imports->Append(strdup(file));
+            word += 1 + (strlen(file) + sizeof(int)) / sizeof(int);
+        }
+        program->SetImports(imports);
+        return program;
+      }
+      case kIdentifier:
+        if (!Record(off, limit, 1)) return NULL;
+        return new Identifier(loc, String(rec, 0));
+      case kVarDecl: {
+        if (!Record(off, limit, 2)) return NULL;
+        Identifier *id = ReadAs<Identifier>(p[0], off);
+        Type *t = ReadAs<Type>(p[1], off);
+        if (!id || !t) { ok = false; return NULL; }
+        return new VarDecl(id, t);
+      }
+      case kClassDecl: {
+        if (!Record(off, limit, 4)) return NULL;
+        Identifier *id = ReadAs<Identifier>(p[0], off);
+        NamedType *ext = ReadAs<NamedType>(p[1], off);
+        List<NamedType*> *imp = ReadList<NamedType*>(p[2], off);
+        List<Decl*> *members = ReadList<Decl*>(p[3], off);
+        if (!id) { ok = false; return NULL; }
+        return new ClassDecl(id, ext, imp, members);
+      }
+      case kInterfaceDecl: {
+        if (!Record(off, limit, 2)) return NULL;
+        Identifier *id = ReadAs<Identifier>(p[0], off);
+        List<Decl*> *members = ReadList<Decl*>(p[1], off);
+        if (!id) { ok = false; return NULL; }
+        return new InterfaceDecl(id, members);
+      }
+      case kFnDecl: {
+        if (!Record(off, limit, 4)) return NULL;
+        Identifier *id = ReadAs<Identifier>(p[0], off);
+        Type *ret = ReadAs<Type>(p[1], off);
+        List<VarDecl*> *formals = ReadList<VarDecl*>(p[2], off);
+        Stmt *body = ReadAs<Stmt>(p[3], off);
+        if (!id || !ret) { ok = false; return NULL; }
+        FnDecl *fn = new FnDecl(id, ret, formals);
+        if (body) fn->SetFunctionBody(body);
+        return fn;
+      }
+      case kBuiltinType: {
+        if (!Record(off, limit, 1)) return NULL;
+        Type *builtins[] = {Type::intType, Type::doubleType, Type::boolType, Type::voidType,
+                            Type::nullType, Type::stringType, Type::errorType};
+        if (p[0] < 0 || p[0] >= (int)(sizeof(builtins)/sizeof(builtins[0]))) { ok = false; return NULL; }
+        return builtins[p[0]];
+      }
+      case kNamedType: {
+        if (!Record(off, limit, 1)) return NULL;
+        Identifier *id = ReadAs<Identifier>(p[0], off);
+        if (!id) { ok = false; return NULL; }
+        return new NamedType(id);
+      }
+      case kArrayType: {
+        if (!Record(off, limit, 1)) return NULL;
+        Type *elem = ReadAs<Type>(p[0], off);
+        if (!elem) { ok = false; return NULL; }
+        return new ArrayType(loc, elem);
+      }
+      case kStmtBlock: {
+        if (!Record(off, limit, 2)) return NULL;
+        List<VarDecl*> *decls = ReadList<VarDecl*>(p[0], off);
+        List<Stmt*> *stmts = ReadList<Stmt*>(p[1], off);
+        return new StmtBlock(decls, stmts);
+      }
+      case kForStmt: {
+        if (!Record(off, limit, 4)) return NULL;
+        Expr *init = ReadAs<Expr>(p[0], off), *test = ReadAs<Expr>(p[1], off);
+        Expr *step = ReadAs<Expr>(p[2], off);
+        Stmt *body = ReadAs<Stmt>(p[3], off);
+        if (!init || !test || !step || !body) { ok = false; return NULL; }
+        return new ForStmt(init, test, step, body);
+      }
+      case kWhileStmt: {
+        if (!Record(off, limit, 2)) return NULL;
+        Expr *test = ReadAs<Expr>(p[0], off);
+        Stmt *body = ReadAs<Stmt>(p[1], off);
+        if (!test || !body) { ok = false; return NULL; }
+        return new WhileStmt(test, body);
+      }
+      case kIfStmt: {
+        if (!Record(off, limit, 3)) return NULL;
+        Expr *test = ReadAs<Expr>(p[0], off);
+        Stmt *body = ReadAs<Stmt>(p[1], off), *elseBody = ReadAs<Stmt>(p[2], off);
+        if (!test || !body) { ok = false; return NULL; }
+        return new IfStmt(test, body, elseBody);
+      }
+      case kBreakStmt:
+        return new BreakStmt(loc);
+      case kReturnStmt: {
+        if (!Record(off, limit, 1)) return NULL;
+        Expr *e = ReadAs<Expr>(p[0], off);
+        if (!e) { ok = false; return NULL; }
+        return new ReturnStmt(loc, e);
+      }
+      case kPrintStmt:
+        if (!Record(off, limit, 1)) return NULL;
+        return new PrintStmt(ReadList<Expr*>(p[0], off));
+      case kEmptyExpr:
+        return new EmptyExpr();
+      case kIntConstant:
+        if (!Record(off, limit, 1)) return NULL;
+        return new IntConstant(loc, p[0]);
+      case kDoubleConstant: {
+        if (!Record(off, limit, 2)) return NULL;
+        double d;
+        memcpy(&d, p, sizeof(d));
+        return new DoubleConstant(loc, d);
+      }
+      case kBoolConstant:
+        if (!Record(off, limit, 1)) return NULL;
+        return new BoolConstant(loc, p[0] != 0);
+      case kStringConstant:
+        if (!Record(off, limit, 1)) return NULL;
+        return new StringConstant(loc, String(rec, 0));
+      case kNullConstant:
+        return new NullConstant(loc);
+      case kOperator:
+        if (!Record(off, limit, 1)) return NULL;
+        return new Operator(loc, String(rec, 0));
+      case kArithmeticExpr: case kRelationalExpr: case kEqualityExpr:
+      case kLogicalExpr: case kAssignExpr: case kPostfixExpr: {
+        if (!Record(off, limit, 3)) return NULL;
+        Expr *l = ReadAs<Expr>(p[0], off), *r = ReadAs<Expr>(p[2], off);
+        Operator *o = ReadAs<Operator>(p[1], off);
+        if (!o || (!l && !r) || !ok) { ok = false; return NULL; }
+        switch (rec[0]) {
+          case kArithmeticExpr:
+            if (!r) break;
+            return l ? new ArithmeticExpr(l, o, r) : new ArithmeticExpr(o, r);
+          case kLogicalExpr:
+            if (!r) break;
+            return l ? new LogicalExpr(l, o, r) : new LogicalExpr(o, r);
+          case kPostfixExpr:
+            if (!l || r) break;
+            return new PostfixExpr(l, o);
+          default:
+            if (!l || !r) break;
+            if (rec[0] == kRelationalExpr) return new RelationalExpr(l, o, r);
+            if (rec[0] == kEqualityExpr) return new EqualityExpr(l, o, r);
+            return new AssignExpr(l, o, r);
+        }
+        ok = false;
+        return NULL;
+      }
+      case kThis:
+        return new This(loc);
+      case kArrayAccess: {
+        if (!Record(off, limit, 2)) return NULL;
+        Expr *b = ReadAs<Expr>(p[0], off), *s = ReadAs<Expr>(p[1], off);
+        if (!b || !s) { ok = false; return NULL; }
+        return new ArrayAccess(loc, b, s);
+      }
+      case kFieldAccess: {
+        if (!Record(off, limit, 2)) return NULL;
+        Expr *b = ReadAs<Expr>(p[0], off);
+        Identifier *f = ReadAs<Identifier>(p[1], off);
+        if (!f) { ok = false; return NULL; }
+        return new FieldAccess(b, f);
+      }
+      case kCall: {
+        if (!Record(off, limit, 3)) return NULL;
+        Expr *b = ReadAs<Expr>(p[0], off);
+        Identifier *f = ReadAs<Identifier>(p[1], off);
+        List<Expr*> *actuals = ReadList<Expr*>(p[2], off);
+        if (!f) { ok = false; return NULL; }
+        return new Call(loc, b, f, actuals);
+      }
+      case kNewExpr: {
+        if (!Record(off, limit, 1)) return NULL;
+        NamedType *c = ReadAs<NamedType>(p[0], off);
+        if (!c) { ok = false; return NULL; }
+        return new NewExpr(loc, c);
+      }
+      case kNewArrayExpr: {
+        if (!Record(off, limit, 2)) return NULL;
+        Expr *sz = ReadAs<Expr>(p[0], off);
+        Type *elem = ReadAs<Type>(p[1], off);
+        if (!sz || !elem) { ok = false; return NULL; }
+        return new NewArrayExpr(loc, sz, elem);
+      }
+      case kReadIntegerExpr:
+        return new ReadIntegerExpr(loc);
+      case kReadLineExpr:
+        return new ReadLineExpr(loc);
+    }
+    ok = false;
+    return NULL;
+}
+
+
+uint64_t HashSource(const char *text, int len) {
+    uint64_t h = 14695981039346656037ULL;
+    for (int i = 0; i < len; i++) {
+        h ^= (unsigned char)text[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static std::string CachePath(const char *dir, uint64_t hash) {
+    char name[32];
+    sprintf(name, "/%016llx.ast", (unsigned long long)hash);
+    return std::string(dir) + name;
+}
+
+Program *LoadCachedProgram(const char *dir, uint64_t hash, int file) {
+    std::string path = CachePath(dir, hash);
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(CacheHeader)) {
+        close(fd);
+        return NULL;
+    }
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    Program *program = NULL;
+    const CacheHeader *h = (const CacheHeader *)map;
+    if (h->magic == CacheMagic && h->version == CacheVersion && h->hash == hash
+        && h->size == (uint32_t)st.st_size) {
+        AstReader reader((const char *)map, st.st_size, file);
+        program = reader.ReadAs<Program>(h->root, st.st_size);
+        if (!reader.Succeeded()) program = NULL;
+    }
+    munmap(map, st.st_size);
+    PrintDebug("cache", "%s %s", program ? "hit" : "stale", path.c_str());
+    return program;
+}
+
+void SaveCachedProgram(const char *dir, uint64_t hash, Program *program) {
+    mkdir(dir, 0777);  // fine if it is already there
+    AstWriter w;
+    int root = w.Write(program);
+    std::string path = CachePath(dir, hash);
+    bool ok = root && w.SaveToFile(path.c_str(), hash, root);
+    PrintDebug("cache", "%s %s", ok ? "saved" : "could not save", path.c_str());
+}
@@ -0,0 +1,103 @@
+/* File: astcache.h
+ * ----------------
+ * The AST cache saves a parsed Program to a compact binary file so that
+ * an unchanged source file can skip the scanner and parser entirely on
+ * the next run. Files are kept in a cache directory and named after a
+ * hash of the source bytes, so a hit is found without looking inside.
+ *
+ * Format: a small header followed by one record per node. Every record
+ * begins with a tag word and the node's location, followed by the
+ * node-specific payload. Child nodes are written before their parent
+ * and the parent refers to them by offset from the start of the file
+ * (offset 0 stands for NULL), so the file contains no pointers and can
+ * be mapped and read in place.
+ *
+ * Each node class writes itself with its Serialize method (see ast.h);
+ * the reader in astcache.cc rebuilds the tree using the same public
+ * constructors the parser uses.
+ */
+
+#ifndef _H_astcache
+#define _H_astcache
+
+#include <stdint.h>
+#include <string>
+#include "list.h"
+
+class Node;
+class Program;
+
+typedef enum {
+    kNullNode, kList, kProgram, kIdentifier, kVarDecl, kClassDecl,
+    kInterfaceDecl, kFnDecl, kBuiltinType, kNamedType, kArrayType,
+    kStmtBlock, kForStmt, kWhileStmt, kIfStmt, kBreakStmt, kReturnStmt,
+    kPrintStmt, kEmptyExpr, kIntConstant, kDoubleConstant, kBoolConstant,
+    kStringConstant, kNullConstant, kOperator, kArithmeticExpr,
+    kRelationalExpr, kEqualityExpr, kLogicalExpr, kAssignExpr,
+    kPostfixExpr, kThis, kArrayAccess, kFieldAccess, kCall, kNewExpr,
+    kNewArrayExpr, kReadIntegerExpr, kReadLineExpr
+} nodeTagT;
+
+class AstWriter
+{
+  protected:
+    std::string buf;
+
+  public:
+    AstWriter();
+
+          // Writes node n (and everything below it) and returns the
+          // offset of its record, or 0 if n is NULL.
+    int Write(Node *n);
+
+          // Writes each element of the list followed by a list record
+          // holding their offsets. Returns the offset of that record.
+    template <class Element> int WriteList(List<Element> *list) {
+        if (!list) return 0;
+        int *offsets = new int[list->NumElements() + 1];
+        for (int i = 0; i < list->NumElements(); i++)
+            offsets[i] = Write(list->Nth(i));
+        int off = BeginNode(kList, NULL);
+        PutInt(list->NumElements());
+        for (int i = 0; i < list->NumElements(); i++)
+            PutRef(offsets[i]);
+        delete[] offsets;
+        return off;
+    }
+
+          // Used from the Serialize methods: start a record for node n
+          // with the given tag, then append its payload.
+    int BeginNode(nodeTagT tag, Node *n);
+    void PutInt(int value);
+    void PutRef(int offset) { PutInt(offset); }
+    void PutDouble(double value);
+    void PutString(const char *str);
+
+    bool SaveToFile(const char *path, uint64_t hash, int root);
+};
+
+
+/* Function: HashSource
+ * --------------------
+ * Returns a 64-bit FNV-1a hash of the source bytes, used as the cache key.
+ */
+uint64_t HashSource(const char *text, int len);
+
+/* Function: LoadCachedProgram
+ * ---------------------------
+ * Looks for a cache file for the given source hash in dir. If one is
+ * found and is valid, maps it and rebuilds the Program tree from it,
+ * with locations in the source file numbered file (see scanner.h).
+ * Returns NULL on a cache miss.
+ */
+Program *LoadCachedProgram(const char *dir, uint64_t hash, int file);
+
+/* Function: SaveCachedProgram
+ * ---------------------------
+ * Writes the tree for program to dir, keyed by the source hash. The
+ * directory is created if needed. Failures are silently ignored, the
+ * cache is only an optimization.
+ */
+void SaveCachedProgram(const char *dir, uint64_t hash, Program *program);
+
+#endif
@@ -0,0 +1,28 @@
+/* File: dvm.cc
+ * ------------
+ * The main() routine of dvm, which runs a bytecode image (see image.h)
+ * without the compiler's front end:
+ *
+ *     dvm prog.dvi [--option[=value] ...] [-d <debug-key> ...]
+ *
+ * It takes the VM's options (--no-jit, --jit-threshold, --vm-stats and
+ * so on) and exits with the program's status.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "utility.h"
+#include "image.h"
+#include "vm.h"
+
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || strncmp(argv[1], "-", 1) == 0) {
+        printf("Usage:   dvm image [--option[=value] ...] [-d <debug-key-1> <debug-key-2> ...] \n");
+        return 2;
+    }
+    ParseCommandLine(argc - 1, argv + 1);   // the options follow the image
+    Module *module = LoadImage(argv[1]);
+    return module ? VM(module).Run() : -1;
+}
@@ -17,27 +17,40 @@ using namespace std;
 #include "ast_decl.h"
 
 
-int ReportError::numErrors = 0;
+std::atomic<int> ReportError::numErrors(0);
+thread_local string *ReportError::capture = NULL;
 
-void ReportError::UnderlineErrorInLine(const char *line, yyltype *pos) {
+void ReportError::CaptureTo(string *buffer) {
+    capture = buffer;
+}
+
+void ReportError::UnderlineErrorInLine(const char *line, yyltype *pos, ostream &out) {
     if (!line) return;
-    cerr << line << endl;
+    out << line << endl;
     for (int i = 1; i <= pos->last_column; i++)
-        cerr << (i >= pos->first_column ? '^' : ' ');
-    cerr << endl;
+        out << (i >= pos->first_column ? '^' : ' ');
+    out << endl;
 }
 
  
  
 void ReportError::OutputError(yyltype *loc, string msg) {
     numErrors++;
-    fflush(stdout); // make sure any buffered text has been output
+    stringstream out;
     if (loc) {
-        cerr << endl << "*** Error line " << loc->first_line << "." << endl;
-        UnderlineErrorInLine(GetLineNumbered(loc->first_line), loc);
+        out << endl << "*** Error line " << loc->first_line;
+        if (loc->file > 0) out << " of " << GetSourceName(loc->file);
+        out << "." << endl;
+        UnderlineErrorInLine(GetLineNumbered(loc->file, loc->first_line), loc, out);
     } else
-        cerr << endl << "*** Error." << endl;
-    cerr << "*** " << msg << endl << endl;
+        out << endl << "*** Error." << endl;
+    out << "*** " << msg << endl << endl;
+    if (capture) {
+        capture->append(out.str());
+        return;
+    }
+    fflush(stdout); // make sure any buffered text has been output
+    cerr << out.str();
 }
 
 
@@ -55,8 +68,9 @@ void ReportError::UntermComment() {
     OutputError(NULL, "Input ends with unterminated comment");
 }
 
-void ReportError::InvalidDirective(int linenum) {
-    yyltype ll = {0, linenum, 0, 0};
+void ReportError::InvalidDirective(yyltype *loc) {
+    yyltype ll = {0, loc->first_line, 0, 0};
+    ll.file = loc->file;
     OutputError(&ll, "Invalid # directive");
 }
 
@@ -80,8 +94,11 @@ void ReportError::UnrecogChar(yyltype *loc, char ch) {
 
 void ReportError::DeclConflict(Decl *decl, Decl *prevDecl) {
     stringstream s;
+    yyltype *prev = prevDecl->GetLocation();
     s << "Declaration of '" << decl << "' here conflicts with declaration on line " 
-      << prevDecl->GetLocation()->first_line << '\0';
+      << prev->first_line;
+    if (prev->file != decl->GetLocation()->file) s << " of " << GetSourceName(prev->file);
+    s << '\0';
     OutputError(decl->GetLocation(), s.str());
 }
   
@@ -97,6 +114,12 @@ void ReportError::InterfaceNotImplemented(Decl *cd, Type *interfaceType) {
     OutputError(interfaceType->GetLocation(), s.str());
 }
 
+void ReportError::InheritanceCycle(ClassDecl *cd) {
+    stringstream s;
+    s << "Class '" << cd << "' inherits from itself through '" << cd->GetExtends() << "'" << '\0';
+    OutputError(cd->GetExtends()->GetLocation(), s.str());
+}
+
 void ReportError::IdentifierNotDeclared(Identifier *ident, reasonT whyNeeded) {
     stringstream s;
     static const char *names[] =  {"type", "class", "interface", "variable", "function"};
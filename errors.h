@@ -12,6 +12,7 @@
 #pragma once
 
 #include <string>
+#include <atomic>
 using std::string;
 #include "location.h"
 class Type;
@@ -21,6 +22,7 @@ class BreakStmt;
 class ReturnStmt;
 class This;
 class Decl;
+class ClassDecl;
 class Operator;
 
 /* General notes on using this class
@@ -51,7 +53,7 @@ class ReportError
 
   // Errors used by preprocessor
   static void UntermComment();
-  static void InvalidDirective(int linenum);
+  static void InvalidDirective(yyltype *loc);
 
 
   // Errors used by scanner
@@ -64,6 +66,7 @@ class ReportError
   static void DeclConflict(Decl *newDecl, Decl *prevDecl);
   static void OverrideMismatch(Decl *fnDecl);
   static void InterfaceNotImplemented(Decl *classDecl, Type *intfType);
+  static void InheritanceCycle(ClassDecl *classDecl);
 
 
   // Errors used by semantic analyzer for identifiers
@@ -105,12 +108,18 @@ class ReportError
 
   // Returns number of error messages printed
   static int NumErrors() { return numErrors; }
+
+  // Messages reported from the calling thread are appended to *buffer
+  // instead of being printed, until CaptureTo(NULL) is called. Used by
+  // parallel passes to print each piece's messages in source order.
+  static void CaptureTo(string *buffer);
   
  private:
 
-  static void UnderlineErrorInLine(const char *line, yyltype *pos);
+  static void UnderlineErrorInLine(const char *line, yyltype *pos, std::ostream &out);
   static void OutputError(yyltype *loc, string msg);
-  static int numErrors;
+  static std::atomic<int> numErrors;
+  static thread_local string *capture;
   
 };
 
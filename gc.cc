@@ -0,0 +1,236 @@
+/* File: gc.cc
+ * -----------
+ * Implementation of the collector.
+ */
+
+#include "gc.h"
+#include "vm.h"
+#include "utility.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <algorithm>
+#include <chrono>
+
+static double Now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static HeapObj *Forwarded(HeapObj *obj) { return (HeapObj *)(obj->gc & ~(uintptr_t)kFlags); }
+
+static long SizeOption(const char *name, long fallback, long unit) {
+    const char *value = GetOption(name);
+    long size = value ? atol(value) : 0;
+    return (size > 0 ? size : fallback) * unit;
+}
+
+long SizeOf(HeapObj *obj) {
+    switch (obj->type) {
+      case kArrayObj:
+      case kRefArrayObj: return sizeof(HeapObj) + obj->length * sizeof(Value);
+      case kStringObj: return (sizeof(HeapObj) + obj->length + 1 + 7) & ~7;
+      default: return (obj->length + 7) & ~7;
+    }
+}
+
+/* Method: Heap
+ * ------------
+ * Reserves the address space for both spaces up front, so blocks never
+ * have to move because a space grew; pages are only used once touched.
+ */
+Heap::Heap(Module *m, RootSet *r) : module(m), roots(r) {
+    refOffsets.resize(module->classes.size());
+    for (size_t c = 0; c < module->classes.size(); c++)
+        for (int k = c; k >= 0; k = module->classes[k].base)
+            for (size_t i = 0; i < module->classes[k].fields.size(); i++)
+                if (IsReference(module->classes[k].fields[i].type))
+                    refOffsets[c].push_back(module->classes[k].fields[i].offset);
+
+    long nurserySize = SizeOption("nursery-size", 1024, 1024);
+    long heapSize = SizeOption("heap-size", 1024, 1024 * 1024);
+    char *space = (char *)mmap(NULL, nurserySize + heapSize, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (space == MAP_FAILED) RuntimeError("Cannot reserve %ld MB for the heap", heapSize >> 20);
+    nursery = nurseryTop = space;
+    nurseryEnd = old = oldTop = space + nurserySize;
+    oldEnd = old + heapSize;
+    oldLimit = old + std::min(4 * nurserySize, heapSize);
+    allocated = promoted = 0;
+    minorCount = majorCount = 0;
+    minorTime = majorTime = maxPause = 0;
+}
+
+/* Method: AllocateSlow
+ * --------------------
+ * Allocates a block that does not fit in what is left of the nursery:
+ * large blocks go to the old space, anything else to the nursery after
+ * emptying it.
+ */
+HeapObj *Heap::AllocateSlow(long bytes) {
+    if (bytes > (nurseryEnd - nursery) / 4) {
+        HeapObj *obj = (HeapObj *)AllocateOld(bytes);
+        memset(obj, 0, bytes);
+        return obj;
+    }
+    MinorCollection();
+    HeapObj *obj = (HeapObj *)nurseryTop;
+    nurseryTop += bytes;
+    return obj;
+}
+
+/* Method: AllocateOld
+ * -------------------
+ * Takes bytes from the old space. Afterwards there must still be room to
+ * promote a full nursery, otherwise the heap is collected first.
+ */
+char *Heap::AllocateOld(long bytes) {
+    if (oldLimit - oldTop < bytes + (nurseryEnd - nursery)) {
+        MinorCollection();
+        if (oldLimit - oldTop < bytes + (nurseryEnd - nursery)) MajorCollection();
+        if (oldLimit - oldTop < bytes + (nurseryEnd - nursery)) {
+            oldLimit = std::min(oldEnd, oldTop + bytes + 2 * (nurseryEnd - nursery));
+            if (oldLimit - oldTop < bytes + (nurseryEnd - nursery)) RuntimeError("Out of memory");
+        }
+    }
+    char *block = oldTop;
+    oldTop += bytes;
+    return block;
+}
+
+void Heap::Remember(HeapObj *obj) {
+    obj->gc |= kRemembered;
+    remembered.push_back(obj);
+}
+
+/* Method: VisitSlots
+ * ------------------
+ * Calls visit on each reference stored in a block.
+ */
+void Heap::VisitSlots(HeapObj *obj, const SlotVisitor &visit) {
+    if (obj->type >= 0) {
+        std::vector<int> &offsets = refOffsets[obj->type];
+        for (size_t i = 0; i < offsets.size(); i++)
+            visit((HeapObj **)FieldAt(obj, offsets[i]));
+    } else if (obj->type == kRefArrayObj) {
+        Value *elems = ElementsOf(obj);
+        for (int i = 0; i < obj->length; i++)
+            visit(&elems[i].p);
+    }
+}
+
+/* Method: Promote
+ * ---------------
+ * Copies a nursery block to the old space, or returns where it was
+ * copied before.
+ */
+HeapObj *Heap::Promote(HeapObj *obj) {
+    if (obj->gc) return Forwarded(obj);
+    long size = SizeOf(obj);
+    HeapObj *copy = (HeapObj *)oldTop;
+    memcpy(copy, obj, size);
+    copy->gc = 0;
+    obj->gc = (uintptr_t)copy;
+    oldTop += size;
+    promoted += size;
+    return copy;
+}
+
+/* Method: MinorCollection
+ * -----------------------
+ * Promotes every nursery block reachable from the roots or the
+ * remembered old blocks, then scans the promoted blocks in order for
+ * further nursery references, so no old block points into the nursery
+ * afterwards. AllocateOld keeps room in the old space for the whole
+ * nursery, so promotion cannot fail.
+ */
+void Heap::MinorCollection() {
+    double start = Now();
+    SlotVisitor promote = [this](HeapObj **slot) {
+        if (*slot && IsYoung(*slot)) *slot = Promote(*slot);
+    };
+    char *scan = oldTop;
+    roots->VisitRoots(promote);
+    for (size_t i = 0; i < remembered.size(); i++) {
+        remembered[i]->gc &= ~(uintptr_t)kRemembered;
+        VisitSlots(remembered[i], promote);
+    }
+    remembered.clear();
+    while (scan < oldTop) {
+        HeapObj *obj = (HeapObj *)scan;
+        VisitSlots(obj, promote);
+        scan += SizeOf(obj);
+    }
+    memset(nursery, 0, nurseryTop - nursery);
+    nurseryTop = nursery;
+    double pause = Now() - start;
+    minorCount++;
+    minorTime += pause;
+    maxPause = std::max(maxPause, pause);
+    if (oldLimit - oldTop < nurseryEnd - nursery) MajorCollection();
+}
+
+/* Method: MajorCollection
+ * -----------------------
+ * Mark-compact of the old space, run with the nursery empty (so there
+ * is nothing to remember): marks the live blocks, gives each its address
+ * after sliding, updates every reference to that address and then moves
+ * the blocks down in order.
+ */
+void Heap::MajorCollection() {
+    double start = Now();
+    SlotVisitor mark = [this](HeapObj **slot) {
+        HeapObj *obj = *slot;
+        if (obj && IsOld(obj) && !(obj->gc & kMarked)) {
+            obj->gc |= kMarked;
+            markStack.push_back(obj);
+        }
+    };
+    roots->VisitRoots(mark);
+    while (!markStack.empty()) {
+        HeapObj *obj = markStack.back();
+        markStack.pop_back();
+        VisitSlots(obj, mark);
+    }
+
+    char *to = old;
+    for (char *scan = old; scan < oldTop; scan += SizeOf((HeapObj *)scan)) {
+        HeapObj *obj = (HeapObj *)scan;
+        if (!(obj->gc & kMarked)) continue;
+        obj->gc = (uintptr_t)to | kMarked;
+        to += SizeOf(obj);
+    }
+
+    SlotVisitor update = [this](HeapObj **slot) {
+        if (*slot && IsOld(*slot)) *slot = Forwarded(*slot);
+    };
+    roots->VisitRoots(update);
+    for (char *scan = old; scan < oldTop; scan += SizeOf((HeapObj *)scan))
+        if (((HeapObj *)scan)->gc & kMarked) VisitSlots((HeapObj *)scan, update);
+
+    for (char *scan = old; scan < oldTop; ) {
+        HeapObj *obj = (HeapObj *)scan;
+        long size = SizeOf(obj);
+        if (obj->gc & kMarked) {
+            HeapObj *dest = Forwarded(obj);
+            memmove(dest, obj, size);
+            dest->gc = 0;
+        }
+        scan += size;
+    }
+    oldTop = to;
+    if (oldTop - old > (oldLimit - old) / 2)
+        oldLimit = old + std::min(oldEnd - old, 2 * (oldLimit - old));
+    if (oldLimit - oldTop < nurseryEnd - nursery) RuntimeError("Out of memory");
+    double pause = Now() - start;
+    majorCount++;
+    majorTime += pause;
+    maxPause = std::max(maxPause, pause);
+}
+
+void Heap::PrintStats(FILE *fp, double seconds) {
+    fprintf(fp, "gc: %lld bytes allocated, %.1f MB/s; %lld bytes promoted\n", allocated,
+            seconds > 0 ? allocated / seconds / (1 << 20) : 0.0, promoted);
+    fprintf(fp, "gc: %d minor collections in %.3f ms, %d major in %.3f ms; longest pause %.3f ms\n",
+            minorCount, minorTime * 1e3, majorCount, majorTime * 1e3, maxPause * 1e3);
+    fprintf(fp, "gc: old space %ld of %ld bytes in use\n", (long)(oldTop - old), (long)(oldLimit - old));
+}
@@ -0,0 +1,135 @@
+/* File: gc.h
+ * ----------
+ * The garbage-collected heap the VM allocates objects, arrays and strings
+ * in. The collector is precise and generational:
+ *
+ *  - New blocks are bump-allocated in the nursery. When it is full, a
+ *    minor collection copies the blocks still reachable into the old
+ *    space (Cheney's algorithm) and empties the nursery.
+ *  - The old space is collected by mark-compact: live blocks are marked
+ *    from the roots, then slid down to the start of the space in address
+ *    order, so it never fragments. This happens right after a minor
+ *    collection, when the nursery is empty, once the old space no longer
+ *    has room for a full nursery. The old space then grows if it is more
+ *    than half full, up to the --heap-size limit.
+ *  - A block too large for the nursery is allocated in the old space.
+ *
+ * The roots are the reference-typed registers of every frame and the
+ * reference-typed globals: the IR gives each register a fixed type, so
+ * the VM knows exactly which ones to visit (see RootSet). References
+ * from old blocks to nursery blocks are found through a remembered set
+ * filled by the write barrier, which stores of references into fields
+ * and array elements must call.
+ *
+ * --nursery-size=KB and --heap-size=MB set the sizes (1024 KB and
+ * 1024 MB by default) and --gc-stats reports allocation and pause times.
+ */
+
+#ifndef _H_gc
+#define _H_gc
+
+#include <stdio.h>
+#include <stdint.h>
+#include <functional>
+#include <vector>
+#include "tac.h"
+
+struct HeapObj;
+
+union Value {
+    int i;       // int and bool
+    double d;
+    HeapObj *p;  // string, object or array, NULL for null
+};
+
+/* Every heap block starts with this header. For an object, type is the
+ * class index, length is ClassInfo::size and each field is at its offset
+ * from the start of the block (see layout.h). Arrays and strings have a
+ * negative type and store their length; array elements are Values,
+ * string characters are bytes followed by a NUL. The gc word is the
+ * collector's: a forwarding address and the flags below. String
+ * constants, which live outside the heap, have kInterned set in it.
+ */
+struct HeapObj {
+    int type;
+    int length;
+    uintptr_t gc;
+};
+
+enum { kArrayObj = -1, kRefArrayObj = -2, kStringObj = -3 };
+enum { kMarked = 1, kRemembered = 2, kInterned = 4, kFlags = 7 };
+
+inline char *FieldAt(HeapObj *obj, intptr_t offset) { return (char *)obj + offset; }
+inline Value *ElementsOf(HeapObj *obj) { return (Value *)(obj + 1); }
+inline char *CharsOf(HeapObj *obj) { return (char *)(obj + 1); }
+
+/* Function: SizeOf
+ * ----------------
+ * Returns the bytes a block takes in the heap, a multiple of 8.
+ */
+long SizeOf(HeapObj *obj);
+
+typedef std::function<void(HeapObj **slot)> SlotVisitor;
+
+/* Class: RootSet
+ * --------------
+ * Whatever holds references into the heap from outside it. VisitRoots
+ * must call visit on every such slot; the collector may change it.
+ */
+class RootSet
+{
+  public:
+    virtual void VisitRoots(const SlotVisitor &visit) = 0;
+};
+
+class Heap
+{
+  protected:
+    Module *module;
+    RootSet *roots;
+    std::vector<std::vector<int> > refOffsets; // per class, of reference fields
+    char *nursery, *nurseryTop, *nurseryEnd;
+    char *old, *oldTop, *oldLimit, *oldEnd;    // collect at oldLimit, reserved to oldEnd
+    std::vector<HeapObj*> remembered;
+    std::vector<HeapObj*> markStack;
+
+    long long allocated, promoted;
+    int minorCount, majorCount;
+    double minorTime, majorTime, maxPause;
+
+    HeapObj *AllocateSlow(long bytes);
+    char *AllocateOld(long bytes);
+    void Remember(HeapObj *obj);
+    void VisitSlots(HeapObj *obj, const SlotVisitor &visit);
+    HeapObj *Promote(HeapObj *obj);
+    void MinorCollection();
+    void MajorCollection();
+
+  public:
+    Heap(Module *module, RootSet *roots);
+
+    bool IsYoung(HeapObj *obj) { return (uintptr_t)((char *)obj - nursery) < (uintptr_t)(nurseryEnd - nursery); }
+    bool IsOld(HeapObj *obj) { return (uintptr_t)((char *)obj - old) < (uintptr_t)(oldEnd - old); }
+
+          // Returns a zeroed block of the given size with its header set
+    HeapObj *Allocate(int type, int length, long bytes) {
+        bytes = (bytes + 7) & ~7;
+        HeapObj *obj = (HeapObj *)nurseryTop;
+        if (bytes > nurseryEnd - nurseryTop) obj = AllocateSlow(bytes);
+        else nurseryTop += bytes;
+        allocated += bytes;
+        obj->type = type;
+        obj->length = length;
+        return obj;
+    }
+
+          // To be called when value is stored in a field or element of obj
+    void WriteBarrier(HeapObj *obj, HeapObj *value) {
+        if (value && IsYoung(value) && !IsYoung(obj) && !(obj->gc & kRemembered))
+            Remember(obj);
+    }
+
+    void PrintStats(FILE *fp, double seconds);
+};
+
+#endif
@@ -0,0 +1,230 @@
+/* File: hierarchy.cc
+ * ------------------
+ * Implementation of the hierarchy pass.
+ */
+
+#include "hierarchy.h"
+#include "ast_decl.h"
+#include "ast_type.h"
+#include "errors.h"
+#include "parallel.h"
+#include "utility.h"
+#include <map>
+#include <vector>
+
+using std::string;
+
+enum { kUnvisited, kVisiting, kDone };
+
+/* Class: Hierarchy
+ * ----------------
+ * The graph for one run. Nodes are the indexes of the class and
+ * interface declarations in the global list; each class has an edge to
+ * the class it extends and to every interface it implements.
+ */
+class Hierarchy
+{
+  protected:
+    List<Decl*> *decls;
+    string *messages;
+    std::map<Decl*, int> index;
+    std::vector<std::vector<int> > bases;
+    std::vector<int> state, level;
+
+    int IndexOf(Decl *d);
+    int BaseClass(int i);
+    void FindCycles(int i);
+    int Level(int i);
+    void ResolveBases(int i);
+    void ResolveTypes(int i);
+
+  public:
+    Hierarchy(List<Decl*> *decls, string *messages);
+    void Prepare();
+};
+
+Hierarchy::Hierarchy(List<Decl*> *d, string *m) : decls(d), messages(m) {
+    int n = decls->NumElements();
+    for (int i = 0; i < n; i++) {
+        Decl *decl = decls->Nth(i);
+        if (decl->IsClassDecl() || decl->IsInterfaceDecl())
+            index.insert(std::make_pair(decl, i));
+    }
+    bases.resize(n);
+    state.assign(n, kUnvisited);
+    level.assign(n, -1);
+    for (int i = 0; i < n; i++) {
+        ClassDecl *c = dynamic_cast<ClassDecl*>(decls->Nth(i));
+        if (!c) continue;
+        int b = BaseClass(i);
+        if (b >= 0) bases[i].push_back(b);
+        List<NamedType*> *implements = c->GetImplements();
+        for (int j = 0; j < implements->NumElements(); j++) {
+            NamedType *in = implements->Nth(j);
+            Decl *id = c->GetParent()->FindDecl(in->GetId());
+            if (id && id->IsInterfaceDecl())
+                bases[i].push_back(IndexOf(id));
+        }
+    }
+}
+
+int Hierarchy::IndexOf(Decl *d) {
+    std::map<Decl*, int>::iterator it = index.find(d);
+    return it == index.end() ? -1 : it->second;
+}
+
+/* Method: BaseClass
+ * -----------------
+ * Returns the index of the class that class i extends, resolved the
+ * same way ClassDecl::PrepareScope does, or -1 if it has none.
+ */
+int Hierarchy::BaseClass(int i) {
+    ClassDecl *c = dynamic_cast<ClassDecl*>(decls->Nth(i));
+    if (!c->GetExtends()) return -1;
+    Decl *ext = c->GetParent()->FindDecl(c->GetExtends()->GetId());
+    return (ext && ext->IsClassDecl()) ? IndexOf(ext) : -1;
+}
+
+/* Method: FindCycles
+ * ------------------
+ * Depth-first walk up the extends chain from class i. Interfaces cannot
+ * extend anything, so a cycle can only run through extends edges. When
+ * the walk reaches a class that is still on the current path, the class
+ * whose extends closed the loop gets the error and loses its base class,
+ * which leaves the rest of the graph acyclic.
+ */
+void Hierarchy::FindCycles(int i) {
+    state[i] = kVisiting;
+    int b = BaseClass(i);
+    if (b >= 0 && state[b] == kVisiting) {
+        ClassDecl *c = dynamic_cast<ClassDecl*>(decls->Nth(i));
+        ReportError::CaptureTo(&messages[i]);
+        ReportError::InheritanceCycle(c);
+        ReportError::CaptureTo(NULL);
+        c->ClearExtends();
+        bases[i].erase(bases[i].begin());
+    } else if (b >= 0 && state[b] == kUnvisited) {
+        FindCycles(b);
+    }
+    state[i] = kDone;
+}
+
+int Hierarchy::Level(int i) {
+    if (level[i] < 0) {
+        level[i] = 0;
+        for (size_t j = 0; j < bases[i].size(); j++) {
+            int l = Level(bases[i][j]) + 1;
+            if (l > level[i]) level[i] = l;
+        }
+    }
+    return level[i];
+}
+
+// Looks up the class or interface a declared type names, if any.
+static void ResolveType(Type *t) {
+    while (ArrayType *at = dynamic_cast<ArrayType*>(t))
+        t = at->GetElemType();
+    NamedType *nt = dynamic_cast<NamedType*>(t);
+    if (nt) nt->GetDeclForType();
+}
+
+static void ResolveSignature(Decl *d) {
+    if (VarDecl *var = dynamic_cast<VarDecl*>(d)) {
+        ResolveType(var->GetDeclaredType());
+    } else if (FnDecl *fn = dynamic_cast<FnDecl*>(d)) {
+        ResolveType(fn->GetReturnType());
+        List<VarDecl*> *formals = fn->GetFormals();
+        for (int i = 0; i < formals->NumElements(); i++)
+            ResolveType(formals->Nth(i)->GetDeclaredType());
+    }
+}
+
+/* Method: ResolveBases
+ * ---------------------
+ * Reports a class whose extends or implements names no class or
+ * interface and drops those names. This runs serially, before anything
+ * else, so a class's missing base is reported ahead of any conflict
+ * among its members, as the checker always did. The names are looked
+ * up in the enclosing scope, the same way BaseClass does: looking them
+ * up from the type itself would prepare the class's scope on the spot.
+ */
+void Hierarchy::ResolveBases(int i) {
+    ClassDecl *c = dynamic_cast<ClassDecl*>(decls->Nth(i));
+    if (!c) return;
+    Node *scope = c->GetParent();
+    ReportError::CaptureTo(&messages[i]);
+    NamedType *ext = c->GetExtends();
+    Decl *d = ext ? scope->FindDecl(ext->GetId()) : NULL;
+    if (ext && !(d && d->IsClassDecl())) {
+        ReportError::IdentifierNotDeclared(ext->GetId(), LookingForClass);
+        c->ClearExtends();
+    }
+    List<NamedType*> *implements = c->GetImplements();
+    for (int j = 0; j < implements->NumElements(); j++) {
+        NamedType *in = implements->Nth(j);
+        d = scope->FindDecl(in->GetId());
+        if (!(d && d->IsInterfaceDecl())) {
+            ReportError::IdentifierNotDeclared(in->GetId(), LookingForInterface);
+            implements->RemoveAt(j--);
+        }
+    }
+    ReportError::CaptureTo(NULL);
+}
+
+/* Method: ResolveTypes
+ * --------------------
+ * Looks up every type named in the headers of declaration i and its
+ * members. This runs serially once the scopes are prepared: checking
+ * compares types through these nodes from any declaration, so once the
+ * pass is over they must only be read.
+ */
+void Hierarchy::ResolveTypes(int i) {
+    Decl *decl = decls->Nth(i);
+    ResolveSignature(decl);
+    List<Decl*> *members = NULL;
+    if (ClassDecl *c = dynamic_cast<ClassDecl*>(decl)) {
+        ResolveType(c->GetExtends());
+        List<NamedType*> *implements = c->GetImplements();
+        for (int j = 0; j < implements->NumElements(); j++)
+            ResolveType(implements->Nth(j));
+        members = c->GetMembers();
+    } else if (InterfaceDecl *in = dynamic_cast<InterfaceDecl*>(decl)) {
+        members = in->GetMembers();
+    }
+    for (int j = 0; members && j < members->NumElements(); j++)
+        ResolveSignature(members->Nth(j));
+}
+
+void Hierarchy::Prepare() {
+    int n = decls->NumElements();
+    for (int i = 0; i < n; i++)
+        ResolveBases(i);
+    for (int i = 0; i < n; i++)
+        if (decls->Nth(i)->IsClassDecl() && state[i] == kUnvisited)
+            FindCycles(i);
+
+    std::vector<std::vector<int> > levels;
+    for (int i = 0; i < n; i++) {
+        if (IndexOf(decls->Nth(i)) < 0) continue;
+        int l = Level(i);
+        if (l >= (int)levels.size()) levels.resize(l + 1);
+        levels[l].push_back(i);
+    }
+    for (size_t l = 0; l < levels.size(); l++) {
+        std::vector<int> &items = levels[l];
+        PrintDebug("hierarchy", "Level %d: %d declarations\n", (int)l, (int)items.size());
+        ParallelFor(items.size(), [&](int k) {
+            int i = items[k];
+            ReportError::CaptureTo(&messages[i]);
+            decls->Nth(i)->PrepareScope();
+            ReportError::CaptureTo(NULL);
+        });
+    }
+    for (int i = 0; i < n; i++)
+        ResolveTypes(i);
+}
+
+void PrepareClassScopes(List<Decl*> *decls, string *messages) {
+    Hierarchy h(decls, messages);
+    h.Prepare();
+}
@@ -0,0 +1,36 @@
+/* File: hierarchy.h
+ * -----------------
+ * The hierarchy pass runs before statement checking. It builds the graph
+ * of classes and the classes or interfaces they extend or implement.
+ * First, serially, it reports the extends and implements that name no
+ * class or interface. It then reports any inheritance cycle and
+ * prepares the scope of every class and interface, bases before the
+ * classes derived from them.
+ *
+ * Scopes are prepared level by level: level 0 holds the declarations
+ * that depend on nothing, level n those whose bases are all on lower
+ * levels. Declarations on the same level do not depend on each other
+ * and are prepared in parallel (see parallel.h). Last, serially, it
+ * looks up every type named in a declaration's header or in its
+ * members'. After this pass every class scope and these types are
+ * complete and are only read while checking.
+ */
+
+#ifndef _H_hierarchy
+#define _H_hierarchy
+
+#include <string>
+#include "list.h"
+
+class Decl;
+
+/* Function: PrepareClassScopes
+ * ----------------------------
+ * Runs the pass over the global declarations in decls. Any error found
+ * for decls->Nth(i), either a cycle through it or a conflict among its
+ * members, is appended to messages[i] instead of being printed, so the
+ * caller can print it in source order.
+ */
+void PrepareClassScopes(List<Decl*> *decls, std::string *messages);
+
+#endif
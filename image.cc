@@ -0,0 +1,461 @@
+/* File: image.cc
+ * --------------
+ * Implementation of the bytecode image writer and the mmap-based loader.
+ */
+
+#include "image.h"
+#include "errors.h"
+#include "utility.h"
+#include "layout.h"
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+
+static const uint32_t ImageMagic = 0x49434344;  // "DCCI"
+static const uint32_t ImageVersion = 1;
+
+struct ImageHeader {
+    uint32_t magic, version;
+    uint32_t opcodes;            // NumOpCodes of the writer
+    uint32_t size;
+};
+
+
+class ImageWriter
+{
+  protected:
+    std::string buf;
+
+    void Pad() { while (buf.size() % sizeof(int)) buf.push_back('\0'); }
+
+  public:
+    ImageWriter() : buf(sizeof(ImageHeader), '\0') {}
+
+    void PutInt(int value) { buf.append((const char *)&value, sizeof(value)); }
+    void PutString(const std::string &s) {
+        PutInt(s.size());
+        buf.append(s);
+        Pad();
+    }
+    template <class T> void PutArray(const std::vector<T> &v) {
+        PutInt(v.size());
+        buf.append((const char *)v.data(), v.size() * sizeof(T));
+        Pad();
+    }
+
+    bool SaveToFile(const char *path);
+};
+
+bool ImageWriter::SaveToFile(const char *path) {
+    ImageHeader h = {ImageMagic, ImageVersion, NumOpCodes, (uint32_t)buf.size()};
+    memcpy(&buf[0], &h, sizeof(h));
+
+    // write to a private name first so a process starting from the image
+    // never maps a half-written file
+    std::string tmp = std::string(path) + ".tmp" + std::to_string(getpid());
+    FILE *fp = fopen(tmp.c_str(), "wb");
+    if (!fp) return false;
+    bool ok = fwrite(buf.data(), 1, buf.size(), fp) == buf.size();
+    ok = (fclose(fp) == 0) && ok;
+    if (ok) ok = rename(tmp.c_str(), path) == 0;
+    if (!ok) unlink(tmp.c_str());
+    return ok;
+}
+
+
+/* Class: ImageReader
+ * ------------------
+ * Reads the sections back in order from the mapped file. A count that
+ * would run past the end marks the read as failed, and from then on
+ * everything reads as empty.
+ */
+class ImageReader
+{
+  protected:
+    const char *p, *end;
+    bool ok;
+
+    void Skip(size_t bytes);
+
+  public:
+    ImageReader(const char *start, const char *e) : p(start), end(e), ok(true) {}
+    bool Succeeded() { return ok && p == end; }
+
+    int Int();
+    int Count(size_t elementSize);   // of what follows, each at least that big
+    std::string String();
+    template <class T> void Array(std::vector<T> &v) {
+        int n = Count(sizeof(T));
+        v.resize(n);
+        if (n) memcpy(v.data(), p, n * sizeof(T));
+        Skip(n * sizeof(T));
+    }
+};
+
+void ImageReader::Skip(size_t bytes) {
+    bytes = (bytes + sizeof(int) - 1) / sizeof(int) * sizeof(int);
+    if (bytes > (size_t)(end - p)) {
+        ok = false;
+        p = end;
+        return;
+    }
+    p += bytes;
+}
+
+int ImageReader::Int() {
+    int value = 0;
+    if (ok && end - p >= (long)sizeof(value)) memcpy(&value, p, sizeof(value));
+    Skip(sizeof(value));
+    return value;
+}
+
+int ImageReader::Count(size_t elementSize) {
+    int n = Int();
+    if (n < 0 || (size_t)n > (end - p) / elementSize) {
+        ok = false;
+        p = end;
+        return 0;
+    }
+    return n;
+}
+
+std::string ImageReader::String() {
+    int n = Count(1);
+    std::string s(p, n);
+    Skip(n);
+    return s;
+}
+
+
+/* Functions: WriteModule, ReadModule
+ * ----------------------------------
+ * Write and read the sections, in the same order.
+ */
+static void WriteModule(ImageWriter &w, Module *m) {
+    w.PutInt(m->strings.size());
+    for (size_t i = 0; i < m->strings.size(); i++)
+        w.PutString(m->strings[i]);
+    w.PutArray(m->doubles);
+    w.PutInt(m->globals.size());
+    for (size_t i = 0; i < m->globals.size(); i++) {
+        w.PutString(m->globals[i].name);
+        w.PutInt(m->globals[i].type);
+    }
+    w.PutInt(m->members.size());
+    for (size_t i = 0; i < m->members.size(); i++) {
+        w.PutInt(m->members[i].cls);
+        w.PutString(m->members[i].name);
+    }
+    w.PutInt(m->classes.size());
+    for (size_t i = 0; i < m->classes.size(); i++) {
+        const ClassInfo &c = m->classes[i];
+        w.PutString(c.name);
+        w.PutInt(c.isInterface);
+        w.PutInt(c.base);
+        w.PutInt(c.size);
+        w.PutArray(c.interfaces);
+        w.PutInt(c.fields.size());
+        for (size_t j = 0; j < c.fields.size(); j++) {
+            w.PutString(c.fields[j].name);
+            w.PutInt(c.fields[j].type);
+            w.PutInt(c.fields[j].offset);
+        }
+        w.PutInt(c.methods.size());
+        for (size_t j = 0; j < c.methods.size(); j++) {
+            w.PutString(c.methods[j].name);
+            w.PutInt(c.methods[j].function);
+            w.PutInt(c.methods[j].slot);
+        }
+        w.PutArray(c.vtable);
+        w.PutInt(c.itables.size());
+        for (size_t j = 0; j < c.itables.size(); j++) {
+            w.PutInt(c.itables[j].interface);
+            w.PutArray(c.itables[j].functions);
+        }
+    }
+    w.PutInt(m->functions.size());
+    for (size_t i = 0; i < m->functions.size(); i++) {
+        const Function &f = m->functions[i];
+        w.PutString(f.name);
+        w.PutInt(f.cls);
+        w.PutInt(f.numParams);
+        w.PutInt(f.returnType);
+        w.PutInt(f.line);
+        w.PutArray(f.regTypes);
+        w.PutArray(f.code);
+        w.PutArray(f.blocks);
+        w.PutArray(f.args);
+    }
+    w.PutInt(m->mainFunction);
+}
+
+static void ReadModule(ImageReader &r, Module *m) {
+    m->strings.resize(r.Count(sizeof(int)));
+    for (size_t i = 0; i < m->strings.size(); i++)
+        m->strings[i] = r.String();
+    r.Array(m->doubles);
+    m->globals.resize(r.Count(2 * sizeof(int)));
+    for (size_t i = 0; i < m->globals.size(); i++) {
+        m->globals[i].name = r.String();
+        m->globals[i].type = (valueTypeT)r.Int();
+    }
+    m->members.resize(r.Count(2 * sizeof(int)));
+    for (size_t i = 0; i < m->members.size(); i++) {
+        m->members[i].cls = r.Int();
+        m->members[i].name = r.String();
+    }
+    m->classes.resize(r.Count(9 * sizeof(int)));
+    for (size_t i = 0; i < m->classes.size(); i++) {
+        ClassInfo &c = m->classes[i];
+        c.name = r.String();
+        c.isInterface = r.Int();
+        c.base = r.Int();
+        c.size = r.Int();
+        r.Array(c.interfaces);
+        c.fields.resize(r.Count(3 * sizeof(int)));
+        for (size_t j = 0; j < c.fields.size(); j++) {
+            c.fields[j].name = r.String();
+            c.fields[j].type = (valueTypeT)r.Int();
+            c.fields[j].offset = r.Int();
+        }
+        c.methods.resize(r.Count(3 * sizeof(int)));
+        for (size_t j = 0; j < c.methods.size(); j++) {
+            c.methods[j].name = r.String();
+            c.methods[j].function = r.Int();
+            c.methods[j].slot = r.Int();
+        }
+        r.Array(c.vtable);
+        c.itables.resize(r.Count(2 * sizeof(int)));
+        for (size_t j = 0; j < c.itables.size(); j++) {
+            c.itables[j].interface = r.Int();
+            r.Array(c.itables[j].functions);
+        }
+    }
+    m->functions.resize(r.Count(9 * sizeof(int)));
+    for (size_t i = 0; i < m->functions.size(); i++) {
+        Function &f = m->functions[i];
+        f.name = r.String();
+        f.cls = r.Int();
+        f.numParams = r.Int();
+        f.returnType = (valueTypeT)r.Int();
+        f.line = r.Int();
+        r.Array(f.regTypes);
+        r.Array(f.code);
+        r.Array(f.blocks);
+        r.Array(f.args);
+    }
+    m->mainFunction = r.Int();
+}
+
+
+static bool InRange(int value, size_t size) { return value >= 0 && (size_t)value < size; }
+static bool ValidType(int t) { return t >= vInt && t <= vVoid; }
+
+/* Function: ValidOperand
+ * ----------------------
+ * Checks one operand of an instruction of f against what its kind (see
+ * TAC_OPCODES) indexes. A register may only be -1, for no register, as
+ * the result of a call or the value of a Return.
+ */
+static bool ValidOperand(const Module &m, const Function &f, const Instr &in, char kind, int value, int k) {
+    switch (kind) {
+      case 'r':
+        if (value == -1)
+            return k == 0 ? (in.op == opCall || in.op == opCallVirtual || in.op == opCallInterface)
+                          : in.op == opReturn;
+        return InRange(value, f.regTypes.size());
+      case 'd': return InRange(value, m.doubles.size());
+      case 's': return InRange(value, m.strings.size());
+      case 'g': return InRange(value, m.globals.size());
+      case 'c': return InRange(value, m.classes.size());
+      case 'm': return InRange(value, m.members.size());
+      case 'f': return InRange(value, m.functions.size());
+      case 't': return ValidType(value);
+      case 'B': return InRange(value, f.blocks.size());
+      case 'n': return value >= 0 && in.c >= 0 && (size_t)value + in.c <= f.args.size();
+      default: return true;
+    }
+}
+
+// Returns the field a member names, looking in the base classes, or NULL.
+static const Field *FieldNamed(const Module &m, const Member &member) {
+    for (int c = member.cls; c >= 0; c = m.classes[c].base)
+        for (size_t j = 0; j < m.classes[c].fields.size(); j++)
+            if (m.classes[c].fields[j].name == member.name) return &m.classes[c].fields[j];
+    return NULL;
+}
+
+/* Function: ValidCall
+ * -------------------
+ * Checks that a call passes as many arguments as every function it may
+ * run takes, and that the method of a virtual or interface call has a
+ * slot in the vtable or the itables it is looked up in. Valid has
+ * checked that overriding methods take as many arguments as the ones
+ * they override and that each itable has a slot per interface method.
+ */
+static bool ValidCall(const Module &m, const Instr &in) {
+    if (in.op == opCall) return m.functions[in.a].numParams == in.c;
+    const Member &method = m.members[in.a];
+    const ClassInfo &c = m.classes[method.cls];
+    int slot = m.FindSlot(method);
+    if (in.c < 1 || slot < 0) return false;
+    if (in.op == opCallVirtual)
+        return !c.isInterface && slot < (int)c.vtable.size() && m.functions[c.vtable[slot]].numParams == in.c;
+    if (!c.isInterface || slot >= (int)c.methods.size()) return false;
+    for (size_t i = 0; i < m.classes.size(); i++)
+        for (size_t j = 0; j < m.classes[i].itables.size(); j++) {
+            const ITable &itable = m.classes[i].itables[j];
+            int fn = itable.interface == method.cls ? itable.functions[slot] : -1;
+            if (fn != -1 && m.functions[fn].numParams != in.c) return false;
+        }
+    return true;
+}
+
+static bool ValidFunction(const Module &m, const Function &f) {
+    if ((f.cls != -1 && !InRange(f.cls, m.classes.size())) || f.numParams < 0
+        || f.numParams > (int)f.regTypes.size() || !ValidType(f.returnType) || f.blocks.empty())
+        return false;
+    for (size_t r = 0; r < f.regTypes.size(); r++)
+        if (!ValidType(f.regTypes[r])) return false;
+    for (size_t i = 0; i < f.args.size(); i++)
+        if (!InRange(f.args[i], f.regTypes.size())) return false;
+    for (size_t b = 0; b < f.blocks.size(); b++) {
+        const Block &block = f.blocks[b];
+        if (block.start < 0 || block.start >= block.end || block.end > (int)f.code.size()) return false;
+        int last = f.code[block.end - 1].op;
+        if (last != opJump && last != opBranch && last != opReturn) return false;
+        for (int s = 0; s < 2; s++)
+            if (block.succ[s] != -1 && !InRange(block.succ[s], f.blocks.size())) return false;
+    }
+    for (size_t i = 0; i < f.code.size(); i++) {
+        const Instr &in = f.code[i];
+        if (!InRange(in.op, NumOpCodes)) return false;
+        const char *operands = OpOperands(in.op);
+        int fields[] = { in.dst, in.a, in.b, in.c };
+        for (int k = 0; k < 4; k++) {
+            if (!ValidOperand(m, f, in, operands[k], fields[k], k)) return false;
+            if (operands[k] == 'n') break;
+        }
+        if ((in.op == opGetField || in.op == opSetField) && !FieldNamed(m, m.members[in.b])) return false;
+        if ((in.op == opCall || in.op == opCallVirtual || in.op == opCallInterface) && !ValidCall(m, in))
+            return false;
+    }
+    return true;
+}
+
+/* Function: ValidClass
+ * --------------------
+ * Checks class i once every class's indexes are known to be in range:
+ * its base chain ends, its fields lie inside its instances, it extends
+ * its base's vtable with methods taking as many arguments as the ones
+ * they override, and each itable has a slot for every method of its
+ * interface.
+ */
+static bool ValidClass(const Module &m, int i) {
+    const ClassInfo &c = m.classes[i];
+    int steps = 0;
+    for (int b = c.base; b >= 0; b = m.classes[b].base)
+        if (++steps > (int)m.classes.size()) return false;
+    for (size_t j = 0; j < c.fields.size(); j++) {
+        int offset = c.fields[j].offset;
+        if (offset < kObjectHeaderSize || offset > c.size - SizeOfValue(c.fields[j].type)) return false;
+    }
+    for (size_t j = 0; j < c.methods.size(); j++) {
+        int slot = c.methods[j].slot;
+        if (slot < 0 || slot >= (int)(c.isInterface ? c.methods.size() : c.vtable.size())) return false;
+    }
+    if (c.base >= 0) {
+        const ClassInfo &base = m.classes[c.base];
+        if (c.size < base.size || c.vtable.size() < base.vtable.size()) return false;
+        for (size_t j = 0; j < base.vtable.size(); j++)
+            if (m.functions[c.vtable[j]].numParams != m.functions[base.vtable[j]].numParams) return false;
+    }
+    for (size_t j = 0; j < c.itables.size(); j++) {
+        const ClassInfo &interface = m.classes[c.itables[j].interface];
+        if (!interface.isInterface || c.itables[j].functions.size() != interface.methods.size()) return false;
+    }
+    return true;
+}
+
+/* Function: Valid
+ * ---------------
+ * Checks every index in the module, and what the VM relies on besides,
+ * so that the VM can trust them.
+ */
+static bool Valid(const Module &m) {
+    if (m.mainFunction != -1 && !InRange(m.mainFunction, m.functions.size())) return false;
+    for (size_t i = 0; i < m.globals.size(); i++)
+        if (!ValidType(m.globals[i].type)) return false;
+    for (size_t i = 0; i < m.members.size(); i++)
+        if (!InRange(m.members[i].cls, m.classes.size())) return false;
+    for (size_t i = 0; i < m.classes.size(); i++) {
+        const ClassInfo &c = m.classes[i];
+        if ((c.base != -1 && !InRange(c.base, m.classes.size())) || c.size < 0) return false;
+        for (size_t j = 0; j < c.interfaces.size(); j++)
+            if (!InRange(c.interfaces[j], m.classes.size())) return false;
+        for (size_t j = 0; j < c.fields.size(); j++)
+            if (!ValidType(c.fields[j].type)) return false;
+        for (size_t j = 0; j < c.methods.size(); j++)
+            if (c.methods[j].function != -1 && !InRange(c.methods[j].function, m.functions.size())) return false;
+        for (size_t j = 0; j < c.vtable.size(); j++)
+            if (!InRange(c.vtable[j], m.functions.size())) return false;
+        for (size_t j = 0; j < c.itables.size(); j++) {
+            if (!InRange(c.itables[j].interface, m.classes.size())) return false;
+            for (size_t k = 0; k < c.itables[j].functions.size(); k++) {
+                int fn = c.itables[j].functions[k];
+                if (fn != -1 && !InRange(fn, m.functions.size())) return false;
+            }
+        }
+    }
+    for (size_t i = 0; i < m.classes.size(); i++)
+        if (!ValidClass(m, i)) return false;
+    for (size_t i = 0; i < m.functions.size(); i++)
+        if (!ValidFunction(m, m.functions[i])) return false;
+    return true;
+}
+
+bool WriteImage(Module *module, const char *path) {
+    ImageWriter w;
+    WriteModule(w, module);
+    bool ok = w.SaveToFile(path);
+    PrintDebug("image", "%s %s\n", ok ? "wrote" : "could not write", path);
+    return ok;
+}
+
+Module *LoadImage(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        ReportError::Formatted(NULL, "Cannot open image file '%s'", path);
+        return NULL;
+    }
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(ImageHeader))
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    Module *module = NULL;
+    if (map != MAP_FAILED) {
+        const ImageHeader *h = (const ImageHeader *)map;
+        if (h->magic == ImageMagic && h->version == ImageVersion && h->opcodes == (uint32_t)NumOpCodes
+            && h->size == (uint64_t)st.st_size) {
+            ImageReader reader((const char *)map + sizeof(ImageHeader), (const char *)map + st.st_size);
+            module = new Module;
+            ReadModule(reader, module);
+            if (!reader.Succeeded() || !Valid(*module)) {
+                delete module;
+                module = NULL;
+            }
+        }
+        munmap(map, st.st_size);
+    }
+    if (!module) ReportError::Formatted(NULL, "'%s' is not an image this dcc can run", path);
+    else PrintDebug("image", "loaded %s: %d functions\n", path, (int)module->functions.size());
+    return module;
+}
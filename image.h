@@ -0,0 +1,57 @@
+/* File: image.h
+ * -------------
+ * A bytecode image holds a compiled program, ready to run: the module
+ * after optimization and layout (see tac.h), with its constant pools,
+ * globals, class descriptors with their field offsets, vtables and
+ * itables, and every function's code. Running an image skips the
+ * scanner, parser, semantic analysis and optimizer:
+ *
+ *     dcc --source=prog.decaf --image=prog.dvi
+ *     dcc --run=prog.dvi            or    dvm prog.dvi
+ *
+ * The IR refers to everything by index, so the file holds no pointers
+ * and the same image works wherever it is mapped. It starts with a
+ * header: a magic word, the format version, the size of the opcode
+ * table it was written with and the file's length. The sections follow
+ * in the order of the Module's members: strings, doubles, globals,
+ * members, classes, functions and the main function. Integers are 4
+ * bytes; a string or array is its element count followed by the
+ * elements as they are laid out in memory, padded to 4 bytes, so an
+ * array of instructions is read back with one copy.
+ *
+ * The loader maps the file read-only, copies every section out into a
+ * fresh Module and unmaps it, so each process that runs the image holds
+ * its own copy, and the VM translates its functions again as it would
+ * for a compiled program. Everything is checked as it is read, and every index in the code
+ * against what it indexes, so a truncated image, or one written by a
+ * dcc with another instruction set, is rejected rather than run. The
+ * loader also checks what the VM takes on trust from the compiler
+ * about the module's structure: that each member names a field or
+ * method of its class, that fields lie inside their objects, that
+ * vtable and itable slots exist, that calls pass as many arguments as
+ * the callee takes and that only a call's result or a Return's value
+ * may be no register. It does not check the types of the values the
+ * code computes with, nor the bounds the optimizer proved for unchecked
+ * array accesses, so a corrupt image that passes may still crash.
+ */
+
+#ifndef _H_image
+#define _H_image
+
+#include "tac.h"
+
+/* Function: WriteImage
+ * --------------------
+ * Writes the image of module, whose classes must be laid out, to path.
+ * Returns false if the file could not be written.
+ */
+bool WriteImage(Module *module, const char *path);
+
+/* Function: LoadImage
+ * -------------------
+ * Maps the image at path and copies it into a new module. Problems are reported
+ * through ReportError and NULL is returned.
+ */
+Module *LoadImage(const char *path);
+
+#endif
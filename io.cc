@@ -0,0 +1,164 @@
+/* File: io.cc
+ * -----------
+ * Implementation of the buffered input and output.
+ */
+
+#include "io.h"
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+static const int BufferSize = 1 << 16;
+
+static char output[BufferSize];
+static int outputLength;
+static char input[BufferSize];
+static int inputStart, inputEnd; // the part of input not read yet
+
+static void WriteAll(const char *chars, long length) {
+    while (length > 0) {
+        ssize_t n = write(STDOUT_FILENO, chars, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        chars += n;
+        length -= n;
+    }
+}
+
+void FlushOutput() {
+    WriteAll(output, outputLength);
+    outputLength = 0;
+}
+
+void PrintChars(const char *chars, long length) {
+    if (outputLength + length > BufferSize) {
+        FlushOutput();
+        if (length > BufferSize) {
+            WriteAll(chars, length);
+            return;
+        }
+    }
+    memcpy(output + outputLength, chars, length);
+    outputLength += length;
+}
+
+void PrintInt(int value) {
+    char digits[16], *p = digits + sizeof digits;
+    unsigned magnitude = value < 0 ? 0u - (unsigned)value : value;
+    do {
+        *--p = '0' + magnitude % 10;
+    } while (magnitude /= 10);
+    if (value < 0) *--p = '-';
+    PrintChars(p, digits + sizeof digits - p);
+}
+
+/* Function: FormatDouble
+ * ----------------------
+ * Writes value to text as %g does and returns the length. The value is
+ * scaled by an exact power of ten to its six significant digits, with
+ * one rounding, which is within far less than a millionth of the exact
+ * product; unless that is close to halfway between two integers, it
+ * rounds the same way and the digits are written out by hand. Ties,
+ * estimates of the exponent that turn out one off and the values whose
+ * power of ten is not exact go to snprintf.
+ */
+static int FormatDouble(double value, char *text) {
+    static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    double magnitude = fabs(value);
+    if (value == 0) return snprintf(text, 32, signbit(value) ? "-0" : "0");
+    int exponent = magnitude > 1e-16 && magnitude < 1e22 ? (int)floor(log10(magnitude)) : 99;
+    if (exponent < -16 || exponent > 21) return snprintf(text, 32, "%g", value);
+    double scaled = exponent <= 5 ? magnitude * powers[5 - exponent] : magnitude / powers[exponent - 5];
+    double fraction = scaled - floor(scaled);
+    long digits = (long)floor(scaled + 0.5);
+    if (fabs(fraction - 0.5) < 1e-6 || digits < 100000 || digits >= 1000000)
+        return snprintf(text, 32, "%g", value);
+    char *p = text;
+    if (value < 0) *p++ = '-';
+    int point = exponent >= -4 && exponent < 6 ? exponent : 0;   /* digits before the point, less one */
+    if (point < 0) {
+        *p++ = '0';
+        *p++ = '.';
+        for (int i = -1; i > point; i--) *p++ = '0';
+    }
+    for (int i = 5; i >= 0; i--) {
+        p[i + (point >= 0 && i > point)] = '0' + digits % 10;
+        digits /= 10;
+    }
+    if (point >= 0) p[point + 1] = '.';
+    p += 6 + (point >= 0);
+    while (p[-1] == '0' && memchr(text, '.', p - text)) p--;
+    if (p[-1] == '.') p--;
+    if (point != exponent) p += snprintf(p, 8, "e%c%02d", exponent < 0 ? '-' : '+', abs(exponent));
+    return p - text;
+}
+
+void PrintDouble(double value) {
+    char text[32];
+    PrintChars(text, FormatDouble(value, text));
+}
+
+/* Function: Refill
+ * ----------------
+ * Moves the unread input to the start of the buffer and reads more
+ * after it, first writing out the buffered output. Returns false at
+ * the end of the input or if the buffer is full.
+ */
+static bool Refill() {
+    FlushOutput();
+    memmove(input, input + inputStart, inputEnd - inputStart);
+    inputEnd -= inputStart;
+    inputStart = 0;
+    ssize_t n;
+    do {
+        n = read(STDIN_FILENO, input + inputEnd, BufferSize - inputEnd);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) return false;
+    inputEnd += n;
+    return true;
+}
+
+std::string ReadInputLine() {
+    std::string line;
+    for (;;) {
+        char *start = input + inputStart, *newline = (char *)memchr(start, '\n', inputEnd - inputStart);
+        if (newline) {
+            line.append(start, newline);
+            inputStart = newline + 1 - input;
+            return line;
+        }
+        line.append(start, input + inputEnd);
+        inputStart = inputEnd;
+        if (!Refill()) return line;
+    }
+}
+
+// Parses as (int)strtol(chars, NULL, 10), the way atoi does.
+static int ParseInt(const char *chars, const char *end) {
+    while (chars < end && (*chars == ' ' || (*chars >= '\t' && *chars <= '\r'))) chars++;
+    bool negative = chars < end && *chars == '-';
+    if (chars < end && (*chars == '-' || *chars == '+')) chars++;
+    unsigned long magnitude = 0, limit = negative ? 0ul - (unsigned long)LONG_MIN : LONG_MAX;
+    for (; chars < end && *chars >= '0' && *chars <= '9'; chars++) {
+        int digit = *chars - '0';
+        magnitude = magnitude > (limit - digit) / 10 ? limit : magnitude * 10 + digit;
+    }
+    return (int)(negative ? 0ul - magnitude : magnitude);
+}
+
+int ReadInputInteger() {
+    for (int tries = 0; tries < 2; tries++) {
+        char *start = input + inputStart, *newline = (char *)memchr(start, '\n', inputEnd - inputStart);
+        if (newline) {
+            inputStart = newline + 1 - input;
+            return ParseInt(start, newline);
+        }
+        if (tries == 0 && !Refill()) break;
+    }
+    std::string line = ReadInputLine();
+    return ParseInt(line.data(), line.data() + line.size());
+}
@@ -0,0 +1,47 @@
+/* File: io.h
+ * ----------
+ * The running program's input and output, for the VM and the code the
+ * JIT compiles (runtime.c has the same for the x86-64 backend).
+ *
+ * Nothing goes through stdio, which takes a lock on every call. Print
+ * fills a 64 KB buffer that is written out with write(2) only when it
+ * is full, before the program waits for input and at exit, so a prompt
+ * still shows before the program reads the answer. Input is read with
+ * read(2) in 64 KB blocks and split into lines in place.
+ *
+ * Ints are formatted by hand, and so are doubles from 1e-4 up to 1e6,
+ * the ones %g prints without an exponent, unless they fall on a rounding
+ * tie; snprintf does the others. ReadInteger parses the line as atoi
+ * does, straight from the buffer.
+ */
+
+#ifndef _H_io
+#define _H_io
+
+#include <string>
+
+void PrintChars(const char *chars, long length);
+void PrintInt(int value);
+void PrintDouble(double value);
+
+/* Function: FlushOutput
+ * ---------------------
+ * Writes out what Print has buffered; anything else that writes to
+ * stdout or exits calls it first.
+ */
+void FlushOutput();
+
+/* Function: ReadInputLine
+ * -----------------------
+ * Reads a line of the program's input, without the newline.
+ */
+std::string ReadInputLine();
+
+/* Function: ReadInputInteger
+ * --------------------------
+ * Reads a line of the program's input and returns the int it starts
+ * with after any white space, 0 if none.
+ */
+int ReadInputInteger();
+
+#endif
@@ -0,0 +1,383 @@
+/* File: irgen.cc
+ * --------------
+ * Implementation of the IRGen state shared by the Emit methods.
+ */
+
+#include "irgen.h"
+#include "ast_decl.h"
+#include "ast_type.h"
+#include "ast_stmt.h"
+#include "scope.h"
+#include "errors.h"
+#include <string.h>
+#include <stdio.h>
+
+IRGen::IRGen() {
+    module = new Module;
+    curFunction = curBlock = curClass = -1;
+    curLine = 0;
+}
+
+valueTypeT ValueTypeOf(Type *type) {
+    if (type == Type::intType) return vInt;
+    if (type == Type::boolType) return vBool;
+    if (type == Type::doubleType) return vDouble;
+    if (type == Type::stringType) return vString;
+    if (type == Type::voidType) return vVoid;
+    if (dynamic_cast<ArrayType*>(type)) return vArray;
+    return vObject;
+}
+
+/* Function: IndexIn
+ * -----------------
+ * Returns the index a map gives a declaration. Everything the program
+ * refers to was entered by DeclareAll (a program with imported
+ * summaries, which have no code, is never lowered), so a missing
+ * declaration is a bug.
+ */
+static int IndexIn(const std::map<Decl*, int> &m, Decl *d) {
+    std::map<Decl*, int>::const_iterator it = m.find(d);
+    Assert(it != m.end());
+    return it->second;
+}
+
+static int AddFunction(Module *module, FnDecl *fn, int cls) {
+    Function f;
+    f.name = fn->GetName();
+    if (cls >= 0) f.name = module->classes[cls].name + "." + f.name;
+    f.cls = cls;
+    f.numParams = fn->GetFormals()->NumElements() + (cls >= 0 ? 1 : 0);
+    f.returnType = ValueTypeOf(fn->GetReturnType());
+    f.line = fn->GetLocation() ? fn->GetLocation()->first_line : 0;
+    module->functions.push_back(f);
+    if (cls < 0 && !strcmp(fn->GetName(), "main"))
+        module->mainFunction = module->functions.size() - 1;
+    return module->functions.size() - 1;
+}
+
+/* Method: DeclareAll
+ * ------------------
+ * Enters the global declarations in the module: a class descriptor for
+ * each class and interface, a global for each variable and an (empty)
+ * function for each function and method, so that their bodies can refer
+ * to any of them by index. Each class's vtable is copied from the slots
+ * ClassDecl assigned.
+ */
+void IRGen::DeclareAll(List<Decl*> *decls) {
+    for (int i = 0; i < decls->NumElements(); i++) {
+        Decl *d = decls->Nth(i);
+        if (!d->IsClassDecl() && !d->IsInterfaceDecl()) continue;
+        ClassInfo c;
+        c.name = d->GetName();
+        c.isInterface = d->IsInterfaceDecl();
+        c.base = -1;
+        c.size = 0;
+        classes[d] = module->classes.size();
+        module->classes.push_back(c);
+    }
+    for (int i = 0; i < decls->NumElements(); i++) {
+        Decl *d = decls->Nth(i);
+        if (d->IsVarDecl()) {
+            Global g;
+            g.name = d->GetName();
+            g.type = ValueTypeOf(dynamic_cast<VarDecl*>(d)->GetDeclaredType());
+            globals[d] = module->globals.size();
+            module->globals.push_back(g);
+        } else if (d->IsFnDecl()) {
+            functions[d] = AddFunction(module, dynamic_cast<FnDecl*>(d), -1);
+        } else {
+            int cls = IndexIn(classes, d);
+            ClassDecl *cd = dynamic_cast<ClassDecl*>(d);
+            List<Decl*> *members;
+            if (cd) {
+                if (cd->GetExtends())
+                    module->classes[cls].base = IndexIn(classes, cd->GetExtends()->GetDeclForType());
+                List<NamedType*> *implements = cd->GetImplements();
+                for (int j = 0; j < implements->NumElements(); j++)
+                    module->classes[cls].interfaces.push_back(IndexIn(classes, implements->Nth(j)->GetDeclForType()));
+                members = cd->GetMembers();
+            } else {
+                members = dynamic_cast<InterfaceDecl*>(d)->GetMembers();
+            }
+            for (int j = 0; j < members->NumElements(); j++) {
+                Decl *m = members->Nth(j);
+                if (m->IsVarDecl()) {
+                    Field f;
+                    f.name = m->GetName();
+                    f.offset = -1;
+                    f.type = ValueTypeOf(dynamic_cast<VarDecl*>(m)->GetDeclaredType());
+                    module->classes[cls].fields.push_back(f);
+                } else {
+                    Method method;
+                    method.name = m->GetName();
+                    method.function = -1;
+                    method.slot = dynamic_cast<FnDecl*>(m)->GetVTableSlot();
+                    if (cd) method.function = functions[m] = AddFunction(module, dynamic_cast<FnDecl*>(m), cls);
+                    module->classes[cls].methods.push_back(method);
+                }
+            }
+        }
+    }
+    for (int i = 0; i < decls->NumElements(); i++) {
+        ClassDecl *cd = dynamic_cast<ClassDecl*>(decls->Nth(i));
+        if (!cd) continue;
+        List<FnDecl*> *vtable = cd->GetVTable();
+        for (int j = 0; j < vtable->NumElements(); j++)
+            module->classes[IndexIn(classes, cd)].vtable.push_back(IndexIn(functions, vtable->Nth(j)));
+        AddITables(cd);
+    }
+}
+
+/* Method: AddITables
+ * ------------------
+ * Builds the class's itable for each interface it or a superclass
+ * implements: entry i is the method of the class named like the
+ * interface's method i (see InterfaceDecl::PrepareScope).
+ */
+void IRGen::AddITables(ClassDecl *cd) {
+    ClassInfo &info = module->classes[IndexIn(classes, cd)];
+    Scope *scope = cd->PrepareScope();
+    for (ClassDecl *c = cd; c; c = c->GetExtends() ? dynamic_cast<ClassDecl*>(c->GetExtends()->GetDeclForType()) : NULL) {
+        List<NamedType*> *implements = c->GetImplements();
+        for (int i = 0; i < implements->NumElements(); i++) {
+            InterfaceDecl *id = dynamic_cast<InterfaceDecl*>(implements->Nth(i)->GetDeclForType());
+            bool seen = false;
+            for (size_t j = 0; id && j < info.itables.size(); j++)
+                seen |= (info.itables[j].interface == IndexIn(classes, id));
+            if (!id || seen) continue;
+            ITable itable;
+            itable.interface = IndexIn(classes, id);
+            List<Decl*> *members = id->GetMembers();
+            for (int j = 0; j < members->NumElements(); j++) {
+                FnDecl *fn = dynamic_cast<FnDecl*>(scope->Lookup(members->Nth(j)->GetId()));
+                bool found = fn && dynamic_cast<ClassDecl*>(fn->GetParent());
+                itable.functions.push_back(found ? IndexIn(functions, fn) : -1);
+            }
+            info.itables.push_back(itable);
+        }
+    }
+}
+
+void IRGen::BeginFunction(FnDecl *fn) {
+    curFunction = IndexIn(functions, fn);
+    locals.clear();
+    regTypes.clear();
+    breakTargets.clear();
+    curBlock = -1;
+    curLine = Fn().line;
+    ClassDecl *cd = dynamic_cast<ClassDecl*>(fn->GetParent());
+    curClass = cd ? IndexIn(classes, cd) : -1;
+    if (cd) NewReg(cd->GetClassType());
+    List<VarDecl*> *formals = fn->GetFormals();
+    for (int i = 0; i < formals->NumElements(); i++)
+        DeclareLocal(formals->Nth(i));
+    StartBlock(NewBlock());
+}
+
+void IRGen::EndFunction() {
+    if (curBlock >= 0) EmitReturn(-1);
+    PrintDebug("irgen", "%s: %d registers, %d blocks, %d instructions\n", Fn().name.c_str(),
+               (int)Fn().regTypes.size(), (int)Fn().blocks.size(), (int)Fn().code.size());
+    curFunction = -1;
+}
+
+int IRGen::NewReg(Type *type) {
+    regTypes.push_back(type);
+    Fn().regTypes.push_back(ValueTypeOf(type));
+    return regTypes.size() - 1;
+}
+
+/* Method: Emit
+ * ------------
+ * Appends an instruction to the current block. Code that follows a
+ * return or break is unreachable; it goes in a new block that no other
+ * block jumps to.
+ */
+void IRGen::Emit(opCodeT op, int dst, int a, int b, int c) {
+    if (curBlock < 0) StartBlock(NewBlock());
+    Instr in = { op, dst, a, b, c, curLine };
+    Fn().code.push_back(in);
+}
+
+int IRGen::EmitValue(opCodeT op, Type *type, int a, int b, int c) {
+    int dst = NewReg(type);
+    Emit(op, dst, a, b, c);
+    return dst;
+}
+
+/* Method: EmitCall
+ * ----------------
+ * Emits a Call or CallMethod with the given argument registers and
+ * returns the register receiving the result, or -1 for a void call.
+ */
+int IRGen::EmitCall(opCodeT op, Type *returnType, int target, const std::vector<int> &args) {
+    int start = Fn().args.size();
+    Fn().args.insert(Fn().args.end(), args.begin(), args.end());
+    int dst = (returnType == Type::voidType) ? -1 : NewReg(returnType);
+    Emit(op, dst, target, start, args.size());
+    return dst;
+}
+
+void IRGen::EmitStmt(Stmt *stmt) {
+    SetLine(stmt);
+    stmt->Emit(this);
+}
+
+/* Method: SetLine
+ * ---------------
+ * Instructions emitted from now on are attributed to the first line of
+ * node, if it has a location.
+ */
+void IRGen::SetLine(Node *node) {
+    if (node->GetLocation()) curLine = node->GetLocation()->first_line;
+}
+
+int IRGen::NewBlock() {
+    Block b = { 0, 0, { -1, -1 } };
+    Fn().blocks.push_back(b);
+    return Fn().blocks.size() - 1;
+}
+
+/* Method: StartBlock
+ * ------------------
+ * Makes block the current block. If the previous block is still open,
+ * it falls through to the new one.
+ */
+void IRGen::StartBlock(int block) {
+    if (curBlock >= 0) EmitJump(block);
+    Fn().blocks[block].start = Fn().code.size();
+    curBlock = block;
+}
+
+void IRGen::EndBlock(int succ0, int succ1) {
+    Block &b = Fn().blocks[curBlock];
+    b.end = Fn().code.size();
+    b.succ[0] = succ0;
+    b.succ[1] = succ1;
+    curBlock = -1;
+}
+
+void IRGen::EmitJump(int block) {
+    if (curBlock < 0) return;
+    Emit(opJump, -1, block);
+    EndBlock(block, -1);
+}
+
+void IRGen::EmitBranch(int test, int ifTrue, int ifFalse) {
+    Emit(opBranch, -1, test, ifTrue, ifFalse);
+    EndBlock(ifTrue, ifFalse);
+}
+
+void IRGen::EmitReturn(int reg) {
+    Emit(opReturn, -1, reg);
+    EndBlock(-1, -1);
+}
+
+int IRGen::DeclareLocal(VarDecl *var) {
+    return locals[var] = NewReg(var->GetDeclaredType());
+}
+
+/* Method: LoadVariable
+ * --------------------
+ * Returns a register holding the value of a variable, which is either
+ * a local (its own register), a global or a field of "this".
+ */
+int IRGen::LoadVariable(VarDecl *var) {
+    std::map<Decl*, int>::iterator it = locals.find(var);
+    if (it != locals.end()) return it->second;
+    it = globals.find(var);
+    if (it != globals.end())
+        return EmitValue(opLoadGlobal, var->GetDeclaredType(), it->second);
+    return EmitValue(opGetField, var->GetDeclaredType(), GetThis(), GetMember(curClass, var->GetName()));
+}
+
+void IRGen::StoreVariable(VarDecl *var, int reg) {
+    std::map<Decl*, int>::iterator it = locals.find(var);
+    if (it != locals.end())
+        Emit(opMove, it->second, reg);
+    else if ((it = globals.find(var)) != globals.end())
+        Emit(opStoreGlobal, -1, it->second, reg);
+    else
+        Emit(opSetField, -1, GetThis(), GetMember(curClass, var->GetName()), reg);
+}
+
+/* Method: GetClassDecl
+ * --------------------
+ * Returns the class or interface that is the static type of a register,
+ * or NULL if it does not hold an object.
+ */
+Decl *IRGen::GetClassDecl(int reg) {
+    NamedType *t = dynamic_cast<NamedType*>(regTypes[reg]);
+    return t ? t->GetDeclForType() : NULL;
+}
+
+Decl *IRGen::LookupMember(Decl *classDecl, Identifier *name) {
+    Scope *scope = classDecl->PrepareScope();
+    return scope ? scope->Lookup(name) : NULL;
+}
+
+int IRGen::GetFunction(FnDecl *fn) {
+    return IndexIn(functions, fn);
+}
+
+int IRGen::GetClass(Decl *classDecl) {
+    return IndexIn(classes, classDecl);
+}
+
+int IRGen::GetMember(Decl *classDecl, const char *name) {
+    return GetMember(IndexIn(classes, classDecl), name);
+}
+
+int IRGen::GetMember(int cls, const char *name) {
+    char key[32];
+    sprintf(key, "%d.", cls);
+    std::string s = std::string(key) + name;
+    std::map<std::string, int>::iterator it = members.find(s);
+    if (it != members.end()) return it->second;
+    Member m;
+    m.cls = cls;
+    m.name = name;
+    module->members.push_back(m);
+    return members[s] = module->members.size() - 1;
+}
+
+/* Method: StringConstant
+ * ----------------------
+ * Returns the pool index of a string literal as written in the source,
+ * with the quotes removed and the escapes \n, \t, \" and \\ replaced.
+ * Equal strings share one entry.
+ */
+int IRGen::StringConstant(const char *literal) {
+    std::string s;
+    int len = strlen(literal);
+    for (int i = 1; i < len - 1; i++) {
+        char ch = literal[i];
+        if (ch == '\\' && i + 1 < len - 1) {
+            switch (literal[++i]) {
+              case 'n': ch = '\n'; break;
+              case 't': ch = '\t'; break;
+              case '"': ch = '"'; break;
+              case '\\': ch = '\\'; break;
+              default: s += '\\'; ch = literal[i]; break;
+            }
+        }
+        s += ch;
+    }
+    std::map<std::string, int>::iterator it = strings.find(s);
+    if (it != strings.end()) return it->second;
+    module->strings.push_back(s);
+    return strings[s] = module->strings.size() - 1;
+}
+
+int IRGen::DoubleConstant(double value) {
+    for (size_t i = 0; i < module->doubles.size(); i++)
+        if (!memcmp(&module->doubles[i], &value, sizeof value)) return i; // keeps -0.0 apart from 0.0
+    module->doubles.push_back(value);
+    return module->doubles.size() - 1;
+}
+
+Module *GenerateIR(Program *program) {
+    IRGen gen;
+    program->Emit(&gen);
+    return gen.GetModule();
+}
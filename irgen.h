@@ -0,0 +1,105 @@
+/* File: irgen.h
+ * -------------
+ * IRGen lowers a checked Program to the three-address IR of tac.h. The
+ * tree drives the lowering: Program::Emit declares every class, global
+ * and function in the Module, then each FnDecl emits its body by calling
+ * Emit on its statements. A Stmt's Emit appends its instructions to the
+ * current block and an Expr's Emit also returns the register holding
+ * its value. An LValue additionally has EmitStore to assign to it.
+ *
+ * IRGen keeps the state those methods share: the function and block
+ * being generated, the registers of local variables, the static type of
+ * each register (used to pick typed operations and to find the class a
+ * field or method is looked up in) and the targets of enclosing loops.
+ *
+ * The tree must have checked cleanly: lowering relies on every name
+ * resolving and every operand having the right type.
+ */
+
+#ifndef _H_irgen
+#define _H_irgen
+
+#include <map>
+#include <string>
+#include <vector>
+#include "tac.h"
+#include "list.h"
+
+class Node;
+class Decl;
+class VarDecl;
+class FnDecl;
+class ClassDecl;
+class Stmt;
+class Expr;
+class Type;
+class Identifier;
+class Program;
+
+class IRGen
+{
+  protected:
+    Module *module;
+    int curFunction, curBlock, curClass, curLine;
+    std::map<Decl*, int> classes, functions, globals, locals;
+    std::map<std::string, int> strings, members;
+    std::vector<Type*> regTypes;  // static type of each register
+    std::vector<int> breakTargets;
+
+    Function &Fn() { return module->functions[curFunction]; }
+    void EndBlock(int succ0, int succ1);
+    void AddITables(ClassDecl *cd);
+
+  public:
+    IRGen();
+    Module *GetModule() { return module; }
+
+          // Used by Program::Emit and the Decl nodes
+    void DeclareAll(List<Decl*> *decls);
+    void BeginFunction(FnDecl *fn);
+    void EndFunction();
+
+          // Registers and instructions
+    int NewReg(Type *type);
+    Type *GetRegType(int reg) { return regTypes[reg]; }
+    valueTypeT GetValueType(int reg) { return (valueTypeT)Fn().regTypes[reg]; }
+    void Emit(opCodeT op, int dst, int a = 0, int b = 0, int c = 0);
+    int EmitValue(opCodeT op, Type *type, int a = 0, int b = 0, int c = 0);
+    int EmitCall(opCodeT op, Type *returnType, int target, const std::vector<int> &args);
+    void EmitStmt(Stmt *stmt);
+    void SetLine(Node *node);
+
+          // Control flow
+    int NewBlock();
+    void StartBlock(int block);
+    void EmitJump(int block);
+    void EmitBranch(int test, int ifTrue, int ifFalse);
+    void EmitReturn(int reg);
+    void PushBreakTarget(int block) { breakTargets.push_back(block); }
+    void PopBreakTarget() { breakTargets.pop_back(); }
+    int GetBreakTarget() { return breakTargets.back(); }
+
+          // Names
+    int DeclareLocal(VarDecl *var);
+    int LoadVariable(VarDecl *var);
+    void StoreVariable(VarDecl *var, int reg);
+    int GetThis() { return 0; }
+    int GetFunction(FnDecl *fn);
+    int GetClass(Decl *classDecl);
+    Decl *GetClassDecl(int reg);
+    Decl *LookupMember(Decl *classDecl, Identifier *name);
+    int GetMember(Decl *classDecl, const char *name);
+    int GetMember(int cls, const char *name);
+    int StringConstant(const char *literal);
+    int DoubleConstant(double value);
+};
+
+/* Function: GenerateIR
+ * --------------------
+ * Lowers a program that has checked without errors.
+ */
+Module *GenerateIR(Program *program);
+
+valueTypeT ValueTypeOf(Type *type);
+
+#endif
@@ -0,0 +1,604 @@
+/* File: jit.cc
+ * ------------
+ * Implementation of the baseline JIT: an encoder for the few x86-64
+ * instruction forms the templates need, the templates and the helpers
+ * compiled code calls.
+ */
+
+#include "jit.h"
+
+#ifdef VM_JIT
+
+#include "layout.h"
+#include "io.h"
+#include "utility.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+enum { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13 };
+
+// Condition codes, as in Jcc and SETcc
+enum { kBelow = 0x2, kAboveEqual = 0x3, kEqual = 0x4, kNotEqual = 0x5, kAbove = 0x7,
+       kParity = 0xA, kNoParity = 0xB, kLess = 0xC, kGreaterEqual = 0xD, kLessEqual = 0xE, kGreater = 0xF };
+
+// Labels after the blocks'
+enum { kReturnStub, kNullObjectStub, kNullArrayStub, kBoundsStub, kDivisionStub, kNumStubs };
+
+static const size_t kRegionSize = 64 << 20;
+
+JIT::JIT(VM *v) : vm(v), used(0), capacity(kRegionSize), compiled(0), code(NULL), raxHolds(-1), raxHoldsAt(0) {
+    region = (uint8_t *)mmap(NULL, capacity, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (region == MAP_FAILED) region = NULL, capacity = 0;
+}
+
+void JIT::Bytes(std::initializer_list<int> bytes) {
+    for (int b : bytes) Byte(b);
+}
+
+void JIT::Int32(int32_t value) {
+    for (int i = 0; i < 4; i++) Byte(value >> 8 * i & 0xFF);
+}
+
+void JIT::Int64(int64_t value) {
+    for (int i = 0; i < 8; i++) Byte(value >> 8 * i & 0xFF);
+}
+
+/* Method: Mem
+ * -----------
+ * Emits an instruction with a [base + disp32] memory operand: the
+ * mandatory prefix if any, a REX prefix if needed (wide for 64-bit
+ * operands), the opcode bytes and the ModRM byte. base must not be rsp
+ * or r12, which would need a SIB byte.
+ */
+void JIT::Mem(int prefix, bool wide, std::initializer_list<int> opcode, int reg, int base, int disp) {
+    if (prefix) Byte(prefix);
+    int rex = (wide ? 8 : 0) | (reg >= 8 ? 4 : 0) | (base >= 8 ? 1 : 0);
+    if (rex) Byte(0x40 | rex);
+    Bytes(opcode);
+    Byte(0x80 | (reg & 7) << 3 | (base & 7));
+    Int32(disp);
+}
+
+/* Methods: Load, Store
+ * --------------------
+ * Move a register of the frame to or from a machine register. Stores
+ * always write all 8 bytes (an int's upper half is zero or garbage), so
+ * a later load of any width is forwarded from the store buffer. A load
+ * into rax right after a store from it is left out.
+ */
+void JIT::Load(int reg, int vr, bool wide) {
+    if (reg == RAX && vr == raxHolds && buf.size() == raxHoldsAt) return;
+    Mem(0, wide, {0x8B}, reg, RBX, 8 * vr);
+}
+
+void JIT::Store(int vr, int reg) {
+    Mem(0, true, {0x89}, reg, RBX, 8 * vr);
+    raxHolds = (reg == RAX) ? vr : -1;
+    raxHoldsAt = buf.size();
+}
+
+void JIT::MovImm(int reg, int64_t value) {
+    Byte(reg >= 8 ? 0x49 : 0x48);
+    Byte(0xB8 + (reg & 7));
+    Int64(value);
+}
+
+void JIT::CallHelper(const void *fn) {
+    MovImm(RAX, (intptr_t)fn);
+    Bytes({0xFF, 0xD0});                          // call rax
+}
+
+void JIT::Jump(int label) {
+    Byte(0xE9);
+    fixups.push_back(std::make_pair((int)buf.size(), label));
+    Int32(0);
+}
+
+void JIT::JumpIf(int cc, int label) {
+    Bytes({0x0F, 0x80 + cc});
+    fixups.push_back(std::make_pair((int)buf.size(), label));
+    Int32(0);
+}
+
+// eax = (eax cc [vr]), for the ints in eax and vr
+void JIT::Compare(int cc, int vr) {
+    Mem(0, false, {0x3B}, RAX, RBX, 8 * vr);      // cmp eax, [vr]
+    Bytes({0x0F, 0x90 + cc, 0xC0});               // setcc al
+    Bytes({0x0F, 0xB6, 0xC0});                    // movzx eax, al
+}
+
+void JIT::CompareDoubles(int op, int a, int b) {
+    bool swap = (op == opLtD || op == opLeD);
+    Mem(0xF2, false, {0x0F, 0x10}, 0, RBX, 8 * (swap ? b : a));  // movsd xmm0, [a or b]
+    Mem(0x66, false, {0x0F, 0x2E}, 0, RBX, 8 * (swap ? a : b));  // ucomisd xmm0, [b or a]
+    if (op == opEqD) {
+        Bytes({0x0F, 0x90 + kEqual, 0xC0, 0x0F, 0x90 + kNoParity, 0xC1, 0x20, 0xC8}); // al = ZF && !PF
+    } else if (op == opNeD) {
+        Bytes({0x0F, 0x90 + kNotEqual, 0xC0, 0x0F, 0x90 + kParity, 0xC1, 0x08, 0xC8}); // al = !ZF || PF
+    } else {
+        Bytes({0x0F, 0x90 + (op == opLtD || op == opGtD ? kAbove : kAboveEqual), 0xC0});
+    }
+    Bytes({0x0F, 0xB6, 0xC0});                    // movzx eax, al
+}
+
+void JIT::LoadReceiver(int vr, int nullLabel) {
+    Load(RAX, vr);
+    Bytes({0x48, 0x85, 0xC0});                    // test rax, rax
+    JumpIf(kEqual, nullLabel);
+}
+
+/* Method: EmitCall
+ * ----------------
+ * A helper sets up the callee's frame and runs it. For a CallVirtual
+ * the callee is loaded from the receiver's vtable first. For a tail
+ * call the helper only sets up the frame, and the function returns.
+ */
+void JIT::EmitCall(const Instr &in, bool tail) {
+    int stubs = code->source->blocks.size();
+    const Function &f = *code->source;
+    if (in.op == opCall) {
+        MovImm(R8, (intptr_t)&vm->code[in.a]);
+    } else if (in.op == opCallVirtual) {
+        LoadReceiver(f.args[in.b], stubs + kNullObjectStub);
+        Bytes({0x48, 0x63, 0x00});                // movsxd rax, [rax]: the class
+        MovImm(RCX, (intptr_t)vm->vtableStart.data());
+        Bytes({0x48, 0x63, 0x04, 0x81});          // movsxd rax, [rcx + rax*4]
+        MovImm(RCX, (intptr_t)(vm->vtables.data() + vm->module->FindSlot(vm->module->members[in.a])));
+        Bytes({0x4C, 0x8B, 0x04, 0xC1});          // mov r8, [rcx + rax*8]
+    } else {
+        Byte(0x41);
+        Byte(0xB8);
+        Int32(vm->module->FindSlot(vm->module->members[in.a])); // mov r8d, slot
+    }
+    MovImm(RDI, (intptr_t)vm);
+    MovImm(RSI, (intptr_t)code);
+    Bytes({0x48, 0x89, 0xDA});                    // mov rdx, rbx
+    MovImm(RCX, (intptr_t)&in);
+    if (tail) {
+        CallHelper(in.op == opCallInterface ? (void *)TailInvokeInterface : (void *)TailInvoke);
+        Jump(stubs + kReturnStub);
+        return;
+    }
+    CallHelper(in.op == opCallInterface ? (void *)InvokeInterface : (void *)Invoke);
+    if (in.dst >= 0) Store(in.dst, RAX);
+}
+
+/* Method: EmitPoll
+ * ----------------
+ * Branches to a stub that takes a sample, for an instruction at line, if
+ * the profiler's timer ticked. The check leaves rax alone, so a load
+ * into rax after it can still be left out; the stub reloads rax.
+ */
+void JIT::EmitPoll(int line) {
+    bool held = (buf.size() == raxHoldsAt);
+    Bytes({0x41, 0x83, 0x7D, 0x00, 0x00});        // cmp dword [r13], 0
+    Bytes({0x0F, 0x80 + kNotEqual});              // jne stub
+    polls.push_back({(int)buf.size(), line, held ? raxHolds : -1});
+    Int32(0);
+    if (held) raxHoldsAt = buf.size();
+}
+
+/* Method: EmitPollStubs
+ * ---------------------
+ * Emits the stubs for the polls: each calls Sample, restores rax if the
+ * code after its poll counts on it and jumps back there.
+ */
+void JIT::EmitPollStubs() {
+    for (size_t i = 0; i < polls.size(); i++) {
+        int site = polls[i].site;
+        int32_t rel = buf.size() - (site + 4);
+        memcpy(&buf[site], &rel, 4);
+        MovImm(RDI, (intptr_t)vm);
+        MovImm(RSI, (intptr_t)code);
+        MovImm(RDX, polls[i].line);
+        CallHelper((void *)Sample);
+        if (polls[i].raxHolds >= 0) Mem(0, true, {0x8B}, RAX, RBX, 8 * polls[i].raxHolds);
+        Byte(0xE9);                               // jmp back
+        Int32(site + 4 - (int)(buf.size() + 4));
+    }
+}
+
+void JIT::EmitInstr(const Instr &in, int next) {
+    int stubs = code->source->blocks.size();
+    switch (in.op) {
+      case opNop:
+        break;
+      case opLoadInt:
+        Mem(0, true, {0xC7}, 0, RBX, 8 * in.dst);
+        Int32(in.a);
+        break;
+      case opLoadDouble: {
+        int64_t bits;
+        memcpy(&bits, &vm->module->doubles[in.a], sizeof(bits));
+        MovImm(RAX, bits);
+        Store(in.dst, RAX);
+        break;
+      }
+      case opLoadString:
+        MovImm(RAX, (intptr_t)vm->strings[in.a]);
+        Store(in.dst, RAX);
+        break;
+      case opLoadNull:
+        Mem(0, true, {0xC7}, 0, RBX, 8 * in.dst);
+        Int32(0);
+        break;
+      case opMove:
+        Load(RAX, in.a);
+        Store(in.dst, RAX);
+        break;
+
+      case opAddI: case opSubI: case opAnd: case opOr:
+        Load(RAX, in.a, false);
+        Mem(0, false, {in.op == opAddI ? 0x03 : in.op == opSubI ? 0x2B : in.op == opAnd ? 0x23 : 0x0B},
+            RAX, RBX, 8 * in.b);
+        Store(in.dst, RAX);
+        break;
+      case opMulI:
+        Load(RAX, in.a, false);
+        Mem(0, false, {0x0F, 0xAF}, RAX, RBX, 8 * in.b);
+        Store(in.dst, RAX);
+        break;
+      case opDivI: case opModI:
+        Load(RAX, in.a, false);
+        Load(RCX, in.b, false);
+        Bytes({0x85, 0xC9});                      // test ecx, ecx
+        JumpIf(kEqual, stubs + kDivisionStub);
+        Bytes({0x83, 0xF9, 0xFF, 0x75, 0x04});    // cmp ecx, -1; jne idiv
+        if (in.op == opDivI)                      // idiv traps on INT_MIN / -1,
+            Bytes({0xF7, 0xD8});                  // so negate (neg eax)
+        else
+            Bytes({0x31, 0xD2});                  // or take 0 (xor edx, edx)
+        Bytes({0xEB, 0x03});                      // jmp past idiv
+        Bytes({0x99, 0xF7, 0xF9});                // idiv: cdq; idiv ecx
+        Store(in.dst, in.op == opDivI ? RAX : RDX);
+        break;
+      case opNegI:
+        Load(RAX, in.a, false);
+        Bytes({0xF7, 0xD8});                      // neg eax
+        Store(in.dst, RAX);
+        break;
+      case opNot:
+        Load(RAX, in.a, false);
+        Bytes({0x83, 0xF0, 0x01});                // xor eax, 1
+        Store(in.dst, RAX);
+        break;
+
+      case opAddD: case opSubD: case opMulD: case opDivD:
+        Mem(0xF2, false, {0x0F, 0x10}, 0, RBX, 8 * in.a);
+        Mem(0xF2, false, {0x0F, in.op == opAddD ? 0x58 : in.op == opSubD ? 0x5C : in.op == opMulD ? 0x59 : 0x5E},
+            0, RBX, 8 * in.b);
+        Mem(0xF2, false, {0x0F, 0x11}, 0, RBX, 8 * in.dst);
+        break;
+      case opModD:
+        Mem(0xF2, false, {0x0F, 0x10}, 0, RBX, 8 * in.a);
+        Mem(0xF2, false, {0x0F, 0x10}, 1, RBX, 8 * in.b);
+        CallHelper((void *)(double (*)(double, double))fmod);
+        Mem(0xF2, false, {0x0F, 0x11}, 0, RBX, 8 * in.dst);
+        break;
+      case opNegD:
+        Load(RAX, in.a);
+        Bytes({0x48, 0x0F, 0xBA, 0xF8, 0x3F});    // btc rax, 63
+        Store(in.dst, RAX);
+        break;
+
+      case opLtI: case opLeI: case opGtI: case opGeI: case opEqI: case opNeI: {
+        static const int cc[] = { kLess, kLessEqual, kGreater, kGreaterEqual, kEqual, kNotEqual };
+        Load(RAX, in.a, false);
+        Compare(cc[in.op - opLtI], in.b);
+        Store(in.dst, RAX);
+        break;
+      }
+      case opEqRef: case opNeRef:
+        Load(RAX, in.a);
+        Mem(0, true, {0x3B}, RAX, RBX, 8 * in.b);  // cmp rax, [b]
+        Bytes({0x0F, 0x90 + (in.op == opEqRef ? kEqual : kNotEqual), 0xC0, 0x0F, 0xB6, 0xC0});
+        Store(in.dst, RAX);
+        break;
+      case opLtD: case opLeD: case opGtD: case opGeD: case opEqD: case opNeD:
+        CompareDoubles(in.op, in.a, in.b);
+        Store(in.dst, RAX);
+        break;
+      case opEqStr: case opNeStr:
+        Load(RDI, in.a);
+        Load(RSI, in.b);
+        CallHelper((void *)EqualStrings);
+        if (in.op == opNeStr) Bytes({0x83, 0xF0, 0x01});
+        Store(in.dst, RAX);
+        break;
+
+      case opLoadGlobal:
+        MovImm(RCX, (intptr_t)&vm->globals[in.a]);
+        Mem(0, true, {0x8B}, RAX, RCX, 0);
+        Store(in.dst, RAX);
+        break;
+      case opStoreGlobal:
+        Load(RAX, in.b);
+        MovImm(RCX, (intptr_t)&vm->globals[in.a]);
+        Mem(0, true, {0x89}, RAX, RCX, 0);
+        break;
+      case opGetField: {
+        const Field *field = vm->fieldOf[in.b];
+        int size = SizeOfValue(field->type);
+        LoadReceiver(in.a, stubs + kNullObjectStub);
+        if (size == 1) Mem(0, false, {0x0F, 0xB6}, RCX, RAX, field->offset);
+        else Mem(0, size == 8, {0x8B}, RCX, RAX, field->offset);
+        Store(in.dst, RCX);
+        break;
+      }
+      case opSetField: {
+        const Field *field = vm->fieldOf[in.b];
+        int size = SizeOfValue(field->type);
+        LoadReceiver(in.a, stubs + kNullObjectStub);
+        Load(RCX, in.c, size == 8);
+        if (size == 1) Mem(0, false, {0x88}, RCX, RAX, field->offset);
+        else Mem(0, size == 8, {0x89}, RCX, RAX, field->offset);
+        if (IsReference(field->type)) {
+            MovImm(RDI, (intptr_t)vm);
+            Bytes({0x48, 0x89, 0xC6, 0x48, 0x89, 0xCA}); // mov rsi, rax; mov rdx, rcx
+            CallHelper((void *)WriteBarrier);
+        }
+        break;
+      }
+      case opNew:
+        MovImm(RDI, (intptr_t)vm);
+        Byte(0xBE);
+        Int32(in.a);                              // mov esi, cls
+        CallHelper((void *)New);
+        Store(in.dst, RAX);
+        break;
+      case opNewArray:
+        MovImm(RDI, (intptr_t)vm);
+        Load(RSI, in.a, false);
+        Byte(0xBA);
+        Int32(in.b);                              // mov edx, type
+        CallHelper((void *)NewArray);
+        Store(in.dst, RAX);
+        break;
+      case opArrayLoad: case opArrayStore:
+      case opArrayLoadUnchecked: case opArrayStoreUnchecked:
+        if (in.op == opArrayLoad || in.op == opArrayStore) {
+            LoadReceiver(in.a, stubs + kNullArrayStub);
+            Load(RCX, in.b, false);
+            Mem(0, false, {0x3B}, RCX, RAX, 4);   // cmp ecx, [rax + length]
+            JumpIf(kAboveEqual, stubs + kBoundsStub);
+        } else {
+            Load(RAX, in.a);
+            Load(RCX, in.b, false);
+        }
+        if (in.op == opArrayLoad || in.op == opArrayLoadUnchecked) {
+            Bytes({0x48, 0x8B, 0x54, 0xC8, 0x10}); // mov rdx, [rax + rcx*8 + 16]
+            Store(in.dst, RDX);
+        } else {
+            Load(RDX, in.c);
+            Bytes({0x48, 0x89, 0x54, 0xC8, 0x10}); // mov [rax + rcx*8 + 16], rdx
+            if (IsReference((valueTypeT)code->source->regTypes[in.c])) {
+                MovImm(RDI, (intptr_t)vm);
+                Bytes({0x48, 0x89, 0xC6});        // mov rsi, rax
+                CallHelper((void *)WriteBarrier);
+            }
+        }
+        break;
+      case opArrayFill: case opArrayCopy: case opArraySumI: case opArraySumD:
+        MovImm(RDI, (intptr_t)vm);
+        MovImm(RSI, (intptr_t)code);
+        Bytes({0x48, 0x89, 0xDA});                // mov rdx, rbx
+        MovImm(RCX, (intptr_t)&in);
+        CallHelper((void *)ArrayOp);
+        if (in.dst >= 0) Store(in.dst, RAX);
+        break;
+      case opArrayLength:
+        LoadReceiver(in.a, stubs + kNullArrayStub);
+        Mem(0, false, {0x8B}, RAX, RAX, 4);       // mov eax, [rax + length]
+        Store(in.dst, RAX);
+        break;
+
+      case opCall: case opCallVirtual: case opCallInterface:
+        EmitCall(in, false);
+        break;
+      case opCheckNull:
+        LoadReceiver(in.a, stubs + kNullObjectStub);
+        break;
+      case opReadInteger:
+        CallHelper((void *)ReadInteger);
+        Store(in.dst, RAX);
+        break;
+      case opReadLine:
+        MovImm(RDI, (intptr_t)vm);
+        CallHelper((void *)ReadLine);
+        Store(in.dst, RAX);
+        break;
+      case opPrintInt: case opPrintBool: case opPrintString:
+        Load(RDI, in.a);
+        CallHelper(in.op == opPrintInt ? (void *)PrintInt : in.op == opPrintBool ? (void *)PrintBool
+                   : (void *)PrintString);
+        break;
+      case opPrintDouble:
+        Mem(0xF2, false, {0x0F, 0x10}, 0, RBX, 8 * in.a);
+        CallHelper((void *)PrintDouble);
+        break;
+
+      case opJump:
+        if (vm->profiler && in.a < next) EmitPoll(in.line);
+        if (in.a != next) Jump(in.a);
+        break;
+      case opBranch:
+        if (vm->profiler && (in.b < next || in.c < next)) EmitPoll(in.line);
+        Load(RAX, in.a, false);
+        Bytes({0x85, 0xC0});                      // test eax, eax
+        if (in.b == next) {
+            JumpIf(kEqual, in.c);
+        } else {
+            JumpIf(kNotEqual, in.b);
+            if (in.c != next) Jump(in.c);
+        }
+        break;
+      case opReturn:
+        if (vm->profiler) EmitPoll(in.line);
+        if (in.a >= 0) Load(RAX, in.a);
+        else Bytes({0x31, 0xC0});                 // xor eax, eax
+        Jump(stubs + kReturnStub);
+        break;
+      default:
+        Assert(0);
+    }
+}
+
+/* Method: Compile
+ * ---------------
+ * The prologue saves rbx, points it at the frame and jumps to the entry
+ * block passed in; rsp stays 16-byte aligned for the helpers. While
+ * profiling it also saves r13, in place of the padding, for the polls.
+ * The epilogue and the runtime error stubs follow the blocks.
+ */
+bool JIT::Compile(Code *c) {
+    const Function &f = *c->source;
+    int numBlocks = f.blocks.size();
+    code = c;
+    buf.clear();
+    fixups.clear();
+    polls.clear();
+    labels.assign(numBlocks + kNumStubs, 0);
+
+    Bytes({0x55, 0x48, 0x89, 0xE5, 0x53});        // push rbp; mov rbp, rsp; push rbx
+    if (vm->profiler) {
+        Bytes({0x41, 0x55});                      // push r13
+        MovImm(R13, (intptr_t)&Profiler::ticks);
+    } else {
+        Bytes({0x48, 0x83, 0xEC, 0x08});          // sub rsp, 8
+    }
+    Bytes({0x48, 0x89, 0xFB, 0xFF, 0xE6});        // mov rbx, rdi; jmp rsi
+    for (int b = 0; b < numBlocks; b++) {
+        labels[b] = buf.size();
+        raxHolds = -1;
+        for (int i = f.blocks[b].start; i < f.blocks[b].end; i++) {
+            if (IsTailCall(f, i)) {
+                EmitCall(f.code[i++], true);       // and leave out the Return
+                continue;
+            }
+            EmitInstr(f.code[i], b + 1);
+        }
+    }
+    labels[numBlocks + kReturnStub] = buf.size();
+    if (vm->profiler) Bytes({0x41, 0x5D});       // pop r13
+    else Bytes({0x48, 0x83, 0xC4, 0x08});         // add rsp, 8
+    Bytes({0x5B, 0x5D, 0xC3});                    // pop rbx; pop rbp; ret
+    static const char *messages[] = { NULL, "Null object reference", "Null array reference",
+                                      "Array subscript out of bounds", "Division by zero" };
+    for (int s = kNullObjectStub; s < kNumStubs; s++) {
+        labels[numBlocks + s] = buf.size();
+        MovImm(RDI, (intptr_t)messages[s]);
+        CallHelper((void *)Error);
+    }
+    EmitPollStubs();
+    for (size_t i = 0; i < fixups.size(); i++) {
+        int32_t rel = labels[fixups[i].second] - (fixups[i].first + 4);
+        memcpy(&buf[fixups[i].first], &rel, 4);
+    }
+
+    size_t size = (buf.size() + 15) & ~(size_t)15;
+    if (used + size > capacity) {
+        c->hotness = INT_MIN;       // do not try again
+        return false;
+    }
+    size_t page = sysconf(_SC_PAGESIZE), start = used / page * page, end = (used + size + page - 1) / page * page;
+    mprotect(region + start, end - start, PROT_READ | PROT_WRITE);
+    memcpy(region + used, buf.data(), buf.size());
+    mprotect(region + start, end - start, PROT_READ | PROT_EXEC);
+    c->native = region + used;
+    c->entries.resize(numBlocks);
+    for (int b = 0; b < numBlocks; b++)
+        c->entries[b] = c->native + labels[b];
+    used += size;
+    compiled++;
+    PrintDebug("jit", "compiled %s to %d bytes\n", f.name.c_str(), (int)buf.size());
+    return true;
+}
+
+void JIT::PrintStats(FILE *fp) {
+    fprintf(fp, "vm: %d functions compiled to %ld bytes of machine code\n", compiled, (long)used);
+}
+
+uint64_t JIT::Invoke(VM *vm, Code *caller, Value *regs, const Instr *in, Code *callee) {
+    if (Profiler::ticks.load(std::memory_order_relaxed)) vm->Sample(caller, in->line);
+    Value *calleeRegs = regs + caller->numRegs;
+    if (calleeRegs + callee->numRegs > vm->stackEnd) RuntimeError("Stack overflow");
+    const int *args = &caller->source->args[in->b];
+    for (int k = 0; k < in->c; k++)
+        calleeRegs[k] = regs[args[k]];
+    memset(calleeRegs + in->c, 0, (callee->numRegs - in->c) * sizeof(Value));
+    Frame frame = { caller, NULL, regs, in->dst };
+    Value result = vm->Call(frame, callee, calleeRegs);
+    uint64_t bits;
+    memcpy(&bits, &result, sizeof(bits));
+    return bits;
+}
+
+uint64_t JIT::InvokeInterface(VM *vm, Code *caller, Value *regs, const Instr *in, int slot) {
+    return Invoke(vm, caller, regs, in, InterfaceCallee(vm, caller, regs, in, slot));
+}
+
+/* Method: TailInvoke
+ * ------------------
+ * Replaces the caller's frame with the callee's, copying the arguments
+ * above the frame first since they may be read from the registers they
+ * go to, and has RunNative run the callee once the caller returns.
+ */
+void JIT::TailInvoke(VM *vm, Code *caller, Value *regs, const Instr *in, Code *callee) {
+    if (Profiler::ticks.load(std::memory_order_relaxed)) vm->Sample(caller, in->line);
+    Value *staged = regs + caller->numRegs;
+    if (regs + callee->numRegs > vm->stackEnd || staged + in->c > vm->stackEnd) RuntimeError("Stack overflow");
+    const int *args = &caller->source->args[in->b];
+    for (int k = 0; k < in->c; k++)
+        staged[k] = regs[args[k]];
+    memmove(regs, staged, in->c * sizeof(Value));
+    memset(regs + in->c, 0, (callee->numRegs - in->c) * sizeof(Value));
+    vm->tailCallee = callee;
+}
+
+void JIT::TailInvokeInterface(VM *vm, Code *caller, Value *regs, const Instr *in, int slot) {
+    TailInvoke(vm, caller, regs, in, InterfaceCallee(vm, caller, regs, in, slot));
+}
+
+Code *JIT::InterfaceCallee(VM *vm, Code *caller, Value *regs, const Instr *in, int slot) {
+    HeapObj *receiver = regs[caller->source->args[in->b]].p;
+    if (!receiver) RuntimeError("Null object reference");
+    int interface = vm->module->members[in->a].cls;
+    return vm->FindInterfaceMethod(receiver->type, interface, slot);
+}
+
+HeapObj *JIT::New(VM *vm, int cls) { return vm->NewObject(cls); }
+
+HeapObj *JIT::NewArray(VM *vm, int length, int elemType) {
+    if (length <= 0) RuntimeError("Array size is <= 0");
+    return vm->NewArray(length, (valueTypeT)elemType);
+}
+
+HeapObj *JIT::ReadLine(VM *vm) {
+    std::string line = ReadInputLine();
+    return vm->LineString(line);
+}
+
+int JIT::ReadInteger() { return ReadInputInteger(); }
+void JIT::WriteBarrier(VM *vm, HeapObj *obj, HeapObj *value) { vm->heap->WriteBarrier(obj, value); }
+uint64_t JIT::ArrayOp(VM *vm, Code *code, Value *regs, const Instr *in) {
+    const int *args = &code->source->args[in->b];
+    Value result = vm->ArrayOp(in->op, regs[args[0]], regs[args[1]], regs[args[2]], regs[args[3]]);
+    uint64_t bits;
+    memcpy(&bits, &result, sizeof(bits));
+    return bits;
+}
+
+int JIT::EqualStrings(HeapObj *a, HeapObj *b) { return ::EqualStrings(a, b); }
+void JIT::PrintInt(int value) { ::PrintInt(value); }
+void JIT::PrintBool(int value) { PrintChars(value ? "true" : "false", value ? 4 : 5); }
+void JIT::PrintDouble(double value) { ::PrintDouble(value); }
+void JIT::PrintString(HeapObj *s) { PrintChars(CharsOf(s), s->length); }
+void JIT::Error(const char *message) { RuntimeError("%s", message); }
+void JIT::Sample(VM *vm, Code *code, int line) { vm->Sample(code, line); }
+
+#endif
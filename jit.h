@@ -0,0 +1,117 @@
+/* File: jit.h
+ * -----------
+ * The VM's baseline JIT: functions that get hot are compiled to x86-64
+ * machine code, one fixed template per IR instruction and no further
+ * optimization. The VM counts the calls of each function and the loop
+ * back edges taken in it; once the count passes --jit-threshold (1000 by
+ * default) the function is compiled, and --no-jit turns compilation off.
+ *
+ * Compiled code keeps using the function's frame of Values on the VM
+ * stack: rbx points to it and each instruction loads its operands from
+ * their slots and stores its result back. So the collector still finds
+ * every reference in the frames, and a function can switch from the
+ * interpreter to its compiled code at the start of any block, in the
+ * middle of a call: when a loop in a running function gets hot, the
+ * interpreter jumps into the compiled loop header and the compiled code
+ * finishes the call.
+ *
+ * Field accesses, array accesses and vtable lookups are inlined as
+ * loads and stores at the offsets the VM uses. Calls, allocation, the
+ * write barrier, the bulk array instructions and I/O go through helper
+ * functions into the VM; a call runs the callee compiled if it is and in
+ * the interpreter otherwise. A tail call, a call whose result is
+ * returned right away, instead sets up the callee's frame in place of
+ * the caller's and returns, leaving the VM to run the callee (see
+ * VM::RunNative), so tail recursion takes no stack.
+ *
+ * While the VM profiles (see profile.h), each return and each jump back
+ * to an earlier block first checks whether the profiler's timer ticked,
+ * with r13 kept pointing at the tick count, and branches to a stub after
+ * the blocks that calls into the VM to take a sample; calls check in
+ * their helper.
+ *
+ * The code lives in an mmap'd buffer that is made writable only while a
+ * function is being copied in.
+ */
+
+#ifndef _H_jit
+#define _H_jit
+
+#include <stdint.h>
+#include <vector>
+#include "vm.h"
+
+#ifdef VM_JIT
+
+/* A compiled function: regs is its frame and entry the start of the
+ * block to begin at. Returns the result's bits.
+ */
+typedef uint64_t (*NativeCode)(Value *regs, uint8_t *entry);
+
+class JIT
+{
+  protected:
+    VM *vm;
+    uint8_t *region;
+    size_t used, capacity;
+    int compiled;
+
+    Code *code;                  // the function being compiled
+    std::vector<uint8_t> buf;
+    std::vector<int> labels;     // offset of each block, then the stubs
+    std::vector<std::pair<int, int> > fixups; // rel32 offset, label
+    struct Poll { int site, line, raxHolds; };
+    std::vector<Poll> polls;     // rel32 offset of each jump to a stub
+    int raxHolds;                // frame register just stored from rax
+    size_t raxHoldsAt;           // where that store ended
+
+    void Byte(int b) { buf.push_back(b); }
+    void Bytes(std::initializer_list<int> bytes);
+    void Int32(int32_t value);
+    void Int64(int64_t value);
+    void Mem(int prefix, bool wide, std::initializer_list<int> opcode, int reg, int base, int disp);
+    void Load(int reg, int vr, bool wide = true);
+    void Store(int vr, int reg);
+    void MovImm(int reg, int64_t value);
+    void CallHelper(const void *fn);
+    void Jump(int label);
+    void JumpIf(int cc, int label);
+    void Compare(int cc, int vr);
+    void CompareDoubles(int op, int a, int b);
+    void LoadReceiver(int vr, int nullLabel);
+    void EmitCall(const Instr &in, bool tail);
+    void EmitPoll(int line);
+    void EmitPollStubs();
+    void EmitInstr(const Instr &in, int next);
+
+          // Called from compiled code
+    static uint64_t Invoke(VM *vm, Code *caller, Value *regs, const Instr *in, Code *callee);
+    static uint64_t InvokeInterface(VM *vm, Code *caller, Value *regs, const Instr *in, int slot);
+    static void TailInvoke(VM *vm, Code *caller, Value *regs, const Instr *in, Code *callee);
+    static void TailInvokeInterface(VM *vm, Code *caller, Value *regs, const Instr *in, int slot);
+    static Code *InterfaceCallee(VM *vm, Code *caller, Value *regs, const Instr *in, int slot);
+    static HeapObj *New(VM *vm, int cls);
+    static HeapObj *NewArray(VM *vm, int length, int elemType);
+    static HeapObj *ReadLine(VM *vm);
+    static int ReadInteger();
+    static void WriteBarrier(VM *vm, HeapObj *obj, HeapObj *value);
+    static uint64_t ArrayOp(VM *vm, Code *code, Value *regs, const Instr *in);
+    static int EqualStrings(HeapObj *a, HeapObj *b);
+    static void PrintInt(int value);
+    static void PrintBool(int value);
+    static void PrintDouble(double value);
+    static void PrintString(HeapObj *s);
+    static void Error(const char *message);
+    static void Sample(VM *vm, Code *code, int line);
+
+  public:
+    JIT(VM *vm);
+
+          // Compiles c, setting its native code and block entries.
+          // Returns false if the code buffer is full.
+    bool Compile(Code *c);
+    void PrintStats(FILE *fp);
+};
+
+#endif
+#endif
@@ -0,0 +1,142 @@
+/* File: layout.cc
+ * ---------------
+ * Implementation of the layout pass.
+ */
+
+#include "layout.h"
+#include "utility.h"
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <set>
+#include <string>
+
+using std::string;
+
+int SizeOfValue(valueTypeT t) {
+    switch (t) {
+      case vBool: return 1;
+      case vInt: return 4;
+      default: return 8;
+    }
+}
+
+/* A gap of unused bytes [start, end) left between fields by alignment.
+ */
+struct Gap {
+    int start, end;
+};
+
+/* Class: Layout
+ * -------------
+ * The state of one run: which classes are laid out so far and, for each
+ * of them, the gaps a subclass may still fill.
+ */
+class Layout
+{
+  protected:
+    Module *module;
+    std::set<string> hot;              // "Class.field"
+    std::vector<bool> done;
+    std::vector<std::vector<Gap> > gaps;
+
+    bool IsHot(int cls, const Field &f);
+    int Place(std::vector<Gap> &gaps, int &end, int size);
+    void Report(int cls);
+
+  public:
+    Layout(Module *module);
+    void LayOut(int cls);
+};
+
+Layout::Layout(Module *m) : module(m) {
+    done.assign(module->classes.size(), false);
+    gaps.resize(module->classes.size());
+    const char *option = GetOption("hot-fields");
+    if (!option) return;
+    char *list = strdup(option);
+    for (char *name = strtok(list, ","); name; name = strtok(NULL, ","))
+        hot.insert(name);
+    free(list);
+}
+
+bool Layout::IsHot(int cls, const Field &f) {
+    return hot.count(module->classes[cls].name + "." + f.name) > 0;
+}
+
+/* Method: Place
+ * -------------
+ * Returns the offset for a field of size bytes (aligned to size): the
+ * first gap it fits in, or else the end of the object, which moves past
+ * it. Any bytes skipped for alignment become a new gap.
+ */
+int Layout::Place(std::vector<Gap> &gaps, int &end, int size) {
+    for (size_t i = 0; i < gaps.size(); i++) {
+        int offset = (gaps[i].start + size - 1) / size * size;
+        if (offset + size > gaps[i].end) continue;
+        Gap after = { offset + size, gaps[i].end };
+        gaps[i].end = offset;
+        if (after.start < after.end) gaps.insert(gaps.begin() + i + 1, after);
+        return offset;
+    }
+    int offset = (end + size - 1) / size * size;
+    if (offset > end) {
+        Gap skipped = { end, offset };
+        gaps.push_back(skipped);
+    }
+    end = offset + size;
+    return offset;
+}
+
+void Layout::LayOut(int cls) {
+    if (done[cls]) return;
+    done[cls] = true;
+    ClassInfo &info = module->classes[cls];
+    int end = kObjectHeaderSize;
+    if (info.base >= 0) {
+        LayOut(info.base);
+        end = module->classes[info.base].size;
+        gaps[cls] = gaps[info.base];
+    }
+
+    std::vector<int> order;
+    for (size_t i = 0; i < info.fields.size(); i++)
+        order.push_back(i);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        Field &fa = info.fields[a], &fb = info.fields[b];
+        if (IsHot(cls, fa) != IsHot(cls, fb)) return IsHot(cls, fa);
+        return SizeOfValue(fa.type) > SizeOfValue(fb.type);
+    });
+    for (size_t i = 0; i < order.size(); i++) {
+        Field &f = info.fields[order[i]];
+        f.offset = Place(gaps[cls], end, SizeOfValue(f.type));
+    }
+    info.size = end;
+    if (IsDebugOn("layout")) Report(cls);
+}
+
+/* Method: Report
+ * --------------
+ * Prints the offsets of a class's own fields and the space an instance
+ * takes, rounded up to 8 bytes as the VM allocates it.
+ */
+void Layout::Report(int cls) {
+    ClassInfo &info = module->classes[cls];
+    int used = kObjectHeaderSize;
+    for (int c = cls; c >= 0; c = module->classes[c].base)
+        for (size_t i = 0; i < module->classes[c].fields.size(); i++)
+            used += SizeOfValue(module->classes[c].fields[i].type);
+    int allocated = (info.size + 7) & ~7;
+    PrintDebug("layout", "class %s: %d bytes (%d header, %d fields, %d padding)\n", info.name.c_str(),
+               allocated, kObjectHeaderSize, used - kObjectHeaderSize, allocated - used);
+    for (size_t i = 0; i < info.fields.size(); i++)
+        PrintDebug("layout", "  +%d %s %s%s\n", info.fields[i].offset, TypeName(info.fields[i].type),
+                   info.fields[i].name.c_str(), IsHot(cls, info.fields[i]) ? " (hot)" : "");
+}
+
+void LayOutClasses(Module *module) {
+    Layout layout(module);
+    for (size_t c = 0; c < module->classes.size(); c++)
+        if (!module->classes[c].isInterface)
+            layout.LayOut(c);
+}
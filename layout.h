@@ -0,0 +1,39 @@
+/* File: layout.h
+ * --------------
+ * The layout pass decides how instances of each class are stored: it
+ * gives every field a byte offset from the start of the object and each
+ * class its instance size (see Field::offset and ClassInfo::size).
+ *
+ * An object starts with a header of kObjectHeaderSize bytes (see gc.h).
+ * The fields inherited from the superclass come next, at the same
+ * offsets as in the superclass, so code compiled for the superclass
+ * works on an instance of any subclass. The class's own fields follow, largest first, each
+ * aligned to its size; a smaller field goes into an earlier gap left by
+ * alignment if one fits. With --hot-fields=Class.field,... the fields
+ * listed are placed before the other fields of their class, so that they
+ * share cache lines.
+ *
+ * With -d layout the pass prints each class's layout and footprint.
+ */
+
+#ifndef _H_layout
+#define _H_layout
+
+#include "tac.h"
+
+const int kObjectHeaderSize = 16;
+
+/* Function: SizeOfValue
+ * ---------------------
+ * Returns how many bytes a field of type t takes: 1 for bool, 4 for int
+ * and 8 for double and references.
+ */
+int SizeOfValue(valueTypeT t);
+
+/* Function: LayOutClasses
+ * -----------------------
+ * Runs the pass over every class of module.
+ */
+void LayOutClasses(Module *module);
+
+#endif
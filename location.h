@@ -20,6 +20,7 @@ typedef struct yyltype
     int first_line, first_column;
     int last_line, last_column;      
     char *text;                    // you can also ignore this field
+    int file;                      // source file, see AddSourceFile
 } yyltype;
 
 #define YYLTYPE yyltype
@@ -45,6 +46,7 @@ inline yyltype Join(yyltype first, yyltype last)
   combined.first_line = first.first_line;
   combined.last_column = last.last_column;
   combined.last_line = last.last_line;
+  combined.file = first.file;
   return combined;
 }
 
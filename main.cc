@@ -6,26 +6,182 @@
  
 #include <string.h>
 #include <stdio.h>
+#include <string>
 #include "utility.h"
 #include "errors.h"
 #include "parser.h"
+#include "module.h"
+#include "summary.h"
+#include "irgen.h"
+#include "opt.h"
+#include "layout.h"
+#include "vm.h"
+#include "x86.h"
+#include "image.h"
+
+
+/* Function: Lowering()
+ * ----------------------
+ * Whether the options ask for the checked program to be lowered.
+ */
+static bool Lowering()
+{
+    return IsDebugOn("tac") || GetOption("asm") || GetOption("image") || GetOption("execute");
+}
+
+/* Function: ImportSummaries()
+ * -----------------------------
+ * --import=a.sum,b.sum makes the declarations in those summary files
+ * visible to the program being checked. A summary has no code, so a
+ * program that imports one can only be checked, not lowered (main
+ * refuses --import with any of the options that lower it).
+ */
+static void ImportSummaries(Program *program)
+{
+    const char *imports = GetOption("import");
+    if (!imports) return;
+    char *list = strdup(imports);
+    for (char *path = strtok(list, ","); path; path = strtok(NULL, ","))
+        program->Import(ReadSummary(path));
+    free(list);
+}
+
+/* Function: WriteSummaryFile()
+ * ----------------------------
+ * --summary=file writes the summary of a program that checked cleanly.
+ */
+static void WriteSummaryFile(Program *program)
+{
+    const char *path = GetOption("summary");
+    if (!path || !*path) return;
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        ReportError::Formatted(NULL, "Cannot write summary file '%s'", path);
+        return;
+    }
+    WriteSummary(program, fp);
+    fclose(fp);
+}
+
+
+/* Function: ReadMainSource()
+ * ---------------------------
+ * Reads the program from stdin, or from the file named by --source so
+ * that stdin is left to a program run with --execute. Sets *dir to the
+ * directory its #imports are relative to.
+ */
+static char *ReadMainSource(int *len, std::string *dir)
+{
+    const char *path = GetOption("source");
+    *dir = ".";
+    if (!path || !*path) return ReadSource(stdin, len);
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        ReportError::Formatted(NULL, "Cannot open source file '%s'", path);
+        return NULL;
+    }
+    const char *slash = strrchr(path, '/');
+    if (slash) *dir = std::string(path, slash - path + 1);
+    char *source = ReadSource(fp, len);
+    fclose(fp);
+    return source;
+}
+
+
+/* Function: WriteAssembly()
+ * --------------------------
+ * --asm=file writes the program as x86-64 assembly (see x86.h).
+ */
+static void WriteAssembly(Module *module)
+{
+    const char *path = GetOption("asm");
+    if (!path || !*path) return;
+    if (module->mainFunction < 0) {
+        ReportError::Formatted(NULL, "Linker: function 'main' not defined");
+        return;
+    }
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        ReportError::Formatted(NULL, "Cannot write assembly file '%s'", path);
+        return;
+    }
+    EmitX86(module, fp);
+    fclose(fp);
+}
+
+
+/* Function: WriteImageFile()
+ * ---------------------------
+ * --image=file writes the program as a bytecode image (see image.h).
+ */
+static void WriteImageFile(Module *module)
+{
+    const char *path = GetOption("image");
+    if (!path || !*path) return;
+    if (!WriteImage(module, path))
+        ReportError::Formatted(NULL, "Cannot write image file '%s'", path);
+}
+
+
+/* Function: RunImage()
+ * --------------------
+ * --run=file runs a bytecode image in the VM instead of compiling a
+ * source file.
+ */
+static int RunImage(const char *path)
+{
+    Module *module = LoadImage(path);
+    return module ? VM(module).Run() : -1;
+}
 
 
 /* Function: main()
  * ----------------
  * Entry point to the entire program.  We parse the command line and turn
  * on any debugging flags requested by the user when invoking the program.
- * InitScanner() is used to set up the scanner.
- * InitParser() is used to set up the parser. The call to yyparse() will
- * attempt to parse a complete program from the input. 
+ * LoadUnit() builds the tree for the input, either by scanning and parsing
+ * it (InitScanner/InitParser/yyparse) or from the AST cache. If that went
+ * without errors, the files it #imports and any imported summaries are
+ * added and the semantic analyzer is run over the tree. A program that
+ * checks cleanly has its constant expressions folded (Program::Fold,
+ * skipped with --no-fold), is lowered to the IR (see irgen.h), optimized
+ * (opt.h) and its objects laid out (layout.h) if it is to be printed
+ * (-d tac), compiled to assembly (--asm, see x86.h), saved as a bytecode
+ * image (--image, see image.h) or run in the VM (--execute, see vm.h);
+ * when it is run, its exit status is the program's. --run runs an image
+ * saved before.
  */
 int main(int argc, char *argv[])
 {
     ParseCommandLine(argc, argv);
-  
-    InitScanner();
-    InitParser();
-    yyparse();
+    if (GetOption("run")) return RunImage(GetOption("run"));
+    if (GetOption("import") && Lowering()) {
+        ReportError::Formatted(NULL, "--import only checks a program: summaries have no code to run (use #import)");
+        return -1;
+    }
+
+    int len;
+    std::string dir;
+    char *source = ReadMainSource(&len, &dir);
+    if (!source) return -1;
+    Program *program = LoadUnit(source, len, AddSourceFile(GetOption("source")));
+    if (program && ReportError::NumErrors() == 0)
+        IncludeImports(program, dir.c_str());
+    if (program && ReportError::NumErrors() == 0) {
+        ImportSummaries(program);
+        program->Check();
+        if (ReportError::NumErrors() == 0)
+            WriteSummaryFile(program);
+        if (ReportError::NumErrors() == 0 && Lowering()) {
+            if (!GetOption("no-fold")) program->Fold();
+            Module *module = GenerateIR(program);
+            Optimize(module);
+            LayOutClasses(module);
+            if (IsDebugOn("tac")) module->Dump(stdout);
+            WriteAssembly(module);
+            WriteImageFile(module);
+            if (GetOption("execute")) return VM(module).Run();
+        }
+    }
     return (ReportError::NumErrors() == 0? 0 : -1);
 }
-
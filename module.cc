@@ -0,0 +1,201 @@
+/* File: module.cc
+ * ---------------
+ * Implementation of multi-file loading and the dependency scheduler.
+ */
+
+#include "module.h"
+#include "ast_stmt.h"
+#include "astcache.h"
+#include "parallel.h"
+#include "parser.h"
+#include "errors.h"
+#include "utility.h"
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <map>
+#include <string>
+#include <vector>
+
+static const char *DefaultCacheDir = ".dcc-cache";
+
+
+char *ReadSource(FILE *fp, int *len)
+{
+    int size = 0, cap = 8192;
+    char *buf = (char *)malloc(cap);
+    int n;
+    while ((n = fread(buf + size, 1, cap - size, fp)) > 0) {
+        size += n;
+        if (size == cap) buf = (char *)realloc(buf, cap *= 2);
+    }
+    *len = size;
+    return buf;
+}
+
+static const char *CacheDir()
+{
+    const char *dir = GetOption("cache");
+    return (dir && !*dir) ? DefaultCacheDir : dir;
+}
+
+// Safe to call from several threads at once, for different files
+static Program *LoadCachedUnit(const char *text, int len, int file)
+{
+    const char *dir = CacheDir();
+    Program *program = dir ? LoadCachedProgram(dir, HashSource(text, len), file) : NULL;
+    if (program) RecordSourceLines(file, text, len);
+    return program;
+}
+
+// Runs the scanner and parser over text; one file at a time only
+static Program *ParseUnit(const char *text, int len, int file)
+{
+    FILE *fp = (len > 0) ? fmemopen((void *)text, len, "r") : fopen("/dev/null", "r");
+    int errorsBefore = ReportError::NumErrors();
+    parsedProgram = NULL;
+    yyrestart(fp);
+    InitScanner(file);
+    InitParser();
+    yyparse();
+    fclose(fp);
+
+    const char *dir = CacheDir();
+    if (dir && parsedProgram && ReportError::NumErrors() == errorsBefore)
+        SaveCachedProgram(dir, HashSource(text, len), parsedProgram);
+    return parsedProgram;
+}
+
+Program *LoadUnit(const char *text, int len, int file)
+{
+    Program *program = LoadCachedUnit(text, len, file);
+    return program ? program : ParseUnit(text, len, file);
+}
+
+
+/* Struct: Unit
+ * ------------
+ * One source file of the program and the indexes of the units it imports.
+ */
+struct Unit {
+    std::string path, dir;
+    std::string shownDir;        // dir as the user would write it
+    char *text;
+    int len;
+    int file;                    // see AddSourceFile
+    bool readable;
+    Program *program;
+    std::vector<int> deps;
+    enum { kUnvisited, kVisiting, kDone } mark;
+};
+
+static std::string DirectoryOf(const std::string &path)
+{
+    size_t slash = path.rfind('/');
+    return slash == std::string::npos ? "." : path.substr(0, slash);
+}
+
+// The path as it was written, from the current directory, for errors
+static std::string DisplayPath(const std::string &dir, const char *file)
+{
+    if (file[0] == '/' || dir == ".") return file;
+    return dir + (!dir.empty() && dir[dir.size() - 1] == '/' ? "" : "/") + file;
+}
+
+static std::string ResolvePath(const std::string &dir, const char *file)
+{
+    std::string path = (file[0] == '/') ? file : dir + "/" + file;
+    char real[PATH_MAX];
+    return realpath(path.c_str(), real) ? real : path;
+}
+
+/* Function: SortUnits
+ * -------------------
+ * Depth-first walk that appends each unit to order after everything it
+ * imports. Reaching a unit that is still on the walk's path means the
+ * imports form a cycle, which is reported.
+ */
+static void SortUnits(std::vector<Unit*> &units, int u, std::vector<int> &order)
+{
+    Unit *unit = units[u];
+    if (unit->mark == Unit::kDone) return;
+    if (unit->mark == Unit::kVisiting) {
+        ReportError::Formatted(NULL, "Import cycle through '%s'", unit->path.c_str());
+        return;
+    }
+    unit->mark = Unit::kVisiting;
+    for (int i = 0; i < unit->deps.size(); i++)
+        SortUnits(units, unit->deps[i], order);
+    unit->mark = Unit::kDone;
+    order.push_back(u);
+}
+
+void IncludeImports(Program *program, const char *dir)
+{
+    std::vector<Unit*> units;
+    std::map<std::string, int> byPath;
+
+    Unit *root = new Unit();
+    root->dir = root->shownDir = dir;
+    root->file = 0;
+    root->readable = true;
+    root->program = program;
+    root->mark = Unit::kUnvisited;
+    units.push_back(root);
+
+    std::vector<int> wave(1, 0);
+    while (!wave.empty()) {
+        // find the files imported by this wave that are not known yet
+        std::vector<int> next;
+        for (int w = 0; w < wave.size(); w++) {
+            Unit *unit = units[wave[w]];
+            if (!unit->program) continue;
+            List<const char*> *imports = unit->program->GetImports();
+            for (int i = 0; i < imports->NumElements(); i++) {
+                std::string path = ResolvePath(unit->dir, imports->Nth(i));
+                if (!byPath.count(path)) {
+                    Unit *dep = new Unit();
+                    dep->path = path;
+                    dep->dir = DirectoryOf(path);
+                    std::string shown = DisplayPath(unit->shownDir, imports->Nth(i));
+                    dep->shownDir = DirectoryOf(shown);
+                    dep->file = AddSourceFile(shown.c_str());
+                    dep->program = NULL;
+                    dep->mark = Unit::kUnvisited;
+                    byPath[path] = units.size();
+                    next.push_back(units.size());
+                    units.push_back(dep);
+                }
+                unit->deps.push_back(byPath[path]);
+            }
+        }
+
+        // read them and try the cache concurrently...
+        ParallelFor(next.size(), [&](int i) {
+            Unit *unit = units[next[i]];
+            FILE *fp = fopen(unit->path.c_str(), "r");
+            unit->readable = (fp != NULL);
+            if (!fp) return;
+            unit->text = ReadSource(fp, &unit->len);
+            fclose(fp);
+            unit->program = LoadCachedUnit(unit->text, unit->len, unit->file);
+        });
+
+        // ...then parse the ones that missed
+        for (int i = 0; i < next.size(); i++) {
+            Unit *unit = units[next[i]];
+            if (!unit->readable)
+                ReportError::Formatted(NULL, "Cannot open imported file '%s'", unit->path.c_str());
+            else if (!unit->program)
+                unit->program = ParseUnit(unit->text, unit->len, unit->file);
+            PrintDebug("module", "loaded %s", unit->path.c_str());
+        }
+        wave = next;
+    }
+
+    std::vector<int> order;
+    SortUnits(units, 0, order);
+    for (int i = 0; i < order.size(); i++)
+        if (order[i] != 0 && units[order[i]]->program)
+            program->Include(units[order[i]]->program);
+}
@@ -0,0 +1,56 @@
+/* File: module.h
+ * --------------
+ * Loading of programs that are split across several source files. A
+ * file names the files it depends on with directives at the start of a
+ * line (recognized by the scanner):
+ *
+ *     #import "shapes.decaf"
+ *
+ * Paths are relative to the directory of the importing file, or to the
+ * current directory for the main program read from standard input. Each
+ * file is loaded once however many files import it.
+ *
+ * Files are loaded in waves: all the files discovered in one round are
+ * read and looked up in the AST cache concurrently, and the ones that
+ * miss are then parsed one at a time, since the generated scanner and
+ * parser keep their state in globals. Once everything is loaded, the
+ * dependency graph is sorted and the files are included in the main
+ * program so that each file's declarations enter the global scope after
+ * those of the files it imports. Each file's lines are kept apart (see
+ * AddSourceFile in scanner.h), so an error in an imported file is
+ * reported with that file's name and line.
+ */
+
+#ifndef _H_module
+#define _H_module
+
+#include <stdio.h>
+
+class Program;
+
+/* Function: ReadSource
+ * --------------------
+ * Reads the whole stream into a new buffer and returns it, setting *len.
+ */
+char *ReadSource(FILE *fp, int *len);
+
+/* Function: LoadUnit
+ * ------------------
+ * Builds the tree for one source file, numbered file by AddSourceFile
+ * (see scanner.h): with --cache[=dir] from the AST cache when the source
+ * is unchanged, otherwise by scanning and parsing it (and saving the
+ * result to the cache if it parsed without errors). Returns NULL if
+ * parsing failed.
+ */
+Program *LoadUnit(const char *text, int len, int file);
+
+/* Function: IncludeImports
+ * ------------------------
+ * Loads every file reachable through #import directives from program and
+ * includes them in it in dependency order. The program's own imports are
+ * relative to dir. Missing files, import cycles and errors in the
+ * imported files are reported through ReportError.
+ */
+void IncludeImports(Program *program, const char *dir);
+
+#endif
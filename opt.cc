@@ -0,0 +1,1810 @@
+/* File: opt.cc
+ * ------------
+ * Implementation of the optimizer's passes.
+ */
+
+#include "opt.h"
+#include "ssa.h"
+#include "utility.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+
+/* Returns whether in computes its result from its operands alone: it
+ * has no effect, cannot fail and gives the same result wherever it runs.
+ */
+static bool IsPure(const Instr &in) {
+    switch (in.op) {
+      case opLoadInt: case opLoadDouble: case opLoadString: case opLoadNull: case opMove:
+      case opAddI: case opSubI: case opMulI: case opNegI:
+      case opAddD: case opSubD: case opMulD: case opDivD: case opModD: case opNegD:
+      case opLtI: case opLeI: case opGtI: case opGeI: case opEqI: case opNeI:
+      case opLtD: case opLeD: case opGtD: case opGeD: case opEqD: case opNeD:
+      case opEqRef: case opNeRef: case opEqStr: case opNeStr:
+      case opAnd: case opOr: case opNot:
+        return true;
+      default:
+        return false;
+    }
+}
+
+static bool IsCommutative(int op) {
+    switch (op) {
+      case opAddI: case opMulI: case opEqI: case opNeI: case opAddD: case opMulD:
+      case opEqD: case opNeD: case opEqRef: case opNeRef: case opEqStr: case opNeStr:
+      case opAnd: case opOr:
+        return true;
+      default:
+        return false;
+    }
+}
+
+/* "this" is never null: a method is only called through an object.
+ */
+static bool IsThis(SSAFunction &fn, int reg) {
+    return reg == 0 && fn.f->cls >= 0;
+}
+
+/* Returns whether in can be dropped when its result is not used.
+ */
+static bool IsRemovable(SSAFunction &fn, const Instr &in) {
+    if (!DefinesRegister(in)) return false;
+    if (in.op == opGetField) return IsThis(fn, in.a);
+    return IsPure(in) || in.op == opLoadGlobal || in.op == opNew || in.op == opArrayLoadUnchecked;
+}
+
+static bool IsCall(int op) {
+    return op == opCall || op == opCallVirtual || op == opCallInterface;
+}
+
+/* Struct: Receivers
+ * -----------------
+ * What is known of the objects in the registers of a function: those
+ * made by a New in it, directly or through copies, are instances of its
+ * class, and they and "this" are never null. Registers added after it
+ * was made are not known.
+ */
+struct Receivers {
+    std::vector<int> created;    // class, -1 if unknown
+    int self;                    // "this", -1 in a global function
+
+    Receivers(SSAFunction &fn);
+    int Class(int reg) const { return reg < (int)created.size() ? created[reg] : -1; }
+    bool NonNull(int reg) const { return reg == self || Class(reg) >= 0; }
+};
+
+Receivers::Receivers(SSAFunction &fn) : created(fn.f->regTypes.size(), -1) {
+    self = fn.f->cls >= 0 ? 0 : -1;
+    for (size_t i = 0; i < fn.rpo.size(); i++) {
+        std::vector<Instr> &code = fn.blocks[fn.rpo[i]].code;
+        for (size_t j = 0; j < code.size(); j++) {
+            if (code[j].op == opNew) created[code[j].dst] = code[j].a;
+            if (code[j].op == opMove) created[code[j].dst] = created[code[j].a];
+        }
+    }
+}
+
+/* Class: CallGraph
+ * ----------------
+ * The functions each function calls, directly or through a method with
+ * one implementation for all the classes the receiver can be. Those are
+ * found by rapid type analysis (Bacon and Sweeney): the module is the
+ * whole program, so the receiver is an instance of a class that some New
+ * creates and that is the class or interface the call names the method
+ * through or below it. The functions are put in order by Tarjan's
+ * algorithm, which finds the strongly connected components callees
+ * first, so a function is optimized after what it calls, except for the
+ * calls within a recursive cycle.
+ */
+class CallGraph
+{
+  protected:
+    Module *module;
+    std::vector<bool> created;   // by some New, for each class
+
+    int Implementation(int cls, const Instr &in);
+
+  public:
+    std::vector<int> order;      // callees first
+    std::vector<int> component;  // of each function
+    std::vector<bool> done;      // optimized and written back
+
+    CallGraph(Module *module);
+    int Target(const Instr &in, int cls = -1);
+};
+
+CallGraph::CallGraph(Module *m) : module(m) {
+    int n = module->functions.size(), counter = 0;
+    std::vector<std::vector<int> > callees(n);
+    created.assign(module->classes.size(), false);
+    for (int i = 0; i < n; i++) {
+        const std::vector<Instr> &code = module->functions[i].code;
+        for (size_t j = 0; j < code.size(); j++)
+            if (code[j].op == opNew) created[code[j].a] = true;
+    }
+    for (int i = 0; i < n; i++) {
+        const std::vector<Instr> &code = module->functions[i].code;
+        for (size_t j = 0; j < code.size(); j++) {
+            int target = IsCall(code[j].op) ? Target(code[j]) : -1;
+            if (target >= 0) callees[i].push_back(target);
+        }
+    }
+    std::vector<int> index(n, -1), low(n), stack;
+    std::vector<bool> onStack(n);
+    component.assign(n, -1);
+    done.assign(n, false);
+    std::function<void(int)> visit = [&](int v) {
+        index[v] = low[v] = counter++;
+        stack.push_back(v);
+        onStack[v] = true;
+        for (size_t i = 0; i < callees[v].size(); i++) {
+            int w = callees[v][i];
+            if (index[w] < 0) {
+                visit(w);
+                low[v] = std::min(low[v], low[w]);
+            } else if (onStack[w]) {
+                low[v] = std::min(low[v], index[w]);
+            }
+        }
+        if (low[v] != index[v]) return;
+        int w;
+        do {
+            w = stack.back();
+            stack.pop_back();
+            onStack[w] = false;
+            component[w] = v;
+            order.push_back(w);
+        } while (w != v);
+    };
+    for (int i = 0; i < n; i++)
+        if (index[i] < 0) visit(i);
+}
+
+/* Method: Implementation
+ * -----------------------
+ * Returns the function that runs for the call in on an instance of
+ * class cls, -1 if cls is not below the class or interface it names.
+ */
+int CallGraph::Implementation(int cls, const Instr &in) {
+    const Member &method = module->members[in.a];
+    const ClassInfo &info = module->classes[cls];
+    if (in.op == opCallInterface) {
+        for (size_t i = 0; i < info.itables.size(); i++)
+            if (info.itables[i].interface == method.cls) return info.itables[i].functions[module->FindSlot(method)];
+        return -1;
+    }
+    int base = cls;
+    while (base >= 0 && base != method.cls) base = module->classes[base].base;
+    return base >= 0 ? info.vtable[module->FindSlot(method)] : -1;
+}
+
+/* Method: Target
+ * --------------
+ * Returns the function a call runs, -1 if that depends on the receiver
+ * or no class the receiver could be is ever created. cls is the class
+ * of the receiver, if known.
+ */
+int CallGraph::Target(const Instr &in, int cls) {
+    if (in.op == opCall) return in.a;
+    if (cls >= 0) return Implementation(cls, in);
+    int target = -1;
+    for (size_t c = 0; c < module->classes.size(); c++) {
+        int f = created[c] ? Implementation(c, in) : -1;
+        if (f < 0 || f == target) continue;
+        if (target >= 0) return -1;
+        target = f;
+    }
+    return target;
+}
+
+/* Class: Inliner
+ * --------------
+ * Replaces calls whose target the call graph knows with a copy of the
+ * target's body, once that has been optimized and if it is small:
+ * --inline-size instructions at most (20 by default, not counting
+ * jumps), and no more than MaxGrowth instructions added to one caller
+ * in all. A call within a recursive cycle is left alone, so inlining
+ * never unrolls recursion. The calls in the copies are not looked at
+ * again: their targets had their chance when the callee was optimized.
+ *
+ * The callee is put into SSA form on its own and its blocks are added
+ * to the caller's, its registers renamed to new ones and its parameters
+ * to the call's arguments. The call's block is split at the call; the
+ * first half jumps to the callee's entry and each Return jumps to the
+ * second half, whose phi (or copy, for one Return) gives the result.
+ * Where a jump is then the only way into a block the two are joined, so
+ * a straight-line callee ends up in the block of the call. A method
+ * has its receiver checked for null first, unless it cannot be.
+ */
+class Inliner
+{
+  protected:
+    static const int MaxGrowth = 500;
+    SSAFunction &fn;
+    CallGraph &graph;
+    int self, maxSize, budget;
+    Receivers receivers;
+
+    int Size(int function);
+    void Join(int from, int to);
+    bool Inline(int b, int j, int target);
+
+  public:
+    Inliner(SSAFunction &fn, CallGraph &graph);
+    int Run();
+};
+
+Inliner::Inliner(SSAFunction &fn, CallGraph &graph) : fn(fn), graph(graph), budget(MaxGrowth), receivers(fn) {
+    self = fn.f - fn.module->functions.data();
+    const char *size = GetOption("inline-size");
+    maxSize = (size && atoi(size) > 0) ? atoi(size) : 20;
+}
+
+int Inliner::Size(int function) {
+    const std::vector<Instr> &code = fn.module->functions[function].code;
+    int size = 0;
+    for (size_t j = 0; j < code.size(); j++)
+        if (code[j].op != opJump) size++;
+    return size;
+}
+
+/* Method: Join
+ * ------------
+ * Moves the code of block to onto the end of block from, if from jumps
+ * there and is its only predecessor.
+ */
+void Inliner::Join(int from, int to) {
+    SSABlock &first = fn.blocks[from], &second = fn.blocks[to];
+    if (second.preds.size() != 1 || first.code.back().op != opJump || first.code.back().a != to) return;
+    first.code.pop_back();
+    first.code.insert(first.code.end(), second.code.begin(), second.code.end());
+    second.code.clear();
+    second.preds.clear();
+    std::vector<int> succs = fn.Succs(from);
+    for (size_t s = 0; s < succs.size(); s++)
+        std::replace(fn.blocks[succs[s]].preds.begin(), fn.blocks[succs[s]].preds.end(), to, from);
+}
+
+/* Method: Inline
+ * --------------
+ * Inlines the call at code[j] of block b, unless the callee's entry is
+ * also the head of a loop, which would need phis at the entry.
+ */
+bool Inliner::Inline(int b, int j, int target) {
+    Function copy = fn.module->functions[target];
+    SSAFunction callee(fn.module, &copy);
+    if (!callee.blocks[0].preds.empty()) return false;
+    Instr call = fn.blocks[b].code[j];
+    int base = fn.blocks.size(), rest = base + callee.blocks.size();
+    std::vector<int> regs(copy.regTypes.size(), -1);
+    for (int p = 0; p < copy.numParams; p++) regs[p] = fn.f->args[call.b + p];
+    std::function<void(int &)> rename = [&](int &r) {
+        if (regs[r] < 0) regs[r] = fn.NewReg((valueTypeT)copy.regTypes[r]);
+        r = regs[r];
+    };
+
+    fn.blocks.resize(rest + 1);
+    for (int k = base; k <= rest; k++) fn.blocks[k].idom = fn.blocks[k].after = -1;
+    SSABlock &first = fn.blocks[b];
+    fn.blocks[rest].code.assign(first.code.begin() + j + 1, first.code.end());
+    std::vector<int> succs = fn.Succs(rest);
+    for (size_t s = 0; s < succs.size(); s++)
+        std::replace(fn.blocks[succs[s]].preds.begin(), fn.blocks[succs[s]].preds.end(), b, rest);
+    first.code.resize(j);
+    bool check = call.op != opCall && !receivers.NonNull(regs[0]);
+    if (check) {
+        Instr in = { opCheckNull, -1, regs[0], 0, 0, call.line };
+        first.code.push_back(in);
+    }
+    Instr jump = { opJump, -1, base, 0, 0, call.line };
+    first.code.push_back(jump);
+
+    std::vector<int> results;
+    int after = b;
+    for (size_t i = 0; i < callee.rpo.size(); i++) {
+        int k = callee.rpo[i];
+        SSABlock &block = fn.blocks[base + k];
+        block = callee.blocks[k];
+        block.after = after;
+        after = base + k;
+        for (size_t p = 0; p < block.preds.size(); p++) block.preds[p] += base;
+        if (k == 0) block.preds.push_back(b);
+        for (size_t p = 0; p < block.phis.size(); p++) {
+            rename(block.phis[p].dst);
+            for (size_t a = 0; a < block.phis[p].args.size(); a++) rename(block.phis[p].args[a]);
+        }
+        for (size_t c = 0; c < block.code.size(); c++) {
+            Instr &in = block.code[c];
+            callee.ForEachUse(in, rename);
+            if (DefinesRegister(in)) rename(in.dst);
+            if (OpOperands(in.op)[2] == 'n') {
+                int start = fn.f->args.size();
+                fn.f->args.insert(fn.f->args.end(), copy.args.begin() + in.b, copy.args.begin() + in.b + in.c);
+                in.b = start;
+            }
+            if (in.op == opJump) in.a += base;
+            if (in.op == opBranch) {
+                in.b += base;
+                in.c += base;
+            }
+            if (in.op == opReturn) {
+                if (call.dst >= 0) results.push_back(in.a);
+                in.op = opJump;
+                in.a = rest;
+                fn.blocks[rest].preds.push_back(base + k);
+            }
+        }
+    }
+    fn.blocks[rest].after = after;
+    if (results.size() == 1) {
+        Instr move = { opMove, call.dst, results[0], 0, 0, call.line };
+        fn.blocks[rest].code.insert(fn.blocks[rest].code.begin(), move);
+    } else if (results.size() > 1) {
+        Phi phi = { call.dst, call.dst, results };
+        fn.blocks[rest].phis.push_back(phi);
+    }
+    Join(b, base);
+    if (fn.blocks[rest].preds.size() == 1) Join(fn.blocks[rest].preds[0], rest);
+    if (check) {                             // a field access may check the receiver as well
+        std::vector<Instr> &code = fn.blocks[b].code;
+        size_t k = j + 1;
+        while (k < code.size() && IsPure(code[k])) k++;
+        if (k < code.size() && (code[k].op == opGetField || code[k].op == opSetField) && code[k].a == regs[0])
+            code.erase(code.begin() + j);
+    }
+    return true;
+}
+
+/* Method: Run
+ * ------------
+ * Looks at the calls of each block from the last back, since inlining
+ * one changes only what comes after it.
+ */
+int Inliner::Run() {
+    int changes = 0;
+    std::vector<int> blocks = fn.rpo;
+    for (size_t i = 0; i < blocks.size(); i++) {
+        int b = blocks[i];
+        for (int j = fn.blocks[b].code.size() - 1; j >= 0; j--) {
+            const Instr &in = fn.blocks[b].code[j];
+            int target = IsCall(in.op) ? graph.Target(in, in.op == opCall ? -1 : receivers.Class(fn.f->args[in.b])) : -1;
+            if (target < 0 || !graph.done[target] || graph.component[target] == graph.component[self]) continue;
+            int size = Size(target);
+            if (size > maxSize || size > budget || !Inline(b, j, target)) continue;
+            budget -= size;
+            changes++;
+        }
+    }
+    if (changes) fn.Analyze();
+    return changes;
+}
+
+/* Class: Devirtualizer
+ * --------------------
+ * Turns a call through a class or interface into a Call when the call
+ * graph knows its target, after a CheckNull of the receiver unless that
+ * cannot be null. This saves the vtable load, or the search for the
+ * itable, of the calls left after inlining. The checks inlining copied
+ * in for receivers that cannot be null go too.
+ */
+class Devirtualizer
+{
+  protected:
+    SSAFunction &fn;
+    CallGraph &graph;
+
+  public:
+    Devirtualizer(SSAFunction &fn, CallGraph &graph) : fn(fn), graph(graph) {}
+    int Run();
+};
+
+int Devirtualizer::Run() {
+    int changes = 0;
+    Receivers receivers(fn);
+    for (size_t i = 0; i < fn.rpo.size(); i++) {
+        std::vector<Instr> &code = fn.blocks[fn.rpo[i]].code, direct;
+        for (size_t j = 0; j < code.size(); j++) {
+            Instr in = code[j];
+            if (in.op == opCheckNull && receivers.NonNull(in.a)) {
+                changes++;
+                continue;
+            }
+            int receiver = in.op == opCallVirtual || in.op == opCallInterface ? fn.f->args[in.b] : -1;
+            int target = receiver >= 0 ? graph.Target(in, receivers.Class(receiver)) : -1;
+            if (target >= 0) {
+                Instr check = { opCheckNull, -1, receiver, 0, 0, in.line };
+                if (!receivers.NonNull(receiver)) direct.push_back(check);
+                in.op = opCall;
+                in.a = target;
+                changes++;
+            }
+            direct.push_back(in);
+        }
+        code.swap(direct);
+    }
+    return changes;
+}
+
+/* Class: SCCP
+ * -----------
+ * Sparse conditional constant propagation. Each int and bool register
+ * starts out unknown (top) and is lowered to a constant or to varying
+ * (bottom) as the blocks that assign it are found reachable; a phi only
+ * merges the values coming over edges found executable so far.
+ */
+class SCCP
+{
+  protected:
+    enum { kTop, kConstant, kBottom };
+    struct Value {
+        int state, value;
+    };
+    SSAFunction &fn;
+    std::vector<Value> values;
+    std::vector<std::vector<std::pair<int, int> > > uses; // block, instruction or ~phi
+    std::vector<bool> reached;
+    std::set<std::pair<int, int> > edges;
+    std::vector<std::pair<int, int> > edgeWork;
+    std::vector<int> regWork;
+
+    void Lower(int reg, Value v);
+    Value Meet(Value a, Value b);
+    Value Evaluate(const Instr &in);
+    void AddEdge(int from, int to);
+    void VisitPhi(int b, Phi &phi);
+    void VisitInstr(int b, Instr &in);
+    void Reach(int b);
+
+  public:
+    SCCP(SSAFunction &fn);
+    int Run();
+};
+
+SCCP::SCCP(SSAFunction &f) : fn(f) {
+    int regs = fn.f->regTypes.size();
+    Value top = { kTop, 0 }, bottom = { kBottom, 0 };
+    values.assign(regs, top);
+    for (int p = 0; p < fn.f->numParams; p++) values[p] = bottom;
+    uses.resize(regs);
+    reached.assign(fn.blocks.size(), false);
+    for (size_t i = 0; i < fn.rpo.size(); i++) {
+        int b = fn.rpo[i];
+        SSABlock &block = fn.blocks[b];
+        for (size_t j = 0; j < block.phis.size(); j++)
+            for (size_t k = 0; k < block.phis[j].args.size(); k++)
+                uses[block.phis[j].args[k]].push_back(std::make_pair(b, ~(int)j));
+        for (size_t j = 0; j < block.code.size(); j++)
+            fn.ForEachUse(block.code[j], [&](int &r) { uses[r].push_back(std::make_pair(b, (int)j)); });
+    }
+}
+
+SCCP::Value SCCP::Meet(Value a, Value b) {
+    if (a.state == kTop) return b;
+    if (b.state == kTop) return a;
+    if (a.state == kConstant && b.state == kConstant && a.value == b.value) return a;
+    Value bottom = { kBottom, 0 };
+    return bottom;
+}
+
+void SCCP::Lower(int reg, Value v) {
+    Value old = values[reg];
+    if (v.state == old.state && (v.state != kConstant || v.value == old.value)) return;
+    if (v.state < old.state) return;
+    if (v.state == kConstant && old.state == kConstant) v.state = kBottom;
+    values[reg] = v;
+    regWork.push_back(reg);
+}
+
+/* Method: Evaluate
+ * ----------------
+ * Computes the value in assigns from the values of its operands. The
+ * arithmetic wraps around as in the VM; a division that would fail is
+ * left for run time.
+ */
+SCCP::Value SCCP::Evaluate(const Instr &in) {
+    Value result = { kBottom, 0 };
+    valueTypeT type = (valueTypeT)fn.f->regTypes[in.dst];
+    if (type != vInt && type != vBool) return result;
+    if (in.op == opLoadInt) {
+        result.state = kConstant;
+        result.value = in.a;
+        return result;
+    }
+    if (!IsPure(in) && in.op != opDivI && in.op != opModI) return result;
+    const char *operands = OpOperands(in.op);
+    Value x = { kConstant, 0 }, y = { kConstant, 0 };
+    if (operands[1] == 'r') x = values[in.a];
+    if (operands[2] == 'r') y = values[in.b];
+    if (x.state == kBottom || y.state == kBottom) return result;
+    if (x.state == kTop || y.state == kTop) {
+        result.state = kTop;
+        return result;
+    }
+    unsigned a = x.value, b = y.value;
+    int value;
+    switch (in.op) {
+      case opMove: value = x.value; break;
+      case opAddI: value = (int)(a + b); break;
+      case opSubI: value = (int)(a - b); break;
+      case opMulI: value = (int)(a * b); break;
+      case opNegI: value = (int)(0u - a); break;
+      case opDivI:
+      case opModI:
+        if (y.value == 0 || (x.value == INT_MIN && y.value == -1)) return result;
+        value = in.op == opDivI ? x.value / y.value : x.value % y.value;
+        break;
+      case opLtI: value = x.value < y.value; break;
+      case opLeI: value = x.value <= y.value; break;
+      case opGtI: value = x.value > y.value; break;
+      case opGeI: value = x.value >= y.value; break;
+      case opEqI: value = x.value == y.value; break;
+      case opNeI: value = x.value != y.value; break;
+      case opAnd: value = x.value && y.value; break;
+      case opOr: value = x.value || y.value; break;
+      case opNot: value = !x.value; break;
+      default: return result;
+    }
+    result.state = kConstant;
+    result.value = value;
+    return result;
+}
+
+void SCCP::AddEdge(int from, int to) {
+    if (edges.insert(std::make_pair(from, to)).second)
+        edgeWork.push_back(std::make_pair(from, to));
+}
+
+void SCCP::VisitPhi(int b, Phi &phi) {
+    Value v = { kTop, 0 };
+    std::vector<int> &preds = fn.blocks[b].preds;
+    for (size_t j = 0; j < preds.size(); j++)
+        if (edges.count(std::make_pair(preds[j], b))) v = Meet(v, values[phi.args[j]]);
+    Lower(phi.dst, v);
+}
+
+void SCCP::VisitInstr(int b, Instr &in) {
+    if (in.op == opJump) {
+        AddEdge(b, in.a);
+    } else if (in.op == opBranch) {
+        Value test = values[in.a];
+        if (test.state == kTop) return;
+        if (test.state == kBottom || test.value) AddEdge(b, in.b);
+        if (test.state == kBottom || !test.value) AddEdge(b, in.c);
+    } else if (DefinesRegister(in)) {
+        Lower(in.dst, Evaluate(in));
+    }
+}
+
+void SCCP::Reach(int b) {
+    SSABlock &block = fn.blocks[b];
+    if (!reached[b]) {
+        reached[b] = true;
+        for (size_t i = 0; i < block.code.size(); i++)
+            VisitInstr(b, block.code[i]);
+    }
+    for (size_t i = 0; i < block.phis.size(); i++)
+        VisitPhi(b, block.phis[i]);
+}
+
+/* Method: Run
+ * -----------
+ * Propagates, then rewrites: registers found constant are loaded as
+ * constants and branches on a constant become jumps. The blocks never
+ * reached lose their last edges and are removed by Analyze.
+ */
+int SCCP::Run() {
+    Reach(0);
+    while (!edgeWork.empty() || !regWork.empty()) {
+        if (!edgeWork.empty()) {
+            int b = edgeWork.back().second;
+            edgeWork.pop_back();
+            Reach(b);
+            continue;
+        }
+        int reg = regWork.back();
+        regWork.pop_back();
+        for (size_t i = 0; i < uses[reg].size(); i++) {
+            int b = uses[reg][i].first, j = uses[reg][i].second;
+            if (!reached[b]) continue;
+            if (j < 0) VisitPhi(b, fn.blocks[b].phis[~j]);
+            else VisitInstr(b, fn.blocks[b].code[j]);
+        }
+    }
+
+    int changes = 0;
+    std::vector<int> rpo = fn.rpo;
+    for (size_t i = 0; i < rpo.size(); i++) {
+        int b = rpo[i];
+        if (!reached[b]) continue;
+        SSABlock &block = fn.blocks[b];
+        std::vector<Instr> constants;
+        for (size_t j = 0; j < block.phis.size(); ) {
+            Value v = values[block.phis[j].dst];
+            if (v.state != kConstant) {
+                j++;
+                continue;
+            }
+            Instr load = { opLoadInt, block.phis[j].dst, v.value, 0, 0, block.code[0].line };
+            constants.push_back(load);
+            block.phis.erase(block.phis.begin() + j);
+            changes++;
+        }
+        for (size_t j = 0; j < block.code.size(); j++) {
+            Instr &in = block.code[j];
+            if (DefinesRegister(in) && in.op != opLoadInt && values[in.dst].state == kConstant) {
+                Instr load = { opLoadInt, in.dst, values[in.dst].value, 0, 0, in.line };
+                in = load;
+                changes++;
+            }
+        }
+        Instr &last = block.code.back();
+        if (last.op == opBranch && values[last.a].state == kConstant) {
+            int taken = values[last.a].value ? last.b : last.c;
+            fn.RemoveEdge(b, taken == last.b ? last.c : last.b);
+            last.op = opJump;
+            last.a = taken;
+            changes++;
+        }
+        block.code.insert(block.code.begin(), constants.begin(), constants.end());
+    }
+    fn.Analyze();
+    return changes;
+}
+
+/* Class: GVN
+ * ----------
+ * Global value numbering: walks the dominator tree keeping a table of
+ * the pure operations available, keyed by opcode, operands and result
+ * type. An operation already in the table, a copy and a phi whose
+ * arguments are all the same register are replaced by the register
+ * they equal, and every use is renamed to match.
+ */
+class GVN
+{
+  protected:
+    typedef std::tuple<int, int, int, int, int> Key;
+    SSAFunction &fn;
+    std::vector<int> same;         // register each register was found equal to
+    std::map<Key, int> available;
+    int changes;
+
+    int Find(int reg);
+    Key KeyOf(const Instr &in);
+    void Visit(int b);
+
+  public:
+    GVN(SSAFunction &fn) : fn(fn), changes(0) {}
+    int Run();
+};
+
+int GVN::Find(int reg) {
+    while (same[reg] != reg) reg = same[reg];
+    return reg;
+}
+
+/* Method: KeyOf
+ * -------------
+ * Commutative operations list their operands in order, and a > or >=
+ * comparison is written as the < or <= with the operands swapped.
+ */
+GVN::Key GVN::KeyOf(const Instr &in) {
+    int op = in.op, a = in.a, b = in.b;
+    switch (op) {
+      case opGtI: op = opLtI; std::swap(a, b); break;
+      case opGeI: op = opLeI; std::swap(a, b); break;
+      case opGtD: op = opLtD; std::swap(a, b); break;
+      case opGeD: op = opLeD; std::swap(a, b); break;
+    }
+    if (IsCommutative(op) && a > b) std::swap(a, b);
+    return Key(op, a, b, in.c, fn.f->regTypes[in.dst]);
+}
+
+void GVN::Visit(int b) {
+    SSABlock &block = fn.blocks[b];
+    std::vector<Key> added;
+    for (size_t i = 0; i < block.phis.size(); ) {
+        Phi &phi = block.phis[i];
+        int value = -1;
+        bool equal = true;
+        for (size_t j = 0; j < phi.args.size(); j++) {
+            int arg = Find(phi.args[j]);
+            if (arg == phi.dst) continue;
+            if (value >= 0 && arg != value) equal = false;
+            value = arg;
+        }
+        if (!equal || value < 0) {
+            i++;
+            continue;
+        }
+        same[phi.dst] = value;
+        block.phis.erase(block.phis.begin() + i);
+        changes++;
+    }
+    for (size_t i = 0; i < block.code.size(); i++) {
+        Instr &in = block.code[i];
+        fn.ForEachUse(in, [&](int &r) { r = Find(r); });
+        if (!DefinesRegister(in) || !IsPure(in)) continue;
+        if (in.op == opMove) {
+            same[in.dst] = in.a;
+            in.op = opNop;
+            changes++;
+            continue;
+        }
+        Key key = KeyOf(in);
+        std::map<Key, int>::iterator it = available.find(key);
+        if (it != available.end()) {
+            same[in.dst] = it->second;
+            in.op = opNop;
+            changes++;
+        } else {
+            available[key] = in.dst;
+            added.push_back(key);
+        }
+    }
+    for (size_t i = 0; i < block.children.size(); i++)
+        Visit(block.children[i]);
+    for (size_t i = 0; i < added.size(); i++)
+        available.erase(added[i]);
+}
+
+int GVN::Run() {
+    same.resize(fn.f->regTypes.size());
+    for (size_t r = 0; r < same.size(); r++) same[r] = r;
+    Visit(0);
+    for (size_t i = 0; i < fn.rpo.size(); i++) {
+        SSABlock &block = fn.blocks[fn.rpo[i]];
+        for (size_t j = 0; j < block.phis.size(); j++)
+            for (size_t k = 0; k < block.phis[j].args.size(); k++)
+                block.phis[j].args[k] = Find(block.phis[j].args[k]);
+        std::vector<Instr> code;
+        for (size_t j = 0; j < block.code.size(); j++) {
+            if (block.code[j].op == opNop) continue;
+            code.push_back(block.code[j]);
+            fn.ForEachUse(code.back(), [&](int &r) { r = Find(r); });
+        }
+        block.code.swap(code);
+    }
+    return changes;
+}
+
+/* Class: LICM
+ * -----------
+ * Loop-invariant code motion. Loops are found from their back edges (an
+ * edge to a block that dominates its source) and handled innermost
+ * first, so what moves out of an inner loop can move on out of the
+ * loops around it.
+ */
+class LICM
+{
+  protected:
+    SSAFunction &fn;
+    int changes;
+
+    int AliasClass(valueTypeT type) { return IsReference(type) ? vObject : type; }
+    void Hoist(int header, const std::vector<bool> &inLoop);
+
+  public:
+    LICM(SSAFunction &fn) : fn(fn), changes(0) {}
+    int Run();
+};
+
+/* Method: Hoist
+ * -------------
+ * Moves the invariant operations of the loop to the end of its one
+ * predecessor outside it, first putting a block on that edge if the
+ * predecessor goes elsewhere as well. An array load only moves if the
+ * loop stores no array element of the same kind of value (arrays of
+ * different element types cannot be the same array), a field read if
+ * the loop stores no field of the same name and a global read if the
+ * loop does not store that global; none moves out of a loop that calls.
+ */
+void LICM::Hoist(int header, const std::vector<bool> &inLoop) {
+    std::vector<int> &preds = fn.blocks[header].preds;
+    int outside = -1;
+    for (size_t i = 0; i < preds.size(); i++) {
+        if (inLoop[preds[i]]) continue;
+        if (outside >= 0) return;
+        outside = preds[i];
+    }
+    if (outside < 0) return;
+
+    Module *module = fn.module;
+    std::vector<bool> defined(fn.f->regTypes.size());
+    std::set<int> arrayStores, globalStores;
+    std::set<std::string> fieldStores;
+    bool calls = false;
+    for (size_t i = 0; i < fn.rpo.size(); i++) {
+        if (!inLoop[fn.rpo[i]]) continue;
+        SSABlock &block = fn.blocks[fn.rpo[i]];
+        for (size_t j = 0; j < block.phis.size(); j++) defined[block.phis[j].dst] = true;
+        for (size_t j = 0; j < block.code.size(); j++) {
+            Instr &in = block.code[j];
+            if (DefinesRegister(in)) defined[in.dst] = true;
+            if (IsCall(in.op) || in.op == opArrayFill || in.op == opArrayCopy) calls = true;
+            if (in.op == opArrayStore || in.op == opArrayStoreUnchecked) arrayStores.insert(AliasClass((valueTypeT)fn.f->regTypes[in.c]));
+            if (in.op == opSetField) fieldStores.insert(module->members[in.b].name);
+            if (in.op == opStoreGlobal) globalStores.insert(in.a);
+        }
+    }
+
+    std::vector<Instr> hoisted;
+    bool blocked = false;        // something in the header before can fail or has an effect
+    for (size_t i = 0; i < fn.rpo.size(); i++) {
+        int b = fn.rpo[i];
+        if (!inLoop[b]) continue;
+        bool first = b == header;
+        std::vector<Instr> code;
+        for (size_t j = 0; j < fn.blocks[b].code.size(); j++) {
+            Instr &in = fn.blocks[b].code[j];
+            bool invariant = DefinesRegister(in);
+            fn.ForEachUse(in, [&](int &r) { if (defined[r]) invariant = false; });
+            bool safe = first && !blocked, move = false;
+            if (invariant) {
+                switch (in.op) {
+                  case opLoadGlobal:
+                    move = !calls && !globalStores.count(in.a);
+                    break;
+                  case opGetField:
+                    move = (safe || IsThis(fn, in.a)) && !calls &&
+                           !fieldStores.count(module->members[in.b].name);
+                    break;
+                  case opArrayLoad:
+                    move = safe && !calls && !arrayStores.count(AliasClass((valueTypeT)fn.f->regTypes[in.dst]));
+                    break;
+                  case opArrayLength: case opDivI: case opModI:
+                    move = safe;
+                    break;
+                  default:
+                    move = IsPure(in);
+                }
+            }
+            if (move) {
+                hoisted.push_back(in);
+                defined[in.dst] = false;
+                changes++;
+                continue;
+            }
+            if (first && !IsRemovable(fn, in)) blocked = true;
+            code.push_back(in);
+        }
+        fn.blocks[b].code.swap(code);
+    }
+    if (hoisted.empty()) return;
+    if (fn.Succs(outside).size() > 1) outside = fn.SplitEdge(outside, header);
+    std::vector<Instr> &code = fn.blocks[outside].code;
+    code.insert(code.end() - 1, hoisted.begin(), hoisted.end());
+}
+
+int LICM::Run() {
+    std::set<int> done;
+    for (;;) {
+        int header = -1, size = 0;
+        std::vector<bool> loop;
+        for (size_t i = 0; i < fn.rpo.size(); i++) {
+            int h = fn.rpo[i];
+            if (done.count(h)) continue;
+            std::vector<bool> inLoop(fn.blocks.size());
+            std::vector<int> work;
+            inLoop[h] = true;
+            for (size_t p = 0; p < fn.blocks[h].preds.size(); p++) {
+                int latch = fn.blocks[h].preds[p];
+                if (fn.Dominates(h, latch) && !inLoop[latch]) {
+                    inLoop[latch] = true;
+                    work.push_back(latch);
+                }
+            }
+            bool isLoop = !work.empty() || std::count(fn.blocks[h].preds.begin(), fn.blocks[h].preds.end(), h);
+            if (!isLoop) continue;
+            int count = 1;
+            while (!work.empty()) {
+                int b = work.back();
+                work.pop_back();
+                count++;
+                for (size_t p = 0; p < fn.blocks[b].preds.size(); p++) {
+                    int pred = fn.blocks[b].preds[p];
+                    if (inLoop[pred]) continue;
+                    inLoop[pred] = true;
+                    work.push_back(pred);
+                }
+            }
+            if (header < 0 || count < size) {
+                header = h;
+                size = count;
+                loop.swap(inLoop);
+            }
+        }
+        if (header < 0) break;
+        done.insert(header);
+        Hoist(header, loop);
+        fn.Analyze();
+    }
+    return changes;
+}
+
+/* Class: Facts
+ * ------------
+ * What the passes below know about the registers of a function in SSA
+ * form: where each is assigned and what the branches taken on the way
+ * to a block say about the int registers they compare.
+ */
+class Facts
+{
+  protected:
+    struct Relation {
+        int less, more;          // registers with less < more, or <= if orEqual
+        bool orEqual;
+    };
+    SSAFunction &fn;
+    std::vector<std::pair<int, int> > defs; // block or -1 for a parameter, instruction or ~phi
+
+    Facts(SSAFunction &fn) : fn(fn) { FindDefs(); }
+    void FindDefs();
+    const Instr *Def(int reg);
+    bool IsConstant(int reg, int &value);
+    bool DefinedAbove(int reg, int b);
+    void Relations(int cond, bool sense, std::vector<Relation> &out, int depth = 0);
+    void EdgeRelations(int from, int to, std::vector<Relation> &out);
+};
+
+void Facts::FindDefs() {
+    defs.assign(fn.f->regTypes.size(), std::make_pair(-1, 0));
+    for (size_t i = 0; i < fn.rpo.size(); i++) {
+        int b = fn.rpo[i];
+        for (size_t j = 0; j < fn.blocks[b].phis.size(); j++)
+            defs[fn.blocks[b].phis[j].dst] = std::make_pair(b, ~(int)j);
+        for (size_t j = 0; j < fn.blocks[b].code.size(); j++)
+            if (DefinesRegister(fn.blocks[b].code[j])) defs[fn.blocks[b].code[j].dst] = std::make_pair(b, (int)j);
+    }
+}
+
+const Instr *Facts::Def(int reg) {
+    std::pair<int, int> def = defs[reg];
+    if (def.first < 0 || def.second < 0) return NULL;
+    return &fn.blocks[def.first].code[def.second];
+}
+
+bool Facts::IsConstant(int reg, int &value) {
+    const Instr *in = Def(reg);
+    if (!in || in->op != opLoadInt) return false;
+    value = in->a;
+    return true;
+}
+
+/* Method: DefinedAbove
+ * --------------------
+ * Returns whether reg is assigned in a block that strictly dominates b,
+ * so it keeps its value from entering b until leaving the part of the
+ * function b dominates.
+ */
+bool Facts::DefinedAbove(int reg, int b) {
+    int db = defs[reg].first;
+    return db < 0 || (db != b && fn.Dominates(db, b));
+}
+
+/* Method: Relations
+ * -----------------
+ * Adds what is known about the int registers cond compares when cond
+ * is sense.
+ */
+void Facts::Relations(int cond, bool sense, std::vector<Relation> &out, int depth) {
+    const Instr *in = Def(cond);
+    if (!in || depth > 8) return;
+    Relation r = { in->a, in->b, false };
+    switch (in->op) {
+      case opLtI: r.orEqual = !sense; if (!sense) std::swap(r.less, r.more); break;
+      case opLeI: r.orEqual = sense; if (!sense) std::swap(r.less, r.more); break;
+      case opGtI: r.orEqual = !sense; if (sense) std::swap(r.less, r.more); break;
+      case opGeI: r.orEqual = sense; if (sense) std::swap(r.less, r.more); break;
+      case opNot:
+        Relations(in->a, !sense, out, depth + 1);
+        return;
+      case opAnd: case opOr:
+        if (sense == (in->op == opAnd)) {
+            Relations(in->a, sense, out, depth + 1);
+            Relations(in->b, sense, out, depth + 1);
+        }
+        return;
+      default:
+        return;
+    }
+    out.push_back(r);
+}
+
+/* Method: EdgeRelations
+ * ---------------------
+ * Adds what the branch at the end of from says on its edge to to.
+ */
+void Facts::EdgeRelations(int from, int to, std::vector<Relation> &out) {
+    const Instr &last = fn.blocks[from].code.back();
+    if (last.op != opBranch || last.b == last.c) return;
+    Relations(last.a, last.b == to, out);
+}
+
+/* Class: TailRecursion
+ * --------------------
+ * Turns a call a function makes to itself just before returning its
+ * result into a jump back to the start, after copying the arguments
+ * into the parameters, so the recursion runs as a loop in constant
+ * stack space. Block 0 keeps only a jump to a new block with its code,
+ * the loop header, so the entry still has no predecessors.
+ *
+ * A return of an int added to or multiplied by such a call is handled
+ * with an accumulator (tail recursion modulo accumulator): the other
+ * operand goes into it and every other return combines its value with
+ * it. Int arithmetic wraps, so reassociating it changes nothing. As the
+ * parameters and the accumulator are assigned more than once, the
+ * function is put into SSA form again afterwards.
+ */
+class TailRecursion
+{
+  protected:
+    SSAFunction &fn;
+    int self;
+
+    int Site(int b, int &op, int &x);
+
+  public:
+    TailRecursion(SSAFunction &fn) : fn(fn), self(fn.f - fn.module->functions.data()) {}
+    int Run();
+};
+
+/* Method: Site
+ * ------------
+ * Returns where the call starts if block b ends by returning the result
+ * of a call to the function itself, -1 if not. op is opNop, or AddI or
+ * MulI if b returns that applied to the result and x.
+ */
+int TailRecursion::Site(int b, int &op, int &x) {
+    const std::vector<Instr> &code = fn.blocks[b].code;
+    int n = code.size();
+    op = opNop;
+    x = -1;
+    if (n < 2 || code[n - 1].op != opReturn) return -1;
+    const Instr &ret = code[n - 1], &last = code[n - 2];
+    if (last.op == opCall && last.a == self && last.dst == ret.a) return n - 2;
+    if (n < 3 || (last.op != opAddI && last.op != opMulI) || last.dst != ret.a) return -1;
+    const Instr &call = code[n - 3];
+    if (call.op != opCall || call.a != self || call.dst < 0) return -1;
+    if (last.a == call.dst && last.b != call.dst) x = last.b;
+    else if (last.b == call.dst && last.a != call.dst) x = last.a;
+    else return -1;
+    op = last.op;
+    return n - 3;
+}
+
+int TailRecursion::Run() {
+    std::vector<int> sites;
+    int accumulate = opNop, op, x;
+    for (size_t i = 0; i < fn.rpo.size(); i++) {
+        if (Site(fn.rpo[i], op, x) < 0 || (op != opNop && accumulate != opNop && op != accumulate)) continue;
+        if (op != opNop) accumulate = op;
+        sites.push_back(fn.rpo[i]);
+    }
+    if (sites.empty()) return 0;
+
+    int header = fn.blocks.size(), line = fn.f->line;
+    fn.blocks.resize(header + 1);
+    SSABlock &entry = fn.blocks[0], &head = fn.blocks[header];
+    head.idom = -1;
+    head.after = 0;
+    head.code.swap(entry.code);
+    std::vector<int> succs = fn.Succs(header);
+    for (size_t s = 0; s < succs.size(); s++)
+        std::replace(fn.blocks[succs[s]].preds.begin(), fn.blocks[succs[s]].preds.end(), 0, header);
+    head.preds.push_back(0);
+    int acc = -1;
+    if (accumulate != opNop) {
+        acc = fn.NewReg(vInt);
+        Instr init = { opLoadInt, acc, accumulate == opAddI ? 0 : 1, 0, 0, line };
+        entry.code.push_back(init);
+    }
+    Instr jump = { opJump, -1, header, 0, 0, line };
+    entry.code.push_back(jump);
+
+    for (size_t i = 0; i < sites.size(); i++) {
+        int b = sites[i] ? sites[i] : header;
+        std::vector<Instr> &code = fn.blocks[b].code;
+        int at = Site(b, op, x);
+        Instr call = code[at];
+        code.resize(at);
+        if (op != opNop) {                     // before the parameters change
+            Instr combine = { op, acc, acc, x, 0, call.line };
+            code.push_back(combine);
+        }
+        std::vector<int> temps;
+        for (int k = 0; k < call.c; k++) {
+            temps.push_back(fn.NewReg((valueTypeT)fn.f->regTypes[k]));
+            Instr copy = { opMove, temps[k], fn.f->args[call.b + k], 0, 0, call.line };
+            code.push_back(copy);
+        }
+        for (int k = 0; k < call.c; k++) {
+            Instr copy = { opMove, k, temps[k], 0, 0, call.line };
+            code.push_back(copy);
+        }
+        jump.a = header;
+        jump.line = call.line;
+        code.push_back(jump);
+        fn.blocks[header].preds.push_back(b);
+    }
+    for (size_t b = 1; acc >= 0 && b < fn.blocks.size(); b++) {
+        std::vector<Instr> &code = fn.blocks[b].code;
+        if (code.empty() || code.back().op != opReturn) continue;
+        Instr ret = code.back();
+        Instr combine = { accumulate, fn.NewReg(vInt), ret.a, acc, 0, ret.line };
+        ret.a = combine.dst;
+        code.back() = combine;
+        code.push_back(ret);
+    }
+    fn.Analyze();
+    fn.Rebuild();
+    return sites.size();
+}
+
+/* Class: Escape
+ * -------------
+ * Escape analysis and scalar replacement. An object made by New, or an
+ * array made by NewArray with a constant size of at most MaxElements,
+ * does not escape the function when its register, and the copies of
+ * it, are only used to read and write its fields, or its elements at
+ * constant indices within it, and its length. Nothing else can then
+ * see it, so each field or element is kept in a register instead: the
+ * allocation zeroes those registers and the accesses become copies,
+ * which later passes fold away. Since the registers are assigned more
+ * than once, the function is put into SSA form again afterwards.
+ * Passing an object to a call makes it escape, but small methods have
+ * been inlined by then.
+ */
+class Escape : protected Facts
+{
+  protected:
+    static const int MaxElements = 8;
+    std::vector<int> root;       // the allocation each register holds, -1 if none
+
+    int Slot(const Instr &in, int alloc);
+    valueTypeT SlotType(int alloc, int slot);
+
+  public:
+    Escape(SSAFunction &fn) : Facts(fn) {}
+    int Run();
+};
+
+/* Method: Slot
+ * ------------
+ * Returns which field or element of allocation alloc in reads or
+ * writes, -1 if that is not known. The fields of an object are numbered
+ * from those of its class up to those of its base classes.
+ */
+int Escape::Slot(const Instr &in, int alloc) {
+    const Instr *def = Def(alloc);
+    if (def->op == opNewArray) {
+        int index, length;
+        IsConstant(def->a, length);
+        return IsConstant(in.b, index) && index >= 0 && index < length ? index : -1;
+    }
+    const Member &member = fn.module->members[in.b];
+    int slot = 0;
+    for (int cls = def->a; cls >= 0; cls = fn.module->classes[cls].base) {
+        const std::vector<Field> &fields = fn.module->classes[cls].fields;
+        for (size_t i = 0; i < fields.size(); i++, slot++)
+            if (fields[i].name == member.name) return slot;
+    }
+    return -1;
+}
+
+valueTypeT Escape::SlotType(int alloc, int slot) {
+    const Instr *def = Def(alloc);
+    if (def->op == opNewArray) return (valueTypeT)def->b;
+    for (int cls = def->a; ; cls = fn.module->classes[cls].base) {
+        const std::vector<Field> &fields = fn.module->classes[cls].fields;
+        if (slot < (int)fields.size()) return fields[slot].type;
+        slot -= fields.size();
+    }
+}
+
+int Escape::Run() {
+    int regs = fn.f->regTypes.size(), length;
+    root.assign(regs, -1);
+    for (size_t i = 0; i < fn.rpo.size(); i++) {
+        std::vector<Instr> &code = fn.blocks[fn.rpo[i]].code;
+        for (size_t j = 0; j < code.size(); j++) {
+            const Instr &in = code[j];
+            if (in.op == opNew) root[in.dst] = in.dst;
+            if (in.op == opNewArray && IsConstant(in.a, length) && length > 0 && length <= MaxElements)
+                root[in.dst] = in.dst;
+            if (in.op == opMove) root[in.dst] = root[in.a];
+        }
+    }
+
+    // Which allocation and which of its slots each instruction uses.
+    std::vector<bool> escapes(regs);
+    std::vector<std::vector<std::pair<int, int> > > uses(fn.blocks.size());
+    std::function<void(int &)> escape = [&](int &r) { if (root[r] >= 0) escapes[root[r]] = true; };
+    for (size_t i = 0; i < fn.rpo.size(); i++) {
+        SSABlock &block = fn.blocks[fn.rpo[i]];
+        for (size_t j = 0; j < block.phis.size(); j++)
+            std::for_each(block.phis[j].args.begin(), block.phis[j].args.end(), escape);
+        for (size_t j = 0; j < block.code.size(); j++) {
+            Instr &in = block.code[j];
+            std::pair<int, int> use(-1, -1);
+            switch (in.op) {
+              case opNew: case opNewArray:
+                use.first = root[in.dst];
+                break;
+              case opMove: case opCheckNull: case opArrayLength:
+                use.first = root[in.a];
+                break;
+              case opGetField: case opArrayLoad: case opArrayLoadUnchecked:
+              case opSetField: case opArrayStore: case opArrayStoreUnchecked:
+                use.first = root[in.a];
+                if (use.first >= 0) use.second = Slot(in, use.first);
+                if (use.first >= 0 && use.second < 0) escape(in.a);
+                if (OpOperands(in.op)[3] == 'r') escape(in.c);
+                break;
+              default:
+                fn.ForEachUse(in, escape);
+                break;
+            }
+            uses[fn.rpo[i]].push_back(use);
+        }
+    }
+
+    int changes = 0;
+    std::vector<std::vector<int> > slots(regs);
+    std::vector<int> lengths(regs);
+    for (int r = 0; r < regs; r++) {
+        if (root[r] != r || escapes[r]) continue;
+        const Instr *def = Def(r);
+        int count = 0;
+        if (def->op == opNewArray) IsConstant(def->a, count);
+        lengths[r] = count;
+        for (int cls = def->op == opNew ? def->a : -1; cls >= 0; cls = fn.module->classes[cls].base)
+            count += fn.module->classes[cls].fields.size();
+        for (int k = 0; k < count; k++) slots[r].push_back(fn.NewReg(SlotType(r, k)));
+        changes++;
+    }
+    if (!changes) return 0;
+
+    for (size_t i = 0; i < fn.rpo.size(); i++) {
+        std::vector<Instr> &code = fn.blocks[fn.rpo[i]].code, kept;
+        for (size_t j = 0; j < code.size(); j++) {
+            Instr in = code[j];
+            int alloc = uses[fn.rpo[i]][j].first, slot = uses[fn.rpo[i]][j].second;
+            if (alloc < 0 || escapes[alloc]) {
+                kept.push_back(in);
+                continue;
+            }
+            switch (in.op) {
+              case opNew: case opNewArray:
+                for (size_t k = 0; k < slots[alloc].size(); k++)
+                    kept.push_back(fn.Zero(slots[alloc][k], in.line));
+                break;
+              case opArrayLength:
+                in.op = opLoadInt;
+                in.a = lengths[alloc];
+                kept.push_back(in);
+                break;
+              case opGetField: case opArrayLoad: case opArrayLoadUnchecked:
+                in.op = opMove;
+                in.a = slots[alloc][slot];
+                kept.push_back(in);
+                break;
+              case opSetField: case opArrayStore: case opArrayStoreUnchecked:
+                in.op = opMove;
+                in.dst = slots[alloc][slot];
+                in.a = in.c;
+                kept.push_back(in);
+                break;
+              default:                         // copies of the allocation and null checks
+                break;
+            }
+        }
+        code.swap(kept);
+    }
+    fn.Rebuild();
+    return changes;
+}
+
+/* Class: BCE
+ * ----------
+ * Bounds-check elimination. An array access needs no check when its
+ * index is known to be at least 0 and below the array's length wherever
+ * it runs. The facts come from the branches taken to get there: on the
+ * true side of i < n, i is below n, and n is no more than the length of
+ * a when it is a.length(), the size a was allocated with or a constant
+ * no larger than that size; a constant is below the constant size an
+ * array was allocated with. A phi is below the length when each of its
+ * arguments is on the edge it comes over, which covers an induction
+ * variable tested both before a loop and at its bottom (see
+ * ForStmt::Emit). An index is at least 0 when a branch says so, when it
+ * is such a constant or length, when it is a phi of such values or when
+ * it adds a constant to one and cannot overflow because it was just
+ * found to be below something. A phi whose arguments are being looked
+ * at is taken to be at least 0 meanwhile: each value it takes was made
+ * from an earlier one.
+ */
+class BCE : protected Facts
+{
+  protected:
+    struct Bound {
+        int array;               // below the length of this array, if >= 0,
+        int limit;               // otherwise below a constant up to limit
+    };
+    std::vector<int> active;     // phis taken to be at least 0
+    int budget;                  // phis left to look at for this access
+
+    bool Accepts(const Bound &bound, int n, int b);
+    bool Below(int x, int b, const Bound &bound);
+    bool BelowOnEdge(int x, int from, int to, const Bound &bound);
+    bool NonNegative(int x, int b);
+    bool NonNegativeOnEdge(int x, int from, int to);
+
+  public:
+    BCE(SSAFunction &fn) : Facts(fn), budget(0) {}
+    int Run();
+};
+
+/* Method: Accepts
+ * ---------------
+ * Returns whether n, as known in block b, is no more than bound allows.
+ */
+bool BCE::Accepts(const Bound &bound, int n, int b) {
+    int value, size;
+    if (bound.array < 0) return IsConstant(n, value) ? value <= bound.limit : bound.limit == INT_MAX;
+    if (!DefinedAbove(bound.array, b)) return false;
+    const Instr *alloc = Def(bound.array), *in = Def(n);
+    if (in && in->op == opArrayLength && in->a == bound.array) return true;
+    if (!alloc || alloc->op != opNewArray) return false;
+    return alloc->a == n || (IsConstant(n, value) && IsConstant(alloc->a, size) && value <= size);
+}
+
+/* Method: Below
+ * -------------
+ * Returns whether x is below what bound allows throughout block b,
+ * going up the dominator tree from b to where x is assigned.
+ */
+bool BCE::Below(int x, int b, const Bound &bound) {
+    int value, size;
+    if (IsConstant(x, value)) {
+        if (bound.array < 0) return value < bound.limit;
+        const Instr *alloc = Def(bound.array);
+        if (alloc && alloc->op == opNewArray && IsConstant(alloc->a, size) && value < size) return true;
+    }
+    for (int d = b; d >= 0; d = fn.blocks[d].idom) {
+        SSABlock &block = fn.blocks[d];
+        if (defs[x].first == d) {
+            if (defs[x].second >= 0 || budget-- <= 0) return false;
+            if (bound.array >= 0 && !DefinedAbove(bound.array, d)) return false;
+            Phi &phi = block.phis[~defs[x].second];
+            for (size_t k = 0; k < phi.args.size(); k++)
+                if (!BelowOnEdge(phi.args[k], block.preds[k], d, bound)) return false;
+            return true;
+        }
+        if (block.preds.size() != 1) continue;
+        std::vector<Relation> relations;
+        EdgeRelations(block.preds[0], d, relations);
+        for (size_t i = 0; i < relations.size(); i++)
+            if (relations[i].less == x && !relations[i].orEqual && Accepts(bound, relations[i].more, d))
+                return true;
+    }
+    return false;
+}
+
+bool BCE::BelowOnEdge(int x, int from, int to, const Bound &bound) {
+    std::vector<Relation> relations;
+    EdgeRelations(from, to, relations);
+    for (size_t i = 0; i < relations.size(); i++)
+        if (relations[i].less == x && !relations[i].orEqual && Accepts(bound, relations[i].more, to))
+            return true;
+    return Below(x, from, bound);
+}
+
+/* Method: NonNegative
+ * -------------------
+ * Returns whether x is at least 0 throughout block b.
+ */
+bool BCE::NonNegative(int x, int b) {
+    int value;
+    if (IsConstant(x, value)) return value >= 0;
+    for (int d = b; d >= 0 && defs[x].first != d; d = fn.blocks[d].idom) {
+        if (fn.blocks[d].preds.size() != 1) continue;
+        std::vector<Relation> relations;
+        EdgeRelations(fn.blocks[d].preds[0], d, relations);
+        for (size_t i = 0; i < relations.size(); i++)
+            if (relations[i].more == x && IsConstant(relations[i].less, value) &&
+                value >= (relations[i].orEqual ? 0 : -1)) return true;
+    }
+
+    std::pair<int, int> def = defs[x];
+    if (def.first < 0) return false;
+    if (def.second < 0) {
+        if (std::count(active.begin(), active.end(), x)) return true;
+        if (budget-- <= 0) return false;
+        SSABlock &block = fn.blocks[def.first];
+        std::vector<int> &args = block.phis[~def.second].args;
+        active.push_back(x);
+        bool all = true;
+        for (size_t k = 0; k < args.size() && all; k++)
+            all = NonNegativeOnEdge(args[k], block.preds[k], def.first);
+        active.pop_back();
+        return all;
+    }
+    const Instr &in = *Def(x);
+    switch (in.op) {
+      case opArrayLength:
+        return true;
+      case opMove:
+        return NonNegative(in.a, b);
+      case opAddI: {
+        int y = in.a;
+        if (!IsConstant(in.b, value)) {
+            if (!IsConstant(in.a, value)) return false;
+            y = in.b;
+        }
+        if (value < 0 || !NonNegative(y, def.first)) return false;
+        Bound noOverflow = { -1, INT_MAX - value + 1 };
+        return value == 0 || Below(y, def.first, noOverflow);
+      }
+      default:
+        return false;
+    }
+}
+
+bool BCE::NonNegativeOnEdge(int x, int from, int to) {
+    int value;
+    std::vector<Relation> relations;
+    EdgeRelations(from, to, relations);
+    for (size_t i = 0; i < relations.size(); i++)
+        if (relations[i].more == x && IsConstant(relations[i].less, value) &&
+            value >= (relations[i].orEqual ? 0 : -1)) return true;
+    return NonNegative(x, from);
+}
+
+int BCE::Run() {
+    int changes = 0;
+    for (size_t i = 0; i < fn.rpo.size(); i++) {
+        int b = fn.rpo[i];
+        for (size_t j = 0; j < fn.blocks[b].code.size(); j++) {
+            Instr &in = fn.blocks[b].code[j];
+            if (in.op != opArrayLoad && in.op != opArrayStore) continue;
+            Bound length = { in.a, 0 };
+            budget = 32;
+            if (!Below(in.b, b, length) || !NonNegative(in.b, b)) continue;
+            in.op = in.op == opArrayLoad ? opArrayLoadUnchecked : opArrayStoreUnchecked;
+            changes++;
+        }
+    }
+    return changes;
+}
+
+/* Class: Idioms
+ * -------------
+ * Replaces a loop that only fills, copies or sums the elements of arrays
+ * by one bulk instruction (see tac.h), which the VM and the native
+ * runtime run with SIMD kernels. The loop must be one block, as
+ * ForStmt::Emit lowers a loop without branches in its body: a phi i
+ * starting at i0, the body, then i + 1 and a test of it against n that
+ * branches back to the top. n and the arrays must be defined before the
+ * loop, and the test before the loop must show i0 < n, so that the loop
+ * runs over exactly [i0, n). Of what the loop computes only the next i
+ * and the sum may be used after it; they become n and the bulk sum.
+ */
+class Idioms : protected Facts
+{
+  protected:
+    bool SameValue(int a, int b);
+    bool Entered(int i0, int n, int from, int to);
+    bool UsedOutside(int b, const std::vector<int> &except);
+    bool Replace(int b);
+
+  public:
+    Idioms(SSAFunction &fn) : Facts(fn) {}
+    int Run();
+};
+
+/* Method: SameValue
+ * -----------------
+ * Returns whether a and b are known to hold the same int: the same
+ * register, the same constant or the length of the same array.
+ */
+bool Idioms::SameValue(int a, int b) {
+    int x, y;
+    if (a == b) return true;
+    if (IsConstant(a, x) && IsConstant(b, y)) return x == y;
+    const Instr *da = Def(a), *db = Def(b);
+    return da && db && da->op == opArrayLength && db->op == opArrayLength && da->a == db->a;
+}
+
+/* Method: Entered
+ * ---------------
+ * Returns whether i0 < n is known on the edge from block from to block
+ * to, from the branches taken to get there.
+ */
+bool Idioms::Entered(int i0, int n, int from, int to) {
+    int x, y;
+    if (IsConstant(i0, x) && IsConstant(n, y)) return x < y;
+    std::vector<Relation> relations;
+    EdgeRelations(from, to, relations);
+    for (int d = from; d >= 0; d = fn.blocks[d].idom)
+        if (fn.blocks[d].preds.size() == 1) EdgeRelations(fn.blocks[d].preds[0], d, relations);
+    for (size_t i = 0; i < relations.size(); i++)
+        if (relations[i].less == i0 && !relations[i].orEqual && SameValue(relations[i].more, n)) return true;
+    return false;
+}
+
+/* Method: UsedOutside
+ * -------------------
+ * Returns whether a register assigned in block b, other than those in
+ * except, is read in another block.
+ */
+bool Idioms::UsedOutside(int b, const std::vector<int> &except) {
+    std::vector<bool> mine(fn.f->regTypes.size());
+    for (size_t j = 0; j < fn.blocks[b].phis.size(); j++) mine[fn.blocks[b].phis[j].dst] = true;
+    for (size_t j = 0; j < fn.blocks[b].code.size(); j++)
+        if (DefinesRegister(fn.blocks[b].code[j])) mine[fn.blocks[b].code[j].dst] = true;
+    for (size_t i = 0; i < except.size(); i++) mine[except[i]] = false;
+    bool used = false;
+    for (size_t i = 0; i < fn.rpo.size() && !used; i++) {
+        SSABlock &block = fn.blocks[fn.rpo[i]];
+        for (size_t j = 0; j < block.phis.size(); j++)
+            for (size_t k = 0; k < block.phis[j].args.size(); k++)
+                if (mine[block.phis[j].args[k]] && (fn.rpo[i] != b || block.preds[k] != b)) used = true;
+        if (fn.rpo[i] == b) continue;
+        for (size_t j = 0; j < block.code.size(); j++)
+            fn.ForEachUse(block.code[j], [&](int &r) { if (mine[r]) used = true; });
+    }
+    return used;
+}
+
+/* Method: Replace
+ * ---------------
+ * Replaces the loop of block b if it is one of the idioms. Constants
+ * and n's length may stay in the block; any other instruction makes it
+ * not an idiom.
+ */
+bool Idioms::Replace(int b) {
+    SSABlock &block = fn.blocks[b];
+    Instr &last = block.code.back();
+    if (block.preds.size() != 2 || last.op != opBranch || last.b != b || last.c == b) return false;
+    int outside = block.preds[0] == b ? block.preds[1] : block.preds[0];
+    if (outside == b || (block.preds[0] != b && block.preds[1] != b)) return false;
+    int fromOutside = block.preds[0] == outside ? 0 : 1;
+
+    const Instr *test = Def(last.a), *step;
+    if (!test || defs[last.a].first != b) return false;
+    int next, n, one;
+    if (test->op == opLtI) next = test->a, n = test->b;
+    else if (test->op == opGtI) next = test->b, n = test->a;
+    else return false;
+    step = Def(next);
+    if (!step || defs[next].first != b || step->op != opAddI) return false;
+    int i = step->a, other = step->b;
+    if (!IsConstant(other, one)) std::swap(i, other);
+    if (!IsConstant(other, one) || one != 1) return false;
+    if (defs[i].first != b || defs[i].second >= 0) return false;
+    Phi &counter = block.phis[~defs[i].second];
+    if (counter.args[1 - fromOutside] != next) return false;
+    const Instr *length = Def(n);
+    bool lengthHere = length && defs[n].first == b;
+    if (!DefinedAbove(n, b) && !(lengthHere && length->op == opArrayLength && DefinedAbove(length->a, b)))
+        return false;
+
+    int store = -1, load = -1, add = -1;
+    std::vector<Instr> code;
+    std::vector<int> results(1, next);  // what may be used after the loop
+    for (size_t j = 0; j + 1 < block.code.size(); j++) {
+        Instr &in = block.code[j];
+        if ((int)j == defs[last.a].second || (int)j == defs[next].second) continue;
+        switch (in.op) {
+          case opArrayLength:
+            if (in.dst != n) return false;
+            // fall through
+          case opLoadInt: case opLoadDouble:
+            code.push_back(in);
+            results.push_back(in.dst);
+            break;
+          case opArrayStore: case opArrayStoreUnchecked:
+            if (store >= 0) return false;
+            store = j;
+            break;
+          case opArrayLoad: case opArrayLoadUnchecked:
+            if (load >= 0) return false;
+            load = j;
+            break;
+          case opAddI: case opAddD:
+            if (add >= 0) return false;
+            add = j;
+            break;
+          default:
+            return false;
+        }
+    }
+
+    Instr bulk = { opNop, -1, 0, (int)fn.f->args.size(), 4, last.line };
+    std::vector<int> args;
+    const Instr *st = store >= 0 ? &block.code[store] : NULL, *ld = load >= 0 ? &block.code[load] : NULL;
+    if (ld && (ld->b != i || !DefinedAbove(ld->a, b))) return false;
+    if (st && (st->b != i || !DefinedAbove(st->a, b))) return false;
+    size_t phis = 1;
+    if (st && !ld && add < 0) {
+        if (!DefinedAbove(st->c, b)) return false;
+        bulk.op = opArrayFill;
+        args = { st->a, i, n, st->c };
+    } else if (st && ld && add < 0) {
+        if (st->c != ld->dst || IsReference((valueTypeT)fn.f->regTypes[ld->dst])) return false;
+        bulk.op = opArrayCopy;
+        args = { st->a, ld->a, i, n };
+    } else if (!st && ld && add >= 0) {
+        const Instr &sum = block.code[add];
+        int s = sum.a == ld->dst ? sum.b : sum.a;
+        if ((sum.a == ld->dst) == (sum.b == ld->dst)) return false;
+        if (defs[s].first != b || defs[s].second >= 0) return false;
+        if (block.phis[~defs[s].second].args[1 - fromOutside] != sum.dst) return false;
+        bulk.op = sum.op == opAddI ? opArraySumI : opArraySumD;
+        bulk.dst = sum.dst;
+        args = { s, ld->a, i, n };
+        results.push_back(sum.dst);
+        phis = 2;
+    } else {
+        return false;
+    }
+    if (block.phis.size() != phis || UsedOutside(b, results)) return false;
+    if (!Entered(counter.args[fromOutside], n, outside, b)) return false;
+
+    fn.f->args.insert(fn.f->args.end(), args.begin(), args.end());
+    code.push_back(bulk);
+    Instr move = { opMove, next, n, 0, 0, last.line };
+    Instr jump = { opJump, -1, last.c, 0, 0, last.line };
+    code.push_back(move);
+    code.push_back(jump);
+    block.code.swap(code);
+    fn.RemoveEdge(b, b);
+    return true;
+}
+
+int Idioms::Run() {
+    int changes = 0;
+    for (size_t i = 0; i < fn.rpo.size(); i++) {
+        if (!Replace(fn.rpo[i])) continue;
+        changes++;
+        FindDefs();
+    }
+    if (changes) fn.Analyze();
+    return changes;
+}
+
+/* Class: DCE
+ * ----------
+ * Dead code elimination: everything that has an effect or may fail is
+ * live, then so is whatever assigns a register something live reads.
+ */
+class DCE
+{
+  protected:
+    SSAFunction &fn;
+
+  public:
+    DCE(SSAFunction &fn) : fn(fn) {}
+    int Run();
+};
+
+int DCE::Run() {
+    int regs = fn.f->regTypes.size();
+    std::vector<std::pair<int, int> > defs(regs, std::make_pair(-1, 0)); // block, instruction or ~phi
+    std::vector<bool> live(regs);
+    std::vector<int> work;
+    std::function<void(int &)> mark = [&](int &r) {
+        if (live[r]) return;
+        live[r] = true;
+        work.push_back(r);
+    };
+    for (size_t i = 0; i < fn.rpo.size(); i++) {
+        int b = fn.rpo[i];
+        SSABlock &block = fn.blocks[b];
+        for (size_t j = 0; j < block.phis.size(); j++)
+            defs[block.phis[j].dst] = std::make_pair(b, ~(int)j);
+        for (size_t j = 0; j < block.code.size(); j++) {
+            Instr &in = block.code[j];
+            if (DefinesRegister(in)) defs[in.dst] = std::make_pair(b, (int)j);
+            if (!IsRemovable(fn, in)) fn.ForEachUse(in, mark);
+        }
+    }
+    while (!work.empty()) {
+        int r = work.back();
+        work.pop_back();
+        if (defs[r].first < 0) continue;
+        SSABlock &block = fn.blocks[defs[r].first];
+        int j = defs[r].second;
+        if (j >= 0) {
+            fn.ForEachUse(block.code[j], mark);
+        } else {
+            std::vector<int> &args = block.phis[~j].args;
+            for (size_t k = 0; k < args.size(); k++) mark(args[k]);
+        }
+    }
+
+    int changes = 0;
+    for (size_t i = 0; i < fn.rpo.size(); i++) {
+        SSABlock &block = fn.blocks[fn.rpo[i]];
+        std::vector<Phi> phis;
+        for (size_t j = 0; j < block.phis.size(); j++)
+            if (live[block.phis[j].dst]) phis.push_back(block.phis[j]);
+        std::vector<Instr> code;
+        for (size_t j = 0; j < block.code.size(); j++)
+            if (!IsRemovable(fn, block.code[j]) || live[block.code[j].dst]) code.push_back(block.code[j]);
+        changes += block.phis.size() - phis.size() + block.code.size() - code.size();
+        block.phis.swap(phis);
+        block.code.swap(code);
+    }
+    return changes;
+}
+
+static int RunInliner(SSAFunction &fn, CallGraph &graph) { return Inliner(fn, graph).Run(); }
+static int RunDevirtualizer(SSAFunction &fn, CallGraph &graph) { return Devirtualizer(fn, graph).Run(); }
+static int RunTailRecursion(SSAFunction &fn, CallGraph &) { return TailRecursion(fn).Run(); }
+static int RunEscape(SSAFunction &fn, CallGraph &) { return Escape(fn).Run(); }
+static int RunSCCP(SSAFunction &fn, CallGraph &) { return SCCP(fn).Run(); }
+static int RunGVN(SSAFunction &fn, CallGraph &) { return GVN(fn).Run(); }
+static int RunLICM(SSAFunction &fn, CallGraph &) { return LICM(fn).Run(); }
+static int RunBCE(SSAFunction &fn, CallGraph &) { return BCE(fn).Run(); }
+static int RunIdioms(SSAFunction &fn, CallGraph &) { return Idioms(fn).Run(); }
+static int RunDCE(SSAFunction &fn, CallGraph &) { return DCE(fn).Run(); }
+
+struct Pass {
+    const char *name;
+    int (*run)(SSAFunction &fn, CallGraph &graph);
+    bool enabled;
+    double seconds;
+    long changes;
+};
+
+static double SecondsSince(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void Optimize(Module *module) {
+    if (GetOption("no-opt")) return;
+    Pass passes[] = {
+        { "inline", RunInliner }, { "devirt", RunDevirtualizer }, { "tailrec", RunTailRecursion },
+        { "escape", RunEscape }, { "sccp", RunSCCP }, { "gvn", RunGVN }, { "licm", RunLICM },
+        { "bce", RunBCE }, { "idiom", RunIdioms }, { "dce", RunDCE }
+    };
+    const int numPasses = sizeof(passes) / sizeof(passes[0]);
+    for (int p = 0; p < numPasses; p++) {
+        std::string option = std::string("no-") + passes[p].name;
+        passes[p].enabled = !GetOption(option.c_str());
+        passes[p].seconds = 0;
+        passes[p].changes = 0;
+    }
+    double ssaSeconds = 0;
+    CallGraph graph(module);
+    for (size_t k = 0; k < graph.order.size(); k++) {
+        int i = graph.order[k];
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        SSAFunction fn(module, &module->functions[i]);
+        ssaSeconds += SecondsSince(begin);
+        for (int p = 0; p < numPasses; p++) {
+            if (!passes[p].enabled) continue;
+            begin = std::chrono::steady_clock::now();
+            passes[p].changes += passes[p].run(fn, graph);
+            passes[p].seconds += SecondsSince(begin);
+        }
+        begin = std::chrono::steady_clock::now();
+        fn.Finish();
+        graph.done[i] = true;
+        ssaSeconds += SecondsSince(begin);
+    }
+    if (!GetOption("opt-stats")) return;
+    fprintf(stderr, "opt: ssa    %8.3f ms to build and leave SSA form\n", ssaSeconds * 1e3);
+    for (int p = 0; p < numPasses; p++) {
+        if (!passes[p].enabled) fprintf(stderr, "opt: %-6s off\n", passes[p].name);
+        else fprintf(stderr, "opt: %-6s %8.3f ms, %ld changes\n", passes[p].name,
+                     passes[p].seconds * 1e3, passes[p].changes);
+    }
+}
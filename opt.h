@@ -0,0 +1,76 @@
+/* File: opt.h
+ * -----------
+ * The optimizer rewrites each function of a lowered module in SSA form
+ * (see ssa.h), callees before their callers, running these passes in
+ * order:
+ *
+ *   inline a call whose target is known is replaced with the
+ *         target's optimized body if that has at most --inline-size
+ *         instructions (20 by default). Calls within a recursive cycle
+ *         are left alone. The target of a call through a class or
+ *         interface is known when the receiver was made by a New in
+ *         the function, or when the method has one implementation in
+ *         all the classes below that the program ever creates (class
+ *         hierarchy and rapid type analysis over the whole program).
+ *   devirt the calls through a class or interface whose target is
+ *         known but that were not inlined become direct Calls.
+ *   tailrec a function that returns the result of calling itself,
+ *         or that result plus or times an int, loops back to its start
+ *         instead, after assigning the arguments to the parameters and
+ *         keeping the sum or product in an accumulator.
+ *   escape escape analysis: an object, or an array of constant size up
+ *         to 8, that the function only reads and writes at known
+ *         fields or indices, and never stores, passes or returns, is
+ *         replaced with one register per field or element (scalar
+ *         replacement), so it is never allocated.
+ *   sccp  sparse conditional constant propagation (Wegman and Zadeck):
+ *         finds the int and bool registers that hold one constant on
+ *         every path that can run, loads the constant instead and turns
+ *         branches on a constant into jumps, dropping the blocks no
+ *         longer reached.
+ *   gvn   global value numbering over the dominator tree: an operation
+ *         with no side effects whose operands are the same as one that
+ *         dominates it reuses that result, and copies are propagated.
+ *   licm  loop-invariant code motion: operations of a loop whose
+ *         operands are defined outside it move to the loop's preheader.
+ *         Operations that may fail, such as array loads and field reads,
+ *         move only from the loop's first block and only if nothing
+ *         before them in it has an effect, since the lowering (see
+ *         ForStmt::Emit) runs that block whenever the loop is entered.
+ *         Loads also need the loop not to call or store anything they
+ *         might read.
+ *   bce   bounds-check elimination: an array access whose index the
+ *         branches taken to reach it show to be at least 0 and below
+ *         the array's length, typically an induction variable tested
+ *         against a.length() or the size a was allocated with, becomes
+ *         an ArrayLoadUnchecked or ArrayStoreUnchecked.
+ *   idiom loop idiom recognition: a loop of one block that only fills
+ *         an array with one value, copies one array to another or sums
+ *         an array's elements becomes an ArrayFill, ArrayCopy or
+ *         ArraySum over the range the loop covers (see tac.h), which
+ *         run with SIMD kernels (see simd.h).
+ *   dce   dead code elimination: drops operations and phis whose result
+ *         is never used and that have no effect.
+ *
+ * --no-opt turns the optimizer off and --no-inline, --no-devirt,
+ * --no-tailrec, --no-escape, --no-sccp, --no-gvn, --no-licm, --no-bce,
+ * --no-idiom and --no-dce the single passes.
+ * --opt-stats prints the time each pass took over the whole module and
+ * how much it changed; for inline that is the number of calls inlined,
+ * for tailrec the number of calls turned into loops, for escape the
+ * number of allocations removed and for bce the number of checks
+ * removed.
+ */
+
+#ifndef _H_opt
+#define _H_opt
+
+#include "tac.h"
+
+/* Function: Optimize
+ * ------------------
+ * Runs the enabled passes over every function of module.
+ */
+void Optimize(Module *module);
+
+#endif
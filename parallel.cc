@@ -0,0 +1,59 @@
+/* File: parallel.cc
+ * -----------------
+ * Implementation of the thread helper.
+ */
+
+#include "parallel.h"
+#include "utility.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+/* Struct: Share
+ * -------------
+ * The range of indexes one thread starts with. Its owner and any thief
+ * claim indexes the same way, by bumping next; claims at or past end
+ * are simply dropped, so no locking is needed.
+ */
+struct Share {
+    std::atomic<int> next;
+    int end;
+    char pad[64 - sizeof(std::atomic<int>) - sizeof(int)]; // one per cache line
+};
+
+
+int NumJobs()
+{
+    const char *jobs = GetOption("jobs");
+    if (!jobs) return 1;
+    int n = *jobs ? atoi(jobs) : (int)std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+void ParallelFor(int count, const std::function<void(int)> &work)
+{
+    int jobs = NumJobs();
+    if (jobs > count) jobs = count;
+    if (jobs <= 1) {
+        for (int i = 0; i < count; i++) work(i);
+        return;
+    }
+    Share *shares = new Share[jobs];
+    for (int t = 0; t < jobs; t++) {
+        shares[t].next = (long)count * t / jobs;
+        shares[t].end = (long)count * (t + 1) / jobs;
+    }
+    std::vector<std::thread> threads;
+    for (int t = 0; t < jobs; t++)
+        threads.push_back(std::thread([&, t]() {
+            for (int v = 0; v < jobs; v++) { // own share first, then the rest
+                Share &s = shares[(t + v) % jobs];
+                for (int i; (i = s.next++) < s.end; )
+                    work(i);
+            }
+        }));
+    for (int t = 0; t < jobs; t++)
+        threads[t].join();
+    delete[] shares;
+}
@@ -0,0 +1,32 @@
+/* File: parallel.h
+ * ----------------
+ * A small helper for running independent pieces of work on several
+ * threads. The number of threads comes from the --jobs=N option;
+ * --jobs without a value uses one thread per processor, and without
+ * the option everything runs on the calling thread.
+ */
+
+#ifndef _H_parallel
+#define _H_parallel
+
+#include <functional>
+
+/* Function: NumJobs
+ * -----------------
+ * Returns the number of threads parallel passes should use.
+ */
+int NumJobs();
+
+/* Function: ParallelFor
+ * ---------------------
+ * Calls work(i) once for each i in [0, count), spread over up to
+ * NumJobs() threads, and returns when all calls have finished. The
+ * calls may run in any order, so work must not depend on one another.
+ *
+ * Each thread starts on its own contiguous share of the indexes. A
+ * thread that finishes its share steals indexes from the others' shares,
+ * so a few expensive items do not leave the other threads idle.
+ */
+void ParallelFor(int count, const std::function<void(int)> &work);
+
+#endif
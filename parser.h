@@ -33,5 +33,6 @@
 
 int yyparse();              // Defined in the generated y.tab.c file
 void InitParser();          // Defined in parser.y
+extern Program *parsedProgram; // Set by the Program rule in parser.y
 
 #endif
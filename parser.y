@@ -3,8 +3,9 @@
  * Yacc input file to generate the parser for the compiler.
  *
  * pp3: add parser rules and tree construction from your pp2. You should
- *      not need to make any significant changes in the parser itself. After
- *      parsing completes, if no syntax errors were found, the parser calls
+ *      not need to make any significant changes in the parser itself. The
+ *      Program rule only leaves the finished tree in parsedProgram. After
+ *      parsing completes, if no syntax errors were found, main() calls
  *      program->Check() to kick off the semantic analyzer pass. The
  *      interesting work happens during the tree traversal.
  */
@@ -16,6 +17,20 @@
 #include "errors.h"
 
 void yyerror(char *msg); // standard error-handling routine
+Program *parsedProgram = NULL;
+
+// yacc's own version sets only the lines and columns of a rule's
+// location; it is in the file its symbols are in as well
+#define YYLLOC_DEFAULT(Current, Rhs, N)                                   \
+    do {                                                                  \
+        if (N) {                                                          \
+            (Current) = Join(YYRHSLOC(Rhs, 1), YYRHSLOC(Rhs, N));         \
+        } else {                                                          \
+            (Current) = YYRHSLOC(Rhs, 0);                                 \
+            (Current).first_line = (Current).last_line;                   \
+            (Current).first_column = (Current).last_column;               \
+        }                                                                 \
+    } while (0)
 
 %}
 
@@ -155,9 +170,8 @@ void yyerror(char *msg); // standard error-handling routine
  */
 Program           :   DeclList
                       {
-                        Program *program = new Program($1);
-                        if (ReportError::NumErrors() == 0)
-                            program->Print(0);
+                        parsedProgram = new Program($1);
+                        parsedProgram->SetImports(GetImportDirectives());
                       }
                   ;
 
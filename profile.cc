@@ -0,0 +1,61 @@
+/* File: profile.cc
+ * ----------------
+ * Implementation of the sampling profiler's timer and its folded-stack
+ * output.
+ */
+
+#include "profile.h"
+#include "utility.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+std::atomic<int> Profiler::ticks(0);
+
+void Profiler::Tick(int signal) {
+    ticks.fetch_add(1, std::memory_order_relaxed);   // lock-free, so safe here
+}
+
+void Profiler::Start(int rate) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = Tick;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, &saved);
+    struct itimerval timer;
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = rate < 1000000 ? 1000000 / rate : 1;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_PROF, &timer, NULL);
+}
+
+void Profiler::Stop() {
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, NULL);
+    sigaction(SIGPROF, &saved, NULL);
+    ticks = 0;
+}
+
+void Profiler::Add(const std::vector<int> &stack, int line, int weight) {
+    std::vector<int> key(stack);
+    key.push_back(line);
+    counts[key] += weight;
+}
+
+bool Profiler::Write(const char *path) {
+    FILE *fp = fopen(path, "w");
+    if (!fp) return false;
+    long samples = 0;
+    for (std::map<std::vector<int>, long>::iterator it = counts.begin(); it != counts.end(); ++it) {
+        const std::vector<int> &key = it->first;
+        for (size_t i = 0; i + 1 < key.size(); i++)
+            fprintf(fp, "%s%s", i ? ";" : "", key[i] < 0 ? "..." : module->functions[key[i]].name.c_str());
+        if (key.back() > 0) fprintf(fp, ":%d", key.back());
+        fprintf(fp, " %ld\n", it->second);
+        samples += it->second;
+    }
+    PrintDebug("profile", "%ld samples in %d stacks\n", samples, (int)counts.size());
+    return fclose(fp) == 0;
+}
@@ -0,0 +1,65 @@
+/* File: profile.h
+ * ---------------
+ * The VM's sampling profiler. With --profile[=file] a timer that counts
+ * the process's CPU time (setitimer's ITIMER_PROF) raises SIGPROF
+ * --profile-rate times a second, 997 by default, a prime so that the
+ * samples do not fall into step with the program's loops. The handler
+ * only counts the tick. The interpreter checks the count at every call,
+ * return and backward jump, and so does compiled code, which the JIT
+ * gives the same checks while profiling. The first such safepoint after
+ * a tick takes the sample: the functions on the VM's stack and the
+ * source line being run, from the line each instruction carries from
+ * the AST's location of the statement it was lowered from (see
+ * Code::lines). The sample counts once for each tick it stands for.
+ *
+ * When the program ends the samples go to file, profile.folded if no
+ * name is given, in the folded-stack format that flamegraph.pl and
+ * speedscope read: a line per stack, the functions from main inwards
+ * separated by semicolons, the innermost followed by its line, then the
+ * number of samples:
+ *
+ *     main;Tree.Insert;Tree.Insert:42 118
+ *
+ * Stacks deeper than 256 calls keep the innermost ones under a frame
+ * named "...". A function that tail-calls another (see opt.h) is gone
+ * from the stack by the time the callee runs.
+ */
+
+#ifndef _H_profile
+#define _H_profile
+
+#include <atomic>
+#include <map>
+#include <vector>
+#include <signal.h>
+#include "tac.h"
+
+class Profiler
+{
+  protected:
+    Module *module;
+    std::map<std::vector<int>, long> counts; // functions outermost first,
+                                             // then the line; -1 for "..."
+    struct sigaction saved;
+
+    static void Tick(int signal);
+
+  public:
+    static const int MaxDepth = 256;
+    static std::atomic<int> ticks;   // since the last sample was taken
+
+    Profiler(Module *module) : module(module) {}
+
+          // Start and stop the timer, at rate ticks a second.
+    void Start(int rate);
+    void Stop();
+
+          // Records a sample that stands for weight ticks.
+    void Add(const std::vector<int> &stack, int line, int weight);
+
+          // Writes the folded stacks. Returns false if the file could
+          // not be written.
+    bool Write(const char *path);
+};
+
+#endif
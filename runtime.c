@@ -0,0 +1,402 @@
+/* File: runtime.c
+ * ---------------
+ * The C runtime programs compiled by the x86-64 backend are linked with
+ * (see x86.h). It provides the program's main, which calls the Decaf
+ * main, and the library routines and runtime errors the generated code
+ * calls, with the same behavior as the VM.
+ *
+ * A heap block starts with a 16-byte header: the class descriptor of an
+ * object, or null for an array or string, and then the object's size or
+ * the array's or string's length. Array elements are 8 bytes each and
+ * string characters are followed by a NUL. Blocks come from malloc and
+ * are never freed.
+ *
+ * String constants are interned as in the VM: the compiled program
+ * lists them in decaf_strings and gives each a non-null class pointer,
+ * and a line read in that equals a constant is that constant, so two
+ * different strings of which one is a constant are never equal.
+ *
+ * Input and output are buffered as in the VM (see io.h): Print fills a
+ * 64 KB buffer that is written out with write(2) when it is full, before
+ * reading input and at exit, and input is read with read(2) in 64 KB
+ * blocks, without stdio and its locks.
+ *
+ * The bulk array operations (see tac.h) and string equality use SSE2
+ * kernels, or AVX2 ones if the CPU supports them. DECAF_SIMD=sse2 or
+ * DECAF_SIMD=none in the environment caps the choice, as --simd does in
+ * the VM.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include <errno.h>
+#include <unistd.h>
+#include <immintrin.h>
+
+typedef struct {
+    void *descriptor;
+    long length;
+} Header;
+
+void decaf_main(void);
+extern Header *decaf_strings[];  /* the string constants, ending with null */
+
+static void FlushOutput(void);
+
+static void RuntimeError(const char *message) {
+    FlushOutput();
+    fprintf(stderr, "Decaf runtime error: %s\n", message);
+    exit(1);
+}
+
+static void *Allocate(long bytes) {
+    void *block = calloc(1, bytes);
+    if (!block) RuntimeError("Out of memory");
+    return block;
+}
+
+void decaf_null_error(void) { RuntimeError("Null object reference"); }
+void decaf_null_array_error(void) { RuntimeError("Null array reference"); }
+void decaf_bounds_error(void) { RuntimeError("Array subscript out of bounds"); }
+void decaf_division_error(void) { RuntimeError("Division by zero"); }
+
+void *decaf_new_object(void *descriptor, int size) {
+    Header *obj = Allocate(size);
+    obj->descriptor = descriptor;
+    obj->length = size;
+    return obj;
+}
+
+void *decaf_new_array(int length) {
+    if (length <= 0) RuntimeError("Array size is <= 0");
+    Header *array = Allocate(sizeof(Header) + 8L * length);
+    array->length = length;
+    return array;
+}
+
+static void FillPlain(long *elements, long count, long value) {
+    for (long i = 0; i < count; i++) elements[i] = value;
+}
+
+static void CopyPlain(long *to, const long *from, long count) {
+    for (long i = 0; i < count; i++) to[i] = from[i];
+}
+
+static unsigned long SumPlain(const long *elements, long count) {
+    unsigned long sum = 0;
+    for (long i = 0; i < count; i++) sum += elements[i];
+    return sum;
+}
+
+static int EqualPlain(const char *a, const char *b, long count) {
+    return memcmp(a, b, count) == 0;
+}
+
+static void FillSSE2(long *elements, long count, long value) {
+    __m128i v = _mm_set1_epi64x(value);
+    long i = 0;
+    for (; i + 2 <= count; i += 2) _mm_storeu_si128((__m128i *)(elements + i), v);
+    FillPlain(elements + i, count - i, value);
+}
+
+static void CopySSE2(long *to, const long *from, long count) {
+    long i = 0;
+    for (; i + 2 <= count; i += 2)
+        _mm_storeu_si128((__m128i *)(to + i), _mm_loadu_si128((const __m128i *)(from + i)));
+    CopyPlain(to + i, from + i, count - i);
+}
+
+static unsigned long SumSSE2(const long *elements, long count) {
+    __m128i sum = _mm_setzero_si128();
+    long i = 0;
+    for (; i + 2 <= count; i += 2) sum = _mm_add_epi64(sum, _mm_loadu_si128((const __m128i *)(elements + i)));
+    unsigned long lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, sum);
+    return lanes[0] + lanes[1] + SumPlain(elements + i, count - i);
+}
+
+static int EqualSSE2(const char *a, const char *b, long count) {
+    long i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i)), y = _mm_loadu_si128((const __m128i *)(b + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xffff) return 0;
+    }
+    return EqualPlain(a + i, b + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static void FillAVX2(long *elements, long count, long value) {
+    __m256i v = _mm256_set1_epi64x(value);
+    long i = 0;
+    for (; i + 4 <= count; i += 4) _mm256_storeu_si256((__m256i *)(elements + i), v);
+    FillPlain(elements + i, count - i, value);
+}
+
+__attribute__((target("avx2")))
+static void CopyAVX2(long *to, const long *from, long count) {
+    long i = 0;
+    for (; i + 4 <= count; i += 4)
+        _mm256_storeu_si256((__m256i *)(to + i), _mm256_loadu_si256((const __m256i *)(from + i)));
+    CopyPlain(to + i, from + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static unsigned long SumAVX2(const long *elements, long count) {
+    __m256i sum = _mm256_setzero_si256();
+    long i = 0;
+    for (; i + 4 <= count; i += 4) sum = _mm256_add_epi64(sum, _mm256_loadu_si256((const __m256i *)(elements + i)));
+    unsigned long lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, sum);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + SumPlain(elements + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static int EqualAVX2(const char *a, const char *b, long count) {
+    long i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i)), y = _mm256_loadu_si256((const __m256i *)(b + i));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)) != -1) return 0;
+    }
+    return EqualSSE2(a + i, b + i, count - i);
+}
+
+static void (*fill)(long *, long, long) = FillSSE2;
+static void (*copy)(long *, const long *, long) = CopySSE2;
+static unsigned long (*sum)(const long *, long) = SumSSE2;
+static int (*equal)(const char *, const char *, long) = EqualSSE2;
+
+static void ChooseKernels(void) {
+    const char *cap = getenv("DECAF_SIMD");
+    if (cap && !strcmp(cap, "none")) {
+        fill = FillPlain, copy = CopyPlain, sum = SumPlain, equal = EqualPlain;
+    } else if ((!cap || strcmp(cap, "sse2")) && __builtin_cpu_supports("avx2")) {
+        fill = FillAVX2, copy = CopyAVX2, sum = SumAVX2, equal = EqualAVX2;
+    }
+}
+
+/* The loop a bulk operation stands for runs over [from, to), from < to,
+ * and would stop at its first failing access; a copy reads src before
+ * it writes dst.
+ */
+static long *CheckedRange(Header *array, int from, int to) {
+    if (!array) decaf_null_array_error();
+    if (from < 0 || from >= array->length || to > array->length) decaf_bounds_error();
+    return (long *)(array + 1) + from;
+}
+
+void decaf_array_fill(Header *array, int from, int to, long value) {
+    fill(CheckedRange(array, from, to), to - from, value);
+}
+
+void decaf_array_copy(Header *dst, Header *src, int from, int to) {
+    if (!src) decaf_null_array_error();
+    if (from < 0 || from >= src->length) decaf_bounds_error();
+    long *elements = CheckedRange(dst, from, to);
+    copy(elements, CheckedRange(src, from, to), to - from);
+}
+
+int decaf_array_sum_int(int start, Header *array, int from, int to) {
+    return (unsigned)start + (unsigned)sum(CheckedRange(array, from, to), to - from);
+}
+
+double decaf_array_sum_double(double start, Header *array, int from, int to) {
+    double *elements = (double *)CheckedRange(array, from, to);
+    for (long i = 0; i < to - from; i++) start += elements[i];
+    return start;
+}
+
+int decaf_strings_equal(Header *a, Header *b) {
+    if (a == b) return 1;
+    if (!a || !b || a->length != b->length || a->descriptor || b->descriptor) return 0;
+    return equal((char *)(a + 1), (char *)(b + 1), a->length);
+}
+
+static Header **constants;       /* decaf_strings by hash, open addressing */
+static unsigned long constantsMask;
+
+static unsigned long Hash(const char *chars, long length) {
+    unsigned long hash = 14695981039346656037UL;
+    for (long i = 0; i < length; i++) hash = (hash ^ (unsigned char)chars[i]) * 1099511628211UL;
+    return hash;
+}
+
+static Header *FindConstant(const char *chars, long length) {
+    if (!constants) {
+        long count = 0;
+        while (decaf_strings[count]) count++;
+        unsigned long size = 1;
+        while (size < 2 * count + 1) size *= 2;
+        constants = Allocate(size * sizeof(Header *));
+        constantsMask = size - 1;
+        for (long i = 0; i < count; i++) {
+            unsigned long hash = Hash((char *)(decaf_strings[i] + 1), decaf_strings[i]->length);
+            while (constants[hash & constantsMask]) hash++;
+            constants[hash & constantsMask] = decaf_strings[i];
+        }
+    }
+    for (unsigned long hash = Hash(chars, length); constants[hash & constantsMask]; hash++) {
+        Header *s = constants[hash & constantsMask];
+        if (s->length == length && !memcmp(s + 1, chars, length)) return s;
+    }
+    return NULL;
+}
+
+static char output[1 << 16], input[1 << 16];
+static long outputLength, inputStart, inputEnd; /* input[inputStart, inputEnd) is unread */
+
+static void WriteAll(const char *chars, long length) {
+    while (length > 0) {
+        long n = write(STDOUT_FILENO, chars, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        chars += n;
+        length -= n;
+    }
+}
+
+static void FlushOutput(void) {
+    WriteAll(output, outputLength);
+    outputLength = 0;
+}
+
+static void PrintChars(const char *chars, long length) {
+    if (outputLength + length > (long)sizeof output) {
+        FlushOutput();
+        if (length > (long)sizeof output) {
+            WriteAll(chars, length);
+            return;
+        }
+    }
+    memcpy(output + outputLength, chars, length);
+    outputLength += length;
+}
+
+void decaf_print_int(int value) {
+    char digits[16], *p = digits + sizeof digits;
+    unsigned magnitude = value < 0 ? 0u - (unsigned)value : (unsigned)value;
+    do {
+        *--p = '0' + magnitude % 10;
+    } while (magnitude /= 10);
+    if (value < 0) *--p = '-';
+    PrintChars(p, digits + sizeof digits - p);
+}
+
+void decaf_print_bool(int value) { PrintChars(value ? "true" : "false", value ? 4 : 5); }
+
+/* Writes value to text as %g does and returns the length; see
+ * FormatDouble in io.cc.
+ */
+static int FormatDouble(double value, char *text) {
+    static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    double magnitude = fabs(value);
+    if (value == 0) return snprintf(text, 32, signbit(value) ? "-0" : "0");
+    int exponent = magnitude > 1e-16 && magnitude < 1e22 ? (int)floor(log10(magnitude)) : 99;
+    if (exponent < -16 || exponent > 21) return snprintf(text, 32, "%g", value);
+    double scaled = exponent <= 5 ? magnitude * powers[5 - exponent] : magnitude / powers[exponent - 5];
+    double fraction = scaled - floor(scaled);
+    long digits = (long)floor(scaled + 0.5);
+    if (fabs(fraction - 0.5) < 1e-6 || digits < 100000 || digits >= 1000000)
+        return snprintf(text, 32, "%g", value);
+    char *p = text;
+    if (value < 0) *p++ = '-';
+    int point = exponent >= -4 && exponent < 6 ? exponent : 0;   /* digits before the point, less one */
+    if (point < 0) {
+        *p++ = '0';
+        *p++ = '.';
+        for (int i = -1; i > point; i--) *p++ = '0';
+    }
+    for (int i = 5; i >= 0; i--) {
+        p[i + (point >= 0 && i > point)] = '0' + digits % 10;
+        digits /= 10;
+    }
+    if (point >= 0) p[point + 1] = '.';
+    p += 6 + (point >= 0);
+    while (p[-1] == '0' && memchr(text, '.', p - text)) p--;
+    if (p[-1] == '.') p--;
+    if (point != exponent) p += snprintf(p, 8, "e%c%02d", exponent < 0 ? '-' : '+', abs(exponent));
+    return p - text;
+}
+
+void decaf_print_double(double value) {
+    char text[32];
+    PrintChars(text, FormatDouble(value, text));
+}
+
+void decaf_print_string(Header *s) { PrintChars((char *)(s + 1), s->length); }
+
+static int Refill(void) {
+    FlushOutput();
+    memmove(input, input + inputStart, inputEnd - inputStart);
+    inputEnd -= inputStart;
+    inputStart = 0;
+    long n;
+    do {
+        n = read(STDIN_FILENO, input + inputEnd, sizeof input - inputEnd);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) return 0;
+    inputEnd += n;
+    return 1;
+}
+
+/* Returns the next line of input, without the newline, and sets
+ * *length; the characters stay valid until the next read.
+ */
+static char *ReadLine(long *length) {
+    static char *joined;         /* a line longer than what is buffered */
+    static long capacity;
+    long n = 0;
+    for (;;) {
+        char *start = input + inputStart, *newline = memchr(start, '\n', inputEnd - inputStart);
+        long part = (newline ? newline : input + inputEnd) - start;
+        inputStart += part + (newline != NULL);
+        if (newline && n == 0) {
+            *length = part;
+            return start;
+        }
+        if (n + part + 1 > capacity) joined = realloc(joined, capacity = 2 * (n + part + 1));
+        memcpy(joined + n, start, part);
+        n += part;
+        if (newline || !Refill()) {
+            *length = n;
+            return joined;
+        }
+    }
+}
+
+void *decaf_read_line(void) {
+    long length;
+    char *chars = ReadLine(&length);
+    Header *s = FindConstant(chars, length);
+    if (!s) {
+        s = Allocate(sizeof(Header) + length + 1);
+        s->length = length;
+        memcpy(s + 1, chars, length);
+    }
+    return s;
+}
+
+/* Parses as (int)strtol(chars, NULL, 10), the way atoi does. */
+int decaf_read_integer(void) {
+    long length;
+    char *chars = ReadLine(&length), *end = chars + length;
+    while (chars < end && (*chars == ' ' || (*chars >= '\t' && *chars <= '\r'))) chars++;
+    int negative = chars < end && *chars == '-';
+    if (chars < end && (*chars == '-' || *chars == '+')) chars++;
+    unsigned long magnitude = 0, limit = negative ? 0ul - (unsigned long)LONG_MIN : LONG_MAX;
+    for (; chars < end && *chars >= '0' && *chars <= '9'; chars++) {
+        int digit = *chars - '0';
+        magnitude = magnitude > (limit - digit) / 10 ? limit : magnitude * 10 + digit;
+    }
+    return (int)(negative ? 0ul - magnitude : magnitude);
+}
+
+int main(void) {
+    ChooseKernels();
+    decaf_main();
+    FlushOutput();
+    return 0;
+}
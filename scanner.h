@@ -10,6 +10,8 @@
 
 #include <stdio.h>
 
+template <class Element> class List;
+
 #define MaxIdentLen 31    // Maximum length for identifiers
 
 extern char *yytext;      // Text of lexeme just scanned
@@ -19,7 +21,11 @@ int yylex();              // Defined in the generated lex.yy.c file
 void yyrestart(FILE *fp); // ditto
 
 
-void InitScanner();                 // Defined in scanner.l user subroutines
-const char *GetLineNumbered(int n); // ditto
+void InitScanner(int file);         // Defined in scanner.l user subroutines
+int AddSourceFile(const char *name);          // ditto
+const char *GetSourceName(int file);          // ditto
+const char *GetLineNumbered(int file, int n); // ditto
+void RecordSourceLines(int file, const char *text, int len); // ditto
+List<const char*> *GetImportDirectives();     // ditto
  
 #endif
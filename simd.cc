@@ -0,0 +1,141 @@
+/* File: simd.cc
+ * -------------
+ * Implementation of the array and string kernels and the choice between them.
+ */
+
+#include "simd.h"
+#include "utility.h"
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+static void FillPlain(uint64_t *elements, long count, uint64_t value) {
+    for (long i = 0; i < count; i++) elements[i] = value;
+}
+
+static void CopyPlain(uint64_t *to, const uint64_t *from, long count) {
+    for (long i = 0; i < count; i++) to[i] = from[i];
+}
+
+static int SumIntsPlain(const uint64_t *elements, long count) {
+    uint64_t sum = 0;
+    for (long i = 0; i < count; i++) sum += elements[i];
+    return (int)(uint32_t)sum;
+}
+
+static bool EqualBytesPlain(const char *a, const char *b, long count) {
+    return memcmp(a, b, count) == 0;
+}
+
+#ifdef SIMD_X86
+
+static void FillSSE2(uint64_t *elements, long count, uint64_t value) {
+    __m128i v = _mm_set1_epi64x(value);
+    long i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i *)(elements + i), v);
+        _mm_storeu_si128((__m128i *)(elements + i + 2), v);
+    }
+    for (; i < count; i++) elements[i] = value;
+}
+
+static void CopySSE2(uint64_t *to, const uint64_t *from, long count) {
+    long i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(from + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(from + i + 2));
+        _mm_storeu_si128((__m128i *)(to + i), a);
+        _mm_storeu_si128((__m128i *)(to + i + 2), b);
+    }
+    for (; i < count; i++) to[i] = from[i];
+}
+
+static int SumIntsSSE2(const uint64_t *elements, long count) {
+    __m128i a = _mm_setzero_si128(), b = _mm_setzero_si128();
+    long i = 0;
+    for (; i + 4 <= count; i += 4) {
+        a = _mm_add_epi64(a, _mm_loadu_si128((const __m128i *)(elements + i)));
+        b = _mm_add_epi64(b, _mm_loadu_si128((const __m128i *)(elements + i + 2)));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, _mm_add_epi64(a, b));
+    uint64_t sum = lanes[0] + lanes[1];
+    for (; i < count; i++) sum += elements[i];
+    return (int)(uint32_t)sum;
+}
+
+static bool EqualBytesSSE2(const char *a, const char *b, long count) {
+    long i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i)), y = _mm_loadu_si128((const __m128i *)(b + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xffff) return false;
+    }
+    return EqualBytesPlain(a + i, b + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static void FillAVX2(uint64_t *elements, long count, uint64_t value) {
+    __m256i v = _mm256_set1_epi64x(value);
+    long i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256((__m256i *)(elements + i), v);
+        _mm256_storeu_si256((__m256i *)(elements + i + 4), v);
+    }
+    for (; i < count; i++) elements[i] = value;
+}
+
+__attribute__((target("avx2")))
+static void CopyAVX2(uint64_t *to, const uint64_t *from, long count) {
+    long i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(from + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(from + i + 4));
+        _mm256_storeu_si256((__m256i *)(to + i), a);
+        _mm256_storeu_si256((__m256i *)(to + i + 4), b);
+    }
+    for (; i < count; i++) to[i] = from[i];
+}
+
+__attribute__((target("avx2")))
+static int SumIntsAVX2(const uint64_t *elements, long count) {
+    __m256i a = _mm256_setzero_si256(), b = _mm256_setzero_si256();
+    long i = 0;
+    for (; i + 8 <= count; i += 8) {
+        a = _mm256_add_epi64(a, _mm256_loadu_si256((const __m256i *)(elements + i)));
+        b = _mm256_add_epi64(b, _mm256_loadu_si256((const __m256i *)(elements + i + 4)));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, _mm256_add_epi64(a, b));
+    uint64_t sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < count; i++) sum += elements[i];
+    return (int)(uint32_t)sum;
+}
+
+__attribute__((target("avx2")))
+static bool EqualBytesAVX2(const char *a, const char *b, long count) {
+    long i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i)), y = _mm256_loadu_si256((const __m256i *)(b + i));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)) != -1) return false;
+    }
+    return EqualBytesSSE2(a + i, b + i, count - i);
+}
+
+#endif
+
+const ArrayKernels &GetArrayKernels() {
+    static const ArrayKernels plain = { "none", FillPlain, CopyPlain, SumIntsPlain, EqualBytesPlain };
+#ifdef SIMD_X86
+    static const ArrayKernels sse2 = { "sse2", FillSSE2, CopySSE2, SumIntsSSE2, EqualBytesSSE2 };
+    static const ArrayKernels avx2 = { "avx2", FillAVX2, CopyAVX2, SumIntsAVX2, EqualBytesAVX2 };
+    const char *cap = GetOption("simd");
+    if (cap && !strcmp(cap, "none")) return plain;
+    if ((!cap || strcmp(cap, "sse2")) && __builtin_cpu_supports("avx2")) return avx2;
+    return sse2;
+#else
+    return plain;
+#endif
+}
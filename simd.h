@@ -0,0 +1,36 @@
+/* File: simd.h
+ * ------------
+ * The kernels the VM runs the bulk array instructions with (ArrayFill,
+ * ArrayCopy and ArraySumI, see opt.h). They work on the 8-byte elements
+ * of an array as plain words: an int element is the low 4 bytes of its
+ * word, so an int sum adds whole words and keeps the low 4 bytes of the
+ * total, which is the same modulo 2^32. String equality compares the
+ * characters with one more kernel, 16 or 32 bytes at a time.
+ *
+ * Each kernel comes in a plain version and, on x86-64, in SSE2 and AVX2
+ * versions written with the compiler's intrinsics. Every x86-64 CPU has
+ * SSE2; the AVX2 ones are used only if the CPU and the OS support them,
+ * as checked once through cpuid, so the same binary runs on any machine.
+ * --simd=avx2, --simd=sse2 or --simd=none caps the choice.
+ */
+
+#ifndef _H_simd
+#define _H_simd
+
+#include <stdint.h>
+
+struct ArrayKernels {
+    const char *name;
+    void (*fill)(uint64_t *elements, long count, uint64_t value);
+    void (*copy)(uint64_t *to, const uint64_t *from, long count);
+    int (*sumInts)(const uint64_t *elements, long count);
+    bool (*equalBytes)(const char *a, const char *b, long count);
+};
+
+/* Function: GetArrayKernels
+ * -------------------------
+ * Returns the fastest kernels the machine supports, within --simd.
+ */
+const ArrayKernels &GetArrayKernels();
+
+#endif
@@ -0,0 +1,577 @@
+/* File: ssa.cc
+ * ------------
+ * Construction of SSA form and the way back out of it.
+ */
+
+#include "ssa.h"
+#include "utility.h"
+#include <algorithm>
+#include <math.h>
+#include <functional>
+#include <set>
+
+bool DefinesRegister(const Instr &in) {
+    return OpOperands(in.op)[0] == 'r' && in.dst >= 0;
+}
+
+/* Method: SSAFunction
+ * -------------------
+ * Splits f into blocks and puts it into SSA form.
+ */
+SSAFunction::SSAFunction(Module *m, Function *fn) : module(m), f(fn) {
+    blocks.resize(f->blocks.size());
+    for (size_t b = 0; b < f->blocks.size(); b++) {
+        Block &block = f->blocks[b];
+        blocks[b].code.assign(f->code.begin() + block.start, f->code.begin() + block.end);
+        blocks[b].idom = -1;
+        blocks[b].after = -1;
+        std::vector<Instr> &code = blocks[b].code;
+        if (!code.empty() && code.back().op == opBranch && code.back().b == code.back().c) {
+            code.back().op = opJump;
+            code.back().a = code.back().b;
+        }
+    }
+    for (size_t b = 0; b < blocks.size(); b++) {
+        std::vector<int> succs = Succs(b);
+        for (size_t i = 0; i < succs.size(); i++)
+            blocks[succs[i]].preds.push_back(b);
+    }
+    Analyze();
+    std::vector<std::vector<bool> > liveIn;
+    ComputeLiveIn(liveIn);
+    ZeroUninitialized(liveIn);
+    PlacePhis(liveIn);
+    std::vector<std::vector<int> > stacks(f->regTypes.size());
+    for (int p = 0; p < f->numParams; p++) stacks[p].push_back(p);
+    Rename(0, stacks);
+}
+
+std::vector<int> SSAFunction::Succs(int b) {
+    std::vector<int> succs;
+    if (blocks[b].code.empty()) return succs;
+    const Instr &last = blocks[b].code.back();
+    if (last.op == opJump) succs.push_back(last.a);
+    if (last.op == opBranch) {
+        succs.push_back(last.b);
+        succs.push_back(last.c);
+    }
+    return succs;
+}
+
+int SSAFunction::NewReg(valueTypeT type) {
+    f->regTypes.push_back(type);
+    return f->regTypes.size() - 1;
+}
+
+/* Method: RemoveEdge
+ * ------------------
+ * Drops from as a predecessor of to, with the phi arguments for it.
+ */
+void SSAFunction::RemoveEdge(int from, int to) {
+    SSABlock &block = blocks[to];
+    std::vector<int>::iterator it = std::find(block.preds.begin(), block.preds.end(), from);
+    if (it == block.preds.end()) return;
+    int i = it - block.preds.begin();
+    block.preds.erase(it);
+    for (size_t p = 0; p < block.phis.size(); p++)
+        block.phis[p].args.erase(block.phis[p].args.begin() + i);
+}
+
+void SSAFunction::RemoveBlock(int b) {
+    std::vector<int> succs = Succs(b);
+    for (size_t i = 0; i < succs.size(); i++)
+        RemoveEdge(b, succs[i]);
+    blocks[b].code.clear();
+    blocks[b].phis.clear();
+    blocks[b].preds.clear();
+    blocks[b].idom = -1;
+}
+
+/* Method: SplitEdge
+ * -----------------
+ * Puts a new block on the edge from -> to and returns it. It takes the
+ * place of from in to's predecessors, so the phis are unchanged.
+ */
+int SSAFunction::SplitEdge(int from, int to) {
+    int n = blocks.size();
+    blocks.push_back(SSABlock());
+    Instr &last = blocks[from].code.back();
+    Instr jump = { opJump, -1, to, 0, 0, last.line };
+    if (last.op == opJump && last.a == to) last.a = n;
+    if (last.op == opBranch && last.b == to) last.b = n;
+    if (last.op == opBranch && last.c == to) last.c = n;
+    SSABlock &block = blocks[n];
+    block.code.push_back(jump);
+    block.preds.push_back(from);
+    block.idom = -1;
+    block.after = from;
+    std::vector<int> &preds = blocks[to].preds;
+    *std::find(preds.begin(), preds.end(), from) = n;
+    return n;
+}
+
+/* Method: Analyze
+ * ---------------
+ * Removes the blocks that can no longer be reached, then numbers the
+ * rest in reverse postorder and computes their immediate dominators
+ * (Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm").
+ * A preorder and postorder numbering of the dominator tree then makes
+ * Dominates a constant-time test.
+ */
+void SSAFunction::Analyze() {
+    int n = blocks.size();
+    std::vector<int> state(n, 0), stack(1, 0), index(n, -1);
+    rpo.clear();
+    state[0] = 1;
+    while (!stack.empty()) {                   // iterative depth-first search
+        int b = stack.back();
+        std::vector<int> succs = Succs(b);
+        bool pushed = false;
+        for (size_t i = 0; i < succs.size() && !pushed; i++)
+            if (!state[succs[i]]) {
+                state[succs[i]] = 1;
+                stack.push_back(succs[i]);
+                pushed = true;
+            }
+        if (pushed) continue;
+        rpo.push_back(b);
+        stack.pop_back();
+    }
+    std::reverse(rpo.begin(), rpo.end());
+    for (int b = 0; b < n; b++)
+        if (!state[b] && !blocks[b].code.empty()) RemoveBlock(b);
+    for (size_t i = 0; i < rpo.size(); i++) index[rpo[i]] = i;
+
+    for (int b = 0; b < n; b++) {
+        blocks[b].idom = -1;
+        blocks[b].children.clear();
+    }
+    blocks[0].idom = 0;
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (size_t i = 1; i < rpo.size(); i++) {
+            SSABlock &block = blocks[rpo[i]];
+            int idom = -1;
+            for (size_t p = 0; p < block.preds.size(); p++) {
+                int a = block.preds[p];
+                if (blocks[a].idom < 0) continue;
+                for (int b = idom; b >= 0 && a != b; ) {
+                    while (index[a] > index[b]) a = blocks[a].idom;
+                    while (index[b] > index[a]) b = blocks[b].idom;
+                }
+                idom = a;
+            }
+            if (idom != block.idom) {
+                block.idom = idom;
+                changed = true;
+            }
+        }
+    }
+    blocks[0].idom = -1;
+    for (size_t i = 1; i < rpo.size(); i++)
+        blocks[blocks[rpo[i]].idom].children.push_back(rpo[i]);
+
+    int counter = 0;
+    std::vector<std::pair<int, size_t> > walk(1, std::make_pair(0, (size_t)0));
+    blocks[0].pre = counter++;
+    while (!walk.empty()) {
+        SSABlock &block = blocks[walk.back().first];
+        if (walk.back().second < block.children.size()) {
+            int child = block.children[walk.back().second++];
+            blocks[child].pre = counter++;
+            walk.push_back(std::make_pair(child, (size_t)0));
+        } else {
+            block.post = counter++;
+            walk.pop_back();
+        }
+    }
+}
+
+/* Method: ComputeLiveIn
+ * ---------------------
+ * Sets liveIn[b][r] when register r may be read in or after block b
+ * before it is written, before renaming.
+ */
+void SSAFunction::ComputeLiveIn(std::vector<std::vector<bool> > &liveIn) {
+    int n = blocks.size(), regs = f->regTypes.size();
+    std::vector<std::vector<bool> > uses(n, std::vector<bool>(regs)), defs = uses;
+    liveIn = uses;
+    for (size_t i = 0; i < rpo.size(); i++) {
+        int b = rpo[i];
+        for (size_t j = 0; j < blocks[b].code.size(); j++) {
+            Instr &in = blocks[b].code[j];
+            ForEachUse(in, [&](int &r) { if (!defs[b][r]) uses[b][r] = true; });
+            if (DefinesRegister(in)) defs[b][in.dst] = true;
+        }
+    }
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (int i = rpo.size() - 1; i >= 0; i--) {
+            int b = rpo[i];
+            std::vector<bool> live = uses[b];
+            std::vector<int> succs = Succs(b);
+            for (size_t s = 0; s < succs.size(); s++)
+                for (int r = 0; r < regs; r++)
+                    if (liveIn[succs[s]][r] && !defs[b][r]) live[r] = true;
+            if (live != liveIn[b]) {
+                liveIn[b] = live;
+                changed = true;
+            }
+        }
+    }
+}
+
+/* Method: ZeroUninitialized
+ * -------------------------
+ * Registers other than the parameters that may be read before they are
+ * written are zero when read. Making that an assignment at the entry
+ * gives every use a definition.
+ */
+void SSAFunction::ZeroUninitialized(const std::vector<std::vector<bool> > &liveIn) {
+    std::vector<Instr> zeroes;
+    for (size_t r = f->numParams; r < liveIn[0].size(); r++)
+        if (liveIn[0][r]) zeroes.push_back(Zero(r, f->line));
+    std::vector<Instr> &code = blocks[0].code;
+    code.insert(code.begin(), zeroes.begin(), zeroes.end());
+}
+
+/* Method: Zero
+ * ------------
+ * Returns an instruction setting reg to the zero of its type: 0, false,
+ * 0.0 or null.
+ */
+Instr SSAFunction::Zero(int reg, int line) {
+    Instr in = { opLoadInt, reg, 0, 0, 0, line };
+    valueTypeT type = (valueTypeT)f->regTypes[reg];
+    if (IsReference(type)) in.op = opLoadNull;
+    if (type == vDouble) {
+        std::vector<double> &doubles = module->doubles;
+        in.op = opLoadDouble;
+        for (in.a = 0; in.a < (int)doubles.size(); in.a++)
+            if (doubles[in.a] == 0.0 && !signbit(doubles[in.a])) break;
+        if (in.a == (int)doubles.size()) doubles.push_back(0.0);
+    }
+    return in;
+}
+
+/* Method: PlacePhis
+ * -----------------
+ * Gives each register a phi in every block of the iterated dominance
+ * frontier of its assignments where it is live.
+ */
+void SSAFunction::PlacePhis(const std::vector<std::vector<bool> > &liveIn) {
+    int n = blocks.size(), regs = liveIn[0].size();
+    std::vector<std::vector<int> > frontier(n), defBlocks(regs);
+    for (size_t i = 0; i < rpo.size(); i++) {
+        int b = rpo[i];
+        SSABlock &block = blocks[b];
+        if (block.preds.size() >= 2)
+            for (size_t p = 0; p < block.preds.size(); p++)
+                for (int r = block.preds[p]; r != block.idom; r = blocks[r].idom)
+                    if (frontier[r].empty() || frontier[r].back() != b)
+                        frontier[r].push_back(b);
+        for (size_t j = 0; j < block.code.size(); j++) {
+            Instr &in = block.code[j];
+            if (DefinesRegister(in) && (defBlocks[in.dst].empty() || defBlocks[in.dst].back() != b))
+                defBlocks[in.dst].push_back(b);
+        }
+    }
+    for (int p = 0; p < f->numParams; p++) defBlocks[p].push_back(0);
+
+    std::vector<int> hasPhi(n, -1), queued(n, -1);
+    for (int r = 0; r < regs; r++) {
+        std::vector<int> work = defBlocks[r];
+        for (size_t i = 0; i < work.size(); i++) queued[work[i]] = r;
+        while (!work.empty()) {
+            int b = work.back();
+            work.pop_back();
+            for (size_t i = 0; i < frontier[b].size(); i++) {
+                int d = frontier[b][i];
+                if (hasPhi[d] == r || !liveIn[d][r]) continue;
+                hasPhi[d] = r;
+                Phi phi = { -1, r, std::vector<int>(blocks[d].preds.size(), -1) };
+                blocks[d].phis.push_back(phi);
+                if (queued[d] != r) {
+                    queued[d] = r;
+                    work.push_back(d);
+                }
+            }
+        }
+    }
+}
+
+/* Method: Rename
+ * --------------
+ * Renames the assignments in b and the blocks it dominates; stacks[r]
+ * holds the registers that stand for r, innermost last.
+ */
+void SSAFunction::Rename(int b, std::vector<std::vector<int> > &stacks) {
+    std::vector<int> pushed;
+    SSABlock &block = blocks[b];
+    for (size_t i = 0; i < block.phis.size(); i++) {
+        Phi &phi = block.phis[i];
+        phi.dst = NewReg((valueTypeT)f->regTypes[phi.var]);
+        stacks[phi.var].push_back(phi.dst);
+        pushed.push_back(phi.var);
+    }
+    for (size_t i = 0; i < block.code.size(); i++) {
+        Instr &in = block.code[i];
+        ForEachUse(in, [&](int &r) {
+            Assert(!stacks[r].empty());
+            r = stacks[r].back();
+        });
+        if (!DefinesRegister(in)) continue;
+        int var = in.dst;
+        in.dst = NewReg((valueTypeT)f->regTypes[var]);
+        stacks[var].push_back(in.dst);
+        pushed.push_back(var);
+    }
+    std::vector<int> succs = Succs(b);
+    for (size_t s = 0; s < succs.size(); s++) {
+        SSABlock &succ = blocks[succs[s]];
+        int j = std::find(succ.preds.begin(), succ.preds.end(), b) - succ.preds.begin();
+        for (size_t i = 0; i < succ.phis.size(); i++) {
+            std::vector<int> &stack = stacks[succ.phis[i].var];
+            succ.phis[i].args[j] = stack.empty() ? -1 : stack.back();
+        }
+    }
+    for (size_t i = 0; i < block.children.size(); i++)
+        Rename(block.children[i], stacks);
+    for (size_t i = 0; i < pushed.size(); i++)
+        stacks[pushed[i]].pop_back();
+}
+
+/* Method: LeaveSSA
+ * ----------------
+ * Replaces the phis with copies. A predecessor with other successors
+ * gets a block of its own on the edge first, so the copies run only on
+ * the way into the phis' block. The copies on one edge happen at once,
+ * so they are ordered to write a register only once no other copy
+ * still reads it, and a cycle of them is broken with a temporary.
+ */
+void SSAFunction::LeaveSSA() {
+    int n = blocks.size();
+    for (int b = 0; b < n; b++) {
+        if (blocks[b].phis.empty()) continue;
+        for (size_t j = 0; j < blocks[b].preds.size(); j++) {
+            int p = blocks[b].preds[j];
+            if (Succs(p).size() > 1) SplitEdge(p, b);
+        }
+    }
+    for (int b = 0; b < n; b++) {
+        for (size_t j = 0; j < blocks[b].preds.size(); j++) {
+            std::vector<std::pair<int, int> > copies;
+            for (size_t i = 0; i < blocks[b].phis.size(); i++) {
+                Phi &phi = blocks[b].phis[i];
+                Assert(phi.args[j] >= 0);
+                if (phi.dst != phi.args[j]) copies.push_back(std::make_pair(phi.dst, phi.args[j]));
+            }
+            std::vector<Instr> &code = blocks[blocks[b].preds[j]].code;
+            int line = code.back().line;
+            std::vector<Instr> moves;
+            while (!copies.empty()) {
+                size_t i = 0;
+                for ( ; i < copies.size(); i++) {
+                    size_t k = 0;
+                    while (k < copies.size() && copies[k].second != copies[i].first) k++;
+                    if (k == copies.size()) break;
+                }
+                if (i < copies.size()) {
+                    Instr move = { opMove, copies[i].first, copies[i].second, 0, 0, line };
+                    moves.push_back(move);
+                    copies.erase(copies.begin() + i);
+                    continue;
+                }
+                int saved = copies[0].first;
+                int temp = NewReg((valueTypeT)f->regTypes[saved]);
+                Instr move = { opMove, temp, saved, 0, 0, line };
+                moves.push_back(move);
+                for (size_t k = 0; k < copies.size(); k++)
+                    if (copies[k].second == saved) copies[k].second = temp;
+            }
+            code.insert(code.end() - 1, moves.begin(), moves.end());
+        }
+        blocks[b].phis.clear();
+    }
+}
+
+/* Method: Coalesce
+ * ----------------
+ * Gives the two sides of a copy the same register when their values are
+ * never live at once, which removes most of the copies LeaveSSA adds.
+ * Walking each block backward from what is live at its end, a register
+ * interferes with everything live where it is assigned, except the
+ * source of a copy into it; the parameters are all assigned at the
+ * entry. Copies are merged greedily, the merged register interfering
+ * with whatever either did. A parameter keeps its register.
+ */
+void SSAFunction::Coalesce() {
+    Analyze();
+    int regs = f->regTypes.size();
+    std::vector<std::vector<bool> > liveIn;
+    ComputeLiveIn(liveIn);
+    std::vector<std::set<int> > interferes(regs);
+    for (size_t i = 0; i < rpo.size(); i++) {
+        int b = rpo[i];
+        std::set<int> live;
+        std::vector<int> succs = Succs(b);
+        for (size_t s = 0; s < succs.size(); s++)
+            for (int r = 0; r < regs; r++)
+                if (liveIn[succs[s]][r]) live.insert(r);
+        std::vector<Instr> &code = blocks[b].code;
+        for (int j = code.size() - 1; j >= 0; j--) {
+            Instr &in = code[j];
+            if (DefinesRegister(in)) {
+                live.erase(in.dst);
+                for (std::set<int>::iterator it = live.begin(); it != live.end(); ++it) {
+                    if (in.op == opMove && *it == in.a) continue;
+                    interferes[in.dst].insert(*it);
+                    interferes[*it].insert(in.dst);
+                }
+            }
+            ForEachUse(in, [&](int &r) { live.insert(r); });
+        }
+    }
+    for (int p = 0; p < f->numParams; p++)
+        for (int r = 0; r < regs; r++)
+            if (r != p && liveIn[0][r]) {
+                interferes[p].insert(r);
+                interferes[r].insert(p);
+            }
+
+    std::vector<int> merged(regs);
+    for (int r = 0; r < regs; r++) merged[r] = r;
+    std::function<int(int)> find = [&](int r) {
+        return merged[r] == r ? r : merged[r] = find(merged[r]);
+    };
+    for (size_t i = 0; i < rpo.size(); i++) {
+        std::vector<Instr> &code = blocks[rpo[i]].code;
+        for (size_t j = 0; j < code.size(); j++) {
+            if (code[j].op != opMove) continue;
+            int to = find(code[j].dst), from = find(code[j].a);
+            if (to == from || f->regTypes[to] != f->regTypes[from] || interferes[to].count(from)) continue;
+            if (from < f->numParams) {
+                if (to < f->numParams) continue;
+                std::swap(to, from);
+            }
+            merged[from] = to;
+            for (std::set<int>::iterator it = interferes[from].begin(); it != interferes[from].end(); ++it) {
+                interferes[*it].insert(to);
+                interferes[to].insert(*it);
+            }
+        }
+    }
+    for (size_t i = 0; i < rpo.size(); i++) {
+        std::vector<Instr> &code = blocks[rpo[i]].code, kept;
+        for (size_t j = 0; j < code.size(); j++) {
+            Instr in = code[j];
+            ForEachUse(in, [&](int &r) { r = find(r); });
+            if (DefinesRegister(in)) in.dst = find(in.dst);
+            if (in.op != opMove || in.dst != in.a) kept.push_back(in);
+        }
+        code.swap(kept);
+    }
+}
+
+/* Method: Write
+ * -------------
+ * Writes the blocks back to the Function, each block split off an edge
+ * right after the block the edge leaves, and renumbers the registers so
+ * those no longer used are dropped. A block holding only a jump is left
+ * out, the edges into it going straight to where it jumps.
+ */
+void SSAFunction::Write() {
+    int n = blocks.size();
+    std::vector<int> forward(n), target(n);
+    for (int b = 0; b < n; b++) {
+        std::vector<Instr> &code = blocks[b].code;
+        forward[b] = b > 0 && code.size() == 1 && code[0].op == opJump ? code[0].a : b;
+    }
+    for (int b = 0; b < n; b++) {
+        int t = b;
+        for (int steps = 0; steps < n && forward[t] != t; steps++) t = forward[t];
+        target[b] = forward[t] == t ? t : b;     // a cycle of jumps stays
+    }
+    std::vector<std::vector<int> > split(n);
+    for (int b = 0; b < n; b++)
+        if (blocks[b].after >= 0) split[blocks[b].after].push_back(b);
+    std::vector<int> order, number(n, -1);
+    for (int b = 0; b < n; b++) {
+        if (blocks[b].after >= 0) continue;
+        std::vector<int> pending(1, b);
+        while (!pending.empty()) {
+            int next = pending.back();
+            pending.pop_back();
+            if (!blocks[next].code.empty() && target[next] == next) {
+                number[next] = order.size();
+                order.push_back(next);
+            }
+            pending.insert(pending.end(), split[next].rbegin(), split[next].rend());
+        }
+    }
+    for (int b = 0; b < n; b++) number[b] = number[target[b]];
+
+    std::vector<int> regs(f->regTypes.size(), -1);
+    for (int p = 0; p < f->numParams; p++) regs[p] = p;
+    std::vector<char> regTypes(f->regTypes.begin(), f->regTypes.begin() + f->numParams);
+    std::vector<int> args;
+    f->code.clear();
+    f->blocks.clear();
+    for (size_t i = 0; i < order.size(); i++) {
+        Block block = { (int)f->code.size(), 0, { -1, -1 } };
+        std::vector<Instr> &code = blocks[order[i]].code;
+        for (size_t j = 0; j < code.size(); j++) {
+            Instr in = code[j];
+            if (in.op == opNop) continue;
+            if (in.op == opBranch && number[in.b] == number[in.c]) {
+                in.op = opJump;
+                in.a = in.b;
+            }
+            if (in.op == opJump) in.a = block.succ[0] = number[in.a];
+            if (in.op == opBranch) {
+                in.b = block.succ[0] = number[in.b];
+                in.c = block.succ[1] = number[in.c];
+            }
+            ForEachUse(in, [&](int &r) {
+                if (regs[r] < 0) {
+                    regs[r] = regTypes.size();
+                    regTypes.push_back(f->regTypes[r]);
+                }
+                r = regs[r];
+            });
+            if (OpOperands(in.op)[2] == 'n') {
+                int start = args.size();
+                args.insert(args.end(), f->args.begin() + in.b, f->args.begin() + in.b + in.c);
+                in.b = start;
+            }
+            if (DefinesRegister(in)) {
+                if (regs[in.dst] < 0) {
+                    regs[in.dst] = regTypes.size();
+                    regTypes.push_back(f->regTypes[in.dst]);
+                }
+                in.dst = regs[in.dst];
+            }
+            f->code.push_back(in);
+        }
+        block.end = f->code.size();
+        f->blocks.push_back(block);
+    }
+    f->args = args;
+    f->regTypes = regTypes;
+}
+
+void SSAFunction::Finish() {
+    LeaveSSA();
+    Coalesce();
+    Write();
+}
+
+/* Method: Rebuild
+ * ---------------
+ * Writes the function back and puts it into SSA form again, for a pass
+ * that leaves registers assigned more than once.
+ */
+void SSAFunction::Rebuild() {
+    Finish();
+    *this = SSAFunction(module, f);
+}
@@ -0,0 +1,104 @@
+/* File: ssa.h
+ * -----------
+ * SSAFunction holds one IR function in static single assignment form,
+ * the form the optimizer (see opt.h) works on: every register is
+ * assigned by exactly one instruction or phi, and that definition
+ * dominates all of its uses.
+ *
+ * The function is split into blocks that each keep their instructions,
+ * their predecessors and the phis at their start; a phi has one argument
+ * per predecessor, in the same order. Construction removes the blocks
+ * that cannot be reached, gives each register that may be read before
+ * it is written an explicit zero at the entry (the VM starts registers
+ * out zeroed), computes dominators by the iterative method of Cooper,
+ * Harvey and Kennedy and places phis at the iterated dominance frontier
+ * of each register's assignments, but only where the register is live.
+ * Renaming then walks the dominator tree, giving every assignment a new
+ * register of the same type. The parameters keep their registers.
+ *
+ * Finish() leaves SSA form: critical edges into blocks with phis are
+ * split and each phi becomes copies at the end of its predecessors,
+ * sequenced so that no copy overwrites a value another still needs.
+ * The blocks and registers are then renumbered densely and written back
+ * to the Function.
+ */
+
+#ifndef _H_ssa
+#define _H_ssa
+
+#include <vector>
+#include "tac.h"
+
+struct Phi {
+    int dst;
+    int var;                     // the register it merged before renaming
+    std::vector<int> args;       // one per predecessor
+};
+
+struct SSABlock {
+    std::vector<Phi> phis;
+    std::vector<Instr> code;     // ends in a Jump, Branch or Return; empty if removed
+    std::vector<int> preds;
+    int idom;                    // -1 for the entry and removed blocks
+    std::vector<int> children;   // in the dominator tree
+    int pre, post;               // dominator tree numbering, see Dominates
+    int after;                   // block it was split off, -1 if original
+};
+
+/* Returns whether instructions with opcode op always define dst (for a
+ * call, only when dst >= 0).
+ */
+bool DefinesRegister(const Instr &in);
+
+class SSAFunction
+{
+  protected:
+    void ZeroUninitialized(const std::vector<std::vector<bool> > &liveIn);
+    void ComputeLiveIn(std::vector<std::vector<bool> > &liveIn);
+    void PlacePhis(const std::vector<std::vector<bool> > &liveIn);
+    void Rename(int b, std::vector<std::vector<int> > &stacks);
+    void LeaveSSA();
+    void Coalesce();
+    void Write();
+
+  public:
+    Module *module;
+    Function *f;
+    std::vector<SSABlock> blocks;
+    std::vector<int> rpo;        // the reachable blocks, in reverse postorder
+
+    SSAFunction(Module *module, Function *f);
+
+          // Recomputes the reverse postorder and the dominator tree after
+          // blocks or edges changed.
+    void Analyze();
+    bool Dominates(int a, int b) {
+        return blocks[a].pre <= blocks[b].pre && blocks[b].post <= blocks[a].post;
+    }
+    std::vector<int> Succs(int b);
+    int NewReg(valueTypeT type);
+    Instr Zero(int reg, int line);
+
+          // Edge changes keep the predecessor lists and the phis in step.
+    void RemoveEdge(int from, int to);
+    void RemoveBlock(int b);
+    int SplitEdge(int from, int to);
+
+          // Calls fn(int &reg) on each register instruction in reads.
+    template <class F> void ForEachUse(Instr &in, F fn) {
+        const char *operands = OpOperands(in.op);
+        int *fields[] = { &in.a, &in.b, &in.c };
+        for (int i = 1; i < 4; i++) {
+            if (operands[i] == 'r' && *fields[i-1] >= 0) fn(*fields[i-1]);
+            if (operands[i] == 'n')
+                for (int j = 0; j < in.c; j++) fn(f->args[in.b + j]);
+        }
+    }
+
+          // Leaves SSA form and writes the function back; Rebuild then
+          // enters it again.
+    void Finish();
+    void Rebuild();
+};
+
+#endif
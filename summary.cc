@@ -0,0 +1,233 @@
+/* File: summary.cc
+ * ----------------
+ * Writing and reading of unit summary files.
+ */
+
+#include "summary.h"
+#include "ast_decl.h"
+#include "ast_type.h"
+#include "ast_stmt.h"
+#include "errors.h"
+#include "module.h"
+#include "scanner.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sstream>
+#include <string>
+
+static const char *SummaryMagic = "dcc-summary 1";
+
+
+static std::string TypeName(Type *t) {
+    std::ostringstream s;
+    s << t;
+    return s.str();
+}
+
+static void WriteVar(VarDecl *v, const char *indent, FILE *fp) {
+    fprintf(fp, "%svar %s %s\n", indent, TypeName(v->GetDeclaredType()).c_str(), v->GetName());
+}
+
+static void WriteFn(FnDecl *fn, const char *indent, FILE *fp) {
+    List<VarDecl*> *formals = fn->GetFormals();
+    fprintf(fp, "%sfn %s %s(", indent, TypeName(fn->GetReturnType()).c_str(), fn->GetName());
+    for (int i = 0; i < formals->NumElements(); i++)
+        fprintf(fp, "%s%s", i ? "," : "", TypeName(formals->Nth(i)->GetDeclaredType()).c_str());
+    fprintf(fp, ")\n");
+}
+
+static void WriteMembers(List<Decl*> *members, FILE *fp) {
+    for (int i = 0; i < members->NumElements(); i++) {
+        Decl *d = members->Nth(i);
+        if (dynamic_cast<VarDecl*>(d))
+            WriteVar(dynamic_cast<VarDecl*>(d), "  ", fp);
+        else if (d->IsFnDecl())
+            WriteFn(dynamic_cast<FnDecl*>(d), "  ", fp);
+    }
+    fprintf(fp, "end\n");
+}
+
+void WriteSummary(Program *program, FILE *fp) {
+    List<Decl*> *decls = program->GetDecls();
+    fprintf(fp, "%s\n", SummaryMagic);
+    for (int i = 0; i < decls->NumElements(); i++) {
+        Decl *d = decls->Nth(i);
+        if (d->IsClassDecl()) {
+            ClassDecl *c = dynamic_cast<ClassDecl*>(d);
+            List<NamedType*> *imp = c->GetImplements();
+            fprintf(fp, "class %s", c->GetName());
+            if (c->GetExtends())
+                fprintf(fp, " extends %s", c->GetExtends()->GetId()->GetName());
+            for (int j = 0; j < imp->NumElements(); j++)
+                fprintf(fp, "%s%s", j ? "," : " implements ", imp->Nth(j)->GetId()->GetName());
+            fprintf(fp, "\n");
+            WriteMembers(c->GetMembers(), fp);
+        } else if (d->IsInterfaceDecl()) {
+            InterfaceDecl *in = dynamic_cast<InterfaceDecl*>(d);
+            fprintf(fp, "interface %s\n", in->GetName());
+            WriteMembers(in->GetMembers(), fp);
+        } else if (d->IsFnDecl()) {
+            if (strcmp(d->GetName(), "main"))   // the importer has its own
+                WriteFn(dynamic_cast<FnDecl*>(d), "", fp);
+        } else if (dynamic_cast<VarDecl*>(d)) {
+            WriteVar(dynamic_cast<VarDecl*>(d), "", fp);
+        }
+    }
+}
+
+
+/* Class: SummaryReader
+ * --------------------
+ * Reads a summary one line at a time. Declarations are located on their
+ * line of the summary, which is added to the source files (see
+ * AddSourceFile), so errors about them show it.
+ */
+class SummaryReader
+{
+  protected:
+    const char *path;
+    FILE *fp;
+    int lineNum;
+    char line[1024];
+    yyltype loc;
+    bool ok;
+
+    bool NextLine();
+    void Malformed();
+    Identifier *Ident(const char *name) { return new Identifier(loc, name); }
+    Type *ParseType(const char *str);
+    Decl *ParseMember(char *text);
+    List<Decl*> *ParseMembers();
+
+  public:
+    SummaryReader(const char *p, FILE *f, int file);
+    List<Decl*> *ReadAll();
+};
+
+SummaryReader::SummaryReader(const char *p, FILE *f, int file) : path(p), fp(f), lineNum(0), ok(true) {
+    memset(&loc, 0, sizeof(loc));
+    loc.file = file;
+}
+
+bool SummaryReader::NextLine() {
+    if (!ok || !fgets(line, sizeof(line), fp)) return false;
+    lineNum++;
+    line[strcspn(line, "\r\n")] = '\0';
+    loc.first_line = loc.last_line = lineNum;
+    loc.first_column = 1;
+    loc.last_column = strlen(line);
+    return true;
+}
+
+void SummaryReader::Malformed() {
+    if (ok) ReportError::Formatted(NULL, "Malformed summary file '%s' at line %d", path, lineNum);
+    ok = false;
+}
+
+// A type is a name followed by zero or more [] pairs
+Type *SummaryReader::ParseType(const char *str) {
+    std::string name(str);
+    int dims = 0;
+    while (name.size() > 2 && name.compare(name.size() - 2, 2, "[]") == 0) {
+        name.resize(name.size() - 2);
+        dims++;
+    }
+    Type *builtins[] = {Type::intType, Type::doubleType, Type::boolType,
+                        Type::voidType, Type::stringType};
+    Type *t = NULL;
+    for (int i = 0; i < sizeof(builtins)/sizeof(builtins[0]) && !t; i++)
+        if (name == TypeName(builtins[i])) t = builtins[i];
+    if (!t) t = new NamedType(Ident(name.c_str()));
+    while (dims-- > 0) t = new ArrayType(loc, t);
+    return t;
+}
+
+// Parses "var <type> <name>" or "fn <type> <name>(<type>,...)"
+Decl *SummaryReader::ParseMember(char *text) {
+    char *kind = strtok(text, " ");
+    char *type = strtok(NULL, " ");
+    char *name = strtok(NULL, "(");
+    if (!kind || !type || !name) { Malformed(); return NULL; }
+    if (!strcmp(kind, "var"))
+        return new VarDecl(Ident(name), ParseType(type));
+    if (strcmp(kind, "fn")) { Malformed(); return NULL; }
+
+    char *params = strtok(NULL, ")");
+    List<VarDecl*> *formals = new List<VarDecl*>;
+    for (char *p = params ? strtok(params, ",") : NULL; p; p = strtok(NULL, ",")) {
+        char argName[32];
+        sprintf(argName, "arg%d", formals->NumElements());
+        formals->Append(new VarDecl(Ident(argName), ParseType(p)));
+    }
+    return new FnDecl(Ident(name), ParseType(type), formals);
+}
+
+List<Decl*> *SummaryReader::ParseMembers() {
+    List<Decl*> *members = new List<Decl*>;
+    while (NextLine()) {
+        char *text = line + strspn(line, " ");
+        if (!strcmp(text, "end")) return members;
+        Decl *d = ParseMember(text);
+        if (d) members->Append(d);
+    }
+    Malformed();
+    return members;
+}
+
+List<Decl*> *SummaryReader::ReadAll() {
+    List<Decl*> *decls = new List<Decl*>;
+    if (!NextLine() || strcmp(line, SummaryMagic)) {
+        Malformed();
+        return decls;
+    }
+    while (NextLine()) {
+        if (!strncmp(line, "interface ", 10)) {
+            char *name = strtok(line + 10, " ");
+            if (!name) { Malformed(); break; }
+            Identifier *id = Ident(name);
+            decls->Append(new InterfaceDecl(id, ParseMembers()));
+        } else if (!strncmp(line, "class ", 6)) {
+            char *name = strtok(line + 6, " ");
+            char *word = strtok(NULL, " ");
+            NamedType *extends = NULL;
+            List<NamedType*> *implements = new List<NamedType*>;
+            if (!name) { Malformed(); break; }
+            Identifier *id = Ident(name);
+            if (word && !strcmp(word, "extends")) {
+                char *base = strtok(NULL, " ");
+                if (!base) { Malformed(); break; }
+                extends = new NamedType(Ident(base));
+                word = strtok(NULL, " ");
+            }
+            if (word && !strcmp(word, "implements")) {
+                for (char *in = strtok(NULL, ","); in; in = strtok(NULL, ","))
+                    implements->Append(new NamedType(Ident(in)));
+            } else if (word) {
+                Malformed();
+                break;
+            }
+            decls->Append(new ClassDecl(id, extends, implements, ParseMembers()));
+        } else if (line[0]) {
+            Decl *d = ParseMember(line);
+            if (d) decls->Append(d);
+        }
+    }
+    return decls;
+}
+
+List<Decl*> *ReadSummary(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        ReportError::Formatted(NULL, "Cannot read summary file '%s'", path);
+        return new List<Decl*>;
+    }
+    int len, file = AddSourceFile(path);
+    char *text = ReadSource(fp, &len);
+    RecordSourceLines(file, text, len);
+    free(text);
+    rewind(fp);
+    SummaryReader reader(path, fp, file);
+    List<Decl*> *decls = reader.ReadAll();
+    fclose(fp);
+    return decls;
+}
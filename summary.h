@@ -0,0 +1,52 @@
+/* File: summary.h
+ * ---------------
+ * A summary file records the interface of a compiled unit: its global
+ * variables and functions, its interfaces, and for each class its base
+ * class, implemented interfaces and member signatures. No function bodies
+ * are kept. A unit that uses classes from a library can import the
+ * library's summary instead of including the library source, so checking
+ * the unit costs time proportional to its own size.
+ *
+ * The format is plain text, one declaration per line:
+ *
+ *     dcc-summary 1
+ *     interface Colorable
+ *       fn void SetColor(Color,int)
+ *     end
+ *     class Shape extends Base implements Colorable
+ *       var double area
+ *       fn double GetArea()
+ *     end
+ *     var int count
+ *     fn int Max(int,int)
+ *
+ * Types are written as they are printed in error messages (int, Shape,
+ * double[][]), so they never contain spaces.
+ */
+
+#ifndef _H_summary
+#define _H_summary
+
+#include <stdio.h>
+#include "list.h"
+
+class Program;
+class Decl;
+
+/* Function: WriteSummary
+ * ----------------------
+ * Writes the summary for the declarations of program to fp. Declarations
+ * the program itself imported are not repeated, and neither is main,
+ * which belongs to the program and not to what others can import.
+ */
+void WriteSummary(Program *program, FILE *fp);
+
+/* Function: ReadSummary
+ * ---------------------
+ * Reads the summary file at path and returns the declarations in it,
+ * ready to be handed to Program::Import. Problems are reported through
+ * ReportError and the declarations read so far are returned.
+ */
+List<Decl*> *ReadSummary(const char *path);
+
+#endif
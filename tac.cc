@@ -0,0 +1,166 @@
+/* File: tac.cc
+ * ------------
+ * Opcode tables, lookups and the debug dump of a Module.
+ */
+
+#include "tac.h"
+#include <string.h>
+
+#define TAC_NAME(name, operands) #name,
+static const char *opNames[] = { TAC_OPCODES(TAC_NAME) };
+#undef TAC_NAME
+
+#define TAC_OPERANDS(name, operands) operands,
+static const char *opOperands[] = { TAC_OPCODES(TAC_OPERANDS) };
+#undef TAC_OPERANDS
+
+const char *OpName(int op) { return opNames[op]; }
+const char *OpOperands(int op) { return opOperands[op]; }
+
+const char *TypeName(valueTypeT t) {
+    static const char *names[] = { "int", "bool", "double", "string", "object", "array", "void" };
+    return names[t];
+}
+
+bool IsTailCall(const Function &f, int i) {
+    const Instr &in = f.code[i];
+    if (in.op != opCall && in.op != opCallVirtual && in.op != opCallInterface) return false;
+    return i + 1 < (int)f.code.size() && f.code[i + 1].op == opReturn && f.code[i + 1].a == in.dst;
+}
+
+int Module::FindClass(const char *name) {
+    for (size_t i = 0; i < classes.size(); i++)
+        if (classes[i].name == name) return i;
+    return -1;
+}
+
+/* Method: FindMethod
+ * ------------------
+ * Returns the function implementing method name for an instance of
+ * class cls, looking in its base classes if cls does not define it.
+ */
+int Module::FindMethod(int cls, const char *name) {
+    for (; cls >= 0; cls = classes[cls].base) {
+        std::vector<Method> &methods = classes[cls].methods;
+        for (size_t i = 0; i < methods.size(); i++)
+            if (methods[i].name == name) return methods[i].function;
+    }
+    return -1;
+}
+
+/* Method: FindSlot
+ * ----------------
+ * Returns the vtable slot of a class's method or the itable slot of an
+ * interface's, looking in the base classes if it is inherited.
+ */
+int Module::FindSlot(const Member &method) const {
+    for (int cls = method.cls; cls >= 0; cls = classes[cls].base) {
+        const std::vector<Method> &methods = classes[cls].methods;
+        for (size_t i = 0; i < methods.size(); i++)
+            if (methods[i].name == method.name) return methods[i].slot;
+    }
+    return -1;
+}
+
+static void DumpString(FILE *fp, const std::string &s) {
+    fputc('"', fp);
+    for (size_t i = 0; i < s.size(); i++) {
+        if (s[i] == '\n') fputs("\\n", fp);
+        else if (s[i] == '\t') fputs("\\t", fp);
+        else if (s[i] == '"' || s[i] == '\\') fprintf(fp, "\\%c", s[i]);
+        else fputc(s[i], fp);
+    }
+    fputc('"', fp);
+}
+
+static void DumpOperand(FILE *fp, Module *m, Function *f, const Instr &in, char kind, int value) {
+    switch (kind) {
+      case 'r': if (value < 0) return; fprintf(fp, "r%d", value); break;
+      case 'i': fprintf(fp, "%d", value); break;
+      case 'd': fprintf(fp, "%g", m->doubles[value]); break;
+      case 's': DumpString(fp, m->strings[value]); break;
+      case 'g': fprintf(fp, "@%s", m->globals[value].name.c_str()); break;
+      case 'c': fprintf(fp, "%s", m->classes[value].name.c_str()); break;
+      case 'm': fprintf(fp, "%s.%s", m->classes[m->members[value].cls].name.c_str(),
+                       m->members[value].name.c_str()); break;
+      case 'f': fprintf(fp, "%s", m->functions[value].name.c_str()); break;
+      case 't': fprintf(fp, "%s", TypeName((valueTypeT)value)); break;
+      case 'B': fprintf(fp, "B%d", value); break;
+      case 'n':
+        fprintf(fp, "(");
+        for (int i = 0; i < in.c; i++)
+            fprintf(fp, "%sr%d", i ? ", " : "", f->args[value + i]);
+        fprintf(fp, ")");
+        break;
+    }
+}
+
+static void DumpInstr(FILE *fp, Module *m, Function *f, const Instr &in) {
+    const char *operands = OpOperands(in.op);
+    fprintf(fp, "    ");
+    if (operands[0] == 'r' && in.dst >= 0) fprintf(fp, "r%d = ", in.dst);
+    fprintf(fp, "%s", OpName(in.op));
+    int fields[] = { in.a, in.b, in.c };
+    bool first = true;
+    for (int i = 1; i < 4; i++) {
+        if (operands[i] == '-' || (operands[i] == 'r' && fields[i-1] < 0)) continue;
+        if (operands[i] != 'n') fprintf(fp, first ? " " : ", ");
+        first = false;
+        DumpOperand(fp, m, f, in, operands[i], fields[i-1]);
+        if (operands[i] == 'n') break;
+    }
+    if (in.line) fprintf(fp, "\t\t; line %d", in.line);
+    fprintf(fp, "\n");
+}
+
+/* Method: Dump
+ * ------------
+ * Prints the module in a readable form, used by the "tac" debug key.
+ */
+void Module::Dump(FILE *fp) {
+    for (size_t i = 0; i < classes.size(); i++) {
+        ClassInfo &c = classes[i];
+        fprintf(fp, "%s %s", c.isInterface ? "interface" : "class", c.name.c_str());
+        if (c.base >= 0) fprintf(fp, " extends %s", classes[c.base].name.c_str());
+        for (size_t j = 0; j < c.interfaces.size(); j++)
+            fprintf(fp, "%s%s", j ? ", " : " implements ", classes[c.interfaces[j]].name.c_str());
+        fprintf(fp, "\n");
+        for (size_t j = 0; j < c.fields.size(); j++) {
+            fprintf(fp, "  field %s %s", TypeName(c.fields[j].type), c.fields[j].name.c_str());
+            if (c.fields[j].offset >= 0) fprintf(fp, " +%d", c.fields[j].offset);
+            fprintf(fp, "\n");
+        }
+        for (size_t j = 0; j < c.methods.size(); j++)
+            fprintf(fp, "  method %s\n", c.methods[j].name.c_str());
+        for (size_t j = 0; j < c.vtable.size(); j++)
+            fprintf(fp, "  vtable[%d] %s\n", (int)j, functions[c.vtable[j]].name.c_str());
+        for (size_t j = 0; j < c.itables.size(); j++) {
+            ITable &it = c.itables[j];
+            fprintf(fp, "  itable %s:", classes[it.interface].name.c_str());
+            for (size_t k = 0; k < it.functions.size(); k++)
+                fprintf(fp, " %s", it.functions[k] >= 0 ? functions[it.functions[k]].name.c_str() : "-");
+            fprintf(fp, "\n");
+        }
+    }
+    for (size_t i = 0; i < globals.size(); i++)
+        fprintf(fp, "global %s @%s\n", TypeName(globals[i].type), globals[i].name.c_str());
+    for (size_t i = 0; i < functions.size(); i++) {
+        Function &f = functions[i];
+        fprintf(fp, "\nfunction %s returns %s\n", f.name.c_str(), TypeName(f.returnType));
+        fprintf(fp, "  registers:");
+        for (size_t r = 0; r < f.regTypes.size(); r++)
+            fprintf(fp, " r%d%s%s", (int)r, (int)r < f.numParams ? "*" : ":",
+                   TypeName((valueTypeT)f.regTypes[r]));
+        fprintf(fp, "\n");
+        for (size_t b = 0; b < f.blocks.size(); b++) {
+            Block &block = f.blocks[b];
+            fprintf(fp, "  B%d:", (int)b);
+            for (int s = 0; s < 2; s++)
+                if (block.succ[s] >= 0) fprintf(fp, "%s B%d", s ? "," : " ->", block.succ[s]);
+            fprintf(fp, "\n");
+            for (int j = block.start; j < block.end; j++)
+                DumpInstr(fp, this, &f, f.code[j]);
+        }
+    }
+    fflush(fp);
+}
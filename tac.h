@@ -0,0 +1,231 @@
+/* File: tac.h
+ * -----------
+ * The three-address intermediate representation the checked tree is
+ * lowered to (see irgen.h). A Module holds everything needed to run a
+ * program: its functions, class descriptors, globals and constant pools.
+ *
+ * The IR is stored in flat arrays and refers to other entities only by
+ * index, never by pointer, so passes can walk it sequentially and it can
+ * be copied or written out as is. It does not refer to the parse tree.
+ *
+ * Each function has an array of virtual registers, numbered from 0, each
+ * holding one value of a fixed type. The parameters come first (for a
+ * method, register 0 is "this"). The instructions of a function are kept
+ * in one array, grouped into basic blocks: a block is a range of that
+ * array ending in a Jump, Branch or Return, and it records the blocks
+ * control can flow to next.
+ */
+
+#ifndef _H_tac
+#define _H_tac
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/* Type of the value held by a register, field, global or array element.
+ * Strings, objects and arrays are references to the heap.
+ */
+typedef enum {
+    vInt, vBool, vDouble, vString, vObject, vArray, vVoid
+} valueTypeT;
+
+inline bool IsReference(valueTypeT t) { return t == vString || t == vObject || t == vArray; }
+
+/* The instruction set. Each entry gives the opcode name and the meaning
+ * of the dst, a, b and c fields of the instruction, one character each:
+ *    r  register             i  integer immediate      d  double pool
+ *    s  string pool          g  global                 c  class
+ *    m  member (field/method reference, see Member)    f  function
+ *    t  value type (valueTypeT)                        B  block
+ *    n  argument list: b is the start in Function::args and c the count
+ *    -  unused
+ * A dst of -1 means the result is discarded, and Return has a = -1 when
+ * there is no value. A method call passes the receiver as the first
+ * argument: through a class type it is a CallVirtual naming the method
+ * through that class, which is called from the receiver's vtable slot
+ * for it, through an interface a CallInterface naming the interface's
+ * method, which is found in the receiver class's itable for it.
+ * CheckNull fails if its register is null; the optimizer puts one where
+ * it calls a method directly instead.
+ * ArrayLoadUnchecked and ArrayStoreUnchecked are what the optimizer
+ * (see opt.h) turns an access into once it has shown the array is not
+ * null and the index is within it; they check neither.
+ *
+ * The bulk array instructions stand for a whole loop over the elements
+ * [from, to) of an array, from < to, and fail as its first failing
+ * access would. ArrayFill (array, from, to, value) stores value in each;
+ * ArrayCopy (dst, src, from, to) copies src's elements to dst's, which
+ * are not references; ArraySumI and ArraySumD (sum, array, from, to)
+ * add them to sum, in order.
+ */
+#define TAC_OPCODES(X) \
+    X(Nop,         "----") \
+    X(LoadInt,     "ri--") \
+    X(LoadDouble,  "rd--") \
+    X(LoadString,  "rs--") \
+    X(LoadNull,    "r---") \
+    X(Move,        "rr--") \
+    X(AddI,        "rrr-") \
+    X(SubI,        "rrr-") \
+    X(MulI,        "rrr-") \
+    X(DivI,        "rrr-") \
+    X(ModI,        "rrr-") \
+    X(NegI,        "rr--") \
+    X(AddD,        "rrr-") \
+    X(SubD,        "rrr-") \
+    X(MulD,        "rrr-") \
+    X(DivD,        "rrr-") \
+    X(ModD,        "rrr-") \
+    X(NegD,        "rr--") \
+    X(LtI,         "rrr-") \
+    X(LeI,         "rrr-") \
+    X(GtI,         "rrr-") \
+    X(GeI,         "rrr-") \
+    X(EqI,         "rrr-") \
+    X(NeI,         "rrr-") \
+    X(LtD,         "rrr-") \
+    X(LeD,         "rrr-") \
+    X(GtD,         "rrr-") \
+    X(GeD,         "rrr-") \
+    X(EqD,         "rrr-") \
+    X(NeD,         "rrr-") \
+    X(EqRef,       "rrr-") \
+    X(NeRef,       "rrr-") \
+    X(EqStr,       "rrr-") \
+    X(NeStr,       "rrr-") \
+    X(And,         "rrr-") \
+    X(Or,          "rrr-") \
+    X(Not,         "rr--") \
+    X(LoadGlobal,  "rg--") \
+    X(StoreGlobal, "-gr-") \
+    X(GetField,    "rrm-") \
+    X(SetField,    "-rmr") \
+    X(New,         "rc--") \
+    X(NewArray,    "rrt-") \
+    X(ArrayLoad,   "rrr-") \
+    X(ArrayStore,  "-rrr") \
+    X(ArrayLoadUnchecked,  "rrr-") \
+    X(ArrayStoreUnchecked, "-rrr") \
+    X(ArrayLength, "rr--") \
+    X(ArrayFill,   "--n-") \
+    X(ArrayCopy,   "--n-") \
+    X(ArraySumI,   "r-n-") \
+    X(ArraySumD,   "r-n-") \
+    X(Call,        "rfn-") \
+    X(CallVirtual, "rmn-") \
+    X(CallInterface, "rmn-") \
+    X(CheckNull,   "-r--") \
+    X(ReadInteger, "r---") \
+    X(ReadLine,    "r---") \
+    X(PrintInt,    "-r--") \
+    X(PrintBool,   "-r--") \
+    X(PrintDouble, "-r--") \
+    X(PrintString, "-r--") \
+    X(Jump,        "-B--") \
+    X(Branch,      "-rBB") \
+    X(Return,      "-r--")
+
+#define TAC_ENUM(name, operands) op##name,
+typedef enum { TAC_OPCODES(TAC_ENUM) NumOpCodes } opCodeT;
+#undef TAC_ENUM
+
+const char *OpName(int op);
+const char *OpOperands(int op); // the operand string from the table above
+
+struct Instr {
+    int op;
+    int dst, a, b, c;
+    int line;        // source line, 0 if unknown
+};
+
+struct Block {
+    int start, end;  // instructions [start, end) of Function::code
+    int succ[2];     // successor blocks, -1 if unused
+};
+
+struct Function {
+    std::string name;            // "f" or "Class.f"
+    int cls;                     // class of a method, -1 otherwise
+    int numParams;               // including "this"
+    valueTypeT returnType;
+    int line;
+    std::vector<char> regTypes;  // valueTypeT of each register
+    std::vector<Instr> code;
+    std::vector<Block> blocks;   // block 0 is the entry
+    std::vector<int> args;       // argument registers of the calls
+};
+
+struct Field {
+    std::string name;
+    valueTypeT type;
+    int offset;                  // in bytes, see layout.h; -1 until laid out
+};
+
+struct Method {
+    std::string name;
+    int function;                // -1 for an interface method
+    int slot;                    // vtable slot, or itable slot for an interface
+};
+
+/* The methods a class uses for one interface it implements, in the order
+ * the interface declares them.
+ */
+struct ITable {
+    int interface;
+    std::vector<int> functions;  // -1 if the class has no such method
+};
+
+struct ClassInfo {
+    std::string name;
+    bool isInterface;
+    int base;                    // class extended, -1 if none
+    int size;                    // bytes of header and fields, see layout.h
+    std::vector<int> interfaces; // interfaces implemented
+    std::vector<Field> fields;   // declared in this class only
+    std::vector<Method> methods; // declared in this class only
+    std::vector<int> vtable;     // function of each slot, inherited first
+    std::vector<ITable> itables; // for every interface, including inherited
+};
+
+/* A field or method named through a class or interface. The name is
+ * looked up starting at that class, so it may be inherited.
+ */
+struct Member {
+    int cls;
+    std::string name;
+};
+
+struct Global {
+    std::string name;
+    valueTypeT type;
+};
+
+class Module
+{
+  public:
+    std::vector<Function> functions;
+    std::vector<ClassInfo> classes;
+    std::vector<Member> members;
+    std::vector<Global> globals;
+    std::vector<std::string> strings;
+    std::vector<double> doubles;
+    int mainFunction;            // -1 if there is no main
+
+    Module() : mainFunction(-1) {}
+
+    int FindClass(const char *name);
+    int FindMethod(int cls, const char *name); // function index, -1 if none
+    int FindSlot(const Member &method) const;
+    void Dump(FILE *fp);
+};
+
+const char *TypeName(valueTypeT t);
+
+/* Returns whether instruction i of f is a call whose result the next
+ * instruction returns (or a call of no result followed by a Return of
+ * none): a tail call, after which the caller's frame is no longer used.
+ */
+bool IsTailCall(const Function &f, int i);
+
+#endif
@@ -10,6 +10,7 @@
 #include <string.h>
 
 static List<const char*> debugKeys;
+static List<const char*> optionNames, optionValues;
 static const int BufferSize = 2048;
 
 void Failure(const char *format, ...)
@@ -66,17 +67,33 @@ void PrintDebug(const char *key, const char *format, ...)
 }
 
 
+const char *GetOption(const char *name)
+{
+   for (int i = optionNames.NumElements() - 1; i >= 0; i--)
+      if (!strcmp(optionNames.Nth(i), name)) return optionValues.Nth(i);
+   return NULL;
+}
+
+
 void ParseCommandLine(int argc, char *argv[])
 {
-  if (argc == 1)
+  int i = 1;
+  for (; i < argc && strncmp(argv[i], "--", 2) == 0; i++) {
+    char *name = strdup(argv[i] + 2);
+    char *eq = strchr(name, '=');
+    if (eq) *eq = '\0';
+    optionNames.Append(name);
+    optionValues.Append(eq ? eq + 1 : "");
+  }
+  if (i == argc)
     return;
   
-  if (strcmp(argv[1], "-d") != 0) { // first arg is not -d
-    printf("Usage:   -d <debug-key-1> <debug-key-2> ... \n");
+  if (strcmp(argv[i], "-d") != 0) { // remaining args do not start with -d
+    printf("Usage:   [--option[=value] ...] [-d <debug-key-1> <debug-key-2> ...] \n");
     exit(2);
   }
 
-  for (int i = 2; i < argc; i++)
+  for (i++; i < argc; i++)
     SetDebugForKey(argv[i], true);
 }
 
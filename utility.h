@@ -71,11 +71,23 @@ bool IsDebugOn(const char *key);
 
 
 
+/* Function: GetOption()
+ * Usage: const char *dir = GetOption("cache");
+ * --------------------------------------------
+ * Returns the value given for a --name=value option on the command line,
+ * an empty string if the option was given without a value (--name), or
+ * NULL if it was not given at all.
+ */
+const char *GetOption(const char *name);
+
+
+
 /* Function: ParseCommandLine
  * --------------------------
- * Turn on the debugging flags from the command line.  Verifies that
- * first argument is -d, and then interpret all the arguments that follow
- * as being flags to turn on.
+ * Turn on the debugging flags from the command line.  Any leading
+ * arguments of the form --name or --name=value are recorded as options
+ * (see GetOption). If more arguments follow, the first must be -d, and
+ * all the arguments after it are interpreted as flags to turn on.
  */
 void ParseCommandLine(int argc, char *argv[]);
      
@@ -0,0 +1,760 @@
+/* File: vm.cc
+ * -----------
+ * Translation of the IR to bytecode and the interpreter loop.
+ */
+
+#include "vm.h"
+#include "jit.h"
+#include "io.h"
+#include "utility.h"
+#include "errors.h"
+#include "layout.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <algorithm>
+#include <string>
+#include <chrono>
+
+static const int StackSize = 1 << 20; // Values
+static const int CacheSize = 4;       // classes cached per interface call
+static const size_t CStackSize = 256 << 20; // calls through compiled code nest on it
+
+static_assert(sizeof(HeapObj) == kObjectHeaderSize, "object header size");
+static_assert(sizeof(Value) == 8, "field size of doubles and references");
+
+void RuntimeError(const char *format, ...) {
+    va_list args;
+    FlushOutput();
+    fprintf(stderr, "Decaf runtime error: ");
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+// String constants live as long as the program, outside the heap.
+static HeapObj *ConstantString(const std::string &s) {
+    HeapObj *obj = (HeapObj *)calloc(1, sizeof(HeapObj) + s.size() + 1);
+    obj->type = kStringObj;
+    obj->length = s.size();
+    obj->gc = kInterned;
+    memcpy(CharsOf(obj), s.data(), s.size());
+    return obj;
+}
+
+/* Method: VM
+ * ----------
+ * Prepares a module whose classes are laid out (see layout.h) to run:
+ * finds the field each member reference names, builds the vtables and
+ * itables, allocates the constant strings and globals and translates
+ * every function.
+ */
+VM::VM(Module *m) : module(m) {
+    int nclasses = module->classes.size(), nmembers = module->members.size();
+    fieldOf.assign(nmembers, NULL);
+    for (int i = 0; i < nmembers; i++) {
+        Member &member = module->members[i];
+        for (int c = member.cls; c >= 0 && !fieldOf[i]; c = module->classes[c].base) {
+            std::vector<Field> &fields = module->classes[c].fields;
+            for (size_t j = 0; j < fields.size(); j++)
+                if (fields[j].name == member.name) fieldOf[i] = &fields[j];
+        }
+    }
+
+    heap = new Heap(module, this);
+    for (size_t i = 0; i < module->strings.size(); i++) {
+        HeapObj *&constant = constants[module->strings[i]];
+        if (!constant) constant = ConstantString(module->strings[i]);
+        strings.push_back(constant);
+    }
+    globals = (Value *)calloc(module->globals.size() + 1, sizeof(Value));
+    stack = (Value *)malloc(StackSize * sizeof(Value));
+    stackEnd = stack + StackSize;
+    frames.reserve(1024);
+    current = NULL;
+    currentRegs = NULL;
+    executed = cacheHits = cacheMisses = 0;
+    threaded = false;
+    jit = NULL;
+    tailCallee = NULL;
+    profiler = GetOption("profile") ? new Profiler(module) : NULL;
+#ifdef VM_JIT
+    if (!GetOption("no-jit")) jit = new JIT(this);
+#endif
+    kernels = &GetArrayKernels();
+    const char *threshold = GetOption("jit-threshold");
+    jitThreshold = (threshold && atoi(threshold) > 0) ? atoi(threshold) : 1000;
+
+    code.resize(module->functions.size());
+    for (size_t i = 0; i < code.size(); i++)
+        Translate(i);
+    itablesOf.resize(nclasses);
+    for (int c = 0; c < nclasses; c++) {
+        ClassInfo &info = module->classes[c];
+        vtableStart.push_back(vtables.size());
+        for (size_t i = 0; i < info.vtable.size(); i++)
+            vtables.push_back(&code[info.vtable[i]]);
+        for (size_t i = 0; i < info.itables.size(); i++) {
+            itablesOf[c].push_back(std::make_pair(info.itables[i].interface, (int)itables.size()));
+            for (size_t j = 0; j < info.itables[i].functions.size(); j++) {
+                int fn = info.itables[i].functions[j];
+                itables.push_back(fn >= 0 ? &code[fn] : NULL);
+            }
+        }
+    }
+}
+
+Code *VM::FindInterfaceMethod(int cls, int interface, int slot) {
+    for (size_t i = 0; i < itablesOf[cls].size(); i++)
+        if (itablesOf[cls][i].first == interface && itables[itablesOf[cls][i].second + slot])
+            return itables[itablesOf[cls][i].second + slot];
+    RuntimeError("Class '%s' does not implement '%s'", module->classes[cls].name.c_str(),
+                 module->classes[interface].name.c_str());
+    return NULL;
+}
+
+/* Method: AddInterfaceCall
+ * -------------------------
+ * Encodes the method of a CallInterface as the interface, its itable
+ * slot and the call site's cache: CacheSize (class, callee) pairs, with
+ * a class of -1 for an unused entry.
+ */
+void VM::AddInterfaceCall(std::vector<intptr_t> &words, const Member &method) {
+    words.push_back(method.cls);
+    words.push_back(module->FindSlot(method));
+    for (int i = 0; i < CacheSize; i++) {
+        words.push_back(-1);
+        words.push_back(0);
+    }
+}
+
+/* Method: Translate
+ * -----------------
+ * Encodes one function: each instruction becomes its opcode followed by
+ * the operands its operand string lists, in dst, a, b, c order. Blocks
+ * are laid out in order and a jump to the block that follows is left
+ * out. A field access becomes the variant for the field's size, and a
+ * direct or virtual call whose result is returned right after a tail
+ * call.
+ */
+void VM::Translate(int fn) {
+    const Function &f = module->functions[fn];
+    Code &c = code[fn];
+    c.source = &f;
+    c.numRegs = f.regTypes.size();
+    c.numParams = f.numParams;
+    for (size_t r = 0; r < f.regTypes.size(); r++)
+        if (IsReference((valueTypeT)f.regTypes[r])) c.refRegs.push_back(r);
+    c.hotness = 0;
+    c.native = NULL;
+    std::vector<int> &blockStart = c.blockStarts;
+    blockStart.resize(f.blocks.size());
+    std::vector<std::pair<int, int> > fixups; // word, block
+    for (size_t b = 0; b < f.blocks.size(); b++) {
+        blockStart[b] = c.words.size();
+        for (int i = f.blocks[b].start; i < f.blocks[b].end; i++) {
+            const Instr &in = f.code[i];
+            if (in.op == opJump && in.a == (int)b + 1) continue;
+            c.instrStarts.push_back(c.words.size());
+            c.lines.push_back(in.line);
+            c.words.push_back(in.op);
+            const char *operands = OpOperands(in.op);
+            int fields[] = { in.dst, in.a, in.b, in.c };
+            for (int k = 0; k < 4; k++) {
+                switch (operands[k]) {
+                  case '-':
+                    break;
+                  case 'B':
+                    fixups.push_back(std::make_pair((int)c.words.size(), fields[k]));
+                    c.words.push_back(0);
+                    break;
+                  case 'm':
+                    if (in.op == opCallInterface) {
+                        AddInterfaceCall(c.words, module->members[fields[k]]);
+                    } else if (in.op == opCallVirtual) {
+                        c.words.push_back(module->FindSlot(module->members[fields[k]]));
+                    } else {
+                        const Field *field = fieldOf[fields[k]];
+                        c.words.push_back(field->offset);
+                        int size = SizeOfValue(field->type);
+                        if (size == 1) c.words[c.instrStarts.back()] = (in.op == opGetField) ? opGetField1 : opSetField1;
+                        if (size == 4) c.words[c.instrStarts.back()] = (in.op == opGetField) ? opGetField4 : opSetField4;
+                        if (in.op == opSetField && IsReference(field->type)) c.words[c.instrStarts.back()] = opSetFieldRef;
+                    }
+                    break;
+                  case 'n':
+                    c.words.push_back(in.c);
+                    for (int j = 0; j < in.c; j++)
+                        c.words.push_back(f.args[in.b + j]);
+                    k = 4;
+                    break;
+                  default:
+                    c.words.push_back(fields[k]);
+                    break;
+                }
+            }
+            if (in.op != opCallInterface && IsTailCall(f, i))
+                c.words[c.instrStarts.back()] = (in.op == opCall) ? opTailCall : opTailCallVirtual;
+        }
+    }
+    for (size_t i = 0; i < fixups.size(); i++)
+        c.words[fixups[i].first] = blockStart[fixups[i].second];
+}
+
+/* Method: Thread
+ * --------------
+ * Replaces every opcode word by the address of its handler.
+ */
+void VM::Thread(void **labels) {
+    for (size_t i = 0; i < code.size(); i++)
+        for (size_t j = 0; j < code[i].instrStarts.size(); j++) {
+            intptr_t &word = code[i].words[code[i].instrStarts[j]];
+            word = (intptr_t)labels[word];
+        }
+}
+
+HeapObj *VM::NewObject(int cls) {
+    return heap->Allocate(cls, module->classes[cls].size, module->classes[cls].size);
+}
+
+HeapObj *VM::NewArray(int length, valueTypeT elemType) {
+    int type = IsReference(elemType) ? kRefArrayObj : kArrayObj;
+    return heap->Allocate(type, length, sizeof(HeapObj) + (long)length * sizeof(Value));
+}
+
+HeapObj *VM::NewString(const char *chars, int length) {
+    HeapObj *obj = heap->Allocate(kStringObj, length, sizeof(HeapObj) + length + 1);
+    memcpy(CharsOf(obj), chars, length);
+    return obj;
+}
+
+/* Method: LineString
+ * ------------------
+ * Returns the string for a line read in: the constant with the same
+ * characters if there is one, so that every string equal to a constant
+ * is that constant, or else a new string.
+ */
+HeapObj *VM::LineString(const std::string &line) {
+    std::map<std::string, HeapObj*>::iterator it = constants.find(line);
+    return it != constants.end() ? it->second : NewString(line.data(), line.size());
+}
+
+/* Method: ArrayOp
+ * ---------------
+ * The accesses of the loop a bulk instruction stands for are checked up
+ * front, in the order the loop makes them: the first access to each
+ * array, then whether the last is within it. Nothing else runs between
+ * the accesses, so only the error the loop would stop with shows.
+ */
+Value VM::ArrayOp(int op, Value a, Value b, Value c, Value d) {
+    Value result;
+    result.d = 0;
+    bool fill = op == opArrayFill;
+    HeapObj *array = fill ? a.p : b.p;   // the array filled, or read
+    int from = fill ? b.i : c.i, to = fill ? c.i : d.i;
+    if (!array) RuntimeError("Null array reference");
+    if (from < 0 || from >= array->length) RuntimeError("Array subscript out of bounds");
+    if (op == opArrayCopy && !a.p) RuntimeError("Null array reference");
+    if (to > array->length || (op == opArrayCopy && to > a.p->length))
+        RuntimeError("Array subscript out of bounds");
+
+    uint64_t *elements = (uint64_t *)(ElementsOf(array) + from);
+    switch (op) {
+      case opArrayFill: {
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        if (array->type == kRefArrayObj) heap->WriteBarrier(array, d.p);
+        kernels->fill(elements, to - from, bits);
+        break;
+      }
+      case opArrayCopy:
+        kernels->copy((uint64_t *)(ElementsOf(a.p) + from), elements, to - from);
+        break;
+      case opArraySumI:
+        result.i = (unsigned)a.i + (unsigned)kernels->sumInts(elements, to - from);
+        break;
+      case opArraySumD:
+        result.d = a.d;
+        for (int i = from; i < to; i++) result.d += ElementsOf(array)[i].d;
+        break;
+    }
+    return result;
+}
+
+/* Method: VisitRoots
+ * ------------------
+ * Visits the reference registers of the running frame and its callers,
+ * and the reference globals.
+ */
+void VM::VisitRoots(const SlotVisitor &visit) {
+    for (size_t f = 0; f <= frames.size(); f++) {
+        Code *fc = (f < frames.size()) ? frames[f].code : current;
+        Value *regs = (f < frames.size()) ? frames[f].regs : currentRegs;
+        for (size_t i = 0; i < fc->refRegs.size(); i++)
+            visit(&regs[fc->refRegs[i]].p);
+    }
+    for (size_t g = 0; g < module->globals.size(); g++)
+        if (IsReference(module->globals[g].type)) visit(&globals[g].p);
+}
+
+/* Function: EqualStrings
+ * -----------------------
+ * Strings equal to a constant are that constant (see LineString), so
+ * two different strings can only be equal if neither is a constant.
+ */
+bool EqualStrings(HeapObj *a, HeapObj *b) {
+    static bool (*equalBytes)(const char *, const char *, long) = GetArrayKernels().equalBytes;
+    if (a == b) return true;
+    if (!a || !b || a->length != b->length || ((a->gc | b->gc) & kInterned)) return false;
+    return equalBytes(CharsOf(a), CharsOf(b), a->length);
+}
+
+#define W(k)  (pc[k])
+#define R(k)  (r[pc[k]])
+
+#ifdef VM_THREADED
+#define CASE(name)  L_##name:
+#define NEXT()      do { count++; goto *(void *)*pc; } while (0)
+#define DISPATCH()  NEXT();
+#else
+#define CASE(name)  case op##name:
+#define NEXT()      do { count++; goto dispatch; } while (0)
+#define DISPATCH()  dispatch: switch (*pc)
+#endif
+
+// before anything that allocates, so the collector finds the frame
+#define SAVE_FRAME()  (current = c, currentRegs = r)
+
+// at calls, returns and back edges, samples if the profiler's timer ticked
+#define POLL() do { \
+        if (Profiler::ticks.load(std::memory_order_relaxed)) Sample(c, LineAt(c, pc)); \
+    } while (0)
+
+// to the block at word offset target, counting the back edges
+#define GOTO(target) do { \
+        intptr_t to = (target); \
+        if (to <= pc - start) { \
+            POLL(); \
+            if (Compiled(c)) { result = RunNative(c, r, to); goto ret; } \
+        } \
+        pc = start + to; NEXT(); \
+    } while (0)
+
+#define BINARY(name, field, expr) \
+    CASE(name) { R(1).field = (expr); pc += 4; NEXT(); }
+
+/* Method: Compiled
+ * ----------------
+ * Counts a call of c or a back edge taken in it, compiling it when that
+ * makes it hot. Returns whether it has compiled code.
+ */
+bool VM::Compiled(Code *c) {
+#ifdef VM_JIT
+    if (c->native) return true;
+    if (jit && ++c->hotness >= jitThreshold) return jit->Compile(c);
+#endif
+    return false;
+}
+
+/* Method: RunNative
+ * -----------------
+ * Runs the compiled code of c in the frame regs from the block starting
+ * at word offset, until the function returns. Compiled code makes a
+ * tail call by setting up the callee's frame in place of its own and
+ * returning with tailCallee set, so the callee runs from here, without
+ * nesting.
+ */
+Value VM::RunNative(Code *c, Value *regs, intptr_t offset) {
+    Value result;
+    result.d = 0;
+#ifdef VM_JIT
+    if ((char *)&result < stackLimit) RuntimeError("Stack overflow");
+    for (;;) {
+        int block = std::lower_bound(c->blockStarts.begin(), c->blockStarts.end(), offset) - c->blockStarts.begin();
+        current = c;
+        currentRegs = regs;
+        uint64_t bits = ((NativeCode)c->native)(regs, c->entries[block]);
+        memcpy(&result, &bits, sizeof(result));
+        if (!tailCallee) break;
+        c = tailCallee;
+        tailCallee = NULL;
+        offset = 0;
+        if (!Compiled(c)) {
+            current = c;
+            return Interpret(c, regs);
+        }
+    }
+#endif
+    return result;
+}
+
+/* Method: Call
+ * ------------
+ * Runs callee, whose frame regs holds its arguments, compiled or in a
+ * nested interpreter. Used where the caller cannot simply continue in
+ * the callee: when the callee has compiled code or the caller has.
+ */
+Value VM::Call(const Frame &caller, Code *callee, Value *regs) {
+    frames.push_back(caller);
+    current = callee;
+    currentRegs = regs;
+    Value result = Compiled(callee) ? RunNative(callee, regs, 0) : Interpret(callee, regs);
+    frames.pop_back();
+    current = caller.code;
+    currentRegs = caller.regs;
+    return result;
+}
+
+/* Method: LineAt
+ * --------------
+ * Returns the source line of the instruction of c at pc.
+ */
+int VM::LineAt(Code *c, const intptr_t *pc) {
+    std::vector<int> &starts = c->instrStarts;
+    size_t i = std::upper_bound(starts.begin(), starts.end(), pc - c->words.data()) - starts.begin();
+    return i ? c->lines[i - 1] : 0;
+}
+
+/* Method: Sample
+ * --------------
+ * Takes a profile sample, if the timer ticked since the last one: leaf
+ * is running at line, called from the functions on frames.
+ */
+void VM::Sample(Code *leaf, int line) {
+    int weight = Profiler::ticks.exchange(0);
+    if (!weight || !profiler) return;
+    std::vector<int> stack;
+    size_t first = 0;
+    if (frames.size() >= (size_t)Profiler::MaxDepth) {
+        first = frames.size() - (Profiler::MaxDepth - 2);
+        stack.push_back(-1);
+    }
+    for (size_t f = first; f < frames.size(); f++)
+        stack.push_back(frames[f].code - code.data());
+    stack.push_back(leaf - code.data());
+    profiler->Add(stack, line, weight);
+}
+
+/* Method: Interpret
+ * -----------------
+ * Runs the function of code c in the frame regs until it returns and
+ * returns its result. Calls do not recurse on the C stack: the caller's
+ * state is pushed on frames and the callee's registers start right after
+ * the caller's on the VM stack. Only a call of a compiled function, or
+ * from one (see Call), nests. A tail call pushes nothing: the callee's
+ * registers replace the caller's and it returns to the caller's caller.
+ *
+ * A jump back to an earlier block counts towards compiling the
+ * function; once it is compiled, the rest of the call runs compiled,
+ * starting at that block.
+ */
+Value VM::Interpret(Code *c, Value *regs) {
+#ifdef VM_THREADED
+#define LABEL(name, operands) &&L_##name,
+    static void *labels[] = { TAC_OPCODES(LABEL) VM_OPCODES(LABEL) };
+#undef LABEL
+    if (!threaded) Thread(labels);
+    threaded = true;
+#endif
+    Code *callee;
+    intptr_t *argv;
+    Value *r = regs;
+    intptr_t *start = c->words.data(), *pc = start;
+    const double *doubles = module->doubles.data();
+    long long count = 0, hits = 0, misses = 0;
+    size_t base = frames.size();
+    Value result;
+
+    DISPATCH() {
+      CASE(Nop)         pc += 1; NEXT();
+      CASE(LoadInt)     R(1).i = W(2); pc += 3; NEXT();
+      CASE(LoadDouble)  R(1).d = doubles[W(2)]; pc += 3; NEXT();
+      CASE(LoadString)  R(1).p = strings[W(2)]; pc += 3; NEXT();
+      CASE(LoadNull)    R(1).p = NULL; pc += 2; NEXT();
+      CASE(Move)        R(1) = R(2); pc += 3; NEXT();
+
+      BINARY(AddI, i, (int)((unsigned)R(2).i + (unsigned)R(3).i))  // int arithmetic wraps
+      BINARY(SubI, i, (int)((unsigned)R(2).i - (unsigned)R(3).i))
+      BINARY(MulI, i, (int)((unsigned)R(2).i * (unsigned)R(3).i))
+      CASE(DivI)                // dividing INT_MIN by -1 wraps
+        if (R(3).i == 0) RuntimeError("Division by zero");
+        R(1).i = R(3).i == -1 ? (int)(0u - (unsigned)R(2).i) : R(2).i / R(3).i; pc += 4; NEXT();
+      CASE(ModI)
+        if (R(3).i == 0) RuntimeError("Division by zero");
+        R(1).i = R(3).i == -1 ? 0 : R(2).i % R(3).i; pc += 4; NEXT();
+      CASE(NegI)        R(1).i = (int)(0u - (unsigned)R(2).i); pc += 3; NEXT();
+      BINARY(AddD, d, R(2).d + R(3).d)
+      BINARY(SubD, d, R(2).d - R(3).d)
+      BINARY(MulD, d, R(2).d * R(3).d)
+      BINARY(DivD, d, R(2).d / R(3).d)
+      BINARY(ModD, d, fmod(R(2).d, R(3).d))
+      CASE(NegD)        R(1).d = -R(2).d; pc += 3; NEXT();
+
+      BINARY(LtI, i, R(2).i < R(3).i)
+      BINARY(LeI, i, R(2).i <= R(3).i)
+      BINARY(GtI, i, R(2).i > R(3).i)
+      BINARY(GeI, i, R(2).i >= R(3).i)
+      BINARY(EqI, i, R(2).i == R(3).i)
+      BINARY(NeI, i, R(2).i != R(3).i)
+      BINARY(LtD, i, R(2).d < R(3).d)
+      BINARY(LeD, i, R(2).d <= R(3).d)
+      BINARY(GtD, i, R(2).d > R(3).d)
+      BINARY(GeD, i, R(2).d >= R(3).d)
+      BINARY(EqD, i, R(2).d == R(3).d)
+      BINARY(NeD, i, R(2).d != R(3).d)
+      BINARY(EqRef, i, R(2).p == R(3).p)
+      BINARY(NeRef, i, R(2).p != R(3).p)
+      BINARY(EqStr, i, EqualStrings(R(2).p, R(3).p))
+      BINARY(NeStr, i, !EqualStrings(R(2).p, R(3).p))
+      BINARY(And, i, R(2).i && R(3).i)
+      BINARY(Or, i, R(2).i || R(3).i)
+      CASE(Not)         R(1).i = !R(2).i; pc += 3; NEXT();
+
+      CASE(LoadGlobal)  R(1) = globals[W(2)]; pc += 3; NEXT();
+      CASE(StoreGlobal) globals[W(1)] = R(2); pc += 3; NEXT();
+      CASE(GetField)
+        if (!R(2).p) RuntimeError("Null object reference");
+        memcpy(&R(1), FieldAt(R(2).p, W(3)), 8); pc += 4; NEXT();
+      CASE(GetField4)
+        if (!R(2).p) RuntimeError("Null object reference");
+        R(1).i = *(int *)FieldAt(R(2).p, W(3)); pc += 4; NEXT();
+      CASE(GetField1)
+        if (!R(2).p) RuntimeError("Null object reference");
+        R(1).i = *(unsigned char *)FieldAt(R(2).p, W(3)); pc += 4; NEXT();
+      CASE(SetField)
+        if (!R(1).p) RuntimeError("Null object reference");
+        memcpy(FieldAt(R(1).p, W(2)), &R(3), 8); pc += 4; NEXT();
+      CASE(SetFieldRef)
+        if (!R(1).p) RuntimeError("Null object reference");
+        heap->WriteBarrier(R(1).p, R(3).p);
+        *(HeapObj **)FieldAt(R(1).p, W(2)) = R(3).p; pc += 4; NEXT();
+      CASE(SetField4)
+        if (!R(1).p) RuntimeError("Null object reference");
+        *(int *)FieldAt(R(1).p, W(2)) = R(3).i; pc += 4; NEXT();
+      CASE(SetField1)
+        if (!R(1).p) RuntimeError("Null object reference");
+        *(unsigned char *)FieldAt(R(1).p, W(2)) = R(3).i; pc += 4; NEXT();
+      CASE(New)
+        SAVE_FRAME();
+        R(1).p = NewObject(W(2)); pc += 3; NEXT();
+      CASE(NewArray)
+        if (R(2).i <= 0) RuntimeError("Array size is <= 0");
+        SAVE_FRAME();
+        R(1).p = NewArray(R(2).i, (valueTypeT)W(3)); pc += 4; NEXT();
+      CASE(ArrayLoad) {
+        HeapObj *a = R(2).p;
+        if (!a) RuntimeError("Null array reference");
+        if ((unsigned)R(3).i >= (unsigned)a->length) RuntimeError("Array subscript out of bounds");
+        R(1) = ElementsOf(a)[R(3).i]; pc += 4; NEXT();
+      }
+      CASE(ArrayStore) {
+        HeapObj *a = R(1).p;
+        if (!a) RuntimeError("Null array reference");
+        if ((unsigned)R(2).i >= (unsigned)a->length) RuntimeError("Array subscript out of bounds");
+        if (a->type == kRefArrayObj) heap->WriteBarrier(a, R(3).p);
+        ElementsOf(a)[R(2).i] = R(3); pc += 4; NEXT();
+      }
+      CASE(ArrayLoadUnchecked)
+        R(1) = ElementsOf(R(2).p)[R(3).i]; pc += 4; NEXT();
+      CASE(ArrayStoreUnchecked) {
+        HeapObj *a = R(1).p;
+        if (a->type == kRefArrayObj) heap->WriteBarrier(a, R(3).p);
+        ElementsOf(a)[R(2).i] = R(3); pc += 4; NEXT();
+      }
+      CASE(ArrayFill)
+        ArrayOp(opArrayFill, R(2), R(3), R(4), R(5)); pc += 6; NEXT();
+      CASE(ArrayCopy)
+        ArrayOp(opArrayCopy, R(2), R(3), R(4), R(5)); pc += 6; NEXT();
+      CASE(ArraySumI)
+        R(1) = ArrayOp(opArraySumI, R(3), R(4), R(5), R(6)); pc += 7; NEXT();
+      CASE(ArraySumD)
+        R(1) = ArrayOp(opArraySumD, R(3), R(4), R(5), R(6)); pc += 7; NEXT();
+      CASE(ArrayLength)
+        if (!R(2).p) RuntimeError("Null array reference");
+        R(1).i = R(2).p->length; pc += 3; NEXT();
+      CASE(CheckNull)
+        if (!R(1).p) RuntimeError("Null object reference");
+        pc += 2; NEXT();
+
+      CASE(Call)
+        callee = &code[W(2)];
+        argv = pc + 3;
+        goto call;
+      CASE(CallVirtual)
+        if (!R(4).p) RuntimeError("Null object reference");
+        callee = vtables[vtableStart[R(4).p->type] + W(2)];
+        argv = pc + 3;
+        goto call;
+      CASE(TailCall)
+        callee = &code[W(2)];
+        argv = pc + 3;
+        goto tailcall;
+      CASE(TailCallVirtual)
+        if (!R(4).p) RuntimeError("Null object reference");
+        callee = vtables[vtableStart[R(4).p->type] + W(2)];
+        argv = pc + 3;
+        goto tailcall;
+      CASE(CallInterface) {
+        argv = pc + 4 + 2 * CacheSize;
+        HeapObj *receiver = r[argv[1]].p;
+        if (!receiver) RuntimeError("Null object reference");
+        intptr_t *entry = pc + 4;
+        while (entry < argv && *entry != receiver->type && *entry >= 0)
+            entry += 2;
+        if (entry < argv && *entry == receiver->type) {
+            callee = (Code *)entry[1];
+            hits++;
+        } else {
+            callee = FindInterfaceMethod(receiver->type, W(2), W(3));
+            misses++;
+            if (entry < argv) {
+                entry[0] = receiver->type;
+                entry[1] = (intptr_t)callee;
+            }
+        }
+      }
+      call: {
+        // argv points at the argument count, followed by the registers
+        POLL();
+        int n = argv[0];
+        Value *regs = r + c->numRegs;
+        if (regs + callee->numRegs > stackEnd) RuntimeError("Stack overflow");
+        for (int k = 0; k < n; k++)
+            regs[k] = r[argv[1 + k]];
+        memset(regs + n, 0, (callee->numRegs - n) * sizeof(Value));
+        Frame caller = { c, argv + 1 + n, r, (int)W(1) };
+        if (Compiled(callee)) {
+            result = Call(caller, callee, regs);
+            if (caller.dst >= 0) r[caller.dst] = result;
+            pc = caller.pc;
+            NEXT();
+        }
+        frames.push_back(caller);
+        c = callee;
+        r = regs;
+        pc = start = c->words.data();
+        NEXT();
+      }
+      tailcall: {
+        // the arguments go above the frame first, as they may be read
+        // from the registers they are copied to
+        POLL();
+        int n = argv[0];
+        Value *staged = r + c->numRegs;
+        if (r + callee->numRegs > stackEnd || staged + n > stackEnd) RuntimeError("Stack overflow");
+        for (int k = 0; k < n; k++)
+            staged[k] = r[argv[1 + k]];
+        memmove(r, staged, n * sizeof(Value));
+        memset(r + n, 0, (callee->numRegs - n) * sizeof(Value));
+        c = callee;
+        if (Compiled(c)) {
+            SAVE_FRAME();
+            result = RunNative(c, r, 0);
+            goto ret;
+        }
+        pc = start = c->words.data();
+        NEXT();
+      }
+      CASE(Return)
+        POLL();
+        if (W(1) >= 0) result = R(1);
+        else result.d = 0;
+      ret:
+        if (frames.size() == base) goto done;
+        {
+            Frame &caller = frames.back();
+            if (caller.dst >= 0) caller.regs[caller.dst] = result;
+            c = caller.code;
+            r = caller.regs;
+            pc = caller.pc;
+            start = c->words.data();
+            frames.pop_back();
+        }
+        NEXT();
+
+      CASE(ReadInteger) R(1).i = ReadInputInteger(); pc += 2; NEXT();
+      CASE(ReadLine) {
+        std::string line = ReadInputLine();
+        SAVE_FRAME();
+        R(1).p = LineString(line); pc += 2; NEXT();
+      }
+      CASE(PrintInt)    PrintInt(R(1).i); pc += 2; NEXT();
+      CASE(PrintBool)   PrintChars(R(1).i ? "true" : "false", R(1).i ? 4 : 5); pc += 2; NEXT();
+      CASE(PrintDouble) PrintDouble(R(1).d); pc += 2; NEXT();
+      CASE(PrintString) PrintChars(CharsOf(R(1).p), R(1).p->length); pc += 2; NEXT();
+
+      CASE(Jump)        GOTO(W(1));
+      CASE(Branch)      GOTO(R(1).i ? W(2) : W(3));
+    }
+done:
+    executed += count;
+    cacheHits += hits;
+    cacheMisses += misses;
+    return result;
+}
+
+/* Method: RunMain
+ * ---------------
+ * Runs main on the calling thread, whose stack is cStackSize bytes.
+ */
+void *VM::RunMain(void *arg) {
+    VM *vm = (VM *)arg;
+    char here;
+    vm->stackLimit = &here - vm->cStackSize + (1 << 20); // leave 1 MB for the helpers
+    Code *main = &vm->code[vm->module->mainFunction];
+    memset(vm->stack, 0, main->numRegs * sizeof(Value));
+    vm->current = main;
+    vm->currentRegs = vm->stack;
+    vm->Interpret(main, vm->stack);
+    return NULL;
+}
+
+int VM::Run() {
+    if (module->mainFunction < 0) {
+        ReportError::Formatted(NULL, "Linker: function 'main' not defined");
+        return -1;
+    }
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    fflush(stdout);                // the program's output bypasses stdio
+    pthread_attr_t attr;
+    pthread_t thread;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, CStackSize);
+    cStackSize = CStackSize;
+    const char *rate = GetOption("profile-rate");
+    if (profiler) profiler->Start((rate && atoi(rate) > 0) ? atoi(rate) : 997);
+    if (pthread_create(&thread, &attr, RunMain, this) == 0) {
+        pthread_join(thread, NULL);
+    } else {
+        struct rlimit limit;
+        cStackSize = 8 << 20;
+        if (getrlimit(RLIMIT_STACK, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+            cStackSize = std::min((size_t)limit.rlim_cur, CStackSize);
+        RunMain(this);
+    }
+    pthread_attr_destroy(&attr);
+    FlushOutput();
+    if (profiler) {
+        profiler->Stop();
+        const char *path = *GetOption("profile") ? GetOption("profile") : "profile.folded";
+        if (!profiler->Write(path)) ReportError::Formatted(NULL, "Cannot write profile file '%s'", path);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    if (GetOption("vm-stats")) {
+        fprintf(stderr, "vm: %lld bytecodes in %.3f s, %.1f million bytecodes/s\n",
+                executed, seconds, seconds > 0 ? executed / seconds / 1e6 : 0.0);
+        fprintf(stderr, "vm: %lld interface calls, %lld found in the call site cache\n",
+                cacheHits + cacheMisses, cacheHits);
+#ifdef VM_JIT
+        if (jit) jit->PrintStats(stderr);
+#endif
+    }
+    if (GetOption("gc-stats")) heap->PrintStats(stderr, seconds);
+    return 0;
+}
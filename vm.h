@@ -0,0 +1,182 @@
+/* File: vm.h
+ * ----------
+ * The bytecode virtual machine that runs a lowered program in-process.
+ *
+ * Each IR function is translated to a compact array of words: an opcode
+ * word followed by one word per operand the opcode uses (see the operand
+ * strings in tac.h), so most instructions take two to four words. Block
+ * targets become word offsets and field references become byte
+ * offsets; other operands are copied as they are. A call lists its argument
+ * registers in the words after it, and the callee's frame is set up
+ * straight from them.
+ *
+ * Like the IR, the machine is register based: each call gets a frame of
+ * Values on the VM stack, one per virtual register, and instructions name
+ * their operands by frame index instead of pushing and popping them.
+ * Objects, arrays and strings read in live in the collected heap (see
+ * gc.h); the reference-typed registers of the frames are its roots.
+ * String constants are interned: each is made once, outside the heap,
+ * and a line read in that equals one is that constant, so comparing a
+ * string with a constant only needs its address.
+ *
+ * A CallVirtual loads the callee from the receiver's vtable. A
+ * CallInterface has to search the receiver's class for its itable for
+ * the interface, so each call site caches the classes it has seen with
+ * the method each one resolved to: up to four, after which further
+ * classes are looked up every time.
+ *
+ * With GCC or Clang the interpreter uses direct threading: before the
+ * first run every opcode word is replaced by the address of the code
+ * that handles it, and each handler jumps straight to the next one
+ * ("computed goto"). Elsewhere, or when built with -DVM_SWITCH_DISPATCH,
+ * it falls back to a switch in a loop.
+ *
+ * The bulk array instructions run with the SIMD kernels of simd.h.
+ *
+ * On x86-64 Linux, functions that run often are compiled to machine code
+ * (see jit.h).
+ *
+ * --profile samples where the program spends its time (see profile.h).
+ */
+
+#ifndef _H_vm
+#define _H_vm
+
+#include <stdint.h>
+#include <string>
+#include <map>
+#include <vector>
+#include "tac.h"
+#include "gc.h"
+#include "simd.h"
+#include "profile.h"
+
+#if defined(__GNUC__) && !defined(VM_SWITCH_DISPATCH)
+#define VM_THREADED 1
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__linux__)
+#define VM_JIT 1
+#endif
+
+class JIT;
+
+/* A function translated to bytecode.
+ */
+struct Code {
+    const Function *source;
+    int numRegs, numParams;
+    std::vector<intptr_t> words;
+    std::vector<int> instrStarts;  // word offset of each instruction
+    std::vector<int> lines;        // and its source line, 0 if unknown
+    std::vector<int> refRegs;      // registers holding references
+    std::vector<int> blockStarts;  // word offset of each block
+    int hotness;                   // calls and back edges taken so far
+    uint8_t *native;               // compiled code, NULL if not compiled
+    std::vector<uint8_t*> entries; // where each block starts in it
+};
+
+/* A suspended caller: where to continue and which of its registers
+ * receives the result. A caller running compiled code has no pc.
+ */
+struct Frame {
+    Code *code;
+    intptr_t *pc;
+    Value *regs;
+    int dst;
+};
+
+/* Opcodes the VM uses besides those of the IR. GetField and SetField
+ * move 8 bytes; the translation picks the 1 or 4 byte variant for bool
+ * and int fields, and SetFieldRef, which calls the write barrier, for
+ * reference fields. A Call or CallVirtual right before a Return of its
+ * result becomes a TailCall or TailCallVirtual, which runs the callee
+ * in the caller's frame.
+ */
+#define VM_OPCODES(X) \
+    X(GetField1,   "rrm-") \
+    X(GetField4,   "rrm-") \
+    X(SetField1,   "-rmr") \
+    X(SetField4,   "-rmr") \
+    X(SetFieldRef, "-rmr") \
+    X(TailCall,    "rfn-") \
+    X(TailCallVirtual, "rmn-")
+
+#define VM_ENUM(name, operands) op##name,
+enum { opLastIR = NumOpCodes - 1, VM_OPCODES(VM_ENUM) NumVMOpCodes };
+#undef VM_ENUM
+
+class VM : public RootSet
+{
+    friend class JIT;
+
+  protected:
+    Module *module;
+    Heap *heap;
+    std::vector<Code> code;
+    std::vector<const Field*> fieldOf; // per member, the field it names
+    std::vector<Code*> vtables;    // the vtables of all classes in a row
+    std::vector<int> vtableStart;  // per class, its first entry in vtables
+    std::vector<Code*> itables;    // the itables of all classes in a row
+    std::vector<std::vector<std::pair<int, int> > > itablesOf; // per class: interface, start
+    std::vector<HeapObj*> strings; // the string pool, outside the heap
+    std::map<std::string, HeapObj*> constants; // the pool by characters
+    Value *globals;
+    Value *stack, *stackEnd;
+    std::vector<Frame> frames;
+    Code *current;                 // the running frame, saved before
+    Value *currentRegs;            // anything that may collect
+    long long executed, cacheHits, cacheMisses;
+    bool threaded;
+    JIT *jit;                      // NULL if not compiling
+    const ArrayKernels *kernels;   // for the bulk array instructions
+    int jitThreshold;
+    size_t cStackSize;             // the C stack main runs on, which
+    char *stackLimit;              // calls through compiled code use
+    Code *tailCallee;              // to run next in the frame compiled
+                                   // code returned from, or NULL
+    Profiler *profiler;            // NULL if not profiling
+
+    void AddInterfaceCall(std::vector<intptr_t> &words, const Member &method);
+    void Translate(int fn);
+    void Thread(void **labels);
+    Value Interpret(Code *c, Value *regs);
+    Code *FindInterfaceMethod(int cls, int interface, int slot);
+    bool Compiled(Code *c);
+    Value RunNative(Code *c, Value *regs, intptr_t offset);
+    Value Call(const Frame &caller, Code *callee, Value *regs);
+    int LineAt(Code *c, const intptr_t *pc);
+    void Sample(Code *leaf, int line);
+    static void *RunMain(void *vm);
+
+  public:
+    VM(Module *module);
+
+          // Runs main and returns the exit status: 0, or -1 if there is
+          // no main. A runtime error exits with status 1. --vm-stats
+          // reports how many bytecodes ran and how fast, --profile
+          // writes where the time went. main runs on a thread of its
+          // own with a large stack.
+    int Run();
+
+    void VisitRoots(const SlotVisitor &visit);
+
+    HeapObj *NewObject(int cls);
+    HeapObj *NewArray(int length, valueTypeT elemType);
+    HeapObj *NewString(const char *chars, int length);
+    HeapObj *LineString(const std::string &line);
+
+          // Runs a bulk array instruction (see tac.h) on the values of
+          // its argument registers; returns the sum for an ArraySum.
+    Value ArrayOp(int op, Value a, Value b, Value c, Value d);
+};
+
+/* Function: RuntimeError
+ * ----------------------
+ * Reports an error in the running program and exits.
+ */
+void RuntimeError(const char *format, ...);
+
+bool EqualStrings(HeapObj *a, HeapObj *b);
+
+#endif
@@ -0,0 +1,752 @@
+/* File: x86.cc
+ * ------------
+ * Implementation of the x86-64 backend.
+ */
+
+#include "x86.h"
+#include "layout.h"
+#include "utility.h"
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <algorithm>
+#include <string>
+
+using std::string;
+using std::vector;
+
+// The allocatable registers: the callee-saved ones first
+static const char *gpNames[] = { "%rbx", "%r12", "%r13", "%r14", "%r15", "%r8", "%r9", "%r10", "%r11" };
+static const char *xmmNames[] = { "%xmm8", "%xmm9", "%xmm10", "%xmm11", "%xmm12", "%xmm13", "%xmm14", "%xmm15" };
+enum { kCalleeSaved = 5, kNumGP = 9, kNumXMM = 8 };
+
+/* Where a virtual register lives: a general or xmm register (an index
+ * into the tables above), a spill slot in the frame or, for a spilled
+ * parameter, the slot its argument was pushed to.
+ */
+struct Location {
+    enum { kNone, kGP, kXMM, kSpill, kParam } kind;
+    int index;
+};
+
+struct Interval {
+    int reg, start, end;
+    bool acrossCall;
+};
+
+/* Class: X86
+ * ----------
+ * Emits one module. The body of each function is collected in text
+ * first, since the prologue depends on the registers it ends up using.
+ */
+class X86
+{
+  protected:
+    Module *module;
+    FILE *fp;
+    string text;
+    int fn;
+    const Function *f;
+    vector<Location> loc;
+    vector<int> uninitialized;    // registers that may be read before written
+    bool saved[kCalleeSaved];
+    int numSaved, numSpills;
+    bool usesNull, usesNullArray, usesBounds, usesDivision;
+
+    void Out(const char *format, ...);
+    string FunctionLabel(int fn);
+    string BlockLabel(int block);
+    string Operand(int reg);
+    void Get(int reg, const char *scratch);
+    void Put(const char *scratch, int reg);
+    void Push(int reg);
+    const char *Accumulator(int reg);
+    void CheckNull(const char *scratch, bool array = false);
+    const Field *FieldOf(int member);
+    void Allocate();
+    void EmitCall(const Instr &in, bool tail);
+    void EmitEpilogue();
+    void EmitInstr(const Instr &in, int next);
+    void EmitFunction();
+    void EmitData();
+
+  public:
+    X86(Module *module, FILE *fp);
+    void Emit();
+};
+
+static bool CallsOut(int op) {
+    switch (op) {
+      case opCall: case opCallVirtual: case opCallInterface: case opNew: case opNewArray:
+      case opReadInteger: case opReadLine: case opPrintInt: case opPrintBool: case opPrintDouble:
+      case opPrintString: case opEqStr: case opNeStr: case opModD:
+      case opArrayFill: case opArrayCopy: case opArraySumI: case opArraySumD:
+        return true;
+      default:
+        return false;
+    }
+}
+
+/* Function: ForEachOperand
+ * ------------------------
+ * Calls use on each register an instruction reads and returns the one
+ * it writes, -1 if none.
+ */
+template <class F>
+static int ForEachOperand(const Function &f, const Instr &in, F use) {
+    const char *operands = OpOperands(in.op);
+    int fields[] = { in.dst, in.a, in.b, in.c };
+    for (int k = 1; k < 4; k++) {
+        if (operands[k] == 'r' && fields[k] >= 0) use(fields[k]);
+        if (operands[k] == 'n')
+            for (int j = 0; j < in.c; j++) use(f.args[in.b + j]);
+    }
+    return operands[0] == 'r' ? in.dst : -1;
+}
+
+X86::X86(Module *m, FILE *file) : module(m), fp(file), fn(-1), f(NULL) {}
+
+void X86::Out(const char *format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    text += '\t';
+    text += buffer;
+    text += '\n';
+}
+
+string X86::FunctionLabel(int i) {
+    if (i == module->mainFunction) return "decaf_main";
+    string name = module->functions[i].name;
+    std::replace(name.begin(), name.end(), '.', '_');
+    return "D" + std::to_string(i) + "_" + name;
+}
+
+string X86::BlockLabel(int block) {
+    return ".L" + std::to_string(fn) + "_" + std::to_string(block);
+}
+
+string X86::Operand(int reg) {
+    Location l = loc[reg];
+    switch (l.kind) {
+      case Location::kGP: return gpNames[l.index];
+      case Location::kXMM: return xmmNames[l.index];
+      case Location::kSpill: return std::to_string(-8 * (numSaved + 1 + l.index)) + "(%rbp)";
+      case Location::kParam: return std::to_string(16 + 8 * l.index) + "(%rbp)";
+      default: Assert(0); return "";
+    }
+}
+
+/* Methods: Get, Put
+ * -----------------
+ * Copy a register's 8 bytes to or from a scratch register. An int only
+ * defines the low 4 bytes.
+ */
+void X86::Get(int reg, const char *scratch) {
+    Out("movq %s, %s", Operand(reg).c_str(), scratch);
+}
+
+void X86::Put(const char *scratch, int reg) {
+    if (loc[reg].kind != Location::kNone) Out("movq %s, %s", scratch, Operand(reg).c_str());
+}
+
+void X86::Push(int reg) {
+    if (loc[reg].kind == Location::kXMM) {
+        Out("subq $8, %%rsp");
+        Out("movq %s, (%%rsp)", Operand(reg).c_str());
+    } else {
+        Out("pushq %s", Operand(reg).c_str());
+    }
+}
+
+const char *X86::Accumulator(int reg) {
+    return f->regTypes[reg] == vDouble ? "%xmm0" : "%rax";
+}
+
+void X86::CheckNull(const char *scratch, bool array) {
+    Out("testq %s, %s", scratch, scratch);
+    Out(array ? "je .L%d_null_array" : "je .L%d_null", fn);
+    (array ? usesNullArray : usesNull) = true;
+}
+
+const Field *X86::FieldOf(int member) {
+    const Member &m = module->members[member];
+    for (int cls = m.cls; cls >= 0; cls = module->classes[cls].base)
+        for (size_t i = 0; i < module->classes[cls].fields.size(); i++)
+            if (module->classes[cls].fields[i].name == m.name) return &module->classes[cls].fields[i];
+    Assert(0);
+    return NULL;
+}
+
+/* Method: Allocate
+ * ----------------
+ * Linear-scan register allocation for the current function (see x86.h).
+ * Instructions are numbered in steps of two in block order; parameters
+ * start live at -1, before the first instruction. An interval crosses a
+ * call if a call lies strictly inside it: an argument's interval may end
+ * at the call and the result's start there.
+ */
+void X86::Allocate() {
+    int numRegs = f->regTypes.size(), numBlocks = f->blocks.size();
+    vector<vector<char> > use(numBlocks, vector<char>(numRegs)), def = use, liveIn = use, liveOut = use;
+    vector<int> first(numBlocks), last(numBlocks), calls;
+    int pos = 0;
+    for (int b = 0; b < numBlocks; b++) {
+        first[b] = pos;
+        for (int i = f->blocks[b].start; i < f->blocks[b].end; i++, pos += 2) {
+            const Instr &in = f->code[i];
+            int d = ForEachOperand(*f, in, [&](int r) { if (!def[b][r]) use[b][r] = 1; });
+            if (d >= 0) def[b][d] = 1;
+            if (CallsOut(in.op)) calls.push_back(pos);
+        }
+        last[b] = pos - 2;
+    }
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (int b = numBlocks - 1; b >= 0; b--) {
+            for (int k = 0; k < 2; k++) {
+                int s = f->blocks[b].succ[k];
+                if (s < 0) continue;
+                for (int r = 0; r < numRegs; r++)
+                    if (liveIn[s][r]) liveOut[b][r] = 1;
+            }
+            for (int r = 0; r < numRegs; r++) {
+                char in = use[b][r] || (liveOut[b][r] && !def[b][r]);
+                if (in != liveIn[b][r]) liveIn[b][r] = in, changed = true;
+            }
+        }
+    }
+
+    uninitialized.clear();
+    for (int r = f->numParams; r < numRegs && numBlocks > 0; r++)
+        if (liveIn[0][r]) uninitialized.push_back(r);
+
+    vector<Interval> intervals(numRegs);
+    for (int r = 0; r < numRegs; r++) {
+        Interval i = { r, INT_MAX, INT_MIN, false };
+        if (r < f->numParams) i.start = i.end = -1;
+        intervals[r] = i;
+    }
+    auto extend = [&](int r, int p) {
+        intervals[r].start = std::min(intervals[r].start, p);
+        intervals[r].end = std::max(intervals[r].end, p);
+    };
+    pos = 0;
+    for (int b = 0; b < numBlocks; b++) {
+        if (f->blocks[b].start == f->blocks[b].end) continue;
+        for (int r = 0; r < numRegs; r++) {
+            if (liveIn[b][r]) extend(r, first[b]);
+            if (liveOut[b][r]) extend(r, last[b]);
+        }
+        for (int i = f->blocks[b].start; i < f->blocks[b].end; i++, pos += 2) {
+            int d = ForEachOperand(*f, f->code[i], [&](int r) { extend(r, pos); });
+            if (d >= 0) extend(d, pos);
+        }
+    }
+    vector<Interval> order;
+    for (int r = 0; r < numRegs; r++) {
+        Interval &i = intervals[r];
+        if (i.start > i.end) continue;
+        i.acrossCall = std::lower_bound(calls.begin(), calls.end(), i.start + 1) != calls.end() &&
+                       *std::lower_bound(calls.begin(), calls.end(), i.start + 1) < i.end;
+        order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [](const Interval &a, const Interval &b) { return a.start < b.start; });
+
+    Location none = { Location::kNone, 0 };
+    loc.assign(numRegs, none);
+    memset(saved, 0, sizeof(saved));
+    numSpills = 0;
+    vector<int> gpOwner(kNumGP, -1), xmmOwner(kNumXMM, -1);
+    vector<Interval*> active;
+    auto spill = [&](int r) {
+        Location l = { Location::kSpill, numSpills };
+        if (r < f->numParams) l.kind = Location::kParam, l.index = r;
+        else numSpills++;
+        loc[r] = l;
+    };
+    for (size_t n = 0; n < order.size(); n++) {
+        Interval &cur = order[n];
+        for (size_t k = 0; k < active.size(); ) {
+            if (active[k]->end >= cur.start) { k++; continue; }
+            Location &l = loc[active[k]->reg];
+            (l.kind == Location::kGP ? gpOwner : xmmOwner)[l.index] = -1;
+            active.erase(active.begin() + k);
+        }
+        bool isDouble = f->regTypes[cur.reg] == vDouble;
+        vector<int> candidates;
+        if (isDouble) {
+            for (int k = 0; k < kNumXMM && !cur.acrossCall; k++) candidates.push_back(k);
+        } else {
+            for (int k = kCalleeSaved; k < kNumGP && !cur.acrossCall; k++) candidates.push_back(k);
+            for (int k = 0; k < kCalleeSaved; k++) candidates.push_back(k);
+        }
+        vector<int> &owner = isDouble ? xmmOwner : gpOwner;
+        int chosen = -1;
+        for (size_t k = 0; k < candidates.size() && chosen < 0; k++)
+            if (owner[candidates[k]] < 0) chosen = candidates[k];
+        if (chosen < 0 && !candidates.empty()) {
+            Interval *victim = NULL;
+            for (size_t k = 0; k < active.size(); k++) {
+                Location &l = loc[active[k]->reg];
+                if ((l.kind == Location::kXMM) != isDouble) continue;
+                if (std::find(candidates.begin(), candidates.end(), l.index) == candidates.end()) continue;
+                if (!victim || active[k]->end > victim->end) victim = active[k];
+            }
+            if (victim && victim->end > cur.end) {
+                chosen = loc[victim->reg].index;
+                spill(victim->reg);
+                active.erase(std::find(active.begin(), active.end(), victim));
+            }
+        }
+        if (chosen < 0) {
+            spill(cur.reg);
+            continue;
+        }
+        Location l = { isDouble ? Location::kXMM : Location::kGP, chosen };
+        loc[cur.reg] = l;
+        owner[chosen] = cur.reg;
+        if (!isDouble && chosen < kCalleeSaved) saved[chosen] = true;
+        active.push_back(&cur);
+    }
+    numSaved = 0;
+    for (int k = 0; k < kCalleeSaved; k++)
+        if (saved[k]) numSaved++;
+    if (IsDebugOn("regalloc")) {
+        int inRegisters = 0;
+        for (int r = 0; r < numRegs; r++)
+            if (loc[r].kind == Location::kGP || loc[r].kind == Location::kXMM) inRegisters++;
+        PrintDebug("regalloc", "%s: %d registers, %d live ranges, %d in machine registers, %d spilled\n",
+                   f->name.c_str(), numRegs, (int)order.size(), inRegisters, (int)order.size() - inRegisters);
+    }
+}
+
+/* Method: EmitCall
+ * ----------------
+ * Pushes the arguments (after 8 bytes of padding if there is an odd
+ * number, to keep the stack 16-byte aligned), calls and pops them. The
+ * receiver of a method call is the first argument.
+ *
+ * A tail call whose callee takes no more arguments than the caller was
+ * passed instead copies the pushed arguments over the caller's, leaves
+ * the caller's frame and jumps to the callee, which returns to the
+ * caller's caller; that caller pops as many as it pushed.
+ */
+void X86::EmitCall(const Instr &in, bool tail) {
+    int n = in.c, pad = tail ? 0 : n % 2;
+    const int *args = &f->args[in.b];
+    if (pad) Out("subq $8, %%rsp");
+    for (int k = n - 1; k >= 0; k--)
+        Push(args[k]);
+    string target;
+    if (in.op == opCall) {
+        target = FunctionLabel(in.a);
+    } else {
+        Get(args[0], "%rax");
+        CheckNull("%rax");
+        Out("movq (%%rax), %%rax");
+        const Member &method = module->members[in.a];
+        if (in.op == opCallVirtual) {
+            target = "*" + std::to_string(8 + 8 * module->FindSlot(method)) + "(%rax)";
+        } else {
+            string search = ".L" + std::to_string(fn) + "_i" + std::to_string(&in - f->code.data());
+            Out("movq (%%rax), %%rax");
+            text += search + ":\n";
+            Out("cmpq $%d, (%%rax)", method.cls);
+            Out("leaq 16(%%rax), %%rax");
+            Out("jne %s", search.c_str());
+            Out("movq -8(%%rax), %%rax");
+            target = "*" + std::to_string(8 * module->FindSlot(method)) + "(%rax)";
+        }
+    }
+    if (tail) {
+        for (int k = 0; k < n; k++) {
+            Out("movq %d(%%rsp), %%rcx", 8 * k);
+            Out("movq %%rcx, %d(%%rbp)", 16 + 8 * k);
+        }
+        EmitEpilogue();
+        Out("jmp %s", target.c_str());
+        return;
+    }
+    Out("call %s", target.c_str());
+    if (n + pad) Out("addq $%d, %%rsp", 8 * (n + pad));
+    if (in.dst >= 0) Put(Accumulator(in.dst), in.dst);
+}
+
+/* Method: EmitEpilogue
+ * --------------------
+ * Restores the callee-saved registers and rbp and pops the frame, up to
+ * the return address.
+ */
+void X86::EmitEpilogue() {
+    Out("leaq %d(%%rbp), %%rsp", -8 * numSaved);
+    for (int k = kCalleeSaved - 1; k >= 0; k--)
+        if (saved[k]) Out("popq %s", gpNames[k]);
+    Out("popq %%rbp");
+}
+
+void X86::EmitInstr(const Instr &in, int next) {
+    static const char *setInt[] = { "setl", "setle", "setg", "setge", "sete", "setne" };
+    switch (in.op) {
+      case opNop:
+        break;
+      case opLoadInt:
+        if (loc[in.dst].kind != Location::kNone) Out("movq $%d, %s", in.a, Operand(in.dst).c_str());
+        break;
+      case opLoadDouble:
+        Out("movsd .LD%d(%%rip), %%xmm0", in.a);
+        Put("%xmm0", in.dst);
+        break;
+      case opLoadString:
+        Out("leaq .LS%d(%%rip), %%rax", in.a);
+        Put("%rax", in.dst);
+        break;
+      case opLoadNull:
+        if (loc[in.dst].kind != Location::kNone) Out("movq $0, %s", Operand(in.dst).c_str());
+        break;
+      case opMove:
+        Get(in.a, Accumulator(in.a));
+        Put(Accumulator(in.a), in.dst);
+        break;
+
+      case opAddI: case opSubI: case opMulI: case opAnd: case opOr: {
+        const char *op = in.op == opAddI ? "addl" : in.op == opSubI ? "subl" : in.op == opMulI ? "imull"
+                       : in.op == opAnd ? "andl" : "orl";
+        Get(in.a, "%rax");
+        Get(in.b, "%rcx");
+        Out("%s %%ecx, %%eax", op);
+        Put("%rax", in.dst);
+        break;
+      }
+      case opDivI: case opModI: {
+        // idivl traps on INT_MIN / -1, so dividing by -1 negates instead
+        string label = ".L" + std::to_string(fn) + "_i" + std::to_string(&in - f->code.data());
+        Get(in.a, "%rax");
+        Get(in.b, "%rcx");
+        Out("testl %%ecx, %%ecx");
+        Out("je .L%d_division", fn);
+        usesDivision = true;
+        Out("cmpl $-1, %%ecx");
+        Out("jne %s", label.c_str());
+        Out(in.op == opDivI ? "negl %%eax" : "xorl %%edx, %%edx");
+        Out("jmp %s_done", label.c_str());
+        text += label + ":\n";
+        Out("cltd");
+        Out("idivl %%ecx");
+        text += label + "_done:\n";
+        Put(in.op == opDivI ? "%rax" : "%rdx", in.dst);
+        break;
+      }
+      case opNegI: case opNot:
+        Get(in.a, "%rax");
+        Out(in.op == opNegI ? "negl %%eax" : "xorl $1, %%eax");
+        Put("%rax", in.dst);
+        break;
+
+      case opAddD: case opSubD: case opMulD: case opDivD: {
+        const char *op = in.op == opAddD ? "addsd" : in.op == opSubD ? "subsd" : in.op == opMulD ? "mulsd" : "divsd";
+        Get(in.a, "%xmm0");
+        Get(in.b, "%xmm1");
+        Out("%s %%xmm1, %%xmm0", op);
+        Put("%xmm0", in.dst);
+        break;
+      }
+      case opModD:
+        Get(in.a, "%xmm0");
+        Get(in.b, "%xmm1");
+        Out("call fmod@PLT");
+        Put("%xmm0", in.dst);
+        break;
+      case opNegD:
+        Get(in.a, "%rax");
+        Out("btcq $63, %%rax");
+        Put("%rax", in.dst);
+        break;
+
+      case opLtI: case opLeI: case opGtI: case opGeI: case opEqI: case opNeI: case opEqRef: case opNeRef:
+        Get(in.a, "%rax");
+        Get(in.b, "%rcx");
+        if (in.op == opEqRef || in.op == opNeRef) Out("cmpq %%rcx, %%rax");
+        else Out("cmpl %%ecx, %%eax");
+        Out("%s %%al", in.op == opEqRef ? "sete" : in.op == opNeRef ? "setne" : setInt[in.op - opLtI]);
+        Out("movzbl %%al, %%eax");
+        Put("%rax", in.dst);
+        break;
+      case opLtD: case opLeD: case opGtD: case opGeD: case opEqD: case opNeD:
+        // unordered compares as false for all but NeD
+        Get(in.a, "%xmm0");
+        Get(in.b, "%xmm1");
+        if (in.op == opGtD || in.op == opGeD) Out("ucomisd %%xmm1, %%xmm0");
+        else Out("ucomisd %%xmm0, %%xmm1");
+        if (in.op == opEqD) {
+            Out("sete %%al");
+            Out("setnp %%cl");
+            Out("andb %%cl, %%al");
+        } else if (in.op == opNeD) {
+            Out("setne %%al");
+            Out("setp %%cl");
+            Out("orb %%cl, %%al");
+        } else {
+            Out(in.op == opLtD || in.op == opGtD ? "seta %%al" : "setae %%al");
+        }
+        Out("movzbl %%al, %%eax");
+        Put("%rax", in.dst);
+        break;
+      case opEqStr: case opNeStr:
+        Get(in.a, "%rdi");
+        Get(in.b, "%rsi");
+        Out("call decaf_strings_equal@PLT");
+        if (in.op == opNeStr) Out("xorl $1, %%eax");
+        Put("%rax", in.dst);
+        break;
+
+      case opLoadGlobal:
+        Out("movq G%d(%%rip), %%rax", in.a);
+        Put("%rax", in.dst);
+        break;
+      case opStoreGlobal:
+        Get(in.b, "%rax");
+        Out("movq %%rax, G%d(%%rip)", in.a);
+        break;
+      case opGetField: {
+        const Field *field = FieldOf(in.b);
+        int size = SizeOfValue(field->type);
+        Get(in.a, "%rax");
+        CheckNull("%rax");
+        if (size == 1) Out("movzbl %d(%%rax), %%ecx", field->offset);
+        else if (size == 4) Out("movl %d(%%rax), %%ecx", field->offset);
+        else Out("movq %d(%%rax), %%rcx", field->offset);
+        Put("%rcx", in.dst);
+        break;
+      }
+      case opSetField: {
+        const Field *field = FieldOf(in.b);
+        int size = SizeOfValue(field->type);
+        Get(in.a, "%rax");
+        CheckNull("%rax");
+        Get(in.c, "%rcx");
+        if (size == 1) Out("movb %%cl, %d(%%rax)", field->offset);
+        else if (size == 4) Out("movl %%ecx, %d(%%rax)", field->offset);
+        else Out("movq %%rcx, %d(%%rax)", field->offset);
+        break;
+      }
+      case opNew:
+        Out("leaq V%d(%%rip), %%rdi", in.a);
+        Out("movl $%d, %%esi", (module->classes[in.a].size + 7) & ~7);
+        Out("call decaf_new_object@PLT");
+        Put("%rax", in.dst);
+        break;
+      case opNewArray:
+        Get(in.a, "%rdi");
+        Out("call decaf_new_array@PLT");
+        Put("%rax", in.dst);
+        break;
+      case opArrayLoad: case opArrayStore:
+      case opArrayLoadUnchecked: case opArrayStoreUnchecked:
+        Get(in.a, "%rax");
+        Get(in.b, "%rcx");
+        Out("movl %%ecx, %%ecx");
+        if (in.op == opArrayLoad || in.op == opArrayStore) {
+            CheckNull("%rax", true);
+            Out("cmpq 8(%%rax), %%rcx");
+            Out("jae .L%d_bounds", fn);
+            usesBounds = true;
+        }
+        if (in.op == opArrayLoad || in.op == opArrayLoadUnchecked) {
+            Out("movq 16(%%rax,%%rcx,8), %%rdx");
+            Put("%rdx", in.dst);
+        } else {
+            Get(in.c, "%rdx");
+            Out("movq %%rdx, 16(%%rax,%%rcx,8)");
+        }
+        break;
+      case opArrayFill: case opArrayCopy: case opArraySumI: case opArraySumD: {
+        static const char *gp[] = { "%rdi", "%rsi", "%rdx", "%rcx" };
+        static const char *names[] = { "fill", "copy", "sum_int", "sum_double" };
+        const int *args = &f->args[in.b];
+        for (int k = 0, next = 0; k < 4; k++) // a double sum is passed in xmm0
+            Get(args[k], in.op == opArraySumD && k == 0 ? "%xmm0" : gp[next++]);
+        Out("call decaf_array_%s@PLT", names[in.op - opArrayFill]);
+        if (in.dst >= 0) Put(in.op == opArraySumD ? "%xmm0" : "%rax", in.dst);
+        break;
+      }
+      case opArrayLength:
+        Get(in.a, "%rax");
+        CheckNull("%rax", true);
+        Out("movq 8(%%rax), %%rax");
+        Put("%rax", in.dst);
+        break;
+
+      case opCall: case opCallVirtual: case opCallInterface:
+        EmitCall(in, false);
+        break;
+      case opCheckNull:
+        Get(in.a, "%rax");
+        CheckNull("%rax");
+        break;
+      case opReadInteger: case opReadLine:
+        Out(in.op == opReadInteger ? "call decaf_read_integer@PLT" : "call decaf_read_line@PLT");
+        Put("%rax", in.dst);
+        break;
+      case opPrintInt: case opPrintBool: case opPrintString:
+        Get(in.a, "%rdi");
+        Out(in.op == opPrintInt ? "call decaf_print_int@PLT" : in.op == opPrintBool ? "call decaf_print_bool@PLT"
+            : "call decaf_print_string@PLT");
+        break;
+      case opPrintDouble:
+        Get(in.a, "%xmm0");
+        Out("call decaf_print_double@PLT");
+        break;
+
+      case opJump:
+        if (in.a != next) Out("jmp %s", BlockLabel(in.a).c_str());
+        break;
+      case opBranch:
+        Get(in.a, "%rax");
+        Out("testl %%eax, %%eax");
+        if (in.b == next) {
+            Out("je %s", BlockLabel(in.c).c_str());
+        } else {
+            Out("jne %s", BlockLabel(in.b).c_str());
+            if (in.c != next) Out("jmp %s", BlockLabel(in.c).c_str());
+        }
+        break;
+      case opReturn:
+        if (in.a >= 0) Get(in.a, Accumulator(in.a));
+        Out("jmp .L%d_return", fn);
+        break;
+      default:
+        Assert(0);
+    }
+}
+
+/* Method: EmitFunction
+ * --------------------
+ * The frame: the caller's arguments above the return address, then the
+ * saved rbp (which rbp points to), the callee-saved registers used and
+ * the spill slots, padded so rsp stays 16-byte aligned.
+ */
+void X86::EmitFunction() {
+    f = &module->functions[fn];
+    Allocate();
+    text.clear();
+    usesNull = usesNullArray = usesBounds = usesDivision = false;
+    for (size_t b = 0; b < f->blocks.size(); b++) {
+        text += BlockLabel(b) + ":\n";
+        for (int i = f->blocks[b].start; i < f->blocks[b].end; i++) {
+            if (IsTailCall(*f, i) && f->code[i].c <= f->numParams) {
+                EmitCall(f->code[i++], true);      // and leave out the Return
+                continue;
+            }
+            EmitInstr(f->code[i], b + 1);
+        }
+    }
+    string body = text;
+
+    text.clear();
+    string label = FunctionLabel(fn);
+    text += "\t.p2align 4\n";
+    if (fn == module->mainFunction) text += "\t.globl " + label + "\n";
+    text += "\t.type " + label + ", @function\n" + label + ":\n";
+    Out("pushq %%rbp");
+    Out("movq %%rsp, %%rbp");
+    for (int k = 0; k < kCalleeSaved; k++)
+        if (saved[k]) Out("pushq %s", gpNames[k]);
+    int frame = 8 * (numSpills + (numSaved + numSpills) % 2);
+    if (frame) Out("subq $%d, %%rsp", frame);
+    for (int p = 0; p < f->numParams; p++)
+        if (loc[p].kind == Location::kGP || loc[p].kind == Location::kXMM)
+            Out("movq %d(%%rbp), %s", 16 + 8 * p, Operand(p).c_str());
+    for (size_t k = 0; k < uninitialized.size(); k++)   // like the VM, start them at zero
+        Out("movq $0, %s", Operand(uninitialized[k]).c_str());
+    text += body;
+    text += ".L" + std::to_string(fn) + "_return:\n";
+    EmitEpilogue();
+    Out("ret");
+    const char *stubs[] = { "null", "null_array", "bounds", "division" };
+    bool used[] = { usesNull, usesNullArray, usesBounds, usesDivision };
+    for (int k = 0; k < 4; k++) {
+        if (!used[k]) continue;
+        text += ".L" + std::to_string(fn) + "_" + stubs[k] + ":\n";
+        Out("andq $-16, %%rsp");
+        Out("call decaf_%s_error@PLT", stubs[k]);
+    }
+    text += "\t.size " + label + ", .-" + label + "\n\n";
+    fputs(text.c_str(), fp);
+}
+
+static void EmitAscii(FILE *fp, const string &s) {
+    fputs("\t.ascii \"", fp);
+    for (size_t i = 0; i < s.size(); i++) {
+        unsigned char ch = s[i];
+        if (ch == '"' || ch == '\\') fprintf(fp, "\\%c", ch);
+        else if (ch < ' ' || ch > '~') fprintf(fp, "\\%03o", ch);
+        else fputc(ch, fp);
+    }
+    fputs("\\0\"\n", fp);
+}
+
+/* Method: EmitData
+ * ----------------
+ * Class descriptors, string and double constants and the globals. A
+ * descriptor V<c> is the address of the class's itable list followed by
+ * its vtable; the list I<c> pairs each interface with its itable and
+ * ends with -1. Constant strings have the same header as those the
+ * runtime allocates, but with the address of decaf_strings, the list
+ * of them all, as the class pointer to mark them interned (see
+ * runtime.c).
+ */
+void X86::EmitData() {
+    fputs("\t.section .data.rel.ro,\"aw\"\n\t.p2align 3\n", fp);
+    for (size_t c = 0; c < module->classes.size(); c++) {
+        ClassInfo &info = module->classes[c];
+        if (info.isInterface) continue;
+        fprintf(fp, "V%d:\t# %s\n\t.quad I%d\n", (int)c, info.name.c_str(), (int)c);
+        for (size_t k = 0; k < info.vtable.size(); k++)
+            fprintf(fp, "\t.quad %s\n", FunctionLabel(info.vtable[k]).c_str());
+        fprintf(fp, "I%d:\n", (int)c);
+        for (size_t k = 0; k < info.itables.size(); k++)
+            fprintf(fp, "\t.quad %d, I%d_%d\n", info.itables[k].interface, (int)c, (int)k);
+        fputs("\t.quad -1, 0\n", fp);
+        for (size_t k = 0; k < info.itables.size(); k++) {
+            fprintf(fp, "I%d_%d:\n", (int)c, (int)k);
+            for (size_t m = 0; m < info.itables[k].functions.size(); m++) {
+                int function = info.itables[k].functions[m];
+                fprintf(fp, "\t.quad %s\n", function < 0 ? "0" : FunctionLabel(function).c_str());
+            }
+        }
+    }
+    for (size_t s = 0; s < module->strings.size(); s++) {
+        fprintf(fp, ".LS%d:\n\t.quad decaf_strings, %d\n", (int)s, (int)module->strings[s].size());
+        EmitAscii(fp, module->strings[s]);
+        fputs("\t.p2align 3\n", fp);
+    }
+    fputs("\t.globl decaf_strings\ndecaf_strings:\n", fp);
+    for (size_t s = 0; s < module->strings.size(); s++)
+        fprintf(fp, "\t.quad .LS%d\n", (int)s);
+    fputs("\t.quad 0\n", fp);
+    fputs("\t.section .rodata\n\t.p2align 3\n", fp);
+    for (size_t d = 0; d < module->doubles.size(); d++) {
+        uint64_t bits;
+        memcpy(&bits, &module->doubles[d], sizeof(bits));
+        fprintf(fp, ".LD%d:\t.quad 0x%llx\t# %g\n", (int)d, (unsigned long long)bits, module->doubles[d]);
+    }
+    fputs("\t.bss\n\t.p2align 3\n", fp);
+    for (size_t g = 0; g < module->globals.size(); g++)
+        fprintf(fp, "G%d:\t.zero 8\t# %s\n", (int)g, module->globals[g].name.c_str());
+}
+
+void X86::Emit() {
+    fputs("\t.text\n", fp);
+    for (fn = 0; fn < (int)module->functions.size(); fn++)
+        EmitFunction();
+    EmitData();
+    fputs("\t.section .note.GNU-stack,\"\",@progbits\n", fp);
+}
+
+void EmitX86(Module *module, FILE *fp) {
+    X86(module, fp).Emit();
+}
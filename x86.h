@@ -0,0 +1,49 @@
+/* File: x86.h
+ * -----------
+ * The native backend: translates a lowered Module to x86-64 assembly for
+ * Linux (GNU as, AT&T syntax), to be assembled and linked with the small
+ * C runtime in runtime.c:
+ *
+ *     dcc --source=prog.decaf --asm=prog.s
+ *     cc -O2 -o prog prog.s runtime.c -lm
+ *
+ * Each function gets its virtual registers allocated to machine
+ * registers by linear scan. Liveness is computed over the blocks, each
+ * register's live range is the interval from its first to its last
+ * live instruction in block order, and the intervals are handed out
+ * in order of their start. A register live across a call may only
+ * get a callee-saved register (rbx, r12-r15); others may also use the
+ * caller-saved r8-r11 and, for doubles, xmm8-xmm15. When none is free,
+ * the interval ending last is spilled to the frame. Instructions work
+ * through the scratch registers rax, rcx, rdx and xmm0-xmm1, so any
+ * operand may be in memory.
+ *
+ * Decaf functions call each other with their own convention: the
+ * arguments are pushed right to left, 8 bytes each, and popped by the
+ * caller; the result comes back in rax, or xmm0 for a double. A call
+ * whose result is returned right away, to a function that takes no
+ * more arguments than the caller, reuses the caller's argument slots
+ * and jumps (a tail call), so tail recursion runs in constant stack.
+ * The runtime is called with the System V convention. Objects have the
+ * layout of layout.h; the first word of the header points to the
+ * class's descriptor, which holds a pointer to the class's itables
+ * followed by its vtable. An interface call searches the itables.
+ *
+ * The runtime allocates with malloc and never frees: the collector of
+ * gc.h is the VM's alone.
+ */
+
+#ifndef _H_x86
+#define _H_x86
+
+#include <stdio.h>
+#include "tac.h"
+
+/* Function: EmitX86
+ * -----------------
+ * Writes the assembly for module, whose classes must be laid out, to fp.
+ * -d regalloc reports where each function's registers went.
+ */
+void EmitX86(Module *module, FILE *fp);
+
+#endif
@@ -1,8 +1,9 @@
-/* A Bison parser, made by GNU Bison 3.0.4.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015 Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
@@ -15,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -33,6 +34,10 @@
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -40,11 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "3.0.4"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -61,8 +66,8 @@
 
 
 
-/* Copy the first part of user declarations.  */
-#line 12 "parser.y" /* yacc.c:339  */
+/* First part of user prologue.  */
+#line 13 "parser.y"
 
 
 #include "scanner.h" // for yylex
@@ -70,28 +75,47 @@
 #include "errors.h"
 
 void yyerror(char *msg); // standard error-handling routine
-
-
-#line 76 "y.tab.c" /* yacc.c:339  */
-
+Program *parsedProgram = NULL;
+
+// yacc's own version sets only the lines and columns of a rule's
+// location; it is in the file its symbols are in as well
+#define YYLLOC_DEFAULT(Current, Rhs, N)                                   \
+    do {                                                                  \
+        if (N) {                                                          \
+            (Current) = Join(YYRHSLOC(Rhs, 1), YYRHSLOC(Rhs, N));         \
+        } else {                                                          \
+            (Current) = YYRHSLOC(Rhs, 0);                                 \
+            (Current).first_line = (Current).last_line;                   \
+            (Current).first_column = (Current).last_column;               \
+        }                                                                 \
+    } while (0)
+
+
+#line 95 "y.tab.c"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
 # ifndef YY_NULLPTR
-#  if defined __cplusplus && 201103L <= __cplusplus
-#   define YY_NULLPTR nullptr
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
 #  else
-#   define YY_NULLPTR 0
+#   define YY_NULLPTR ((void*)0)
 #  endif
 # endif
 
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
-
-/* In a future release of Bison, this section will be replaced
-   by #include "y.tab.h".  */
+/* Use api.header.include to #include this header
+   instead of duplicating it here.  */
 #ifndef YY_YY_Y_TAB_H_INCLUDED
 # define YY_YY_Y_TAB_H_INCLUDED
 /* Debug traces.  */
@@ -102,52 +126,61 @@ void yyerror(char *msg); // standard error-handling routine
 extern int yydebug;
 #endif
 
-/* Token type.  */
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
   enum yytokentype
   {
-    T_Void = 258,
-    T_Bool = 259,
-    T_Int = 260,
-    T_Double = 261,
-    T_String = 262,
-    T_Class = 263,
-    T_LessEqual = 264,
-    T_GreaterEqual = 265,
-    T_Equal = 266,
-    T_NotEqual = 267,
-    T_Dims = 268,
-    T_And = 269,
-    T_Or = 270,
-    T_Null = 271,
-    T_Extends = 272,
-    T_This = 273,
-    T_Interface = 274,
-    T_Implements = 275,
-    T_While = 276,
-    T_For = 277,
-    T_If = 278,
-    T_Else = 279,
-    T_Return = 280,
-    T_Break = 281,
-    T_New = 282,
-    T_NewArray = 283,
-    T_Print = 284,
-    T_ReadInteger = 285,
-    T_ReadLine = 286,
-    T_Increment = 287,
-    T_Decrement = 288,
-    T_Identifier = 289,
-    T_StringConstant = 290,
-    T_IntConstant = 291,
-    T_DoubleConstant = 292,
-    T_BoolConstant = 293,
-    IF_NO_ELSE = 294,
-    UMINUS = 295
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    T_Void = 258,                  /* T_Void  */
+    T_Bool = 259,                  /* T_Bool  */
+    T_Int = 260,                   /* T_Int  */
+    T_Double = 261,                /* T_Double  */
+    T_String = 262,                /* T_String  */
+    T_Class = 263,                 /* T_Class  */
+    T_LessEqual = 264,             /* T_LessEqual  */
+    T_GreaterEqual = 265,          /* T_GreaterEqual  */
+    T_Equal = 266,                 /* T_Equal  */
+    T_NotEqual = 267,              /* T_NotEqual  */
+    T_Dims = 268,                  /* T_Dims  */
+    T_And = 269,                   /* T_And  */
+    T_Or = 270,                    /* T_Or  */
+    T_Null = 271,                  /* T_Null  */
+    T_Extends = 272,               /* T_Extends  */
+    T_This = 273,                  /* T_This  */
+    T_Interface = 274,             /* T_Interface  */
+    T_Implements = 275,            /* T_Implements  */
+    T_While = 276,                 /* T_While  */
+    T_For = 277,                   /* T_For  */
+    T_If = 278,                    /* T_If  */
+    T_Else = 279,                  /* T_Else  */
+    T_Return = 280,                /* T_Return  */
+    T_Break = 281,                 /* T_Break  */
+    T_New = 282,                   /* T_New  */
+    T_NewArray = 283,              /* T_NewArray  */
+    T_Print = 284,                 /* T_Print  */
+    T_ReadInteger = 285,           /* T_ReadInteger  */
+    T_ReadLine = 286,              /* T_ReadLine  */
+    T_Increment = 287,             /* T_Increment  */
+    T_Decrement = 288,             /* T_Decrement  */
+    T_Identifier = 289,            /* T_Identifier  */
+    T_StringConstant = 290,        /* T_StringConstant  */
+    T_IntConstant = 291,           /* T_IntConstant  */
+    T_DoubleConstant = 292,        /* T_DoubleConstant  */
+    T_BoolConstant = 293,          /* T_BoolConstant  */
+    IF_NO_ELSE = 294,              /* IF_NO_ELSE  */
+    UMINUS = 295                   /* UMINUS  */
   };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
-/* Tokens.  */
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 257
 #define T_Void 258
 #define T_Bool 259
 #define T_Int 260
@@ -189,10 +222,9 @@ extern int yydebug;
 
 /* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-
 union YYSTYPE
 {
-#line 26 "parser.y" /* yacc.c:355  */
+#line 41 "parser.y"
 
     int integerConstant;
     bool boolConstant;
@@ -232,9 +264,9 @@ union YYSTYPE
     
     
 
-#line 236 "y.tab.c" /* yacc.c:355  */
-};
+#line 268 "y.tab.c"
 
+};
 typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
 # define YYSTYPE_IS_DECLARED 1
@@ -257,40 +289,199 @@ struct YYLTYPE
 
 extern YYSTYPE yylval;
 extern YYLTYPE yylloc;
+
 int yyparse (void);
 
+
 #endif /* !YY_YY_Y_TAB_H_INCLUDED  */
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_T_Void = 3,                     /* T_Void  */
+  YYSYMBOL_T_Bool = 4,                     /* T_Bool  */
+  YYSYMBOL_T_Int = 5,                      /* T_Int  */
+  YYSYMBOL_T_Double = 6,                   /* T_Double  */
+  YYSYMBOL_T_String = 7,                   /* T_String  */
+  YYSYMBOL_T_Class = 8,                    /* T_Class  */
+  YYSYMBOL_T_LessEqual = 9,                /* T_LessEqual  */
+  YYSYMBOL_T_GreaterEqual = 10,            /* T_GreaterEqual  */
+  YYSYMBOL_T_Equal = 11,                   /* T_Equal  */
+  YYSYMBOL_T_NotEqual = 12,                /* T_NotEqual  */
+  YYSYMBOL_T_Dims = 13,                    /* T_Dims  */
+  YYSYMBOL_T_And = 14,                     /* T_And  */
+  YYSYMBOL_T_Or = 15,                      /* T_Or  */
+  YYSYMBOL_T_Null = 16,                    /* T_Null  */
+  YYSYMBOL_T_Extends = 17,                 /* T_Extends  */
+  YYSYMBOL_T_This = 18,                    /* T_This  */
+  YYSYMBOL_T_Interface = 19,               /* T_Interface  */
+  YYSYMBOL_T_Implements = 20,              /* T_Implements  */
+  YYSYMBOL_T_While = 21,                   /* T_While  */
+  YYSYMBOL_T_For = 22,                     /* T_For  */
+  YYSYMBOL_T_If = 23,                      /* T_If  */
+  YYSYMBOL_T_Else = 24,                    /* T_Else  */
+  YYSYMBOL_T_Return = 25,                  /* T_Return  */
+  YYSYMBOL_T_Break = 26,                   /* T_Break  */
+  YYSYMBOL_T_New = 27,                     /* T_New  */
+  YYSYMBOL_T_NewArray = 28,                /* T_NewArray  */
+  YYSYMBOL_T_Print = 29,                   /* T_Print  */
+  YYSYMBOL_T_ReadInteger = 30,             /* T_ReadInteger  */
+  YYSYMBOL_T_ReadLine = 31,                /* T_ReadLine  */
+  YYSYMBOL_T_Increment = 32,               /* T_Increment  */
+  YYSYMBOL_T_Decrement = 33,               /* T_Decrement  */
+  YYSYMBOL_T_Identifier = 34,              /* T_Identifier  */
+  YYSYMBOL_T_StringConstant = 35,          /* T_StringConstant  */
+  YYSYMBOL_T_IntConstant = 36,             /* T_IntConstant  */
+  YYSYMBOL_T_DoubleConstant = 37,          /* T_DoubleConstant  */
+  YYSYMBOL_T_BoolConstant = 38,            /* T_BoolConstant  */
+  YYSYMBOL_IF_NO_ELSE = 39,                /* IF_NO_ELSE  */
+  YYSYMBOL_40_ = 40,                       /* '='  */
+  YYSYMBOL_41_ = 41,                       /* '<'  */
+  YYSYMBOL_42_ = 42,                       /* '>'  */
+  YYSYMBOL_43_ = 43,                       /* '+'  */
+  YYSYMBOL_44_ = 44,                       /* '-'  */
+  YYSYMBOL_45_ = 45,                       /* '*'  */
+  YYSYMBOL_46_ = 46,                       /* '/'  */
+  YYSYMBOL_47_ = 47,                       /* '%'  */
+  YYSYMBOL_48_ = 48,                       /* '!'  */
+  YYSYMBOL_UMINUS = 49,                    /* UMINUS  */
+  YYSYMBOL_50_ = 50,                       /* '['  */
+  YYSYMBOL_51_ = 51,                       /* '.'  */
+  YYSYMBOL_52_ = 52,                       /* ';'  */
+  YYSYMBOL_53_ = 53,                       /* '('  */
+  YYSYMBOL_54_ = 54,                       /* ')'  */
+  YYSYMBOL_55_ = 55,                       /* ','  */
+  YYSYMBOL_56_ = 56,                       /* '{'  */
+  YYSYMBOL_57_ = 57,                       /* '}'  */
+  YYSYMBOL_58_ = 58,                       /* ']'  */
+  YYSYMBOL_YYACCEPT = 59,                  /* $accept  */
+  YYSYMBOL_Program = 60,                   /* Program  */
+  YYSYMBOL_DeclList = 61,                  /* DeclList  */
+  YYSYMBOL_Decl = 62,                      /* Decl  */
+  YYSYMBOL_VariableDecl = 63,              /* VariableDecl  */
+  YYSYMBOL_Variable = 64,                  /* Variable  */
+  YYSYMBOL_Type = 65,                      /* Type  */
+  YYSYMBOL_FunctionDecl = 66,              /* FunctionDecl  */
+  YYSYMBOL_Formals = 67,                   /* Formals  */
+  YYSYMBOL_VarList = 68,                   /* VarList  */
+  YYSYMBOL_ClassDecl = 69,                 /* ClassDecl  */
+  YYSYMBOL_Field_star = 70,                /* Field_star  */
+  YYSYMBOL_Ident_plus_comma = 71,          /* Ident_plus_comma  */
+  YYSYMBOL_Field = 72,                     /* Field  */
+  YYSYMBOL_InterfaceDecl = 73,             /* InterfaceDecl  */
+  YYSYMBOL_Prototype_star = 74,            /* Prototype_star  */
+  YYSYMBOL_Prototype = 75,                 /* Prototype  */
+  YYSYMBOL_Var_Decl_plus = 76,             /* Var_Decl_plus  */
+  YYSYMBOL_Expr_plus_comma = 77,           /* Expr_plus_comma  */
+  YYSYMBOL_Expr = 78,                      /* Expr  */
+  YYSYMBOL_Call = 79,                      /* Call  */
+  YYSYMBOL_Actuals = 80,                   /* Actuals  */
+  YYSYMBOL_Constant = 81,                  /* Constant  */
+  YYSYMBOL_Stmt_plus = 82,                 /* Stmt_plus  */
+  YYSYMBOL_StmtBlock = 83,                 /* StmtBlock  */
+  YYSYMBOL_Stmt = 84,                      /* Stmt  */
+  YYSYMBOL_IfStmt = 85,                    /* IfStmt  */
+  YYSYMBOL_WhileStmt = 86,                 /* WhileStmt  */
+  YYSYMBOL_ForStmt = 87,                   /* ForStmt  */
+  YYSYMBOL_ReturnStmt = 88,                /* ReturnStmt  */
+  YYSYMBOL_BreakStmt = 89,                 /* BreakStmt  */
+  YYSYMBOL_PrintStmt = 90,                 /* PrintStmt  */
+  YYSYMBOL_LValue = 91,                    /* LValue  */
+  YYSYMBOL_Optional_Expr = 92              /* Optional_Expr  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
 
-/* Copy the second part of user declarations.  */
 
-#line 267 "y.tab.c" /* yacc.c:358  */
 
 #ifdef short
 # undef short
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
-#else
-typedef unsigned char yytype_uint8;
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
 #else
 typedef signed char yytype_int8;
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -298,15 +489,28 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
@@ -320,47 +524,43 @@ typedef short int yytype_int16;
 # endif
 #endif
 
-#ifndef YY_ATTRIBUTE
-# if (defined __GNUC__                                               \
-      && (2 < __GNUC__ || (__GNUC__ == 2 && 96 <= __GNUC_MINOR__)))  \
-     || defined __SUNPRO_C && 0x5110 <= __SUNPRO_C
-#  define YY_ATTRIBUTE(Spec) __attribute__(Spec)
-# else
-#  define YY_ATTRIBUTE(Spec) /* empty */
-# endif
-#endif
 
 #ifndef YY_ATTRIBUTE_PURE
-# define YY_ATTRIBUTE_PURE   YY_ATTRIBUTE ((__pure__))
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
 #endif
 
 #ifndef YY_ATTRIBUTE_UNUSED
-# define YY_ATTRIBUTE_UNUSED YY_ATTRIBUTE ((__unused__))
-#endif
-
-#if !defined _Noreturn \
-     && (!defined __STDC_VERSION__ || __STDC_VERSION__ < 201112)
-# if defined _MSC_VER && 1200 <= _MSC_VER
-#  define _Noreturn __declspec (noreturn)
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
 # else
-#  define _Noreturn YY_ATTRIBUTE ((__noreturn__))
+#  define YY_ATTRIBUTE_UNUSED
 # endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-#if defined __GNUC__ && 407 <= __GNUC__ * 100 + __GNUC_MINOR__
 /* Suppress an incorrect diagnostic about yylval being uninitialized.  */
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN \
-    _Pragma ("GCC diagnostic push") \
-    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")\
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
     _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
-# define YY_IGNORE_MAYBE_UNINITIALIZED_END \
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
     _Pragma ("GCC diagnostic pop")
 #else
 # define YY_INITIAL_VALUE(Value) Value
@@ -373,8 +573,22 @@ typedef short int yytype_int16;
 # define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if !defined yyoverflow
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -439,8 +653,7 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
@@ -450,18 +663,19 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
   YYLTYPE yyls_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE) + sizeof (YYLTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE) \
+             + YYSIZEOF (YYLTYPE)) \
       + 2 * YYSTACK_GAP_MAXIMUM)
 
 # define YYCOPY_NEEDED 1
@@ -474,11 +688,11 @@ union yyalloc
 # define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
     do                                                                  \
       {                                                                 \
-        YYSIZE_T yynewbytes;                                            \
+        YYPTRDIFF_T yynewbytes;                                         \
         YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
         Stack = &yyptr->Stack_alloc;                                    \
-        yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-        yyptr += yynewbytes / sizeof (*yyptr);                          \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
       }                                                                 \
     while (0)
 
@@ -490,12 +704,12 @@ union yyalloc
 # ifndef YYCOPY
 #  if defined __GNUC__ && 1 < __GNUC__
 #   define YYCOPY(Dst, Src, Count) \
-      __builtin_memcpy (Dst, Src, (Count) * sizeof (*(Src)))
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
 #  else
 #   define YYCOPY(Dst, Src, Count)              \
       do                                        \
         {                                       \
-          YYSIZE_T yyi;                         \
+          YYPTRDIFF_T yyi;                      \
           for (yyi = 0; yyi < (Count); yyi++)   \
             (Dst)[yyi] = (Src)[yyi];            \
         }                                       \
@@ -518,17 +732,20 @@ union yyalloc
 /* YYNSTATES -- Number of states.  */
 #define YYNSTATES  212
 
-/* YYTRANSLATE[YYX] -- Symbol number corresponding to YYX as returned
-   by yylex, with out-of-bounds checking.  */
-#define YYUNDEFTOK  2
+/* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   295
 
-#define YYTRANSLATE(YYX)                                                \
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
 
 /* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
-   as returned by yylex, without out-of-bounds checking.  */
-static const yytype_uint8 yytranslate[] =
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -563,73 +780,72 @@ static const yytype_uint8 yytranslate[] =
 };
 
 #if YYDEBUG
-  /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
-static const yytype_uint16 yyrline[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,   156,   156,   164,   165,   168,   169,   170,   171,   174,
-     177,   184,   185,   186,   187,   188,   193,   199,   205,   213,
-     214,   217,   222,   228,   235,   240,   247,   254,   255,   262,
-     269,   277,   278,   281,   288,   289,   295,   300,   307,   312,
-     319,   324,   330,   335,   336,   337,   338,   339,   343,   348,
-     353,   358,   363,   368,   373,   378,   383,   388,   393,   398,
-     403,   408,   413,   418,   422,   426,   432,   436,   440,   446,
-     451,   458,   459,   462,   466,   470,   474,   478,   484,   489,
-     495,   499,   503,   507,   513,   514,   515,   516,   517,   518,
-     519,   520,   525,   529,   535,   541,   547,   553,   559,   565,
-     570,   575,   581,   582
+       0,   171,   171,   178,   179,   182,   183,   184,   185,   188,
+     191,   198,   199,   200,   201,   202,   207,   213,   219,   227,
+     228,   231,   236,   242,   249,   254,   261,   268,   269,   276,
+     283,   291,   292,   295,   302,   303,   309,   314,   321,   326,
+     333,   338,   344,   349,   350,   351,   352,   353,   357,   362,
+     367,   372,   377,   382,   387,   392,   397,   402,   407,   412,
+     417,   422,   427,   432,   436,   440,   446,   450,   454,   460,
+     465,   472,   473,   476,   480,   484,   488,   492,   498,   503,
+     509,   513,   517,   521,   527,   528,   529,   530,   531,   532,
+     533,   534,   539,   543,   549,   555,   561,   567,   573,   579,
+     584,   589,   595,   596
 };
 #endif
 
-#if YYDEBUG || YYERROR_VERBOSE || 0
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "T_Void", "T_Bool", "T_Int", "T_Double",
-  "T_String", "T_Class", "T_LessEqual", "T_GreaterEqual", "T_Equal",
-  "T_NotEqual", "T_Dims", "T_And", "T_Or", "T_Null", "T_Extends", "T_This",
-  "T_Interface", "T_Implements", "T_While", "T_For", "T_If", "T_Else",
-  "T_Return", "T_Break", "T_New", "T_NewArray", "T_Print", "T_ReadInteger",
-  "T_ReadLine", "T_Increment", "T_Decrement", "T_Identifier",
-  "T_StringConstant", "T_IntConstant", "T_DoubleConstant",
-  "T_BoolConstant", "IF_NO_ELSE", "'='", "'<'", "'>'", "'+'", "'-'", "'*'",
-  "'/'", "'%'", "'!'", "UMINUS", "'['", "'.'", "';'", "'('", "')'", "','",
-  "'{'", "'}'", "']'", "$accept", "Program", "DeclList", "Decl",
-  "VariableDecl", "Variable", "Type", "FunctionDecl", "Formals", "VarList",
-  "ClassDecl", "Field_star", "Ident_plus_comma", "Field", "InterfaceDecl",
-  "Prototype_star", "Prototype", "Var_Decl_plus", "Expr_plus_comma",
-  "Expr", "Call", "Actuals", "Constant", "Stmt_plus", "StmtBlock", "Stmt",
-  "IfStmt", "WhileStmt", "ForStmt", "ReturnStmt", "BreakStmt", "PrintStmt",
-  "LValue", "Optional_Expr", YY_NULLPTR
+  "\"end of file\"", "error", "\"invalid token\"", "T_Void", "T_Bool",
+  "T_Int", "T_Double", "T_String", "T_Class", "T_LessEqual",
+  "T_GreaterEqual", "T_Equal", "T_NotEqual", "T_Dims", "T_And", "T_Or",
+  "T_Null", "T_Extends", "T_This", "T_Interface", "T_Implements",
+  "T_While", "T_For", "T_If", "T_Else", "T_Return", "T_Break", "T_New",
+  "T_NewArray", "T_Print", "T_ReadInteger", "T_ReadLine", "T_Increment",
+  "T_Decrement", "T_Identifier", "T_StringConstant", "T_IntConstant",
+  "T_DoubleConstant", "T_BoolConstant", "IF_NO_ELSE", "'='", "'<'", "'>'",
+  "'+'", "'-'", "'*'", "'/'", "'%'", "'!'", "UMINUS", "'['", "'.'", "';'",
+  "'('", "')'", "','", "'{'", "'}'", "']'", "$accept", "Program",
+  "DeclList", "Decl", "VariableDecl", "Variable", "Type", "FunctionDecl",
+  "Formals", "VarList", "ClassDecl", "Field_star", "Ident_plus_comma",
+  "Field", "InterfaceDecl", "Prototype_star", "Prototype", "Var_Decl_plus",
+  "Expr_plus_comma", "Expr", "Call", "Actuals", "Constant", "Stmt_plus",
+  "StmtBlock", "Stmt", "IfStmt", "WhileStmt", "ForStmt", "ReturnStmt",
+  "BreakStmt", "PrintStmt", "LValue", "Optional_Expr", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[NUM] -- (External) token number corresponding to the
-   (internal) symbol number NUM (which must be that of a token).  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,   288,   289,   290,   291,   292,   293,   294,
-      61,    60,    62,    43,    45,    42,    47,    37,    33,   295,
-      91,    46,    59,    40,    41,    44,   123,   125,    93
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-#define YYPACT_NINF -94
+#define YYPACT_NINF (-94)
 
-#define yypact_value_is_default(Yystate) \
-  (!!((Yystate) == (-94)))
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-#define YYTABLE_NINF -16
+#define YYTABLE_NINF (-16)
 
-#define yytable_value_is_error(Yytable_value) \
-  (!!((Yytable_value) == (-16)))
+#define yytable_value_is_error(Yyn) \
+  ((Yyn) == YYTABLE_NINF)
 
-  /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-     STATE-NUM.  */
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
      199,   -25,   -94,   -94,   -94,   -94,   -21,     8,   -94,    45,
@@ -656,10 +872,10 @@ static const yytype_int16 yypact[] =
      632,   -94
 };
 
-  /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
-     Performed when YYTABLE does not specify something else to do.  Zero
-     means the default is an error.  */
-static const yytype_uint8 yydefact[] =
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
 {
        0,     0,    13,    11,    12,    14,     0,     0,    15,     0,
        2,     4,     5,     0,     0,     6,     7,     8,     0,     0,
@@ -685,7 +901,7 @@ static const yytype_uint8 yydefact[] =
      102,    95
 };
 
-  /* YYPGOTO[NTERM-NUM].  */
+/* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
      -94,   -94,   -94,   204,     5,   -19,     0,    51,   -27,   -94,
@@ -694,18 +910,18 @@ static const yytype_int16 yypgoto[] =
      -94,   -94,   -94,   -70
 };
 
-  /* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int16 yydefgoto[] =
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_uint8 yydefgoto[] =
 {
-      -1,     9,    10,    11,    50,    13,    33,    51,    34,    35,
+       0,     9,    10,    11,    50,    13,    33,    51,    34,    35,
       16,    39,    38,    52,    17,    40,    56,    90,   162,    91,
       92,   163,    93,    94,    95,    96,    97,    98,    99,   100,
      101,   102,   103,   104
 };
 
-  /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
-     positive, shift that token.  If negative, reduce the rule whose
-     number is the opposite.  If YYTABLE_NINF, syntax error.  */
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int16 yytable[] =
 {
       14,   146,    24,   114,    41,    12,   -15,    32,    45,    18,
@@ -856,9 +1072,9 @@ static const yytype_int16 yycheck[] =
       44,    -1,    -1,    -1,    48,    -1,    -1,    -1,    -1,    53
 };
 
-  /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-     symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
        0,     3,     4,     5,     6,     7,     8,    19,    34,    60,
       61,    62,    63,    64,    65,    66,    69,    73,    34,    34,
@@ -884,8 +1100,8 @@ static const yytype_uint8 yystos[] =
       54,    84
 };
 
-  /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
 {
        0,    59,    60,    61,    61,    62,    62,    62,    62,    63,
       64,    65,    65,    65,    65,    65,    65,    66,    66,    67,
@@ -900,8 +1116,8 @@ static const yytype_uint8 yyr1[] =
       91,    91,    92,    92
 };
 
-  /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
 {
        0,     2,     1,     2,     1,     1,     1,     1,     1,     2,
        2,     1,     1,     1,     1,     1,     2,     6,     6,     1,
@@ -917,39 +1133,39 @@ static const yytype_uint8 yyr2[] =
 };
 
 
+enum { YYENOMEM = -2 };
+
 #define yyerrok         (yyerrstatus = 0)
 #define yyclearin       (yychar = YYEMPTY)
-#define YYEMPTY         (-2)
-#define YYEOF           0
 
 #define YYACCEPT        goto yyacceptlab
 #define YYABORT         goto yyabortlab
 #define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
 #define YYRECOVERING()  (!!yyerrstatus)
 
-#define YYBACKUP(Token, Value)                                  \
-do                                                              \
-  if (yychar == YYEMPTY)                                        \
-    {                                                           \
-      yychar = (Token);                                         \
-      yylval = (Value);                                         \
-      YYPOPSTACK (yylen);                                       \
-      yystate = *yyssp;                                         \
-      goto yybackup;                                            \
-    }                                                           \
-  else                                                          \
-    {                                                           \
-      yyerror (YY_("syntax error: cannot back up")); \
-      YYERROR;                                                  \
-    }                                                           \
-while (0)
-
-/* Error token number */
-#define YYTERROR        1
-#define YYERRCODE       256
-
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
 /* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
    If N is 0, then set CURRENT to the empty location which ends
@@ -993,20 +1209,27 @@ do {                                            \
 } while (0)
 
 
-/* YY_LOCATION_PRINT -- Print the location on the stream.
+/* YYLOCATION_PRINT -- Print the location on the stream.
    This macro was not mandated originally: define only if we know
    we won't break user code: when these are the locations we know.  */
 
-#ifndef YY_LOCATION_PRINT
-# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+# ifndef YYLOCATION_PRINT
+
+#  if defined YY_LOCATION_PRINT
+
+   /* Temporary convenience wrapper in case some people defined the
+      undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YYLOCATION_PRINT(File, Loc)  YY_LOCATION_PRINT(File, *(Loc))
+
+#  elif defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
 
 /* Print *YYLOCP on YYO.  Private, do not rely on its existence. */
 
 YY_ATTRIBUTE_UNUSED
-static unsigned
+static int
 yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
 {
-  unsigned res = 0;
+  int res = 0;
   int end_col = 0 != yylocp->last_column ? yylocp->last_column - 1 : 0;
   if (0 <= yylocp->first_line)
     {
@@ -1026,63 +1249,71 @@ yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
         res += YYFPRINTF (yyo, "-%d", end_col);
     }
   return res;
- }
+}
 
-#  define YY_LOCATION_PRINT(File, Loc)          \
-  yy_location_print_ (File, &(Loc))
+#   define YYLOCATION_PRINT  yy_location_print_
 
-# else
-#  define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-# endif
-#endif
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT(File, Loc)  YYLOCATION_PRINT(File, &(Loc))
+
+#  else
 
+#   define YYLOCATION_PRINT(File, Loc) ((void) 0)
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT  YYLOCATION_PRINT
 
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)                    \
+#  endif
+# endif /* !defined YYLOCATION_PRINT */
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
 do {                                                                      \
   if (yydebug)                                                            \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Type, Value, Location); \
+                  Kind, Value, Location); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
 
 
-/*----------------------------------------.
-| Print this symbol's value on YYOUTPUT.  |
-`----------------------------------------*/
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
 
 static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
 {
-  FILE *yyo = yyoutput;
-  YYUSE (yyo);
-  YYUSE (yylocationp);
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (yylocationp);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# endif
-  YYUSE (yytype);
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
 static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
 {
-  YYFPRINTF (yyoutput, "%s %s (",
-             yytype < YYNTOKENS ? "token" : "nterm", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  YY_LOCATION_PRINT (yyoutput, *yylocationp);
-  YYFPRINTF (yyoutput, ": ");
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep, yylocationp);
-  YYFPRINTF (yyoutput, ")");
+  YYLOCATION_PRINT (yyo, yylocationp);
+  YYFPRINTF (yyo, ": ");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, yylocationp);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -1091,7 +1322,7 @@ yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, YYL
 `------------------------------------------------------------------*/
 
 static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -1114,21 +1345,22 @@ do {                                                            \
 `------------------------------------------------*/
 
 static void
-yy_reduce_print (yytype_int16 *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp, int yyrule)
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
+                 int yyrule)
 {
-  unsigned long int yylno = yyrline[yyrule];
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
              yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
-                       yystos[yyssp[yyi + 1 - yynrhs]],
-                       &(yyvsp[(yyi + 1) - (yynrhs)])
-                       , &(yylsp[(yyi + 1) - (yynrhs)])                       );
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)],
+                       &(yylsp[(yyi + 1) - (yynrhs)]));
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -1143,8 +1375,8 @@ do {                                    \
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
@@ -1167,250 +1399,31 @@ int yydebug;
 #endif
 
 
-#if YYERROR_VERBOSE
-
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
-/* Return the length of YYSTR.  */
-static YYSIZE_T
-yystrlen (const char *yystr)
-{
-  YYSIZE_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
-
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
-
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
-
-  return yyd - 1;
-}
-#  endif
-# endif
-
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYSIZE_T
-yytnamerr (char *yyres, const char *yystr)
-{
-  if (*yystr == '"')
-    {
-      YYSIZE_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-        switch (*++yyp)
-          {
-          case '\'':
-          case ',':
-            goto do_not_strip_quotes;
-
-          case '\\':
-            if (*++yyp != '\\')
-              goto do_not_strip_quotes;
-            /* Fall through.  */
-          default:
-            if (yyres)
-              yyres[yyn] = *yyp;
-            yyn++;
-            break;
-
-          case '"':
-            if (yyres)
-              yyres[yyn] = '\0';
-            return yyn;
-          }
-    do_not_strip_quotes: ;
-    }
-
-  if (! yyres)
-    return yystrlen (yystr);
-
-  return yystpcpy (yyres, yystr) - yyres;
-}
-# endif
-
-/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
-   about the unexpected token YYTOKEN for the state stack whose top is
-   YYSSP.
-
-   Return 0 if *YYMSG was successfully written.  Return 1 if *YYMSG is
-   not large enough to hold the message.  In that case, also set
-   *YYMSG_ALLOC to the required number of bytes.  Return 2 if the
-   required number of bytes is too large to store.  */
-static int
-yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
-                yytype_int16 *yyssp, int yytoken)
-{
-  YYSIZE_T yysize0 = yytnamerr (YY_NULLPTR, yytname[yytoken]);
-  YYSIZE_T yysize = yysize0;
-  enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-  /* Internationalized format string. */
-  const char *yyformat = YY_NULLPTR;
-  /* Arguments of yyformat. */
-  char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-  /* Number of reported tokens (one for the "unexpected", one per
-     "expected"). */
-  int yycount = 0;
-
-  /* There are many possibilities here to consider:
-     - If this state is a consistent state with a default action, then
-       the only way this function was invoked is if the default action
-       is an error action.  In that case, don't check for expected
-       tokens because there are none.
-     - The only way there can be no lookahead present (in yychar) is if
-       this state is a consistent state with a default action.  Thus,
-       detecting the absence of a lookahead is sufficient to determine
-       that there is no unexpected or expected token to report.  In that
-       case, just report a simple "syntax error".
-     - Don't assume there isn't a lookahead just because this state is a
-       consistent state with a default action.  There might have been a
-       previous inconsistent state, consistent state with a non-default
-       action, or user semantic action that manipulated yychar.
-     - Of course, the expected token list depends on states to have
-       correct lookahead information, and it depends on the parser not
-       to perform extra reductions after fetching a lookahead from the
-       scanner and before detecting a syntax error.  Thus, state merging
-       (from LALR or IELR) and default reductions corrupt the expected
-       token list.  However, the list is correct for canonical LR with
-       one exception: it will still contain any token that will not be
-       accepted due to an error action in a later state.
-  */
-  if (yytoken != YYEMPTY)
-    {
-      int yyn = yypact[*yyssp];
-      yyarg[yycount++] = yytname[yytoken];
-      if (!yypact_value_is_default (yyn))
-        {
-          /* Start YYX at -YYN if negative to avoid negative indexes in
-             YYCHECK.  In other words, skip the first -YYN actions for
-             this state because they are default actions.  */
-          int yyxbegin = yyn < 0 ? -yyn : 0;
-          /* Stay within bounds of both yycheck and yytname.  */
-          int yychecklim = YYLAST - yyn + 1;
-          int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-          int yyx;
-
-          for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-            if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR
-                && !yytable_value_is_error (yytable[yyx + yyn]))
-              {
-                if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-                  {
-                    yycount = 1;
-                    yysize = yysize0;
-                    break;
-                  }
-                yyarg[yycount++] = yytname[yyx];
-                {
-                  YYSIZE_T yysize1 = yysize + yytnamerr (YY_NULLPTR, yytname[yyx]);
-                  if (! (yysize <= yysize1
-                         && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-                    return 2;
-                  yysize = yysize1;
-                }
-              }
-        }
-    }
-
-  switch (yycount)
-    {
-# define YYCASE_(N, S)                      \
-      case N:                               \
-        yyformat = S;                       \
-      break
-      YYCASE_(0, YY_("syntax error"));
-      YYCASE_(1, YY_("syntax error, unexpected %s"));
-      YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
-      YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
-      YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
-      YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
-# undef YYCASE_
-    }
 
-  {
-    YYSIZE_T yysize1 = yysize + yystrlen (yyformat);
-    if (! (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-      return 2;
-    yysize = yysize1;
-  }
 
-  if (*yymsg_alloc < yysize)
-    {
-      *yymsg_alloc = 2 * yysize;
-      if (! (yysize <= *yymsg_alloc
-             && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
-        *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
-      return 1;
-    }
 
-  /* Avoid sprintf, as that infringes on the user's name space.
-     Don't have undefined behavior even if the translation
-     produced a string with the wrong number of "%s"s.  */
-  {
-    char *yyp = *yymsg;
-    int yyi = 0;
-    while ((*yyp = *yyformat) != '\0')
-      if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
-        {
-          yyp += yytnamerr (yyp, yyarg[yyi++]);
-          yyformat += 2;
-        }
-      else
-        {
-          yyp++;
-          yyformat++;
-        }
-  }
-  return 0;
-}
-#endif /* YYERROR_VERBOSE */
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
 static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, YYLTYPE *yylocationp)
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, YYLTYPE *yylocationp)
 {
-  YYUSE (yyvaluep);
-  YYUSE (yylocationp);
+  YY_USE (yyvaluep);
+  YY_USE (yylocationp);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yytype);
+  YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-
-
-/* The lookahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
 /* The semantic value of the lookahead symbol.  */
@@ -1425,6 +1438,8 @@ YYLTYPE yylloc
 int yynerrs;
 
 
+
+
 /*----------.
 | yyparse.  |
 `----------*/
@@ -1432,53 +1447,45 @@ int yynerrs;
 int
 yyparse (void)
 {
-    int yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
+    int yyerrstatus = 0;
 
-    /* The stacks and their tools:
-       'yyss': related to states.
-       'yyvs': related to semantic values.
-       'yyls': related to locations.
-
-       Refer to the stacks through separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH];
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-    /* The semantic value stack.  */
+    /* The semantic value stack: array, bottom, top.  */
     YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
-    /* The location stack.  */
+    /* The location stack: array, bottom, top.  */
     YYLTYPE yylsa[YYINITDEPTH];
-    YYLTYPE *yyls;
-    YYLTYPE *yylsp;
-
-    /* The locations where the error started and ended.  */
-    YYLTYPE yyerror_range[3];
-
-    YYSIZE_T yystacksize;
+    YYLTYPE *yyls = yylsa;
+    YYLTYPE *yylsp = yyls;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken = 0;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
   YYLTYPE yyloc;
 
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+  /* The locations where the error started and ended.  */
+  YYLTYPE yyerror_range[3];
+
+
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N), yylsp -= (N))
 
@@ -1486,43 +1493,49 @@ yyparse (void)
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yyssp = yyss = yyssa;
-  yyvsp = yyvs = yyvsa;
-  yylsp = yyls = yylsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
+
   yylsp[0] = yylloc;
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
         /* Give user a chance to reallocate the stack.  Use copies of
            these so that the &'s don't force the real ones into
            memory.  */
+        yy_state_t *yyss1 = yyss;
         YYSTYPE *yyvs1 = yyvs;
-        yytype_int16 *yyss1 = yyss;
         YYLTYPE *yyls1 = yyls;
 
         /* Each stack pointer address is followed by the size of the
@@ -1530,32 +1543,29 @@ yyparse (void)
            conditional around just the two extra args, but that might
            be undefined if yyoverflow is a macro.  */
         yyoverflow (YY_("memory exhausted"),
-                    &yyss1, yysize * sizeof (*yyssp),
-                    &yyvs1, yysize * sizeof (*yyvsp),
-                    &yyls1, yysize * sizeof (*yylsp),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yyls1, yysize * YYSIZEOF (*yylsp),
                     &yystacksize);
-
-        yyls = yyls1;
         yyss = yyss1;
         yyvs = yyvs1;
+        yyls = yyls1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-        goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
         yystacksize = YYMAXDEPTH;
 
       {
-        yytype_int16 *yyss1 = yyss;
+        yy_state_t *yyss1 = yyss;
         union yyalloc *yyptr =
-          (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
         if (! yyptr)
-          goto yyexhaustedlab;
+          YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
         YYSTACK_RELOCATE (yyls_alloc, yyls);
@@ -1564,31 +1574,32 @@ yyparse (void)
           YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
       yylsp = yyls + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-                  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
         YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
 
   if (yystate == YYFINAL)
     YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
      lookahead token if we need one and don't already have one.  */
 
@@ -1599,18 +1610,30 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
+      YYDPRINTF ((stderr, "Reading a token\n"));
       yychar = yylex ();
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      yyerror_range[1] = yylloc;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1638,15 +1661,14 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
   *++yylsp = yylloc;
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1661,7 +1683,7 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
@@ -1677,816 +1699,817 @@ yyreduce:
      GCC warning that YYVAL may be used uninitialized.  */
   yyval = yyvsp[1-yylen];
 
-  /* Default location.  */
+  /* Default location. */
   YYLLOC_DEFAULT (yyloc, (yylsp - yylen), yylen);
+  yyerror_range[1] = yyloc;
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 2:
-#line 157 "parser.y" /* yacc.c:1646  */
-    {
-                        Program *program = new Program((yyvsp[0].declList));
-                        if (ReportError::NumErrors() == 0)
-                            program->Print(0);
+  case 2: /* Program: DeclList  */
+#line 172 "parser.y"
+                      {
+                        parsedProgram = new Program((yyvsp[0].declList));
+                        parsedProgram->SetImports(GetImportDirectives());
                       }
-#line 1693 "y.tab.c" /* yacc.c:1646  */
+#line 1715 "y.tab.c"
     break;
 
-  case 3:
-#line 164 "parser.y" /* yacc.c:1646  */
-    {((yyval.declList)=(yyvsp[-1].declList))->Append((yyvsp[0].decl));}
-#line 1699 "y.tab.c" /* yacc.c:1646  */
+  case 3: /* DeclList: DeclList Decl  */
+#line 178 "parser.y"
+                                    {((yyval.declList)=(yyvsp[-1].declList))->Append((yyvsp[0].decl));}
+#line 1721 "y.tab.c"
     break;
 
-  case 4:
-#line 165 "parser.y" /* yacc.c:1646  */
-    {((yyval.declList) = new List<Decl*>)->Append((yyvsp[0].decl));}
-#line 1705 "y.tab.c" /* yacc.c:1646  */
+  case 4: /* DeclList: Decl  */
+#line 179 "parser.y"
+                                    {((yyval.declList) = new List<Decl*>)->Append((yyvsp[0].decl));}
+#line 1727 "y.tab.c"
     break;
 
-  case 5:
-#line 168 "parser.y" /* yacc.c:1646  */
-    {(yyval.decl) = (yyvsp[0].varDecl);}
-#line 1711 "y.tab.c" /* yacc.c:1646  */
+  case 5: /* Decl: VariableDecl  */
+#line 182 "parser.y"
+                                    {(yyval.decl) = (yyvsp[0].varDecl);}
+#line 1733 "y.tab.c"
     break;
 
-  case 6:
-#line 169 "parser.y" /* yacc.c:1646  */
-    {(yyval.decl) = (yyvsp[0].fnDecl);}
-#line 1717 "y.tab.c" /* yacc.c:1646  */
+  case 6: /* Decl: FunctionDecl  */
+#line 183 "parser.y"
+                                    {(yyval.decl) = (yyvsp[0].fnDecl);}
+#line 1739 "y.tab.c"
     break;
 
-  case 7:
-#line 170 "parser.y" /* yacc.c:1646  */
-    {(yyval.decl) = (yyvsp[0].classDecl);}
-#line 1723 "y.tab.c" /* yacc.c:1646  */
+  case 7: /* Decl: ClassDecl  */
+#line 184 "parser.y"
+                                    {(yyval.decl) = (yyvsp[0].classDecl);}
+#line 1745 "y.tab.c"
     break;
 
-  case 8:
-#line 171 "parser.y" /* yacc.c:1646  */
-    {(yyval.decl) = (yyvsp[0].interfDecl);}
-#line 1729 "y.tab.c" /* yacc.c:1646  */
+  case 8: /* Decl: InterfaceDecl  */
+#line 185 "parser.y"
+                                    {(yyval.decl) = (yyvsp[0].interfDecl);}
+#line 1751 "y.tab.c"
     break;
 
-  case 9:
-#line 174 "parser.y" /* yacc.c:1646  */
-    {(yyval.varDecl) = (yyvsp[-1].varDecl);}
-#line 1735 "y.tab.c" /* yacc.c:1646  */
+  case 9: /* VariableDecl: Variable ';'  */
+#line 188 "parser.y"
+                                    {(yyval.varDecl) = (yyvsp[-1].varDecl);}
+#line 1757 "y.tab.c"
     break;
 
-  case 10:
-#line 178 "parser.y" /* yacc.c:1646  */
-    {
+  case 10: /* Variable: Type T_Identifier  */
+#line 192 "parser.y"
+                      {
                         Identifier *ident = new Identifier((yylsp[0]), (yyvsp[0].identifier));
                         (yyval.varDecl) = new VarDecl(ident, (yyvsp[-1].type));
                       }
-#line 1744 "y.tab.c" /* yacc.c:1646  */
+#line 1766 "y.tab.c"
     break;
 
-  case 11:
-#line 184 "parser.y" /* yacc.c:1646  */
-    {(yyval.type) = Type::intType;}
-#line 1750 "y.tab.c" /* yacc.c:1646  */
+  case 11: /* Type: T_Int  */
+#line 198 "parser.y"
+                                  {(yyval.type) = Type::intType;}
+#line 1772 "y.tab.c"
     break;
 
-  case 12:
-#line 185 "parser.y" /* yacc.c:1646  */
-    {(yyval.type) = Type::doubleType;}
-#line 1756 "y.tab.c" /* yacc.c:1646  */
+  case 12: /* Type: T_Double  */
+#line 199 "parser.y"
+                                  {(yyval.type) = Type::doubleType;}
+#line 1778 "y.tab.c"
     break;
 
-  case 13:
-#line 186 "parser.y" /* yacc.c:1646  */
-    {(yyval.type) = Type::boolType;}
-#line 1762 "y.tab.c" /* yacc.c:1646  */
+  case 13: /* Type: T_Bool  */
+#line 200 "parser.y"
+                                  {(yyval.type) = Type::boolType;}
+#line 1784 "y.tab.c"
     break;
 
-  case 14:
-#line 187 "parser.y" /* yacc.c:1646  */
-    {(yyval.type) = Type::stringType;}
-#line 1768 "y.tab.c" /* yacc.c:1646  */
+  case 14: /* Type: T_String  */
+#line 201 "parser.y"
+                                  {(yyval.type) = Type::stringType;}
+#line 1790 "y.tab.c"
     break;
 
-  case 15:
-#line 189 "parser.y" /* yacc.c:1646  */
-    {
+  case 15: /* Type: T_Identifier  */
+#line 203 "parser.y"
+                      {
                         Identifier *ident = new Identifier((yylsp[0]), (yyvsp[0].identifier));
                         (yyval.type) = new NamedType(ident);
                       }
-#line 1777 "y.tab.c" /* yacc.c:1646  */
+#line 1799 "y.tab.c"
     break;
 
-  case 16:
-#line 194 "parser.y" /* yacc.c:1646  */
-    {
+  case 16: /* Type: Type T_Dims  */
+#line 208 "parser.y"
+                      {
                         (yyval.type) = new ArrayType((yylsp[-1]), (yyvsp[-1].type));
                       }
-#line 1785 "y.tab.c" /* yacc.c:1646  */
+#line 1807 "y.tab.c"
     break;
 
-  case 17:
-#line 200 "parser.y" /* yacc.c:1646  */
-    {
+  case 17: /* FunctionDecl: Type T_Identifier '(' Formals ')' StmtBlock  */
+#line 214 "parser.y"
+                      {
                           Identifier *ident = new Identifier((yylsp[-4]), (yyvsp[-4].identifier));
                           (yyval.fnDecl) = new FnDecl(ident, (yyvsp[-5].type), (yyvsp[-2].varDeclList));
                           (yyval.fnDecl) -> SetFunctionBody((yyvsp[0].stmtBlock));
                       }
-#line 1795 "y.tab.c" /* yacc.c:1646  */
+#line 1817 "y.tab.c"
     break;
 
-  case 18:
-#line 206 "parser.y" /* yacc.c:1646  */
-    {
+  case 18: /* FunctionDecl: T_Void T_Identifier '(' Formals ')' StmtBlock  */
+#line 220 "parser.y"
+                      {
                           Identifier *ident = new Identifier((yylsp[-4]), (yyvsp[-4].identifier));
                           (yyval.fnDecl) = new FnDecl(ident, Type::voidType, (yyvsp[-2].varDeclList));
                           (yyval.fnDecl) -> SetFunctionBody((yyvsp[0].stmtBlock));
                       }
-#line 1805 "y.tab.c" /* yacc.c:1646  */
+#line 1827 "y.tab.c"
     break;
 
-  case 19:
-#line 213 "parser.y" /* yacc.c:1646  */
-    {(yyval.varDeclList) = (yyvsp[0].varDeclList);}
-#line 1811 "y.tab.c" /* yacc.c:1646  */
+  case 19: /* Formals: VarList  */
+#line 227 "parser.y"
+                              {(yyval.varDeclList) = (yyvsp[0].varDeclList);}
+#line 1833 "y.tab.c"
     break;
 
-  case 20:
-#line 214 "parser.y" /* yacc.c:1646  */
-    {(yyval.varDeclList) = new List<VarDecl*>;}
-#line 1817 "y.tab.c" /* yacc.c:1646  */
+  case 20: /* Formals: %empty  */
+#line 228 "parser.y"
+                      {(yyval.varDeclList) = new List<VarDecl*>;}
+#line 1839 "y.tab.c"
     break;
 
-  case 21:
-#line 218 "parser.y" /* yacc.c:1646  */
-    {
+  case 21: /* VarList: Variable  */
+#line 232 "parser.y"
+                      {
                         (yyval.varDeclList) = new List<VarDecl*>;
                         (yyval.varDeclList) -> Append((yyvsp[0].varDecl));
                       }
-#line 1826 "y.tab.c" /* yacc.c:1646  */
+#line 1848 "y.tab.c"
     break;
 
-  case 22:
-#line 223 "parser.y" /* yacc.c:1646  */
-    {
+  case 22: /* VarList: VarList ',' Variable  */
+#line 237 "parser.y"
+                      {
                         (yyval.varDeclList) -> Append((yyvsp[0].varDecl));
                       }
-#line 1834 "y.tab.c" /* yacc.c:1646  */
+#line 1856 "y.tab.c"
     break;
 
-  case 23:
-#line 229 "parser.y" /* yacc.c:1646  */
-    {
+  case 23: /* ClassDecl: T_Class T_Identifier T_Extends T_Identifier T_Implements Ident_plus_comma '{' Field_star '}'  */
+#line 243 "parser.y"
+                      {
                         Identifier *ident_1 = new Identifier((yylsp[-7]), (yyvsp[-7].identifier));
                         Identifier *ident_2 = new Identifier((yylsp[-5]), (yyvsp[-5].identifier));
                         NamedType *nt = new NamedType(ident_2);
                         (yyval.classDecl) = new ClassDecl(ident_1, nt, (yyvsp[-3].namedTypeList), (yyvsp[-1].declList));
                       }
-#line 1845 "y.tab.c" /* yacc.c:1646  */
+#line 1867 "y.tab.c"
     break;
 
-  case 24:
-#line 236 "parser.y" /* yacc.c:1646  */
-    {
+  case 24: /* ClassDecl: T_Class T_Identifier T_Implements Ident_plus_comma '{' Field_star '}'  */
+#line 250 "parser.y"
+                      {
                         Identifier *ident = new Identifier((yylsp[-5]), (yyvsp[-5].identifier));
                         (yyval.classDecl) = new ClassDecl(ident, NULL, (yyvsp[-3].namedTypeList), (yyvsp[-1].declList));
                       }
-#line 1854 "y.tab.c" /* yacc.c:1646  */
+#line 1876 "y.tab.c"
     break;
 
-  case 25:
-#line 241 "parser.y" /* yacc.c:1646  */
-    {
+  case 25: /* ClassDecl: T_Class T_Identifier T_Extends T_Identifier '{' Field_star '}'  */
+#line 255 "parser.y"
+                      {
                         Identifier *ident_1 = new Identifier((yylsp[-5]), (yyvsp[-5].identifier));
                         Identifier *ident_2 = new Identifier((yylsp[-3]), (yyvsp[-3].identifier));
                         NamedType *nt = new NamedType(ident_2);
                         (yyval.classDecl) = new ClassDecl(ident_1, nt, new List<NamedType*>, (yyvsp[-1].declList));
                       }
-#line 1865 "y.tab.c" /* yacc.c:1646  */
+#line 1887 "y.tab.c"
     break;
 
-  case 26:
-#line 248 "parser.y" /* yacc.c:1646  */
-    {
+  case 26: /* ClassDecl: T_Class T_Identifier '{' Field_star '}'  */
+#line 262 "parser.y"
+                      {
                         Identifier *ident = new Identifier((yylsp[-3]), (yyvsp[-3].identifier));
                         (yyval.classDecl) = new ClassDecl(ident, NULL, new List<NamedType*>, (yyvsp[-1].declList));
                       }
-#line 1874 "y.tab.c" /* yacc.c:1646  */
+#line 1896 "y.tab.c"
     break;
 
-  case 27:
-#line 254 "parser.y" /* yacc.c:1646  */
-    {(yyval.declList) = new List<Decl*>;}
-#line 1880 "y.tab.c" /* yacc.c:1646  */
+  case 27: /* Field_star: %empty  */
+#line 268 "parser.y"
+                      {(yyval.declList) = new List<Decl*>;}
+#line 1902 "y.tab.c"
     break;
 
-  case 28:
-#line 256 "parser.y" /* yacc.c:1646  */
-    {
+  case 28: /* Field_star: Field_star Field  */
+#line 270 "parser.y"
+                      {
                         (yyval.declList) = (yyvsp[-1].declList);
                         (yyval.declList) -> Append((yyvsp[0].decl));
                       }
-#line 1889 "y.tab.c" /* yacc.c:1646  */
+#line 1911 "y.tab.c"
     break;
 
-  case 29:
-#line 263 "parser.y" /* yacc.c:1646  */
-    {
+  case 29: /* Ident_plus_comma: T_Identifier  */
+#line 277 "parser.y"
+                      {
                         Identifier *ident = new Identifier((yylsp[0]), (yyvsp[0].identifier));
                         NamedType *nt = new NamedType(ident);
                         (yyval.namedTypeList) = new List<NamedType*>;
                         (yyval.namedTypeList) -> Append(nt);
                       }
-#line 1900 "y.tab.c" /* yacc.c:1646  */
+#line 1922 "y.tab.c"
     break;
 
-  case 30:
-#line 270 "parser.y" /* yacc.c:1646  */
-    {
+  case 30: /* Ident_plus_comma: Ident_plus_comma ',' T_Identifier  */
+#line 284 "parser.y"
+                      {
                         Identifier *ident = new Identifier((yylsp[0]), (yyvsp[0].identifier));
                         NamedType *nt = new NamedType(ident);
                         (yyval.namedTypeList) -> Append(nt);
                       }
-#line 1910 "y.tab.c" /* yacc.c:1646  */
+#line 1932 "y.tab.c"
     break;
 
-  case 31:
-#line 277 "parser.y" /* yacc.c:1646  */
-    {(yyval.decl) = (yyvsp[0].varDecl);}
-#line 1916 "y.tab.c" /* yacc.c:1646  */
+  case 31: /* Field: VariableDecl  */
+#line 291 "parser.y"
+                                    {(yyval.decl) = (yyvsp[0].varDecl);}
+#line 1938 "y.tab.c"
     break;
 
-  case 32:
-#line 278 "parser.y" /* yacc.c:1646  */
-    {(yyval.decl) = (yyvsp[0].fnDecl);}
-#line 1922 "y.tab.c" /* yacc.c:1646  */
+  case 32: /* Field: FunctionDecl  */
+#line 292 "parser.y"
+                                    {(yyval.decl) = (yyvsp[0].fnDecl);}
+#line 1944 "y.tab.c"
     break;
 
-  case 33:
-#line 282 "parser.y" /* yacc.c:1646  */
-    {
+  case 33: /* InterfaceDecl: T_Interface T_Identifier '{' Prototype_star '}'  */
+#line 296 "parser.y"
+                      {
                         Identifier *ident = new Identifier((yylsp[-3]), (yyvsp[-3].identifier));
                         (yyval.interfDecl) = new InterfaceDecl(ident, (yyvsp[-1].declList));
                       }
-#line 1931 "y.tab.c" /* yacc.c:1646  */
+#line 1953 "y.tab.c"
     break;
 
-  case 34:
-#line 288 "parser.y" /* yacc.c:1646  */
-    {(yyval.declList) = new List<Decl*>;}
-#line 1937 "y.tab.c" /* yacc.c:1646  */
+  case 34: /* Prototype_star: %empty  */
+#line 302 "parser.y"
+                      {(yyval.declList) = new List<Decl*>;}
+#line 1959 "y.tab.c"
     break;
 
-  case 35:
-#line 290 "parser.y" /* yacc.c:1646  */
-    {
+  case 35: /* Prototype_star: Prototype_star Prototype  */
+#line 304 "parser.y"
+                      {
                         (yyval.declList) -> Append((yyvsp[0].decl));
                       }
-#line 1945 "y.tab.c" /* yacc.c:1646  */
+#line 1967 "y.tab.c"
     break;
 
-  case 36:
-#line 296 "parser.y" /* yacc.c:1646  */
-    {
+  case 36: /* Prototype: Type T_Identifier '(' Formals ')' ';'  */
+#line 310 "parser.y"
+                      {
                         Identifier *ident = new Identifier((yylsp[-4]), (yyvsp[-4].identifier));
                         (yyval.decl) = new FnDecl(ident, (yyvsp[-5].type), (yyvsp[-2].varDeclList));
                       }
-#line 1954 "y.tab.c" /* yacc.c:1646  */
+#line 1976 "y.tab.c"
     break;
 
-  case 37:
-#line 301 "parser.y" /* yacc.c:1646  */
-    {
+  case 37: /* Prototype: T_Void T_Identifier '(' Formals ')' ';'  */
+#line 315 "parser.y"
+                      {
                         Identifier *ident = new Identifier((yylsp[-4]), (yyvsp[-4].identifier));
                         (yyval.decl) = new FnDecl(ident, Type::voidType, (yyvsp[-2].varDeclList));
                       }
-#line 1963 "y.tab.c" /* yacc.c:1646  */
+#line 1985 "y.tab.c"
     break;
 
-  case 38:
-#line 308 "parser.y" /* yacc.c:1646  */
-    {
+  case 38: /* Var_Decl_plus: VariableDecl  */
+#line 322 "parser.y"
+                      {
                         (yyval.varDeclList) = new List<VarDecl*>;
                         (yyval.varDeclList) -> Append((yyvsp[0].varDecl));
                       }
-#line 1972 "y.tab.c" /* yacc.c:1646  */
+#line 1994 "y.tab.c"
     break;
 
-  case 39:
-#line 313 "parser.y" /* yacc.c:1646  */
-    {
+  case 39: /* Var_Decl_plus: Var_Decl_plus VariableDecl  */
+#line 327 "parser.y"
+                      {
                         (yyval.varDeclList) -> Append((yyvsp[0].varDecl));
                       }
-#line 1980 "y.tab.c" /* yacc.c:1646  */
+#line 2002 "y.tab.c"
     break;
 
-  case 40:
-#line 320 "parser.y" /* yacc.c:1646  */
-    {
+  case 40: /* Expr_plus_comma: Expr  */
+#line 334 "parser.y"
+                      {
                         (yyval.expr_plus_comma) = new List<Expr*>;
                         (yyval.expr_plus_comma) -> Append((yyvsp[0].expr));
                       }
-#line 1989 "y.tab.c" /* yacc.c:1646  */
+#line 2011 "y.tab.c"
     break;
 
-  case 41:
-#line 325 "parser.y" /* yacc.c:1646  */
-    {
+  case 41: /* Expr_plus_comma: Expr_plus_comma ',' Expr  */
+#line 339 "parser.y"
+                      {
                         (yyval.expr_plus_comma) -> Append((yyvsp[0].expr));
                       }
-#line 1997 "y.tab.c" /* yacc.c:1646  */
+#line 2019 "y.tab.c"
     break;
 
-  case 42:
-#line 331 "parser.y" /* yacc.c:1646  */
-    {
+  case 42: /* Expr: LValue '=' Expr  */
+#line 345 "parser.y"
+                      {
                         Operator *op = new Operator((yylsp[-1]), "=");
                         (yyval.expr) = new AssignExpr((yyvsp[-2].lValue), op, (yyvsp[0].expr));
                       }
-#line 2006 "y.tab.c" /* yacc.c:1646  */
+#line 2028 "y.tab.c"
     break;
 
-  case 43:
-#line 335 "parser.y" /* yacc.c:1646  */
-    {(yyval.expr) = (yyvsp[0].expr);}
-#line 2012 "y.tab.c" /* yacc.c:1646  */
+  case 43: /* Expr: Constant  */
+#line 349 "parser.y"
+                                {(yyval.expr) = (yyvsp[0].expr);}
+#line 2034 "y.tab.c"
     break;
 
-  case 44:
-#line 336 "parser.y" /* yacc.c:1646  */
-    {(yyval.expr) = (yyvsp[0].lValue);}
-#line 2018 "y.tab.c" /* yacc.c:1646  */
+  case 44: /* Expr: LValue  */
+#line 350 "parser.y"
+                                {(yyval.expr) = (yyvsp[0].lValue);}
+#line 2040 "y.tab.c"
     break;
 
-  case 45:
-#line 337 "parser.y" /* yacc.c:1646  */
-    {(yyval.expr) = new This((yylsp[0]));}
-#line 2024 "y.tab.c" /* yacc.c:1646  */
+  case 45: /* Expr: T_This  */
+#line 351 "parser.y"
+                                {(yyval.expr) = new This((yylsp[0]));}
+#line 2046 "y.tab.c"
     break;
 
-  case 46:
-#line 338 "parser.y" /* yacc.c:1646  */
-    {(yyval.expr) = (yyvsp[0].call);}
-#line 2030 "y.tab.c" /* yacc.c:1646  */
+  case 46: /* Expr: Call  */
+#line 352 "parser.y"
+                                {(yyval.expr) = (yyvsp[0].call);}
+#line 2052 "y.tab.c"
     break;
 
-  case 47:
-#line 340 "parser.y" /* yacc.c:1646  */
-    {
+  case 47: /* Expr: '(' Expr ')'  */
+#line 354 "parser.y"
+                      {
                         (yyval.expr) = (yyvsp[-1].expr);
                       }
-#line 2038 "y.tab.c" /* yacc.c:1646  */
+#line 2060 "y.tab.c"
     break;
 
-  case 48:
-#line 344 "parser.y" /* yacc.c:1646  */
-    {
+  case 48: /* Expr: Expr '+' Expr  */
+#line 358 "parser.y"
+                      {
                         Operator *op = new Operator((yylsp[-1]), "+");
                         (yyval.expr) = new ArithmeticExpr((yyvsp[-2].expr), op, (yyvsp[0].expr));
                       }
-#line 2047 "y.tab.c" /* yacc.c:1646  */
+#line 2069 "y.tab.c"
     break;
 
-  case 49:
-#line 349 "parser.y" /* yacc.c:1646  */
-    {
+  case 49: /* Expr: Expr '-' Expr  */
+#line 363 "parser.y"
+                      {
                         Operator *op = new Operator((yylsp[-1]), "-");
                         (yyval.expr) = new ArithmeticExpr((yyvsp[-2].expr), op, (yyvsp[0].expr));
                       }
-#line 2056 "y.tab.c" /* yacc.c:1646  */
+#line 2078 "y.tab.c"
     break;
 
-  case 50:
-#line 354 "parser.y" /* yacc.c:1646  */
-    {
+  case 50: /* Expr: Expr '*' Expr  */
+#line 368 "parser.y"
+                      {
                         Operator *op = new Operator((yylsp[-1]), "*");
                         (yyval.expr) = new ArithmeticExpr((yyvsp[-2].expr), op, (yyvsp[0].expr));
                       }
-#line 2065 "y.tab.c" /* yacc.c:1646  */
+#line 2087 "y.tab.c"
     break;
 
-  case 51:
-#line 359 "parser.y" /* yacc.c:1646  */
-    {
+  case 51: /* Expr: Expr '/' Expr  */
+#line 373 "parser.y"
+                      {
                         Operator *op = new Operator((yylsp[-1]), "/");
                         (yyval.expr) = new ArithmeticExpr((yyvsp[-2].expr), op, (yyvsp[0].expr));
                       }
-#line 2074 "y.tab.c" /* yacc.c:1646  */
+#line 2096 "y.tab.c"
     break;
 
-  case 52:
-#line 364 "parser.y" /* yacc.c:1646  */
-    {
+  case 52: /* Expr: Expr '%' Expr  */
+#line 378 "parser.y"
+                      {
                         Operator *op = new Operator((yylsp[-1]), "%");
                         (yyval.expr) = new ArithmeticExpr((yyvsp[-2].expr), op, (yyvsp[0].expr));
                       }
-#line 2083 "y.tab.c" /* yacc.c:1646  */
+#line 2105 "y.tab.c"
     break;
 
-  case 53:
-#line 369 "parser.y" /* yacc.c:1646  */
-    {
+  case 53: /* Expr: '-' Expr  */
+#line 383 "parser.y"
+                      {
                         Operator *op = new Operator((yylsp[-1]), "-");
                         (yyval.expr) = new ArithmeticExpr(op, (yyvsp[0].expr));
                       }
-#line 2092 "y.tab.c" /* yacc.c:1646  */
+#line 2114 "y.tab.c"
     break;
 
-  case 54:
-#line 374 "parser.y" /* yacc.c:1646  */
-    {
+  case 54: /* Expr: Expr '<' Expr  */
+#line 388 "parser.y"
+                      {
                         Operator *op = new Operator((yylsp[-1]), "<");
                         (yyval.expr) = new RelationalExpr((yyvsp[-2].expr), op, (yyvsp[0].expr));
                       }
-#line 2101 "y.tab.c" /* yacc.c:1646  */
+#line 2123 "y.tab.c"
     break;
 
-  case 55:
-#line 379 "parser.y" /* yacc.c:1646  */
-    {
+  case 55: /* Expr: Expr T_LessEqual Expr  */
+#line 393 "parser.y"
+                      {
                         Operator *op = new Operator((yylsp[-1]), "<=");
                         (yyval.expr) = new RelationalExpr((yyvsp[-2].expr), op, (yyvsp[0].expr));
                       }
-#line 2110 "y.tab.c" /* yacc.c:1646  */
+#line 2132 "y.tab.c"
     break;
 
-  case 56:
-#line 384 "parser.y" /* yacc.c:1646  */
-    {
+  case 56: /* Expr: Expr '>' Expr  */
+#line 398 "parser.y"
+                      {
                         Operator *op = new Operator((yylsp[-1]), ">");
                         (yyval.expr) = new RelationalExpr((yyvsp[-2].expr), op, (yyvsp[0].expr));
                       }
-#line 2119 "y.tab.c" /* yacc.c:1646  */
+#line 2141 "y.tab.c"
     break;
 
-  case 57:
-#line 389 "parser.y" /* yacc.c:1646  */
-    {
+  case 57: /* Expr: Expr T_GreaterEqual Expr  */
+#line 403 "parser.y"
+                      {
                         Operator *op = new Operator((yylsp[-1]), ">=");
                         (yyval.expr) = new RelationalExpr((yyvsp[-2].expr), op, (yyvsp[0].expr));
                       }
-#line 2128 "y.tab.c" /* yacc.c:1646  */
+#line 2150 "y.tab.c"
     break;
 
-  case 58:
-#line 394 "parser.y" /* yacc.c:1646  */
-    {
+  case 58: /* Expr: Expr T_Equal Expr  */
+#line 408 "parser.y"
+                      {
                         Operator *op = new Operator((yylsp[-1]), "==");
                         (yyval.expr) = new EqualityExpr((yyvsp[-2].expr), op, (yyvsp[0].expr));
                       }
-#line 2137 "y.tab.c" /* yacc.c:1646  */
+#line 2159 "y.tab.c"
     break;
 
-  case 59:
-#line 399 "parser.y" /* yacc.c:1646  */
-    {
+  case 59: /* Expr: Expr T_NotEqual Expr  */
+#line 413 "parser.y"
+                      {
                         Operator *op = new Operator((yylsp[-1]), "!=");
                         (yyval.expr) = new EqualityExpr((yyvsp[-2].expr), op, (yyvsp[0].expr));
                       }
-#line 2146 "y.tab.c" /* yacc.c:1646  */
+#line 2168 "y.tab.c"
     break;
 
-  case 60:
-#line 404 "parser.y" /* yacc.c:1646  */
-    {
+  case 60: /* Expr: Expr T_And Expr  */
+#line 418 "parser.y"
+                      {
                         Operator *op = new Operator((yylsp[-1]), "&&");
                         (yyval.expr) = new LogicalExpr((yyvsp[-2].expr), op, (yyvsp[0].expr));
                       }
-#line 2155 "y.tab.c" /* yacc.c:1646  */
+#line 2177 "y.tab.c"
     break;
 
-  case 61:
-#line 409 "parser.y" /* yacc.c:1646  */
-    {
+  case 61: /* Expr: Expr T_Or Expr  */
+#line 423 "parser.y"
+                      {
                         Operator *op = new Operator((yylsp[-1]), "||");
                         (yyval.expr) = new LogicalExpr((yyvsp[-2].expr), op, (yyvsp[0].expr));
                       }
-#line 2164 "y.tab.c" /* yacc.c:1646  */
+#line 2186 "y.tab.c"
     break;
 
-  case 62:
-#line 414 "parser.y" /* yacc.c:1646  */
-    {
+  case 62: /* Expr: '!' Expr  */
+#line 428 "parser.y"
+                      {
                         Operator *op = new Operator((yylsp[-1]), "!");
                         (yyval.expr) = new LogicalExpr(op, (yyvsp[0].expr));
                       }
-#line 2173 "y.tab.c" /* yacc.c:1646  */
+#line 2195 "y.tab.c"
     break;
 
-  case 63:
-#line 419 "parser.y" /* yacc.c:1646  */
-    {
+  case 63: /* Expr: T_ReadInteger '(' ')'  */
+#line 433 "parser.y"
+                      {
                         (yyval.expr) = new ReadIntegerExpr((yylsp[-2]));
                       }
-#line 2181 "y.tab.c" /* yacc.c:1646  */
+#line 2203 "y.tab.c"
     break;
 
-  case 64:
-#line 423 "parser.y" /* yacc.c:1646  */
-    {
+  case 64: /* Expr: T_ReadLine '(' ')'  */
+#line 437 "parser.y"
+                      {
                         (yyval.expr) = new ReadLineExpr((yylsp[-2]));
                       }
-#line 2189 "y.tab.c" /* yacc.c:1646  */
+#line 2211 "y.tab.c"
     break;
 
-  case 65:
-#line 427 "parser.y" /* yacc.c:1646  */
-    {
+  case 65: /* Expr: T_New '(' T_Identifier ')'  */
+#line 441 "parser.y"
+                      {
                         Identifier *ident = new Identifier((yylsp[-1]), (yyvsp[-1].identifier));
                         NamedType *nt = new NamedType(ident);
                         (yyval.expr) = new NewExpr((yylsp[-3]), nt);
                       }
-#line 2199 "y.tab.c" /* yacc.c:1646  */
+#line 2221 "y.tab.c"
     break;
 
-  case 66:
-#line 433 "parser.y" /* yacc.c:1646  */
-    {
+  case 66: /* Expr: T_NewArray '(' Expr ',' Type ')'  */
+#line 447 "parser.y"
+                      {
                         (yyval.expr) = new NewArrayExpr((yylsp[-5]), (yyvsp[-3].expr), (yyvsp[-1].type));
                       }
-#line 2207 "y.tab.c" /* yacc.c:1646  */
+#line 2229 "y.tab.c"
     break;
 
-  case 67:
-#line 436 "parser.y" /* yacc.c:1646  */
-    {
+  case 67: /* Expr: Expr T_Increment  */
+#line 450 "parser.y"
+                                        {
                         Operator *op = new Operator((yylsp[0]), "++");
                         (yyval.expr) = new ArithmeticExpr(op, (yyvsp[-1].expr));
                      }
-#line 2216 "y.tab.c" /* yacc.c:1646  */
+#line 2238 "y.tab.c"
     break;
 
-  case 68:
-#line 440 "parser.y" /* yacc.c:1646  */
-    {
+  case 68: /* Expr: Expr T_Decrement  */
+#line 454 "parser.y"
+                                        {
                         Operator *op = new Operator((yylsp[0]), "--");
                         (yyval.expr) = new ArithmeticExpr(op, (yyvsp[-1].expr));
                       }
-#line 2225 "y.tab.c" /* yacc.c:1646  */
+#line 2247 "y.tab.c"
     break;
 
-  case 69:
-#line 447 "parser.y" /* yacc.c:1646  */
-    {
+  case 69: /* Call: T_Identifier '(' Actuals ')'  */
+#line 461 "parser.y"
+                      {
                         Identifier *ident = new Identifier((yylsp[-3]), (yyvsp[-3].identifier));
                         (yyval.call) = new Call((yylsp[-3]), NULL, ident, (yyvsp[-1].expr_plus_comma));
                       }
-#line 2234 "y.tab.c" /* yacc.c:1646  */
+#line 2256 "y.tab.c"
     break;
 
-  case 70:
-#line 452 "parser.y" /* yacc.c:1646  */
-    {
+  case 70: /* Call: Expr '.' T_Identifier '(' Actuals ')'  */
+#line 466 "parser.y"
+                      {
                         Identifier *ident = new Identifier((yylsp[-3]), (yyvsp[-3].identifier));
                         (yyval.call) = new Call((yylsp[-5]), (yyvsp[-5].expr), ident, (yyvsp[-1].expr_plus_comma));
                       }
-#line 2243 "y.tab.c" /* yacc.c:1646  */
+#line 2265 "y.tab.c"
     break;
 
-  case 71:
-#line 458 "parser.y" /* yacc.c:1646  */
-    {(yyval.expr_plus_comma) = (yyvsp[0].expr_plus_comma);}
-#line 2249 "y.tab.c" /* yacc.c:1646  */
+  case 71: /* Actuals: Expr_plus_comma  */
+#line 472 "parser.y"
+                                        {(yyval.expr_plus_comma) = (yyvsp[0].expr_plus_comma);}
+#line 2271 "y.tab.c"
     break;
 
-  case 72:
-#line 459 "parser.y" /* yacc.c:1646  */
-    {(yyval.expr_plus_comma) = new List<Expr*>;}
-#line 2255 "y.tab.c" /* yacc.c:1646  */
+  case 72: /* Actuals: %empty  */
+#line 473 "parser.y"
+                                        {(yyval.expr_plus_comma) = new List<Expr*>;}
+#line 2277 "y.tab.c"
     break;
 
-  case 73:
-#line 463 "parser.y" /* yacc.c:1646  */
-    {
+  case 73: /* Constant: T_IntConstant  */
+#line 477 "parser.y"
+                      {
                         (yyval.expr) = new IntConstant((yylsp[0]), (yyvsp[0].integerConstant));
                       }
-#line 2263 "y.tab.c" /* yacc.c:1646  */
+#line 2285 "y.tab.c"
     break;
 
-  case 74:
-#line 467 "parser.y" /* yacc.c:1646  */
-    {
+  case 74: /* Constant: T_DoubleConstant  */
+#line 481 "parser.y"
+                      {
                         (yyval.expr) = new DoubleConstant((yylsp[0]), (yyvsp[0].doubleConstant));
                       }
-#line 2271 "y.tab.c" /* yacc.c:1646  */
+#line 2293 "y.tab.c"
     break;
 
-  case 75:
-#line 471 "parser.y" /* yacc.c:1646  */
-    {
+  case 75: /* Constant: T_BoolConstant  */
+#line 485 "parser.y"
+                      {
                         (yyval.expr) = new BoolConstant((yylsp[0]), (yyvsp[0].boolConstant));
                       }
-#line 2279 "y.tab.c" /* yacc.c:1646  */
+#line 2301 "y.tab.c"
     break;
 
-  case 76:
-#line 475 "parser.y" /* yacc.c:1646  */
-    {
+  case 76: /* Constant: T_StringConstant  */
+#line 489 "parser.y"
+                      {
                         (yyval.expr) = new StringConstant((yylsp[0]), (yyvsp[0].stringConstant));
                       }
-#line 2287 "y.tab.c" /* yacc.c:1646  */
+#line 2309 "y.tab.c"
     break;
 
-  case 77:
-#line 479 "parser.y" /* yacc.c:1646  */
-    {
+  case 77: /* Constant: T_Null  */
+#line 493 "parser.y"
+                      {
                         (yyval.expr) = new NullConstant((yylsp[0]));
                       }
-#line 2295 "y.tab.c" /* yacc.c:1646  */
+#line 2317 "y.tab.c"
     break;
 
-  case 78:
-#line 485 "parser.y" /* yacc.c:1646  */
-    {
+  case 78: /* Stmt_plus: Stmt  */
+#line 499 "parser.y"
+                      {
                         (yyval.stmt_plus) = new List<Stmt*>;
                         (yyval.stmt_plus) -> Append((yyvsp[0].stmt));
                       }
-#line 2304 "y.tab.c" /* yacc.c:1646  */
+#line 2326 "y.tab.c"
     break;
 
-  case 79:
-#line 490 "parser.y" /* yacc.c:1646  */
-    {
+  case 79: /* Stmt_plus: Stmt_plus Stmt  */
+#line 504 "parser.y"
+                      {
                         (yyval.stmt_plus) -> Append((yyvsp[0].stmt));
                       }
-#line 2312 "y.tab.c" /* yacc.c:1646  */
+#line 2334 "y.tab.c"
     break;
 
-  case 80:
-#line 496 "parser.y" /* yacc.c:1646  */
-    {
+  case 80: /* StmtBlock: '{' Var_Decl_plus Stmt_plus '}'  */
+#line 510 "parser.y"
+                      {
                         (yyval.stmtBlock) = new StmtBlock((yyvsp[-2].varDeclList), (yyvsp[-1].stmt_plus));
                       }
-#line 2320 "y.tab.c" /* yacc.c:1646  */
+#line 2342 "y.tab.c"
     break;
 
-  case 81:
-#line 500 "parser.y" /* yacc.c:1646  */
-    {
+  case 81: /* StmtBlock: '{' Stmt_plus '}'  */
+#line 514 "parser.y"
+                      {
                         (yyval.stmtBlock) = new StmtBlock(new List<VarDecl*>, (yyvsp[-1].stmt_plus));
                       }
-#line 2328 "y.tab.c" /* yacc.c:1646  */
+#line 2350 "y.tab.c"
     break;
 
-  case 82:
-#line 504 "parser.y" /* yacc.c:1646  */
-    {
+  case 82: /* StmtBlock: '{' Var_Decl_plus '}'  */
+#line 518 "parser.y"
+                      {
                         (yyval.stmtBlock) = new StmtBlock((yyvsp[-1].varDeclList), new List<Stmt*>);
                       }
-#line 2336 "y.tab.c" /* yacc.c:1646  */
+#line 2358 "y.tab.c"
     break;
 
-  case 83:
-#line 508 "parser.y" /* yacc.c:1646  */
-    {
+  case 83: /* StmtBlock: '{' '}'  */
+#line 522 "parser.y"
+                      {
                         (yyval.stmtBlock) = new StmtBlock(new List<VarDecl*>, new List<Stmt*>);
                       }
-#line 2344 "y.tab.c" /* yacc.c:1646  */
+#line 2366 "y.tab.c"
     break;
 
-  case 84:
-#line 513 "parser.y" /* yacc.c:1646  */
-    {(yyval.stmt) = (yyvsp[-1].expr);}
-#line 2350 "y.tab.c" /* yacc.c:1646  */
+  case 84: /* Stmt: Optional_Expr ';'  */
+#line 527 "parser.y"
+                                          {(yyval.stmt) = (yyvsp[-1].expr);}
+#line 2372 "y.tab.c"
     break;
 
-  case 85:
-#line 514 "parser.y" /* yacc.c:1646  */
-    {(yyval.stmt) = (yyvsp[0].ifStmt);}
-#line 2356 "y.tab.c" /* yacc.c:1646  */
+  case 85: /* Stmt: IfStmt  */
+#line 528 "parser.y"
+                                          {(yyval.stmt) = (yyvsp[0].ifStmt);}
+#line 2378 "y.tab.c"
     break;
 
-  case 86:
-#line 515 "parser.y" /* yacc.c:1646  */
-    {(yyval.stmt) = (yyvsp[0].whileStmt);}
-#line 2362 "y.tab.c" /* yacc.c:1646  */
+  case 86: /* Stmt: WhileStmt  */
+#line 529 "parser.y"
+                                          {(yyval.stmt) = (yyvsp[0].whileStmt);}
+#line 2384 "y.tab.c"
     break;
 
-  case 87:
-#line 516 "parser.y" /* yacc.c:1646  */
-    {(yyval.stmt) = (yyvsp[0].forStmt);}
-#line 2368 "y.tab.c" /* yacc.c:1646  */
+  case 87: /* Stmt: ForStmt  */
+#line 530 "parser.y"
+                                          {(yyval.stmt) = (yyvsp[0].forStmt);}
+#line 2390 "y.tab.c"
     break;
 
-  case 88:
-#line 517 "parser.y" /* yacc.c:1646  */
-    {(yyval.stmt) = (yyvsp[0].breakStmt);}
-#line 2374 "y.tab.c" /* yacc.c:1646  */
+  case 88: /* Stmt: BreakStmt  */
+#line 531 "parser.y"
+                                          {(yyval.stmt) = (yyvsp[0].breakStmt);}
+#line 2396 "y.tab.c"
     break;
 
-  case 89:
-#line 518 "parser.y" /* yacc.c:1646  */
-    {(yyval.stmt) = (yyvsp[0].returnStmt);}
-#line 2380 "y.tab.c" /* yacc.c:1646  */
+  case 89: /* Stmt: ReturnStmt  */
+#line 532 "parser.y"
+                                          {(yyval.stmt) = (yyvsp[0].returnStmt);}
+#line 2402 "y.tab.c"
     break;
 
-  case 90:
-#line 519 "parser.y" /* yacc.c:1646  */
-    {(yyval.stmt) = (yyvsp[0].printStmt);}
-#line 2386 "y.tab.c" /* yacc.c:1646  */
+  case 90: /* Stmt: PrintStmt  */
+#line 533 "parser.y"
+                                          {(yyval.stmt) = (yyvsp[0].printStmt);}
+#line 2408 "y.tab.c"
     break;
 
-  case 91:
-#line 520 "parser.y" /* yacc.c:1646  */
-    {(yyval.stmt) = (yyvsp[0].stmtBlock);}
-#line 2392 "y.tab.c" /* yacc.c:1646  */
+  case 91: /* Stmt: StmtBlock  */
+#line 534 "parser.y"
+                                          {(yyval.stmt) = (yyvsp[0].stmtBlock);}
+#line 2414 "y.tab.c"
     break;
 
-  case 92:
-#line 526 "parser.y" /* yacc.c:1646  */
-    {
+  case 92: /* IfStmt: T_If '(' Expr ')' Stmt  */
+#line 540 "parser.y"
+                      {
                         (yyval.ifStmt) = new IfStmt((yyvsp[-2].expr), (yyvsp[0].stmt), NULL);
                       }
-#line 2400 "y.tab.c" /* yacc.c:1646  */
+#line 2422 "y.tab.c"
     break;
 
-  case 93:
-#line 530 "parser.y" /* yacc.c:1646  */
-    {
+  case 93: /* IfStmt: T_If '(' Expr ')' Stmt T_Else Stmt  */
+#line 544 "parser.y"
+                      {
                         (yyval.ifStmt) = new IfStmt((yyvsp[-4].expr), (yyvsp[-2].stmt), (yyvsp[0].stmt));
                       }
-#line 2408 "y.tab.c" /* yacc.c:1646  */
+#line 2430 "y.tab.c"
     break;
 
-  case 94:
-#line 536 "parser.y" /* yacc.c:1646  */
-    {
+  case 94: /* WhileStmt: T_While '(' Expr ')' Stmt  */
+#line 550 "parser.y"
+                      {
                         (yyval.whileStmt) = new WhileStmt((yyvsp[-2].expr), (yyvsp[0].stmt));
                       }
-#line 2416 "y.tab.c" /* yacc.c:1646  */
+#line 2438 "y.tab.c"
     break;
 
-  case 95:
-#line 542 "parser.y" /* yacc.c:1646  */
-    {
+  case 95: /* ForStmt: T_For '(' Optional_Expr ';' Expr ';' Optional_Expr ')' Stmt  */
+#line 556 "parser.y"
+                      {
                         (yyval.forStmt) = new ForStmt((yyvsp[-6].expr), (yyvsp[-4].expr), (yyvsp[-2].expr), (yyvsp[0].stmt));
                       }
-#line 2424 "y.tab.c" /* yacc.c:1646  */
+#line 2446 "y.tab.c"
     break;
 
-  case 96:
-#line 548 "parser.y" /* yacc.c:1646  */
-    {
+  case 96: /* ReturnStmt: T_Return Optional_Expr ';'  */
+#line 562 "parser.y"
+                      {
                         (yyval.returnStmt) = new ReturnStmt((yylsp[-2]), (yyvsp[-1].expr));
                       }
-#line 2432 "y.tab.c" /* yacc.c:1646  */
+#line 2454 "y.tab.c"
     break;
 
-  case 97:
-#line 554 "parser.y" /* yacc.c:1646  */
-    {
+  case 97: /* BreakStmt: T_Break ';'  */
+#line 568 "parser.y"
+                      {
                         (yyval.breakStmt) = new BreakStmt((yylsp[-1]));
                       }
-#line 2440 "y.tab.c" /* yacc.c:1646  */
+#line 2462 "y.tab.c"
     break;
 
-  case 98:
-#line 560 "parser.y" /* yacc.c:1646  */
-    {
+  case 98: /* PrintStmt: T_Print '(' Expr_plus_comma ')' ';'  */
+#line 574 "parser.y"
+                      {
                         (yyval.printStmt) = new PrintStmt((yyvsp[-2].expr_plus_comma));
                       }
-#line 2448 "y.tab.c" /* yacc.c:1646  */
+#line 2470 "y.tab.c"
     break;
 
-  case 99:
-#line 566 "parser.y" /* yacc.c:1646  */
-    {
+  case 99: /* LValue: T_Identifier  */
+#line 580 "parser.y"
+                      {
                         Identifier *ident = new Identifier((yylsp[0]), (yyvsp[0].identifier));
                         (yyval.lValue) = new FieldAccess(NULL, ident);
                       }
-#line 2457 "y.tab.c" /* yacc.c:1646  */
+#line 2479 "y.tab.c"
     break;
 
-  case 100:
-#line 571 "parser.y" /* yacc.c:1646  */
-    {
+  case 100: /* LValue: Expr '.' T_Identifier  */
+#line 585 "parser.y"
+                      {
                         Identifier *ident = new Identifier((yylsp[0]), (yyvsp[0].identifier));
                         (yyval.lValue) = new FieldAccess((yyvsp[-2].expr), ident);
                       }
-#line 2466 "y.tab.c" /* yacc.c:1646  */
+#line 2488 "y.tab.c"
     break;
 
-  case 101:
-#line 576 "parser.y" /* yacc.c:1646  */
-    {
+  case 101: /* LValue: Expr '[' Expr ']'  */
+#line 590 "parser.y"
+                      {
                         (yyval.lValue) = new ArrayAccess((yylsp[-3]), (yyvsp[-3].expr), (yyvsp[-1].expr));
                       }
-#line 2474 "y.tab.c" /* yacc.c:1646  */
+#line 2496 "y.tab.c"
     break;
 
-  case 102:
-#line 581 "parser.y" /* yacc.c:1646  */
-    {(yyval.expr) = new EmptyExpr();}
-#line 2480 "y.tab.c" /* yacc.c:1646  */
+  case 102: /* Optional_Expr: %empty  */
+#line 595 "parser.y"
+                            {(yyval.expr) = new EmptyExpr();}
+#line 2502 "y.tab.c"
     break;
 
-  case 103:
-#line 582 "parser.y" /* yacc.c:1646  */
-    {(yyval.expr) = (yyvsp[0].expr);}
-#line 2486 "y.tab.c" /* yacc.c:1646  */
+  case 103: /* Optional_Expr: Expr  */
+#line 596 "parser.y"
+                            {(yyval.expr) = (yyvsp[0].expr);}
+#line 2508 "y.tab.c"
     break;
 
 
-#line 2490 "y.tab.c" /* yacc.c:1646  */
+#line 2512 "y.tab.c"
+
       default: break;
     }
   /* User semantic actions sometimes alter yychar, and that requires
@@ -2500,11 +2523,10 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
   *++yylsp = yyloc;
@@ -2512,14 +2534,13 @@ yyreduce:
   /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
@@ -2530,50 +2551,15 @@ yyreduce:
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYEMPTY : YYTRANSLATE (yychar);
-
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
       yyerror (YY_("syntax error"));
-#else
-# define YYSYNTAX_ERROR yysyntax_error (&yymsg_alloc, &yymsg, \
-                                        yyssp, yytoken)
-      {
-        char const *yymsgp = YY_("syntax error");
-        int yysyntax_error_status;
-        yysyntax_error_status = YYSYNTAX_ERROR;
-        if (yysyntax_error_status == 0)
-          yymsgp = yymsg;
-        else if (yysyntax_error_status == 1)
-          {
-            if (yymsg != yymsgbuf)
-              YYSTACK_FREE (yymsg);
-            yymsg = (char *) YYSTACK_ALLOC (yymsg_alloc);
-            if (!yymsg)
-              {
-                yymsg = yymsgbuf;
-                yymsg_alloc = sizeof yymsgbuf;
-                yysyntax_error_status = 2;
-              }
-            else
-              {
-                yysyntax_error_status = YYSYNTAX_ERROR;
-                yymsgp = yymsg;
-              }
-          }
-        yyerror (yymsgp);
-        if (yysyntax_error_status == 2)
-          goto yyexhaustedlab;
-      }
-# undef YYSYNTAX_ERROR
-#endif
     }
 
   yyerror_range[1] = yylloc;
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
@@ -2602,14 +2588,12 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
-
-  yyerror_range[1] = yylsp[1-yylen];
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
   YYPOPSTACK (yylen);
@@ -2625,13 +2609,14 @@ yyerrorlab:
 yyerrlab1:
   yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
         {
-          yyn += YYTERROR;
-          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
             {
               yyn = yytable[yyn];
               if (0 < yyn)
@@ -2645,7 +2630,7 @@ yyerrlab1:
 
       yyerror_range[1] = *yylsp;
       yydestruct ("Error: popping",
-                  yystos[yystate], yyvsp, yylsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, yylsp);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -2656,13 +2641,11 @@ yyerrlab1:
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
   yyerror_range[2] = yylloc;
-  /* Using YYLLOC is tempting, but would change the location of
-     the lookahead.  YYLOC is available though.  */
-  YYLLOC_DEFAULT (yyloc, yyerror_range, 2);
-  *++yylsp = yyloc;
+  ++yylsp;
+  YYLLOC_DEFAULT (*yylsp, yyerror_range, 2);
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -2673,26 +2656,30 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
 
-#if !defined yyoverflow || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
 
-yyreturn:
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -2708,20 +2695,18 @@ yyreturn:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  yystos[*yyssp], yyvsp, yylsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, yylsp);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
+
   return yyresult;
 }
-#line 586 "parser.y" /* yacc.c:1906  */
+
+#line 600 "parser.y"
 
 
 